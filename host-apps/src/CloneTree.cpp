@@ -0,0 +1,378 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CloneTree.h"
+
+#include <cerrno>
+#include <climits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+[[noreturn]] void
+throwErrno(std::string const& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+struct CloneContext
+{
+    std::filesystem::path sourceRoot;
+    std::filesystem::path destRoot;
+    CloneTreeOptions const& options;
+    CloneTreeStats stats;
+
+    /** Set after the first failed attempt to reflink a file. */
+    bool reflinksUnsupported = false;
+};
+
+/**
+ * Closes a file descriptor on scope exit.
+ */
+class FdCloser
+{
+public:
+    explicit FdCloser(int fd) : mFd(fd) {}
+
+    FdCloser(FdCloser const&) = delete;
+    FdCloser& operator=(FdCloser const&) = delete;
+
+    ~FdCloser() { close(mFd); }
+
+private:
+    int mFd;
+};
+
+/**
+ * Copies file contents the slow way, for when the kernel can't do it for us.
+ */
+void
+copyWithReadWrite(int srcFd, int dstFd, std::filesystem::path const& dstPath)
+{
+    std::vector<char> buffer(1 << 20);
+
+    for (;;)
+    {
+        ssize_t const numRead = read(srcFd, buffer.data(), buffer.size());
+        if (numRead == 0)
+        {
+            return;
+        }
+        else if (numRead == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throwErrno("Failed to read the source of " + dstPath.string());
+        }
+
+        for (ssize_t offset = 0; offset < numRead;)
+        {
+            ssize_t const numWritten = write(dstFd, buffer.data() + offset, numRead - offset);
+            if (numWritten == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throwErrno("Failed to write " + dstPath.string());
+            }
+            offset += numWritten;
+        }
+    }
+}
+
+/**
+ * Copies file contents without sharing storage.
+ */
+void
+copyFileContents(int srcFd, int dstFd, std::filesystem::path const& dstPath, off_t size)
+{
+    off_t remaining = size;
+
+    while (remaining > 0)
+    {
+        ssize_t const numCopied =
+            copy_file_range(srcFd, nullptr, dstFd, nullptr, static_cast<size_t>(remaining), 0);
+        if (numCopied == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            else if (
+                remaining == size &&
+                (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+            {
+                // copy_file_range() has limitations on older kernels and some filesystems.
+                copyWithReadWrite(srcFd, dstFd, dstPath);
+                return;
+            }
+            throwErrno("Failed to copy into " + dstPath.string());
+        }
+        else if (numCopied == 0)
+        {
+            // The file shrank while we were copying it.
+            return;
+        }
+        remaining -= numCopied;
+    }
+}
+
+void
+cloneFile(
+    CloneContext& ctx, std::filesystem::path const& srcPath, std::filesystem::path const& dstPath,
+    struct stat const& st)
+{
+    ctx.stats.numBytes += static_cast<uint64_t>(st.st_size);
+
+    bool const isReadOnly = (st.st_mode & 0222) == 0;
+    if (ctx.reflinksUnsupported && ctx.options.hardlinkReadOnlyFiles && isReadOnly)
+    {
+        if (link(srcPath.c_str(), dstPath.c_str()) == 0)
+        {
+            ++ctx.stats.numHardlinkedFiles;
+            return;
+        }
+        else if (errno != EXDEV && errno != EPERM && errno != EMLINK)
+        {
+            throwErrno("Failed to hard-link " + dstPath.string());
+        }
+    }
+
+    int const srcFd = open(srcPath.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (srcFd == -1)
+    {
+        throwErrno("Failed to open " + srcPath.string());
+    }
+    FdCloser const srcFdCloser(srcFd);
+
+    int const dstFd =
+        open(dstPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, (st.st_mode & 07777) | 0200);
+    if (dstFd == -1)
+    {
+        throwErrno("Failed to create " + dstPath.string());
+    }
+    FdCloser const dstFdCloser(dstFd);
+
+    if (!ctx.reflinksUnsupported && ioctl(dstFd, FICLONE, srcFd) == 0)
+    {
+        ++ctx.stats.numReflinkedFiles;
+    }
+    else
+    {
+        // EOPNOTSUPP, EXDEV, EINVAL and friends all mean "do it the other way".
+        ctx.reflinksUnsupported = true;
+        copyFileContents(srcFd, dstFd, dstPath, st.st_size);
+        ++ctx.stats.numCopiedFiles;
+    }
+
+    // O_CREAT's mode is subject to the umask.
+    if (fchmod(dstFd, st.st_mode & 07777) == -1)
+    {
+        throwErrno("Failed to set permissions on " + dstPath.string());
+    }
+
+    struct timespec const times[2] = {st.st_atim, st.st_mtim};
+    if (futimens(dstFd, times) == -1)
+    {
+        throwErrno("Failed to set timestamps on " + dstPath.string());
+    }
+}
+
+void
+cloneSymlink(
+    CloneContext& ctx, std::filesystem::path const& srcPath, std::filesystem::path const& dstPath)
+{
+    std::string target;
+    target.resize(PATH_MAX);
+
+    ssize_t const targetLength = readlink(srcPath.c_str(), target.data(), target.size());
+    if (targetLength == -1)
+    {
+        throwErrno("Failed to read the symlink " + srcPath.string());
+    }
+    target.resize(static_cast<size_t>(targetLength));
+
+    std::string const sourcePrefix = ctx.sourceRoot.string() + "/";
+    if (target == ctx.sourceRoot.string())
+    {
+        target = ctx.destRoot.string();
+    }
+    else if (target.starts_with(sourcePrefix))
+    {
+        target = ctx.destRoot.string() + "/" + target.substr(sourcePrefix.size());
+    }
+
+    if (symlink(target.c_str(), dstPath.c_str()) == -1)
+    {
+        throwErrno("Failed to create the symlink " + dstPath.string());
+    }
+
+    ++ctx.stats.numSymlinks;
+}
+
+void
+cloneDirContents(
+    CloneContext& ctx, std::filesystem::path const& srcDir, std::filesystem::path const& dstDir)
+{
+    DIR* const dir = opendir(srcDir.c_str());
+    if (!dir)
+    {
+        throwErrno("Failed to open the directory " + srcDir.string());
+    }
+
+    std::vector<std::string> names;
+
+    errno = 0;
+    while (dirent const* entry = readdir(dir))
+    {
+        std::string_view const name = entry->d_name;
+        if (name != "." && name != "..")
+        {
+            names.emplace_back(name);
+        }
+    }
+
+    int const readdirErrno = errno;
+    closedir(dir);
+
+    if (readdirErrno != 0)
+    {
+        errno = readdirErrno;
+        throwErrno("Failed to list the directory " + srcDir.string());
+    }
+
+    for (std::string const& name : names)
+    {
+        std::filesystem::path const srcPath = srcDir / name;
+        std::filesystem::path const dstPath = dstDir / name;
+
+        struct stat st;
+        if (lstat(srcPath.c_str(), &st) == -1)
+        {
+            throwErrno("Failed to stat " + srcPath.string());
+        }
+
+        if (S_ISDIR(st.st_mode))
+        {
+            // We need to be able to populate the directory, even if the original is read-only.
+            if (mkdir(dstPath.c_str(), (st.st_mode & 07777) | 0700) == -1)
+            {
+                throwErrno("Failed to create the directory " + dstPath.string());
+            }
+            ++ctx.stats.numDirs;
+
+            cloneDirContents(ctx, srcPath, dstPath);
+
+            // Populating a directory updates its modification time, so restore it afterwards.
+            struct timespec const times[2] = {st.st_atim, st.st_mtim};
+            chmod(dstPath.c_str(), st.st_mode & 07777);
+            utimensat(AT_FDCWD, dstPath.c_str(), times, AT_SYMLINK_NOFOLLOW);
+        }
+        else if (S_ISLNK(st.st_mode))
+        {
+            cloneSymlink(ctx, srcPath, dstPath);
+        }
+        else if (S_ISREG(st.st_mode))
+        {
+            cloneFile(ctx, srcPath, dstPath, st);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (ctx.options.onEntry)
+        {
+            ctx.options.onEntry(srcPath.lexically_relative(ctx.sourceRoot), st);
+        }
+    }
+}
+
+/**
+ * Makes a path absolute and removes ".", ".." and trailing slashes from it.
+ */
+std::filesystem::path
+normalizedAbsolutePath(std::filesystem::path const& path)
+{
+    std::filesystem::path normalized = std::filesystem::absolute(path).lexically_normal();
+
+    if (!normalized.has_filename() && normalized.has_relative_path())
+    {
+        normalized = normalized.parent_path();
+    }
+
+    return normalized;
+}
+
+} // namespace
+
+CloneTreeStats
+cloneTree(
+    std::filesystem::path const& sourceDir, std::filesystem::path const& destDir,
+    CloneTreeOptions const& options)
+{
+    CloneContext ctx{
+        normalizedAbsolutePath(sourceDir), normalizedAbsolutePath(destDir), options, {}};
+
+    struct stat st;
+    if (stat(ctx.sourceRoot.c_str(), &st) == -1)
+    {
+        throwErrno("Failed to stat " + ctx.sourceRoot.string());
+    }
+
+    if (mkdir(ctx.destRoot.c_str(), (st.st_mode & 07777) | 0700) == -1)
+    {
+        throwErrno("Failed to create the directory " + ctx.destRoot.string());
+    }
+
+    ctx.stats.numDirs = 1;
+
+    cloneDirContents(ctx, ctx.sourceRoot, ctx.destRoot);
+
+    chmod(ctx.destRoot.c_str(), st.st_mode & 07777);
+
+    return ctx.stats;
+}
+
+void
+cloneRegularFile(std::filesystem::path const& srcPath, std::filesystem::path const& dstPath)
+{
+    struct stat st;
+    if (stat(srcPath.c_str(), &st) == -1)
+    {
+        throwErrno("Failed to stat " + srcPath.string());
+    }
+
+    CloneTreeOptions const options;
+    CloneContext ctx{srcPath.parent_path(), dstPath.parent_path(), options, {}};
+    cloneFile(ctx, srcPath, dstPath, st);
+}
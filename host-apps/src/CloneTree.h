@@ -0,0 +1,80 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+#include <sys/stat.h>
+
+/**
+ * What cloneTree() did.
+ */
+struct CloneTreeStats
+{
+    size_t numDirs = 0;
+    size_t numSymlinks = 0;
+    size_t numReflinkedFiles = 0;
+    size_t numHardlinkedFiles = 0;
+    size_t numCopiedFiles = 0;
+    uint64_t numBytes = 0;
+};
+
+struct CloneTreeOptions
+{
+    /**
+     * Hard-link files that have no write permission bits, rather than copy them,
+     * when the filesystem doesn't support reflinks.
+     */
+    bool hardlinkReadOnlyFiles = false;
+
+    /**
+     * Called for every directory, symlink and regular file cloned, except the root,
+     * with a path relative to the source directory and the status of the source entry.
+     */
+    std::function<void(std::filesystem::path const&, struct stat const&)> onEntry;
+};
+
+/**
+ * Recursively clones a directory tree.
+ *
+ * Regular files are cloned with the FICLONE ioctl where the filesystem supports it, which
+ * makes them share storage with the originals until either side is modified. Elsewhere they
+ * are copied with copy_file_range(). Files are only hard-linked if asked for, as Wine modifies
+ * files in place. Permissions and modification times are preserved. Symbolic links are recreated,
+ * with absolute targets pointing inside @p sourceDir redirected into @p destDir. Other types
+ * of files are skipped.
+ *
+ * @param destDir Must not exist, but its parent must.
+ * @throw std::system_error On failure, in which case a partially populated @p destDir
+ *        may remain.
+ */
+CloneTreeStats cloneTree(
+    std::filesystem::path const& sourceDir, std::filesystem::path const& destDir,
+    CloneTreeOptions const& options = {});
+
+/**
+ * Clones a single regular file the same way cloneTree() does, minus hard-linking.
+ *
+ * @param dstPath Must not exist.
+ * @throw std::system_error On failure.
+ */
+void cloneRegularFile(std::filesystem::path const& srcPath, std::filesystem::path const& dstPath);
@@ -0,0 +1,309 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ContentStore.h"
+#include "MappedFile.h"
+#include "ParallelDirWalker.h"
+
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+[[noreturn]] void
+throwErrno(std::string const& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+std::string
+objectPath(Sha256::Digest const& digest, bool executable)
+{
+    std::string const hex = toHexString(digest);
+    return hex.substr(0, 2) + "/" + hex.substr(2) + (executable ? "-x" : "");
+}
+
+/**
+ * A name that no other thread or process is going to use for a temporary link.
+ */
+std::string
+uniqueTempName()
+{
+    static std::atomic<uint64_t> counter = 0;
+    return ".store-tmp-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+}
+
+} // namespace
+
+ContentStore::ContentStore(fs::path const& storeDir)
+{
+    fs::path const objectsDir = storeDir / "objects";
+    fs::create_directories(objectsDir);
+
+    mObjectsFd = open(objectsDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mObjectsFd == -1)
+    {
+        throwErrno("Failed to open " + objectsDir.string());
+    }
+}
+
+ContentStore::~ContentStore()
+{
+    if (mObjectsFd != -1)
+    {
+        close(mObjectsFd);
+    }
+}
+
+ContentStoreLock::ContentStoreLock(fs::path const& storeDir, Mode mode)
+{
+    fs::create_directories(storeDir);
+    fs::path const lockFilePath = storeDir / "lock";
+
+    int const fd = open(lockFilePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        throwErrno("Failed to open " + lockFilePath.string());
+    }
+
+    int const operation = mode == Mode::Extraction ? LOCK_SH : LOCK_EX | LOCK_NB;
+
+    int result;
+    do
+    {
+        result = flock(fd, operation);
+    } while (result == -1 && errno == EINTR);
+
+    if (result == -1)
+    {
+        int const savedErrno = errno;
+        close(fd);
+
+        if (savedErrno == EWOULDBLOCK)
+        {
+            return;
+        }
+
+        errno = savedErrno;
+        throwErrno("Failed to lock " + lockFilePath.string());
+    }
+
+    mFd = fd;
+}
+
+ContentStoreLock::~ContentStoreLock()
+{
+    if (mFd != -1)
+    {
+        // Closing the file releases the lock.
+        close(mFd);
+    }
+}
+
+bool
+ContentStore::materialize(
+    Sha256::Digest const& digest, bool executable, int dirFd, std::string const& name)
+{
+    std::string const object = objectPath(digest, executable);
+    std::string const tempName = uniqueTempName();
+
+    if (linkat(mObjectsFd, object.c_str(), dirFd, tempName.c_str(), 0) == -1)
+    {
+        if (errno == ENOENT || errno == EMLINK)
+        {
+            return false;
+        }
+        throwErrno("Failed to link the object " + object);
+    }
+
+    // Renaming over the target makes the replacement atomic.
+    if (renameat(dirFd, tempName.c_str(), dirFd, name.c_str()) == -1)
+    {
+        int const savedErrno = errno;
+        unlinkat(dirFd, tempName.c_str(), 0);
+        errno = savedErrno;
+        throwErrno("Failed to replace " + name + " with a link to the object " + object);
+    }
+
+    return true;
+}
+
+bool
+ContentStore::addFile(
+    Sha256::Digest const& digest, bool executable, int dirFd, std::string const& name)
+{
+    if (fchmodat(dirFd, name.c_str(), executable ? 0555 : 0444, 0) == -1)
+    {
+        throwErrno("Failed to make " + name + " read-only");
+    }
+
+    std::string const object = objectPath(digest, executable);
+    std::string const fanoutDir = object.substr(0, 2);
+
+    if (mkdirat(mObjectsFd, fanoutDir.c_str(), 0755) == -1 && errno != EEXIST)
+    {
+        throwErrno("Failed to create the object directory " + fanoutDir);
+    }
+
+    if (linkat(dirFd, name.c_str(), mObjectsFd, object.c_str(), 0) == 0)
+    {
+        return true;
+    }
+    else if (errno != EEXIST)
+    {
+        throwErrno("Failed to add " + name + " to the store");
+    }
+
+    // Someone else has added the same contents in the meantime. If that object can't
+    // take any more links, the file stays as it is.
+    materialize(digest, executable, dirFd, name);
+    return false;
+}
+
+ContentStoreIngestStats
+ingestTrees(fs::path const& storeDir, std::vector<fs::path> const& roots, unsigned numThreads)
+{
+    ContentStore store(storeDir);
+    ContentStoreIngestStats stats;
+    std::mutex statsMutex;
+
+    auto ingestFile = [&](fs::path const& path, struct stat const& status) {
+        MappedFile const file(path);
+        Sha256::Digest const digest = sha256(file.data());
+        bool const executable = (status.st_mode & S_IXUSR) != 0;
+
+        std::string const object = objectPath(digest, executable);
+        struct stat objectStatus;
+        bool const alreadyStored =
+            fstatat(store.objectsDirFd(), object.c_str(), &objectStatus, 0) == 0 &&
+            objectStatus.st_dev == status.st_dev && objectStatus.st_ino == status.st_ino;
+
+        if (alreadyStored)
+        {
+            // Already in the store.
+            std::lock_guard lock(statsMutex);
+            ++stats.numFiles;
+            return;
+        }
+
+        int const dirFd = open(path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd == -1)
+        {
+            throwErrno("Failed to open " + path.parent_path().string());
+        }
+
+        bool added = false;
+        try
+        {
+            std::string const name = path.filename();
+            if (!store.materialize(digest, executable, dirFd, name))
+            {
+                added = store.addFile(digest, executable, dirFd, name);
+            }
+        }
+        catch (...)
+        {
+            close(dirFd);
+            throw;
+        }
+        close(dirFd);
+
+        std::lock_guard lock(statsMutex);
+        ++stats.numFiles;
+        if (added)
+        {
+            ++stats.numNewObjects;
+        }
+        else
+        {
+            ++stats.numSharedFiles;
+            stats.numBytesShared += status.st_size;
+        }
+    };
+
+    size_t const numWalkErrors = walkTreesInParallel(
+        roots, numThreads, [&](fs::path const& path, struct stat const& status) {
+            if (S_ISREG(status.st_mode) && status.st_size > 0)
+            {
+                try
+                {
+                    ingestFile(path, status);
+                }
+                catch (std::exception const&)
+                {
+                    std::lock_guard lock(statsMutex);
+                    ++stats.numErrors;
+                }
+            }
+            return true;
+        });
+
+    stats.numErrors += numWalkErrors;
+    return stats;
+}
+
+ContentStoreGcStats
+collectGarbage(fs::path const& storeDir)
+{
+    ContentStoreGcStats stats;
+
+    fs::path const objectsDir = storeDir / "objects";
+    if (!fs::exists(objectsDir))
+    {
+        return stats;
+    }
+
+    for (fs::directory_entry const& fanoutDir : fs::directory_iterator(objectsDir))
+    {
+        if (!fanoutDir.is_directory())
+        {
+            continue;
+        }
+
+        for (fs::directory_entry const& object : fs::directory_iterator(fanoutDir.path()))
+        {
+            struct stat status;
+            if (lstat(object.path().c_str(), &status) == -1 || !S_ISREG(status.st_mode))
+            {
+                continue;
+            }
+
+            ++stats.numObjects;
+
+            // The store's own link is the only one left.
+            if (status.st_nlink == 1 && unlink(object.path().c_str()) == 0)
+            {
+                ++stats.numRemovedObjects;
+                stats.numBytesFreed += status.st_size;
+            }
+        }
+    }
+
+    return stats;
+}
@@ -0,0 +1,168 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Sha256.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * A content-addressed store of read-only files, which Wine builds are materialized from
+ * as trees of hard links.
+ *
+ * Objects live under "<storeDir>/objects/<2 hex digits>/<62 hex digits>", named after
+ * the SHA-256 of their contents, with a "-x" suffix for executable ones, as hard links
+ * share the mode. Objects are made read-only, which is fine for Wine builds, as nothing
+ * modifies them in place. An object no longer linked from anywhere has a link count of 1,
+ * which is what collectGarbage() looks for.
+ *
+ * Files being added to the store have to be on the same filesystem as the store.
+ * All the methods are thread-safe.
+ */
+class ContentStore
+{
+public:
+    ContentStore(ContentStore const&) = delete;
+    ContentStore& operator=(ContentStore const&) = delete;
+
+    /**
+     * Opens the store, creating it if necessary.
+     *
+     * @throw std::system_error On failure.
+     */
+    explicit ContentStore(std::filesystem::path const& storeDir);
+
+    ~ContentStore();
+
+    /**
+     * Links an existing object to @p name in the directory @p dirFd, replacing whatever
+     * is there.
+     *
+     * @return false if there is no such object, or it has as many links as the filesystem
+     *         allows.
+     * @throw std::system_error On other failures.
+     */
+    bool materialize(
+        Sha256::Digest const& digest, bool executable, int dirFd, std::string const& name);
+
+    /**
+     * Makes a regular file read-only and adds it to the store as the object with
+     * the given digest. If such an object already exists, the file is replaced with
+     * a link to it instead.
+     *
+     * @return true if the file became a new object.
+     * @throw std::system_error On failure.
+     */
+    bool addFile(
+        Sha256::Digest const& digest, bool executable, int dirFd, std::string const& name);
+
+    int objectsDirFd() const { return mObjectsFd; }
+
+private:
+    int mObjectsFd = -1;
+};
+
+/**
+ * Keeps extractions into the store and its maintenance from running at the same time.
+ *
+ * ingestTrees() hashing a file an extraction is still writing would produce an object whose
+ * contents don't match its name, and collectGarbage() could remove objects an extraction is
+ * about to link to. Extractions hold a shared flock() on "<storeDir>/lock" for as long as
+ * they run, while ingestTrees() and collectGarbage() need it exclusively.
+ */
+class ContentStoreLock
+{
+public:
+    enum class Mode
+    {
+        /** Waits for maintenance to finish. Any number of extractions may hold it. */
+        Extraction,
+
+        /** Doesn't wait. Check acquired() to see whether the lock was taken. */
+        Maintenance,
+    };
+
+    ContentStoreLock(ContentStoreLock const&) = delete;
+    ContentStoreLock& operator=(ContentStoreLock const&) = delete;
+
+    /**
+     * @throw std::system_error If the lock file can't be created or locked for reasons
+     *        other than someone else holding it.
+     */
+    ContentStoreLock(std::filesystem::path const& storeDir, Mode mode);
+
+    /**
+     * Releases the lock, if it was taken.
+     */
+    ~ContentStoreLock();
+
+    /**
+     * Returns false if the lock is held in a conflicting mode, in which case it was
+     * not taken. Always true in the extraction mode.
+     */
+    bool acquired() const { return mFd != -1; }
+
+private:
+    int mFd = -1;
+};
+
+struct ContentStoreIngestStats
+{
+    size_t numFiles = 0;
+    size_t numNewObjects = 0;
+
+    /** Files replaced with links to objects that were already there. */
+    size_t numSharedFiles = 0;
+
+    /** The size of the files replaced with links to existing objects. */
+    uint64_t numBytesShared = 0;
+
+    size_t numErrors = 0;
+};
+
+/**
+ * Adds every non-empty regular file under the given directories to the store, turning them
+ * into links to its objects. This is how builds installed before the store existed join it.
+ * The caller is expected to hold a ContentStoreLock in the maintenance mode.
+ *
+ * @param numThreads 0 means the number of CPUs.
+ * @throw std::system_error If the store can't be opened.
+ */
+ContentStoreIngestStats ingestTrees(
+    std::filesystem::path const& storeDir, std::vector<std::filesystem::path> const& roots,
+    unsigned numThreads = 0);
+
+struct ContentStoreGcStats
+{
+    size_t numObjects = 0;
+    size_t numRemovedObjects = 0;
+    uint64_t numBytesFreed = 0;
+};
+
+/**
+ * Removes the objects no longer linked from any build. The caller is expected to hold
+ * a ContentStoreLock in the maintenance mode.
+ *
+ * @throw std::system_error If the store can't be listed.
+ */
+ContentStoreGcStats collectGarbage(std::filesystem::path const& storeDir);
@@ -0,0 +1,430 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Dedupe.h"
+
+#include "ParallelDirWalker.h"
+#include "Xxh64.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * The kernel may cap the length of a single dedupe request, so we go in chunks.
+ */
+uint64_t const kDedupeChunkSize = 16 * 1024 * 1024;
+
+struct Candidate
+{
+    std::string path;
+    dev_t device;
+    ino_t inode;
+    uint64_t size;
+    int64_t mtimeNs;
+    mode_t mode;
+    uint64_t hash = 0;
+    bool wasDeduped = false;
+};
+
+enum class ShareResult
+{
+    Shared,
+    Differs,
+    Unsupported,
+    Failed,
+};
+
+int64_t
+mtimeNs(struct stat const& st)
+{
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+}
+
+/**
+ * Makes @p dst share the extents of @p src, which must have the same size.
+ */
+ShareResult
+shareExtents(Candidate const& src, Candidate const& dst, uint64_t& numBytesShared)
+{
+    int const srcFd = open(src.path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (srcFd == -1)
+    {
+        return ShareResult::Failed;
+    }
+
+    // Deduplicating into a file opened read-only works for its owner on any recent kernel.
+    int const dstFd = open(dst.path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (dstFd == -1)
+    {
+        close(srcFd);
+        return ShareResult::Failed;
+    }
+
+    alignas(file_dedupe_range) uint8_t
+        buffer[sizeof(file_dedupe_range) + sizeof(file_dedupe_range_info)] = {};
+    auto* const request = reinterpret_cast<file_dedupe_range*>(buffer);
+    request->dest_count = 1;
+    request->info[0].dest_fd = dstFd;
+
+    ShareResult result = ShareResult::Shared;
+
+    for (uint64_t offset = 0; offset < src.size;)
+    {
+        request->src_offset = offset;
+        request->src_length = std::min(kDedupeChunkSize, src.size - offset);
+        request->info[0].dest_offset = offset;
+        request->info[0].bytes_deduped = 0;
+        request->info[0].status = 0;
+
+        if (ioctl(srcFd, FIDEDUPERANGE, request) == -1)
+        {
+            result = (errno == EOPNOTSUPP || errno == EINVAL || errno == ENOTTY || errno == EXDEV)
+                         ? ShareResult::Unsupported
+                         : ShareResult::Failed;
+            break;
+        }
+
+        if (request->info[0].status == FILE_DEDUPE_RANGE_DIFFERS)
+        {
+            result = ShareResult::Differs;
+            break;
+        }
+        else if (request->info[0].status < 0)
+        {
+            result = request->info[0].status == -EOPNOTSUPP || request->info[0].status == -EINVAL
+                         ? ShareResult::Unsupported
+                         : ShareResult::Failed;
+            break;
+        }
+        else if (request->info[0].bytes_deduped == 0)
+        {
+            // Shouldn't happen, but it would make us loop forever.
+            result = ShareResult::Failed;
+            break;
+        }
+
+        numBytesShared += request->info[0].bytes_deduped;
+        offset += request->info[0].bytes_deduped;
+    }
+
+    close(dstFd);
+    close(srcFd);
+
+    return result;
+}
+
+bool
+haveSameContents(std::string const& lhsPath, std::string const& rhsPath)
+{
+    int const lhsFd = open(lhsPath.c_str(), O_RDONLY | O_CLOEXEC);
+    int const rhsFd = open(rhsPath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    bool same = lhsFd != -1 && rhsFd != -1;
+    std::vector<char> lhsBuffer(1 << 20);
+    std::vector<char> rhsBuffer(1 << 20);
+
+    while (same)
+    {
+        ssize_t const lhsRead = read(lhsFd, lhsBuffer.data(), lhsBuffer.size());
+        ssize_t const rhsRead = read(rhsFd, rhsBuffer.data(), rhsBuffer.size());
+
+        if (lhsRead < 0 || lhsRead != rhsRead ||
+            !std::equal(lhsBuffer.begin(), lhsBuffer.begin() + lhsRead, rhsBuffer.begin()))
+        {
+            same = false;
+        }
+        else if (lhsRead == 0)
+        {
+            break;
+        }
+    }
+
+    if (lhsFd != -1)
+    {
+        close(lhsFd);
+    }
+    if (rhsFd != -1)
+    {
+        close(rhsFd);
+    }
+
+    return same;
+}
+
+/**
+ * Replaces @p dst with a hard link to @p src and makes the now shared file read-only,
+ * so that modifying it through one path doesn't affect the others.
+ */
+bool
+hardlinkOver(Candidate const& src, Candidate const& dst)
+{
+    if (!haveSameContents(src.path, dst.path))
+    {
+        return false;
+    }
+
+    std::string const tempPath = dst.path + ".winebar-dedupe";
+    unlink(tempPath.c_str());
+
+    if (link(src.path.c_str(), tempPath.c_str()) == -1)
+    {
+        return false;
+    }
+
+    if (rename(tempPath.c_str(), dst.path.c_str()) == -1)
+    {
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    chmod(src.path.c_str(), src.mode & 07555);
+    return true;
+}
+
+} // namespace
+
+DedupeStats
+dedupeTrees(
+    std::vector<std::filesystem::path> const& roots, DedupeOptions const& options,
+    DedupeState& state)
+{
+    DedupeStats stats;
+
+    // Collect the regular files that are large enough.
+    std::mutex candidatesMutex;
+    std::vector<Candidate> candidates;
+
+    stats.numErrors += walkTreesInParallel(
+        roots, options.numThreads, [&](std::filesystem::path const& path, struct stat const& st) {
+            if (!S_ISREG(st.st_mode) || static_cast<uint64_t>(st.st_size) < options.minFileSize)
+            {
+                return true;
+            }
+
+            std::string pathString = path.string();
+            if (pathString.find_first_of("\t\n") != std::string::npos)
+            {
+                return true;
+            }
+
+            Candidate candidate{
+                std::move(pathString), st.st_dev, st.st_ino, static_cast<uint64_t>(st.st_size),
+                mtimeNs(st), st.st_mode};
+
+            std::lock_guard<std::mutex> const lock(candidatesMutex);
+            candidates.push_back(std::move(candidate));
+            return true;
+        });
+
+    stats.numFilesScanned = candidates.size();
+
+    // Only files sharing the device and the size with a file of a different inode
+    // may have duplicates. Of a set of hard links, we only keep one.
+    std::sort(candidates.begin(), candidates.end(), [](auto const& lhs, auto const& rhs) {
+        return std::tie(lhs.device, lhs.size, lhs.inode, lhs.path) <
+               std::tie(rhs.device, rhs.size, rhs.inode, rhs.path);
+    });
+    candidates.erase(
+        std::unique(
+            candidates.begin(), candidates.end(),
+            [](auto const& lhs, auto const& rhs) {
+                return lhs.device == rhs.device && lhs.inode == rhs.inode;
+            }),
+        candidates.end());
+
+    std::vector<Candidate> sameSize;
+    for (size_t i = 0; i < candidates.size();)
+    {
+        size_t j = i + 1;
+        while (j < candidates.size() && candidates[j].device == candidates[i].device &&
+               candidates[j].size == candidates[i].size)
+        {
+            ++j;
+        }
+
+        if (j - i > 1)
+        {
+            std::move(candidates.begin() + i, candidates.begin() + j, std::back_inserter(sameSize));
+        }
+        i = j;
+    }
+    candidates.clear();
+
+    // Hash what the state doesn't already have a hash for, in parallel.
+    std::vector<Candidate*> toHash;
+    for (Candidate& candidate : sameSize)
+    {
+        auto const it = state.find(candidate.path);
+        if (it != state.end() && it->second.inode == candidate.inode &&
+            it->second.size == candidate.size && it->second.mtimeNs == candidate.mtimeNs)
+        {
+            candidate.hash = it->second.hash;
+            candidate.wasDeduped = it->second.deduped;
+        }
+        else
+        {
+            toHash.push_back(&candidate);
+        }
+    }
+
+    std::atomic<size_t> nextToHash = 0;
+    std::atomic<size_t> numHashErrors = 0;
+    auto hashWorker = [&] {
+        for (size_t i = nextToHash++; i < toHash.size(); i = nextToHash++)
+        {
+            try
+            {
+                toHash[i]->hash = xxh64File(toHash[i]->path);
+            }
+            catch (std::exception const&)
+            {
+                // A file we can't read can't be deduplicated either. Giving it a path-specific
+                // hash keeps it out of any group.
+                toHash[i]->hash = std::hash<std::string>()(toHash[i]->path);
+                ++numHashErrors;
+            }
+        }
+    };
+
+    unsigned const numThreads =
+        options.numThreads ? options.numThreads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back(hashWorker);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    stats.numFilesHashed = toHash.size();
+    for (Candidate const* candidate : toHash)
+    {
+        stats.numBytesHashed += candidate->size;
+    }
+    stats.numErrors += numHashErrors;
+
+    // Group by hash and share storage within each group.
+    std::map<std::tuple<dev_t, uint64_t, uint64_t>, std::vector<Candidate*>> groups;
+    for (Candidate& candidate : sameSize)
+    {
+        groups[{candidate.device, candidate.size, candidate.hash}].push_back(&candidate);
+    }
+
+    bool sharingUnsupported = false;
+
+    for (auto& [key, group] : groups)
+    {
+        if (group.size() < 2)
+        {
+            continue;
+        }
+
+        stats.numDuplicates += group.size() - 1;
+
+        bool const alreadyShared = std::all_of(
+            group.begin(), group.end(), [](Candidate const* c) { return c->wasDeduped; });
+        if (alreadyShared)
+        {
+            stats.numDuplicatesAlreadyShared += group.size() - 1;
+            continue;
+        }
+
+        if (options.dryRun)
+        {
+            continue;
+        }
+
+        Candidate const& src = *group.front();
+
+        for (size_t i = 1; i < group.size(); ++i)
+        {
+            Candidate& dst = *group[i];
+            ShareResult result = ShareResult::Unsupported;
+
+            if (!sharingUnsupported)
+            {
+                uint64_t numBytesShared = 0;
+                result = shareExtents(src, dst, numBytesShared);
+                if (result == ShareResult::Shared)
+                {
+                    ++stats.numReflinked;
+                    stats.numBytesSaved += numBytesShared;
+                    dst.wasDeduped = true;
+                }
+                else if (result == ShareResult::Unsupported)
+                {
+                    sharingUnsupported = true;
+                }
+            }
+
+            if (result == ShareResult::Unsupported && options.allowHardlinks)
+            {
+                if (hardlinkOver(src, dst))
+                {
+                    ++stats.numHardlinked;
+                    stats.numBytesSaved += dst.size;
+                    dst.inode = src.inode;
+                    dst.mtimeNs = src.mtimeNs;
+                    dst.wasDeduped = true;
+                    continue;
+                }
+                result = ShareResult::Failed;
+            }
+
+            if (result == ShareResult::Failed)
+            {
+                ++stats.numErrors;
+            }
+        }
+
+        group.front()->wasDeduped =
+            std::any_of(group.begin() + 1, group.end(), [](Candidate const* c) {
+                return c->wasDeduped;
+            });
+    }
+
+    // Only remember the files we've seen this time around.
+    DedupeState newState;
+    for (Candidate const& candidate : sameSize)
+    {
+        newState[candidate.path] = DedupeStateEntry{
+            candidate.inode, candidate.size, candidate.mtimeNs, candidate.hash,
+            candidate.wasDeduped};
+    }
+    state = std::move(newState);
+
+    return stats;
+}
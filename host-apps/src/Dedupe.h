@@ -0,0 +1,72 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "DedupeState.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct DedupeOptions
+{
+    /** Smaller files aren't worth the trouble. */
+    uint64_t minFileSize = 16 * 1024;
+
+    /**
+     * When the filesystem doesn't support sharing extents, replace duplicates with hard links
+     * and make the shared file read-only. Off by default, as Wine may want to modify those
+     * files, for example when updating a prefix.
+     */
+    bool allowHardlinks = false;
+
+    /** Only find duplicates, without touching them. */
+    bool dryRun = false;
+
+    /** 0 means the number of CPUs. */
+    unsigned numThreads = 0;
+};
+
+struct DedupeStats
+{
+    size_t numFilesScanned = 0;
+    size_t numFilesHashed = 0;
+    uint64_t numBytesHashed = 0;
+    size_t numDuplicates = 0;
+    size_t numDuplicatesAlreadyShared = 0;
+    size_t numReflinked = 0;
+    size_t numHardlinked = 0;
+    uint64_t numBytesSaved = 0;
+    size_t numErrors = 0;
+};
+
+/**
+ * Finds files with identical contents under the given directories and makes them share
+ * storage.
+ *
+ * Candidates are grouped by device and size, then by hash. Hashes are taken from @p state
+ * for files whose inode, size and modification time haven't changed since it was saved.
+ * Duplicates are deduplicated with the FIDEDUPERANGE ioctl, which has the kernel compare
+ * the contents before sharing extents, so a hash collision can't cause any harm.
+ * @p state is updated with what was learned during this run.
+ */
+DedupeStats dedupeTrees(
+    std::vector<std::filesystem::path> const& roots, DedupeOptions const& options,
+    DedupeState& state);
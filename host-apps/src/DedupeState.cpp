@@ -0,0 +1,130 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DedupeState.h"
+
+#include "MappedFile.h"
+#include "WriteFileAtomically.h"
+
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+// Format:
+//
+//   # WineBar dedupe state 1
+//   <inode><TAB><size><TAB><mtime ns><TAB><hash hex><TAB><deduped 0|1><TAB><path>
+//   ...
+//
+// Paths can't contain newlines, as we skip files that have them.
+
+namespace
+{
+
+std::string_view const kHeader = "# WineBar dedupe state 1";
+
+template <typename T>
+T
+parseNumber(std::string_view field, int base)
+{
+    T value = 0;
+    auto const [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value, base);
+    if (ec != std::errc() || end != field.data() + field.size())
+    {
+        throw std::runtime_error("Malformed dedupe state: bad number " + std::string(field));
+    }
+    return value;
+}
+
+} // namespace
+
+DedupeState
+readDedupeState(std::filesystem::path const& filePath)
+{
+    DedupeState state;
+
+    if (!std::filesystem::exists(filePath))
+    {
+        return state;
+    }
+
+    MappedFile const file(filePath);
+    std::string_view text = file.text();
+
+    if (!text.starts_with(kHeader))
+    {
+        throw std::runtime_error("Not a dedupe state file: " + filePath.string());
+    }
+
+    while (!text.empty())
+    {
+        size_t const newline = text.find('\n');
+        std::string_view line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+        if (line.empty() || line.starts_with('#'))
+        {
+            continue;
+        }
+
+        std::vector<std::string_view> fields;
+        for (int i = 0; i < 5; ++i)
+        {
+            size_t const tab = line.find('\t');
+            if (tab == std::string_view::npos)
+            {
+                throw std::runtime_error("Malformed dedupe state line: " + std::string(line));
+            }
+            fields.push_back(line.substr(0, tab));
+            line.remove_prefix(tab + 1);
+        }
+
+        DedupeStateEntry entry;
+        entry.inode = parseNumber<uint64_t>(fields[0], 10);
+        entry.size = parseNumber<uint64_t>(fields[1], 10);
+        entry.mtimeNs = parseNumber<int64_t>(fields[2], 10);
+        entry.hash = parseNumber<uint64_t>(fields[3], 16);
+        entry.deduped = fields[4] == "1";
+        state.emplace(std::string(line), entry);
+    }
+
+    return state;
+}
+
+void
+writeDedupeState(std::filesystem::path const& filePath, DedupeState const& state)
+{
+    std::string text(kHeader);
+    text += "\n";
+
+    for (auto const& [path, entry] : state)
+    {
+        char fields[128];
+        snprintf(
+            fields, sizeof(fields), "%" PRIu64 "\t%" PRIu64 "\t%" PRId64 "\t%016" PRIx64 "\t%d\t",
+            entry.inode, entry.size, entry.mtimeNs, entry.hash, entry.deduped ? 1 : 0);
+        text += fields;
+        text += path;
+        text += "\n";
+    }
+
+    writeFileAtomically(filePath, text);
+}
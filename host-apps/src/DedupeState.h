@@ -0,0 +1,56 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+/**
+ * What a previous deduplication run learned about a file.
+ */
+struct DedupeStateEntry
+{
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    uint64_t hash = 0;
+
+    /** Whether the file was found to share its storage with its duplicates. */
+    bool deduped = false;
+};
+
+/**
+ * Keyed by absolute path.
+ */
+using DedupeState = std::unordered_map<std::string, DedupeStateEntry>;
+
+/**
+ * Reads the state saved by writeDedupeState(). A missing file is an empty state.
+ *
+ * @throw std::system_error If the file exists but can't be read.
+ * @throw std::runtime_error If the file is malformed.
+ */
+DedupeState readDedupeState(std::filesystem::path const& filePath);
+
+/**
+ * @throw std::system_error On failure.
+ */
+void writeDedupeState(std::filesystem::path const& filePath, DedupeState const& state);
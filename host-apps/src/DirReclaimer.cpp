@@ -0,0 +1,288 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DirReclaimer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+std::vector<std::string>
+listDir(int dirFd)
+{
+    int const dupFd = fcntl(dirFd, F_DUPFD_CLOEXEC, 0);
+    DIR* const dirStream = dupFd == -1 ? nullptr : fdopendir(dupFd);
+    if (!dirStream)
+    {
+        if (dupFd != -1)
+        {
+            close(dupFd);
+        }
+        throw std::system_error(errno, std::generic_category(), "Failed to list a directory");
+    }
+
+    std::vector<std::string> names;
+    while (dirent const* entry = readdir(dirStream))
+    {
+        std::string_view const name = entry->d_name;
+        if (name != "." && name != "..")
+        {
+            names.emplace_back(name);
+        }
+    }
+
+    closedir(dirStream);
+    return names;
+}
+
+/**
+ * A directory being emptied. It's removed once its own listing and the removal of all its
+ * subdirectories are done, whichever thread finishes last.
+ */
+struct PendingDir
+{
+    std::shared_ptr<PendingDir> parent;
+    std::string name;
+
+    /** Open from the moment the directory is listed until it's removed. */
+    int fd = -1;
+
+    /** The listing itself plus the subdirectories not removed yet. */
+    std::atomic<size_t> numPending = 1;
+};
+
+class ReclaimState
+{
+public:
+    explicit ReclaimState(DirReclaimProgress& progress)
+        : mProgress(progress)
+    {
+    }
+
+    void push(std::shared_ptr<PendingDir> dir)
+    {
+        {
+            std::lock_guard<std::mutex> const lock(mMutex);
+            mStack.push_back(std::move(dir));
+        }
+        mCondition.notify_one();
+    }
+
+    void runWorker()
+    {
+        for (;;)
+        {
+            std::shared_ptr<PendingDir> dir;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return !mStack.empty() || mNumBusy == 0; });
+
+                if (mStack.empty())
+                {
+                    // Nobody is busy, so nobody can add more work.
+                    mCondition.notify_all();
+                    return;
+                }
+
+                // Taking the most recent directory keeps the walk close to depth-first,
+                // which bounds the number of directories kept open to roughly the depth
+                // of the tree times the number of threads.
+                dir = std::move(mStack.back());
+                mStack.pop_back();
+                ++mNumBusy;
+            }
+
+            std::vector<std::string> names;
+            if (openAndListDir(*dir, names))
+            {
+                removeEntries(dir, std::move(names));
+            }
+            finishDir(std::move(dir));
+
+            {
+                std::lock_guard<std::mutex> const lock(mMutex);
+                --mNumBusy;
+            }
+            mCondition.notify_all();
+        }
+    }
+
+    /**
+     * Removes the files among @p names, which are the entries of @p dir, and hands its
+     * subdirectories over to the stack.
+     */
+    void removeEntries(std::shared_ptr<PendingDir> const& dir, std::vector<std::string> names)
+    {
+        for (std::string& name : names)
+        {
+            // Most entries are files, so try that first.
+            if (unlinkat(dir->fd, name.c_str(), 0) == 0)
+            {
+                ++mProgress.numFiles;
+            }
+            else if (errno == EISDIR || errno == EPERM)
+            {
+                auto subdir = std::make_shared<PendingDir>();
+                subdir->parent = dir;
+                subdir->name = std::move(name);
+                ++dir->numPending;
+                push(std::move(subdir));
+            }
+            else if (errno != ENOENT)
+            {
+                // Without write permission on the parent, nothing in it can go.
+                ++mProgress.numErrors;
+            }
+        }
+    }
+
+    /**
+     * Drops one pending item of a directory, removing it if that was the last one, which in
+     * turn may complete its parent.
+     */
+    void finishDir(std::shared_ptr<PendingDir> dir)
+    {
+        while (dir && --dir->numPending == 0)
+        {
+            if (dir->fd != -1)
+            {
+                close(dir->fd);
+                dir->fd = -1;
+            }
+
+            std::shared_ptr<PendingDir> parent = std::move(dir->parent);
+            if (!parent)
+            {
+                // The top-level directory stays.
+                return;
+            }
+
+            if (unlinkat(parent->fd, dir->name.c_str(), AT_REMOVEDIR) == 0)
+            {
+                ++mProgress.numDirs;
+            }
+            else if (errno != ENOENT)
+            {
+                ++mProgress.numErrors;
+            }
+
+            dir = std::move(parent);
+        }
+    }
+
+private:
+    bool openAndListDir(PendingDir& dir, std::vector<std::string>& names)
+    {
+        int const flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+        dir.fd = openat(dir.parent->fd, dir.name.c_str(), flags);
+        if (dir.fd == -1)
+        {
+            ++mProgress.numErrors;
+            return false;
+        }
+
+        // Read-only directories are common in Wine builds and prefix templates.
+        struct stat status;
+        if (fstat(dir.fd, &status) == 0 && (status.st_mode & S_IRWXU) != S_IRWXU)
+        {
+            fchmod(dir.fd, status.st_mode | S_IRWXU);
+        }
+
+        try
+        {
+            names = listDir(dir.fd);
+        }
+        catch (std::system_error const&)
+        {
+            ++mProgress.numErrors;
+            return false;
+        }
+
+        return true;
+    }
+
+    DirReclaimProgress& mProgress;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<std::shared_ptr<PendingDir>> mStack;
+    unsigned mNumBusy = 0;
+};
+
+} // namespace
+
+void
+removeDirContents(
+    std::filesystem::path const& dir, unsigned numThreads, DirReclaimProgress& progress)
+{
+    auto root = std::make_shared<PendingDir>();
+    root->fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root->fd == -1)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open " + dir.string());
+    }
+
+    // Listed here rather than by a worker, so that failing to do so can be reported.
+    std::vector<std::string> names;
+    try
+    {
+        names = listDir(root->fd);
+    }
+    catch (...)
+    {
+        close(root->fd);
+        throw;
+    }
+
+    if (numThreads == 0)
+    {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    ReclaimState state(progress);
+    state.removeEntries(root, std::move(names));
+    state.finishDir(std::move(root));
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back([&state] { state.runWorker(); });
+    }
+    state.runWorker();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
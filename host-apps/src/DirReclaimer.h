@@ -0,0 +1,49 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+
+/**
+ * Progress of removeDirContents(), readable from other threads while it runs.
+ */
+struct DirReclaimProgress
+{
+    std::atomic<size_t> numFiles = 0;
+    std::atomic<size_t> numDirs = 0;
+    std::atomic<size_t> numErrors = 0;
+};
+
+/**
+ * Removes everything inside a directory, but not the directory itself.
+ *
+ * Directories at any depth are shared between @p numThreads threads through a common work
+ * queue, so that a single huge subtree keeps all of them busy. Everything is accessed
+ * through directory descriptors, which makes it immune to paths too long for the kernel
+ * and to concurrent renames. Directories that lack write permission are given
+ * it, and symbolic links are never followed. Entries that can't be removed are counted
+ * and skipped.
+ *
+ * @param numThreads 0 means the number of CPUs.
+ * @throw std::system_error If @p dir can't be listed.
+ */
+void removeDirContents(
+    std::filesystem::path const& dir, unsigned numThreads, DirReclaimProgress& progress);
@@ -0,0 +1,516 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DiskUsage.h"
+
+#include "MappedFile.h"
+#include "ParallelDirWalker.h"
+#include "WriteFileAtomically.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Cache file format:
+//
+//   # WineBar disk usage cache 1
+//   D<TAB><inode><TAB><mtime ns><TAB><allocated bytes><TAB><relative dir path>
+//   <TAB><f|o><TAB><inode><TAB><links><TAB><size><TAB><allocated><TAB><shared><TAB><name>
+//   ...
+//
+// Entry lines belong to the directory line above them. 'f' stands for a regular file
+// and 'o' for anything else.
+
+namespace
+{
+
+std::string_view const kHeader = "# WineBar disk usage cache 1";
+
+/**
+ * Looking for shared extents in small files isn't worth an extra open() per file.
+ */
+uint64_t const kMinSizeToCheckForSharing = 16 * 1024;
+
+int64_t
+mtimeNs(struct stat const& st)
+{
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+}
+
+/**
+ * Returns the number of bytes in the extents of the file that are shared with other files.
+ * Returns 0 if the filesystem can't tell.
+ */
+uint64_t
+sharedExtentBytes(std::filesystem::path const& path)
+{
+    int const fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd == -1)
+    {
+        return 0;
+    }
+
+    size_t const kMaxExtents = 64;
+    alignas(fiemap) uint8_t buffer[sizeof(fiemap) + kMaxExtents * sizeof(fiemap_extent)];
+    auto* const request = reinterpret_cast<fiemap*>(buffer);
+
+    uint64_t sharedBytes = 0;
+    uint64_t start = 0;
+
+    for (bool done = false; !done;)
+    {
+        std::fill(std::begin(buffer), std::end(buffer), 0);
+        request->fm_start = start;
+        request->fm_length = FIEMAP_MAX_OFFSET - start;
+        request->fm_extent_count = kMaxExtents;
+
+        if (ioctl(fd, FS_IOC_FIEMAP, request) == -1 || request->fm_mapped_extents == 0)
+        {
+            break;
+        }
+
+        for (uint32_t i = 0; i < request->fm_mapped_extents; ++i)
+        {
+            fiemap_extent const& extent = request->fm_extents[i];
+            if (extent.fe_flags & FIEMAP_EXTENT_SHARED)
+            {
+                sharedBytes += extent.fe_length;
+            }
+            if (extent.fe_flags & FIEMAP_EXTENT_LAST)
+            {
+                done = true;
+            }
+            start = extent.fe_logical + extent.fe_length;
+        }
+    }
+
+    close(fd);
+    return sharedBytes;
+}
+
+template <typename T>
+T
+parseNumber(std::string_view field)
+{
+    T value = 0;
+    auto const [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (ec != std::errc() || end != field.data() + field.size())
+    {
+        throw std::runtime_error("Malformed disk usage cache: bad number " + std::string(field));
+    }
+    return value;
+}
+
+/**
+ * Splits @p line into @p numFields fields separated by tabs, the last one taking
+ * the rest of the line.
+ */
+std::vector<std::string_view>
+splitFields(std::string_view line, size_t numFields)
+{
+    std::vector<std::string_view> fields;
+    for (size_t i = 0; i + 1 < numFields; ++i)
+    {
+        size_t const tab = line.find('\t');
+        if (tab == std::string_view::npos)
+        {
+            throw std::runtime_error("Malformed disk usage cache line: " + std::string(line));
+        }
+        fields.push_back(line.substr(0, tab));
+        line.remove_prefix(tab + 1);
+    }
+    fields.push_back(line);
+    return fields;
+}
+
+bool
+isStorableName(std::string_view name)
+{
+    return name.find_first_of("\t\n") == std::string_view::npos;
+}
+
+std::string
+parentOf(std::string const& relPath)
+{
+    size_t const slash = relPath.rfind('/');
+    return slash == std::string::npos ? std::string() : relPath.substr(0, slash);
+}
+
+} // namespace
+
+DiskUsageScan
+scanDiskUsage(
+    std::filesystem::path const& rootDir, DiskUsageScan const& previousScan,
+    unsigned numThreads, DiskUsageScanStats* stats)
+{
+    struct stat rootStatus;
+    if (stat(rootDir.c_str(), &rootStatus) == -1)
+    {
+        throw std::system_error(errno, std::generic_category(), rootDir.string());
+    }
+    else if (!S_ISDIR(rootStatus.st_mode))
+    {
+        throw std::system_error(ENOTDIR, std::generic_category(), rootDir.string());
+    }
+
+    std::string rootPrefix = rootDir.string();
+    while (rootPrefix.size() > 1 && rootPrefix.back() == '/')
+    {
+        rootPrefix.pop_back();
+    }
+    if (rootPrefix != "/")
+    {
+        rootPrefix += '/';
+    }
+
+    auto relativePath = [&rootPrefix](std::filesystem::path const& path) {
+        std::string const& pathString = path.native();
+        return pathString.size() > rootPrefix.size() ? pathString.substr(rootPrefix.size())
+                                                     : std::string();
+    };
+
+    std::mutex mutex;
+    DiskUsageScan scan;
+    DiskUsageScanStats localStats;
+
+    auto onDir = [&](std::filesystem::path const& path, struct stat const& st) {
+        std::string relPath = relativePath(path);
+
+        std::lock_guard<std::mutex> const lock(mutex);
+
+        auto const it = previousScan.find(relPath);
+        if (it != previousScan.end() && it->second.inode == st.st_ino &&
+            it->second.mtimeNs == mtimeNs(st))
+        {
+            scan.emplace(std::move(relPath), it->second);
+            ++localStats.numDirsReused;
+            return false;
+        }
+
+        DiskUsageDir& dir = scan[std::move(relPath)];
+        dir.inode = st.st_ino;
+        dir.mtimeNs = mtimeNs(st);
+        dir.allocatedBytes = static_cast<uint64_t>(st.st_blocks) * 512;
+        ++localStats.numDirsListed;
+        return true;
+    };
+
+    auto onEntry = [&](std::filesystem::path const& path, struct stat const& st) {
+        if (S_ISDIR(st.st_mode))
+        {
+            return true;
+        }
+
+        DiskUsageEntry entry;
+        entry.name = path.filename().native();
+        entry.isRegularFile = S_ISREG(st.st_mode);
+        entry.inode = st.st_ino;
+        entry.numLinks = st.st_nlink;
+        entry.size = static_cast<uint64_t>(st.st_size);
+        entry.allocatedBytes = static_cast<uint64_t>(st.st_blocks) * 512;
+
+        if (entry.isRegularFile && entry.allocatedBytes >= kMinSizeToCheckForSharing)
+        {
+            entry.sharedBytes = std::min(sharedExtentBytes(path), entry.allocatedBytes);
+        }
+
+        std::string const parentRelPath = relativePath(path.parent_path());
+
+        std::lock_guard<std::mutex> const lock(mutex);
+        scan[parentRelPath].entries.push_back(std::move(entry));
+        return true;
+    };
+
+    localStats.numErrors = walkTreesInParallel({rootDir}, numThreads, onEntry, onDir);
+
+    for (auto& [relPath, dir] : scan)
+    {
+        std::sort(dir.entries.begin(), dir.entries.end(), [](auto const& lhs, auto const& rhs) {
+            return lhs.name < rhs.name;
+        });
+    }
+
+    if (stats)
+    {
+        *stats = localStats;
+    }
+
+    return scan;
+}
+
+DiskUsageScan
+readDiskUsageScan(std::filesystem::path const& filePath)
+{
+    DiskUsageScan scan;
+
+    if (!std::filesystem::exists(filePath))
+    {
+        return scan;
+    }
+
+    MappedFile const file(filePath);
+    std::string_view text = file.text();
+
+    if (!text.starts_with(kHeader))
+    {
+        throw std::runtime_error("Not a disk usage cache file: " + filePath.string());
+    }
+
+    DiskUsageDir* currentDir = nullptr;
+
+    while (!text.empty())
+    {
+        size_t const newline = text.find('\n');
+        std::string_view const line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+        if (line.empty() || line.starts_with('#'))
+        {
+            continue;
+        }
+
+        if (line.starts_with("D\t"))
+        {
+            auto const fields = splitFields(line.substr(2), 4);
+            currentDir = &scan[std::string(fields[3])];
+            currentDir->inode = parseNumber<uint64_t>(fields[0]);
+            currentDir->mtimeNs = parseNumber<int64_t>(fields[1]);
+            currentDir->allocatedBytes = parseNumber<uint64_t>(fields[2]);
+        }
+        else if (line.starts_with('\t') && currentDir)
+        {
+            auto const fields = splitFields(line.substr(1), 7);
+            DiskUsageEntry& entry = currentDir->entries.emplace_back();
+            entry.isRegularFile = fields[0] == "f";
+            entry.inode = parseNumber<uint64_t>(fields[1]);
+            entry.numLinks = parseNumber<uint32_t>(fields[2]);
+            entry.size = parseNumber<uint64_t>(fields[3]);
+            entry.allocatedBytes = parseNumber<uint64_t>(fields[4]);
+            entry.sharedBytes = parseNumber<uint64_t>(fields[5]);
+            entry.name = fields[6];
+        }
+        else
+        {
+            throw std::runtime_error("Malformed disk usage cache line: " + std::string(line));
+        }
+    }
+
+    return scan;
+}
+
+void
+writeDiskUsageScan(std::filesystem::path const& filePath, DiskUsageScan const& scan)
+{
+    std::string text(kHeader);
+    text += "\n";
+
+    for (auto const& [relPath, dir] : scan)
+    {
+        bool const storable =
+            isStorableName(relPath) &&
+            std::all_of(dir.entries.begin(), dir.entries.end(), [](auto const& entry) {
+                return isStorableName(entry.name);
+            });
+        if (!storable)
+        {
+            // Will be listed again next time.
+            continue;
+        }
+
+        char fields[128];
+        snprintf(
+            fields, sizeof(fields), "D\t%" PRIu64 "\t%" PRId64 "\t%" PRIu64 "\t", dir.inode,
+            dir.mtimeNs, dir.allocatedBytes);
+        text += fields;
+        text += relPath;
+        text += "\n";
+
+        for (DiskUsageEntry const& entry : dir.entries)
+        {
+            snprintf(
+                fields, sizeof(fields),
+                "\t%c\t%" PRIu64 "\t%" PRIu32 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t",
+                entry.isRegularFile ? 'f' : 'o', entry.inode, entry.numLinks, entry.size,
+                entry.allocatedBytes, entry.sharedBytes);
+            text += fields;
+            text += entry.name;
+            text += "\n";
+        }
+    }
+
+    writeFileAtomically(filePath, text);
+}
+
+FileCategory
+categorizeFile(std::string_view fileName)
+{
+    size_t const dot = fileName.rfind('.');
+    if (dot == std::string_view::npos)
+    {
+        return FileCategory::Other;
+    }
+
+    std::string extension(fileName.substr(dot + 1));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char ch) {
+        return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+    });
+
+    static std::pair<std::string_view, FileCategory> const kExtensions[] = {
+        {"exe", FileCategory::Executables}, {"dll", FileCategory::Executables},
+        {"sys", FileCategory::Executables}, {"drv", FileCategory::Executables},
+        {"ocx", FileCategory::Executables}, {"cpl", FileCategory::Executables},
+        {"acm", FileCategory::Executables}, {"ax", FileCategory::Executables},
+        {"com", FileCategory::Executables}, {"so", FileCategory::Executables},
+        {"ttf", FileCategory::Fonts},       {"ttc", FileCategory::Fonts},
+        {"otf", FileCategory::Fonts},       {"fon", FileCategory::Fonts},
+        {"fnt", FileCategory::Fonts},       {"msi", FileCategory::Installers},
+        {"msp", FileCategory::Installers},  {"cab", FileCategory::Installers},
+        {"zip", FileCategory::Installers},  {"7z", FileCategory::Installers},
+        {"rar", FileCategory::Installers},  {"png", FileCategory::Media},
+        {"jpg", FileCategory::Media},       {"jpeg", FileCategory::Media},
+        {"bmp", FileCategory::Media},       {"gif", FileCategory::Media},
+        {"ico", FileCategory::Media},       {"dds", FileCategory::Media},
+        {"ogg", FileCategory::Media},       {"wav", FileCategory::Media},
+        {"mp3", FileCategory::Media},       {"mp4", FileCategory::Media},
+        {"avi", FileCategory::Media},       {"wmv", FileCategory::Media},
+        {"bik", FileCategory::Media},       {"txt", FileCategory::Documents},
+        {"pdf", FileCategory::Documents},   {"htm", FileCategory::Documents},
+        {"html", FileCategory::Documents},  {"chm", FileCategory::Documents},
+        {"hlp", FileCategory::Documents},   {"rtf", FileCategory::Documents},
+    };
+
+    for (auto const& [knownExtension, category] : kExtensions)
+    {
+        if (extension == knownExtension)
+        {
+            return category;
+        }
+    }
+
+    return FileCategory::Other;
+}
+
+std::string_view
+fileCategoryName(FileCategory category)
+{
+    switch (category)
+    {
+    case FileCategory::Executables:
+        return "executables";
+    case FileCategory::Fonts:
+        return "fonts";
+    case FileCategory::Installers:
+        return "installers";
+    case FileCategory::Media:
+        return "media";
+    case FileCategory::Documents:
+        return "documents";
+    default:
+        return "other";
+    }
+}
+
+DiskUsageSummary
+summarizeDiskUsage(DiskUsageScan const& scan, size_t maxLargestFiles)
+{
+    DiskUsageSummary summary;
+    std::unordered_set<uint64_t> seenMultiLinkInodes;
+    std::vector<LargeFile> files;
+
+    for (auto const& [relPath, dir] : scan)
+    {
+        DiskUsageTotals& totals = summary.dirTotals[relPath];
+        totals.allocatedBytes += dir.allocatedBytes;
+
+        for (DiskUsageEntry const& entry : dir.entries)
+        {
+            if (entry.numLinks > 1 && !seenMultiLinkInodes.insert(entry.inode).second)
+            {
+                continue;
+            }
+
+            totals.apparentBytes += entry.size;
+            totals.allocatedBytes += entry.allocatedBytes;
+            totals.sharedBytes += entry.sharedBytes;
+
+            if (!entry.isRegularFile)
+            {
+                continue;
+            }
+
+            ++totals.numFiles;
+
+            DiskUsageTotals& categoryTotals =
+                summary.categoryTotals[static_cast<size_t>(categorizeFile(entry.name))];
+            ++categoryTotals.numFiles;
+            categoryTotals.apparentBytes += entry.size;
+            categoryTotals.allocatedBytes += entry.allocatedBytes;
+            categoryTotals.sharedBytes += entry.sharedBytes;
+
+            files.push_back(
+                {relPath.empty() ? entry.name : relPath + "/" + entry.name, entry.size,
+                 entry.allocatedBytes});
+        }
+    }
+
+    // Everything below a directory comes after it in the map, so going backwards
+    // we reach each directory after having accumulated everything below it.
+    for (auto it = summary.dirTotals.rbegin(); it != summary.dirTotals.rend(); ++it)
+    {
+        if (it->first.empty())
+        {
+            continue;
+        }
+
+        auto const parent = summary.dirTotals.find(parentOf(it->first));
+        if (parent != summary.dirTotals.end())
+        {
+            parent->second.numFiles += it->second.numFiles;
+            parent->second.apparentBytes += it->second.apparentBytes;
+            parent->second.allocatedBytes += it->second.allocatedBytes;
+            parent->second.sharedBytes += it->second.sharedBytes;
+        }
+    }
+
+    size_t const numLargest = std::min(maxLargestFiles, files.size());
+    std::partial_sort(
+        files.begin(), files.begin() + numLargest, files.end(),
+        [](LargeFile const& lhs, LargeFile const& rhs) {
+            return lhs.allocatedBytes != rhs.allocatedBytes
+                       ? lhs.allocatedBytes > rhs.allocatedBytes
+                       : lhs.path < rhs.path;
+        });
+    files.resize(numLargest);
+    summary.largestFiles = std::move(files);
+
+    return summary;
+}
@@ -0,0 +1,148 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Anything in a directory that isn't a directory itself.
+ */
+struct DiskUsageEntry
+{
+    std::string name;
+    bool isRegularFile = false;
+    uint64_t inode = 0;
+    uint32_t numLinks = 1;
+    uint64_t size = 0;
+    uint64_t allocatedBytes = 0;
+
+    /** The part of allocatedBytes in extents shared with other files (reflinks). */
+    uint64_t sharedBytes = 0;
+};
+
+struct DiskUsageDir
+{
+    uint64_t inode = 0;
+    int64_t mtimeNs = 0;
+
+    /** Taken by the directory itself. */
+    uint64_t allocatedBytes = 0;
+
+    std::vector<DiskUsageEntry> entries;
+};
+
+/**
+ * Keyed by the path relative to the scanned directory, with an empty string standing
+ * for the scanned directory itself. Being ordered, every directory comes before
+ * everything below it.
+ */
+using DiskUsageScan = std::map<std::string, DiskUsageDir>;
+
+struct DiskUsageScanStats
+{
+    size_t numDirsListed = 0;
+    size_t numDirsReused = 0;
+    size_t numErrors = 0;
+};
+
+/**
+ * Records the sizes of everything under @p rootDir.
+ *
+ * A directory found in @p previousScan with the same inode and modification time is assumed
+ * to have the same entries with the same sizes, which spares stat'ing them. This doesn't
+ * hold for files modified in place, but Wine and most installers replace files rather than
+ * rewrite them.
+ *
+ * @throw std::system_error If @p rootDir can't be listed.
+ */
+DiskUsageScan scanDiskUsage(
+    std::filesystem::path const& rootDir, DiskUsageScan const& previousScan,
+    unsigned numThreads = 0, DiskUsageScanStats* stats = nullptr);
+
+/**
+ * Reads what writeDiskUsageScan() wrote. A missing file is an empty scan.
+ *
+ * @throw std::system_error If the file exists but can't be read.
+ * @throw std::runtime_error If the file is malformed.
+ */
+DiskUsageScan readDiskUsageScan(std::filesystem::path const& filePath);
+
+/**
+ * Directories whose paths contain tabs or newlines are left out.
+ *
+ * @throw std::system_error On failure.
+ */
+void writeDiskUsageScan(std::filesystem::path const& filePath, DiskUsageScan const& scan);
+
+enum class FileCategory
+{
+    Executables,
+    Fonts,
+    Installers,
+    Media,
+    Documents,
+    Other,
+    Count
+};
+
+/**
+ * Tells what kind of a file it is by its extension.
+ */
+FileCategory categorizeFile(std::string_view fileName);
+
+std::string_view fileCategoryName(FileCategory category);
+
+struct DiskUsageTotals
+{
+    size_t numFiles = 0;
+    uint64_t apparentBytes = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t sharedBytes = 0;
+};
+
+struct LargeFile
+{
+    std::string path;
+    uint64_t size = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+struct DiskUsageSummary
+{
+    /** Totals of everything below each directory, keyed like DiskUsageScan. */
+    std::map<std::string, DiskUsageTotals> dirTotals;
+
+    /** The largest files by allocated size, the largest first. */
+    std::vector<LargeFile> largestFiles;
+
+    std::array<DiskUsageTotals, static_cast<size_t>(FileCategory::Count)> categoryTotals;
+};
+
+/**
+ * Files hard-linked from several places are only counted once, at the first path in
+ * the sort order.
+ */
+DiskUsageSummary summarizeDiskUsage(DiskUsageScan const& scan, size_t maxLargestFiles);
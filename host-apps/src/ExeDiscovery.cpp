@@ -0,0 +1,349 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ExeDiscovery.h"
+
+#include "MappedFile.h"
+#include "ParallelDirWalker.h"
+#include "PeFile.h"
+#include "PeVersionInfo.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <mutex>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * The headers and the section table of a PE file fit into that with a lot of room to spare.
+ */
+size_t const kHeadSize = 4096;
+
+/**
+ * Anything smaller is a stub of some kind.
+ */
+uint64_t const kMinExeSize = 16 * 1024;
+
+size_t const kMaxShortDescriptionLength = 40;
+
+std::array<std::string_view, 11> const kNoiseDirNames = {
+    "__installer",   "_commonredist", "_redist",    "crashpad", "directx", "dotnet",
+    "installer",     "installers",    "redist",     "vcredist", "prerequisites",
+};
+
+std::array<std::string_view, 14> const kNoiseFileNameParts = {
+    "unins",     "vcredist", "vc_redist",   "dxsetup", "dotnetfx", "crash",     "bugreport",
+    "errorrep",  "update",   "subprocess",  "setup",   "install",  "redist",    "helper",
+};
+
+std::array<std::string_view, 9> const kNoiseVersionStringParts = {
+    "uninstall", "redistributable", "crash",         "setup",         "installer",
+    "updater",   "bootstrapper",    "error report",  "helper",
+};
+
+std::array<std::string_view, 4> const kVersionStringsToCheckForNoise = {
+    "FileDescription", "ProductName", "InternalName", "OriginalFilename"};
+
+std::string
+toLower(std::string_view str)
+{
+    std::string lower(str);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return lower;
+}
+
+/**
+ * Lowercases and drops anything but letters and digits, so that "My Game (x64)"
+ * and "mygame_x64" compare equal.
+ */
+std::string
+simplifyName(std::string_view str)
+{
+    std::string simplified;
+    for (unsigned char ch : str)
+    {
+        if (std::isalnum(ch))
+        {
+            simplified += static_cast<char>(std::tolower(ch));
+        }
+    }
+    return simplified;
+}
+
+template <size_t N>
+bool
+containsAnyOf(std::string_view lowerStr, std::array<std::string_view, N> const& parts)
+{
+    return std::any_of(parts.begin(), parts.end(), [lowerStr](std::string_view part) {
+        return lowerStr.find(part) != std::string_view::npos;
+    });
+}
+
+std::string
+versionString(ExeCandidate const& candidate, std::string const& key)
+{
+    auto const it = candidate.versionStrings.find(key);
+    return it == candidate.versionStrings.end() ? std::string() : it->second;
+}
+
+int
+scoreCandidate(ExeCandidate const& candidate, std::filesystem::path const& root)
+{
+    int score = 0;
+
+    if (candidate.icon)
+    {
+        score += 30;
+    }
+
+    std::string const productName = versionString(candidate, "ProductName");
+    if (!productName.empty() || !versionString(candidate, "FileDescription").empty())
+    {
+        score += 10;
+    }
+
+    // The main executable tends to be named after the product or the directory it's in.
+    std::string const stem = simplifyName(candidate.path.stem().native());
+    std::string const dirName = simplifyName(candidate.path.parent_path().filename().native());
+    for (std::string const& name : {simplifyName(productName), dirName})
+    {
+        if (!stem.empty() && !name.empty() &&
+            (name.find(stem) != std::string::npos || stem.find(name) != std::string::npos))
+        {
+            score += 20;
+            break;
+        }
+    }
+
+    // "Program Files/Vendor/Product/product.exe" is as deep as the main executable
+    // normally goes.
+    std::filesystem::path const relPath = candidate.path.lexically_relative(root);
+    int const depth = static_cast<int>(std::distance(relPath.begin(), relPath.end()));
+    score -= 10 * std::max(0, depth - 3);
+
+    if (candidate.size >= 10 * 1024 * 1024)
+    {
+        score += 10;
+    }
+    else if (candidate.size >= 1024 * 1024)
+    {
+        score += 5;
+    }
+
+    return score;
+}
+
+/**
+ * Returns std::nullopt if the file is not a GUI executable or is noise.
+ *
+ * @throw std::exception If the file can't be read or parsed.
+ */
+std::optional<ExeCandidate>
+examineExecutable(
+    std::filesystem::path const& path, uint64_t size, ExeDiscoveryOptions const& options)
+{
+    std::array<uint8_t, kHeadSize> head;
+    ssize_t headSize = 0;
+    {
+        int const fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), path.string());
+        }
+        headSize = pread(fd, head.data(), head.size(), 0);
+        close(fd);
+    }
+
+    if (headSize <= 0)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<PeHeaders> const headers =
+        parsePeHeaders(std::span<uint8_t const>(head.data(), headSize));
+    if (!headers || !headers->isGui() || headers->isDll())
+    {
+        return std::nullopt;
+    }
+
+    ExeCandidate candidate;
+    candidate.path = path;
+    candidate.size = size;
+    candidate.is64Bit = headers->is64Bit;
+
+    // Only the pages holding the resources we look at get read.
+    MappedFile const file(path);
+
+    if (auto const version = findPeResource(file.data(), *headers, PeResourceType::Version))
+    {
+        candidate.versionStrings = parseVersionStrings(*version);
+    }
+
+    if (isNoiseExecutable(path.filename().native(), candidate.versionStrings))
+    {
+        return std::nullopt;
+    }
+
+    if (options.extractIcons)
+    {
+        candidate.icon = extractPeIcon(file.data(), *headers);
+    }
+
+    return candidate;
+}
+
+} // namespace
+
+std::string
+ExeCandidate::label() const
+{
+    std::string const description = versionString(*this, "FileDescription");
+    if (!description.empty() && description.size() <= kMaxShortDescriptionLength)
+    {
+        return description;
+    }
+
+    std::string const productName = versionString(*this, "ProductName");
+    if (!productName.empty())
+    {
+        return productName;
+    }
+
+    return path.stem().string();
+}
+
+std::vector<std::filesystem::path>
+programFilesDirs(std::filesystem::path const& driveCDir)
+{
+    std::vector<std::filesystem::path> dirs;
+
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator(driveCDir, ec))
+    {
+        if (toLower(entry.path().filename().native()).starts_with("program files") &&
+            entry.is_directory(ec))
+        {
+            dirs.push_back(entry.path());
+        }
+    }
+
+    std::sort(dirs.begin(), dirs.end());
+    return dirs;
+}
+
+std::vector<ExeCandidate>
+discoverExecutables(
+    std::vector<std::filesystem::path> const& roots, ExeDiscoveryOptions const& options)
+{
+    std::mutex mutex;
+    std::vector<ExeCandidate> candidates;
+
+    walkTreesInParallel(
+        roots, options.numThreads,
+        [&](std::filesystem::path const& path, struct stat const& st) {
+            std::string const lowerName = toLower(path.filename().native());
+
+            if (S_ISDIR(st.st_mode))
+            {
+                return !isNoiseDirectory(lowerName);
+            }
+            else if (!S_ISREG(st.st_mode) || !lowerName.ends_with(".exe") ||
+                     static_cast<uint64_t>(st.st_size) < kMinExeSize)
+            {
+                return true;
+            }
+
+            // Checking the file name first spares reading uninstallers and the like.
+            if (containsAnyOf(lowerName, kNoiseFileNameParts))
+            {
+                return true;
+            }
+
+            try
+            {
+                std::optional<ExeCandidate> candidate =
+                    examineExecutable(path, st.st_size, options);
+                if (candidate)
+                {
+                    std::lock_guard<std::mutex> const lock(mutex);
+                    candidates.push_back(std::move(*candidate));
+                }
+            }
+            catch (std::exception const&)
+            {
+                // Not something we can suggest.
+            }
+
+            return true;
+        });
+
+    for (ExeCandidate& candidate : candidates)
+    {
+        auto const root = std::find_if(roots.begin(), roots.end(), [&candidate](auto const& dir) {
+            auto const relPath = candidate.path.lexically_relative(dir);
+            return !relPath.empty() && *relPath.begin() != "..";
+        });
+        candidate.score = scoreCandidate(candidate, root == roots.end() ? roots.front() : *root);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.path < rhs.path;
+    });
+
+    return candidates;
+}
+
+bool
+isNoiseDirectory(std::string_view dirName)
+{
+    std::string const lowerName = toLower(dirName);
+    return std::find(kNoiseDirNames.begin(), kNoiseDirNames.end(), lowerName) !=
+           kNoiseDirNames.end();
+}
+
+bool
+isNoiseExecutable(
+    std::string_view fileName, std::map<std::string, std::string> const& versionStrings)
+{
+    if (containsAnyOf(toLower(fileName), kNoiseFileNameParts))
+    {
+        return true;
+    }
+
+    for (std::string_view const key : kVersionStringsToCheckForNoise)
+    {
+        auto const it = versionStrings.find(std::string(key));
+        if (it != versionStrings.end() &&
+            containsAnyOf(toLower(it->second), kNoiseVersionStringParts))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
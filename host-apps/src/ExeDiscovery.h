@@ -0,0 +1,89 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PeIcon.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * An executable worth suggesting for pinning.
+ */
+struct ExeCandidate
+{
+    std::filesystem::path path;
+    uint64_t size = 0;
+    bool is64Bit = false;
+
+    /** FileDescription, ProductName, CompanyName and so on, from the version resource. */
+    std::map<std::string, std::string> versionStrings;
+
+    std::optional<PeIconImage> icon;
+
+    /** The higher, the more likely it's what the user is looking for. */
+    int score = 0;
+
+    /**
+     * A human-friendly name: the file description if it's short, otherwise the product name,
+     * otherwise the file name without the extension.
+     */
+    std::string label() const;
+};
+
+struct ExeDiscoveryOptions
+{
+    bool extractIcons = true;
+
+    /** 0 means the number of CPUs. */
+    unsigned numThreads = 0;
+};
+
+/**
+ * Returns the "Program Files" and "Program Files (x86)" directories of a drive_c directory,
+ * matching their names case-insensitively, like Windows would.
+ */
+std::vector<std::filesystem::path> programFilesDirs(std::filesystem::path const& driveCDir);
+
+/**
+ * Finds GUI executables under @p roots, skipping uninstallers, redistributables, crash
+ * reporters and the like, and ranks them. Only the first page of every .exe file is read,
+ * unless it turns out to be a GUI executable, in which case its resources are looked at.
+ *
+ * @return Candidates with the highest score first.
+ */
+std::vector<ExeCandidate> discoverExecutables(
+    std::vector<std::filesystem::path> const& roots, ExeDiscoveryOptions const& options);
+
+/**
+ * Tells whether a directory is unlikely to contain anything worth pinning, judging by its name.
+ */
+bool isNoiseDirectory(std::string_view dirName);
+
+/**
+ * Tells whether an executable is unlikely to be worth pinning, judging by its file name and
+ * version strings.
+ */
+bool isNoiseExecutable(
+    std::string_view fileName, std::map<std::string, std::string> const& versionStrings);
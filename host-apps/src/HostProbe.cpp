@@ -0,0 +1,175 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HostProbe.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+bool
+isPidfdSupported()
+{
+    int const fd = static_cast<int>(syscall(SYS_pidfd_open, getpid(), 0));
+    if (fd == -1)
+    {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+/**
+ * io_uring may be compiled in but disabled by sysctl or a seccomp filter,
+ * so the only way to know is to try setting up a ring.
+ */
+bool
+isIoUringSupported()
+{
+    io_uring_params params = {};
+    int const fd = static_cast<int>(syscall(SYS_io_uring_setup, 1, &params));
+    if (fd == -1)
+    {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+unsigned
+countCpus()
+{
+    // What we are allowed to run on, rather than what's installed.
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0)
+    {
+        return static_cast<unsigned>(CPU_COUNT(&cpus));
+    }
+    return static_cast<unsigned>(sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+} // namespace
+
+HostProbe
+probeHost(fs::path const& dataDir)
+{
+    HostProbe probe;
+
+    probe.bootId = readBootId();
+    probe.pageSize = sysconf(_SC_PAGESIZE);
+    probe.numCpus = countCpus();
+
+    utsname name;
+    if (uname(&name) == 0)
+    {
+        probe.arch = name.machine;
+    }
+
+    probe.muvmAvailable = isExecutableInPath("muvm");
+    probe.fexAvailable = isExecutableInPath("FEXInterpreter");
+    probe.pidfdSupported = isPidfdSupported();
+    probe.ioUringSupported = isIoUringSupported();
+
+    std::error_code ec;
+    fs::path dir = fs::absolute(dataDir, ec);
+    while (!fs::is_directory(dir, ec) && dir.has_relative_path())
+    {
+        dir = dir.parent_path();
+    }
+    probe.reflinksSupported = dirSupportsReflinks(dir);
+
+    return probe;
+}
+
+std::string
+readBootId()
+{
+    std::string bootId;
+    std::getline(std::ifstream("/proc/sys/kernel/random/boot_id"), bootId);
+    return bootId;
+}
+
+bool
+isExecutableInPath(std::string const& name)
+{
+    char const* const path = getenv("PATH");
+    std::string_view dirs = path ? path : "/usr/local/bin:/usr/bin:/bin";
+
+    while (!dirs.empty())
+    {
+        size_t const colon = dirs.find(':');
+        std::string dir(dirs.substr(0, colon));
+        dirs.remove_prefix(colon == std::string_view::npos ? dirs.size() : colon + 1);
+
+        if (dir.empty())
+        {
+            // An empty entry means the current directory.
+            dir = ".";
+        }
+
+        if (access((dir + "/" + name).c_str(), X_OK) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+dirSupportsReflinks(fs::path const& dir)
+{
+    // Unnamed temporary files leave nothing behind, whatever happens.
+    int const srcFd = open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (srcFd == -1)
+    {
+        return false;
+    }
+
+    int const dstFd = open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (dstFd == -1)
+    {
+        close(srcFd);
+        return false;
+    }
+
+    std::vector<char> const block(4096, 'x');
+    bool const supported = write(srcFd, block.data(), block.size()) ==
+                               static_cast<ssize_t>(block.size()) &&
+                           ioctl(dstFd, FICLONE, srcFd) == 0;
+
+    close(dstFd);
+    close(srcFd);
+    return supported;
+}
@@ -0,0 +1,71 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+/**
+ * Facts about the host the app needs at startup.
+ */
+struct HostProbe
+{
+    /** Changes on every boot, which makes it a good cache key for the rest. */
+    std::string bootId;
+
+    long pageSize = 0;
+
+    /** As in "uname -m". */
+    std::string arch;
+
+    unsigned numCpus = 0;
+
+    bool muvmAvailable = false;
+    bool fexAvailable = false;
+
+    bool pidfdSupported = false;
+    bool ioUringSupported = false;
+
+    /** Whether the filesystem of the data directory supports the FICLONE ioctl. */
+    bool reflinksSupported = false;
+};
+
+/**
+ * Collects everything in HostProbe with system calls alone, without starting any processes.
+ *
+ * @param dataDir Where reflink support is checked. If it doesn't exist yet, its nearest
+ *        existing ancestor is checked instead.
+ */
+HostProbe probeHost(std::filesystem::path const& dataDir);
+
+/**
+ * Returns the contents of /proc/sys/kernel/random/boot_id without the trailing newline,
+ * or an empty string if it can't be read.
+ */
+std::string readBootId();
+
+/**
+ * Checks if an executable with the given name is found in any of the directories in $PATH.
+ */
+bool isExecutableInPath(std::string const& name);
+
+/**
+ * Tries cloning a temporary file in @p dir.
+ */
+bool dirSupportsReflinks(std::filesystem::path const& dir);
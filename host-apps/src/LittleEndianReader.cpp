@@ -0,0 +1,129 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LittleEndianReader.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+void
+checkBounds(std::span<uint8_t const> data, size_t offset, size_t numBytes)
+{
+    if (offset > data.size() || numBytes > data.size() - offset)
+    {
+        throw std::runtime_error(
+            "Attempt to read " + std::to_string(numBytes) + " bytes at offset " +
+            std::to_string(offset) + " of a " + std::to_string(data.size()) + " byte buffer");
+    }
+}
+
+template <typename T>
+T
+loadLittleEndian(std::span<uint8_t const> data, size_t offset)
+{
+    checkBounds(data, offset, sizeof(T));
+
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(data[offset + i]) << (8 * i);
+    }
+
+    return value;
+}
+
+} // namespace
+
+LittleEndianReader::LittleEndianReader(std::span<uint8_t const> data) : mData(data)
+{
+}
+
+void
+LittleEndianReader::seek(size_t position)
+{
+    checkBounds(mData, position, 0);
+    mPosition = position;
+}
+
+void
+LittleEndianReader::skip(size_t numBytes)
+{
+    checkBounds(mData, mPosition, numBytes);
+    mPosition += numBytes;
+}
+
+uint8_t
+LittleEndianReader::readU8()
+{
+    checkBounds(mData, mPosition, 1);
+    return mData[mPosition++];
+}
+
+uint16_t
+LittleEndianReader::readU16()
+{
+    uint16_t const value = loadU16(mData, mPosition);
+    mPosition += sizeof(value);
+    return value;
+}
+
+uint32_t
+LittleEndianReader::readU32()
+{
+    uint32_t const value = loadU32(mData, mPosition);
+    mPosition += sizeof(value);
+    return value;
+}
+
+uint64_t
+LittleEndianReader::readU64()
+{
+    uint64_t const value = loadU64(mData, mPosition);
+    mPosition += sizeof(value);
+    return value;
+}
+
+std::span<uint8_t const>
+LittleEndianReader::readBytes(size_t numBytes)
+{
+    checkBounds(mData, mPosition, numBytes);
+    auto const bytes = mData.subspan(mPosition, numBytes);
+    mPosition += numBytes;
+    return bytes;
+}
+
+uint16_t
+loadU16(std::span<uint8_t const> data, size_t offset)
+{
+    return loadLittleEndian<uint16_t>(data, offset);
+}
+
+uint32_t
+loadU32(std::span<uint8_t const> data, size_t offset)
+{
+    return loadLittleEndian<uint32_t>(data, offset);
+}
+
+uint64_t
+loadU64(std::span<uint8_t const> data, size_t offset)
+{
+    return loadLittleEndian<uint64_t>(data, offset);
+}
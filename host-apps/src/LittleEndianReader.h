@@ -0,0 +1,101 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * Reads little-endian integers from a byte buffer, checking every read against its bounds.
+ *
+ * All the binary formats we parse on the host side (.lnk, PE, registry indices) are
+ * little-endian, regardless of the host's endianness.
+ */
+class LittleEndianReader
+{
+public:
+    explicit LittleEndianReader(std::span<uint8_t const> data);
+
+    size_t position() const { return mPosition; }
+
+    size_t remaining() const { return mData.size() - mPosition; }
+
+    /**
+     * @throw std::runtime_error If @p position is past the end of the data.
+     */
+    void seek(size_t position);
+
+    /**
+     * @throw std::runtime_error If there are fewer than @p numBytes bytes remaining.
+     */
+    void skip(size_t numBytes);
+
+    /**
+     * @throw std::runtime_error If there are not enough bytes remaining.
+     */
+    uint8_t readU8();
+
+    /**
+     * @throw std::runtime_error If there are not enough bytes remaining.
+     */
+    uint16_t readU16();
+
+    /**
+     * @throw std::runtime_error If there are not enough bytes remaining.
+     */
+    uint32_t readU32();
+
+    /**
+     * @throw std::runtime_error If there are not enough bytes remaining.
+     */
+    uint64_t readU64();
+
+    /**
+     * Returns a view of the next @p numBytes bytes and advances past them.
+     *
+     * @throw std::runtime_error If there are fewer than @p numBytes bytes remaining.
+     */
+    std::span<uint8_t const> readBytes(size_t numBytes);
+
+private:
+    std::span<uint8_t const> mData;
+    size_t mPosition = 0;
+};
+
+/**
+ * Loads a little-endian 16-bit integer at @p offset.
+ *
+ * @throw std::runtime_error If the integer doesn't fit into @p data.
+ */
+uint16_t loadU16(std::span<uint8_t const> data, size_t offset);
+
+/**
+ * Loads a little-endian 32-bit integer at @p offset.
+ *
+ * @throw std::runtime_error If the integer doesn't fit into @p data.
+ */
+uint32_t loadU32(std::span<uint8_t const> data, size_t offset);
+
+/**
+ * Loads a little-endian 64-bit integer at @p offset.
+ *
+ * @throw std::runtime_error If the integer doesn't fit into @p data.
+ */
+uint64_t loadU64(std::span<uint8_t const> data, size_t offset);
@@ -0,0 +1,517 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LnkFile.h"
+
+#include "LittleEndianReader.h"
+#include "TextEncoding.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+uint32_t const kHeaderSize = 0x4C;
+
+// 00021401-0000-0000-C000-000000000046 in its on-disk byte order.
+std::array<uint8_t, 16> const kShellLinkClsid = {
+    0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46};
+
+// LinkFlags
+uint32_t const kHasLinkTargetIdList = 0x00000001;
+uint32_t const kHasLinkInfo = 0x00000002;
+uint32_t const kHasName = 0x00000004;
+uint32_t const kHasRelativePath = 0x00000008;
+uint32_t const kHasWorkingDir = 0x00000010;
+uint32_t const kHasArguments = 0x00000020;
+uint32_t const kHasIconLocation = 0x00000040;
+uint32_t const kIsUnicode = 0x00000080;
+uint32_t const kForceNoLinkInfo = 0x00000100;
+
+// LinkInfoFlags
+uint32_t const kVolumeIdAndLocalBasePath = 0x00000001;
+
+// Extra data block signatures
+uint32_t const kEnvironmentVariableDataBlockSignature = 0xA0000001;
+uint32_t const kIconEnvironmentDataBlockSignature = 0xA0000007;
+uint32_t const kEnvironmentDataBlockSize = 0x314;
+size_t const kEnvironmentDataBlockAnsiSize = 260;
+size_t const kEnvironmentDataBlockUnicodeSize = 520;
+
+// Shell item types (the high nibble of the class type indicator, with bit 0x80 masked out)
+uint8_t const kRootFolderItem = 0x10;
+uint8_t const kVolumeItem = 0x20;
+uint8_t const kFileEntryItem = 0x30;
+uint8_t const kFileEntryItemUnicodeFlag = 0x04;
+
+uint32_t const kFileEntryExtensionSignature = 0xBEEF0004;
+
+void
+appendPathComponent(std::string& path, std::string const& component)
+{
+    if (!path.empty() && path.back() != '\\')
+    {
+        path += '\\';
+    }
+
+    path += component;
+}
+
+/**
+ * Returns the long (UTF-16) name from the 0xBEEF0004 extension block of a file entry
+ * shell item, if there is one.
+ */
+std::optional<std::string>
+longNameFromExtensionBlock(std::span<uint8_t const> item, size_t extensionOffset)
+{
+    if (extensionOffset + 8 > item.size())
+    {
+        return std::nullopt;
+    }
+
+    uint16_t const extensionSize = loadU16(item, extensionOffset);
+    uint16_t const extensionVersion = loadU16(item, extensionOffset + 2);
+    uint32_t const extensionSignature = loadU32(item, extensionOffset + 4);
+
+    if (extensionSignature != kFileEntryExtensionSignature || extensionVersion < 3 ||
+        extensionSize > item.size() - extensionOffset)
+    {
+        return std::nullopt;
+    }
+
+    // The layout grows with every version of the extension block.
+    size_t longNameOffset = 20;
+    if (extensionVersion >= 7)
+    {
+        longNameOffset = 38;
+    }
+    if (extensionVersion >= 8)
+    {
+        longNameOffset += 4;
+    }
+    if (extensionVersion >= 9)
+    {
+        longNameOffset += 4;
+    }
+
+    if (longNameOffset >= extensionSize)
+    {
+        return std::nullopt;
+    }
+
+    auto const extension = item.subspan(extensionOffset, extensionSize);
+    auto const longName = untilUtf16Terminator(extension.subspan(longNameOffset));
+
+    if (longName.empty())
+    {
+        return std::nullopt;
+    }
+
+    return utf16LeToUtf8(longName);
+}
+
+/**
+ * Returns the name of the file or directory a file entry shell item refers to.
+ * @p item includes the 2-byte size field.
+ */
+std::optional<std::string>
+fileEntryName(std::span<uint8_t const> item)
+{
+    // size (2), class type (1), unknown (1), file size (4), modification time (4),
+    // attributes (2), followed by the primary name.
+    size_t const primaryNameOffset = 14;
+    if (item.size() <= primaryNameOffset)
+    {
+        return std::nullopt;
+    }
+
+    bool const isUnicode = (item[2] & kFileEntryItemUnicodeFlag) != 0;
+
+    std::span<uint8_t const> primaryName;
+    size_t primaryNameEnd = 0;
+
+    if (isUnicode)
+    {
+        primaryName = untilUtf16Terminator(item.subspan(primaryNameOffset));
+        primaryNameEnd = primaryNameOffset + primaryName.size() + 2;
+    }
+    else
+    {
+        primaryName = untilAnsiTerminator(item.subspan(primaryNameOffset));
+        primaryNameEnd = primaryNameOffset + primaryName.size() + 1;
+        // The ANSI name is padded to a 16-bit boundary.
+        primaryNameEnd += primaryNameEnd % 2;
+    }
+
+    // The long name lives in the extension block. The short name is a fallback for
+    // items produced by ancient versions of Windows.
+    if (auto longName = longNameFromExtensionBlock(item, primaryNameEnd))
+    {
+        return longName;
+    }
+
+    if (primaryName.empty())
+    {
+        return std::nullopt;
+    }
+
+    return isUnicode ? utf16LeToUtf8(primaryName) : ansiToUtf8(primaryName);
+}
+
+/**
+ * Reconstructs a filesystem path from a LinkTargetIDList. Only handles the common
+ * case of My Computer -> volume -> file entries. Returns std::nullopt for
+ * anything else, like network locations or virtual folders.
+ */
+std::optional<std::string>
+pathFromIdList(std::span<uint8_t const> idList)
+{
+    std::string path;
+    bool haveVolume = false;
+
+    LittleEndianReader reader(idList);
+
+    while (reader.remaining() >= 2)
+    {
+        size_t const itemStart = reader.position();
+        uint16_t const itemSize = reader.readU16();
+
+        if (itemSize == 0)
+        {
+            // TerminalID
+            break;
+        }
+
+        if (itemSize < 3)
+        {
+            return std::nullopt;
+        }
+
+        reader.seek(itemStart);
+        auto const item = reader.readBytes(itemSize);
+
+        uint8_t const itemType = item[2] & 0x70;
+
+        if (itemType == kRootFolderItem)
+        {
+            // Presumably "My Computer". We don't check the CLSID, as anything else
+            // would be followed by items we fail to interpret anyway.
+            continue;
+        }
+        else if (itemType == kVolumeItem)
+        {
+            auto const volumeName = untilAnsiTerminator(item.subspan(3));
+            path = ansiToUtf8(volumeName);
+            haveVolume = true;
+        }
+        else if (itemType == kFileEntryItem)
+        {
+            if (!haveVolume)
+            {
+                return std::nullopt;
+            }
+
+            auto name = fileEntryName(item);
+            if (!name)
+            {
+                return std::nullopt;
+            }
+
+            appendPathComponent(path, *name);
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (!haveVolume)
+    {
+        return std::nullopt;
+    }
+
+    return path;
+}
+
+std::optional<std::string>
+nulTerminatedAnsiAt(std::span<uint8_t const> data, size_t offset)
+{
+    if (offset == 0 || offset >= data.size())
+    {
+        return std::nullopt;
+    }
+
+    return ansiToUtf8(untilAnsiTerminator(data.subspan(offset)));
+}
+
+std::optional<std::string>
+nulTerminatedUtf16At(std::span<uint8_t const> data, size_t offset)
+{
+    if (offset == 0 || offset >= data.size())
+    {
+        return std::nullopt;
+    }
+
+    return utf16LeToUtf8(untilUtf16Terminator(data.subspan(offset)));
+}
+
+std::optional<std::string>
+pathFromLinkInfo(std::span<uint8_t const> linkInfo)
+{
+    uint32_t const headerSize = loadU32(linkInfo, 4);
+    uint32_t const flags = loadU32(linkInfo, 8);
+
+    if (!(flags & kVolumeIdAndLocalBasePath))
+    {
+        // A network path, which doesn't map to anything in a Wine prefix.
+        return std::nullopt;
+    }
+
+    uint32_t const localBasePathOffset = loadU32(linkInfo, 16);
+    uint32_t const commonPathSuffixOffset = loadU32(linkInfo, 24);
+
+    std::optional<std::string> localBasePath;
+    std::optional<std::string> commonPathSuffix;
+
+    if (headerSize >= 0x24)
+    {
+        localBasePath = nulTerminatedUtf16At(linkInfo, loadU32(linkInfo, 28));
+        commonPathSuffix = nulTerminatedUtf16At(linkInfo, loadU32(linkInfo, 32));
+    }
+
+    if (!localBasePath)
+    {
+        localBasePath = nulTerminatedAnsiAt(linkInfo, localBasePathOffset);
+    }
+
+    if (!commonPathSuffix)
+    {
+        commonPathSuffix = nulTerminatedAnsiAt(linkInfo, commonPathSuffixOffset);
+    }
+
+    if (!localBasePath || localBasePath->empty())
+    {
+        return std::nullopt;
+    }
+
+    std::string path = *localBasePath;
+    if (commonPathSuffix && !commonPathSuffix->empty())
+    {
+        appendPathComponent(path, *commonPathSuffix);
+    }
+
+    return path;
+}
+
+std::string
+readStringData(LittleEndianReader& reader, bool isUnicode)
+{
+    uint16_t const numChars = reader.readU16();
+
+    if (isUnicode)
+    {
+        return utf16LeToUtf8(reader.readBytes(size_t(numChars) * 2));
+    }
+    else
+    {
+        return ansiToUtf8(reader.readBytes(numChars));
+    }
+}
+
+/**
+ * Extracts the target from an EnvironmentVariableDataBlock or an IconEnvironmentDataBlock.
+ * @p block includes the size and signature fields.
+ */
+std::optional<std::string>
+pathFromEnvironmentDataBlock(std::span<uint8_t const> block)
+{
+    if (block.size() < kEnvironmentDataBlockSize)
+    {
+        return std::nullopt;
+    }
+
+    auto const ansiTarget = block.subspan(8, kEnvironmentDataBlockAnsiSize);
+    auto const unicodeTarget =
+        block.subspan(8 + kEnvironmentDataBlockAnsiSize, kEnvironmentDataBlockUnicodeSize);
+
+    std::string target = utf16LeToUtf8(untilUtf16Terminator(unicodeTarget));
+    if (target.empty())
+    {
+        target = ansiToUtf8(untilAnsiTerminator(ansiTarget));
+    }
+
+    if (target.empty())
+    {
+        return std::nullopt;
+    }
+
+    return target;
+}
+
+} // namespace
+
+std::optional<std::string>
+LnkFile::targetPath() const
+{
+    if (environmentTargetPath)
+    {
+        return environmentTargetPath;
+    }
+    else if (linkInfoPath)
+    {
+        return linkInfoPath;
+    }
+    else
+    {
+        return idListPath;
+    }
+}
+
+std::optional<std::string>
+LnkFile::effectiveIconLocation() const
+{
+    return environmentIconLocation ? environmentIconLocation : iconLocation;
+}
+
+LnkFile
+parseLnkFile(std::span<uint8_t const> data)
+{
+    LittleEndianReader reader(data);
+
+    if (reader.remaining() < kHeaderSize || reader.readU32() != kHeaderSize)
+    {
+        throw std::runtime_error("Not a shell link: bad header size");
+    }
+
+    auto const clsid = reader.readBytes(kShellLinkClsid.size());
+    if (!std::equal(clsid.begin(), clsid.end(), kShellLinkClsid.begin()))
+    {
+        throw std::runtime_error("Not a shell link: bad CLSID");
+    }
+
+    LnkFile lnk;
+
+    uint32_t const linkFlags = reader.readU32();
+    bool const isUnicode = (linkFlags & kIsUnicode) != 0;
+
+    // FileAttributes, CreationTime, AccessTime, WriteTime, FileSize
+    reader.skip(4 + 8 + 8 + 8 + 4);
+    lnk.iconIndex = static_cast<int32_t>(reader.readU32());
+    lnk.showCommand = reader.readU32();
+    reader.seek(kHeaderSize);
+
+    if (linkFlags & kHasLinkTargetIdList)
+    {
+        uint16_t const idListSize = reader.readU16();
+        lnk.idListPath = pathFromIdList(reader.readBytes(idListSize));
+    }
+
+    if (linkFlags & kHasLinkInfo)
+    {
+        size_t const linkInfoStart = reader.position();
+        uint32_t const linkInfoSize = reader.readU32();
+        reader.seek(linkInfoStart);
+        auto const linkInfo = reader.readBytes(linkInfoSize);
+
+        // ForceNoLinkInfo tells us to ignore the structure, even though it's present.
+        if (!(linkFlags & kForceNoLinkInfo))
+        {
+            lnk.linkInfoPath = pathFromLinkInfo(linkInfo);
+        }
+    }
+
+    if (linkFlags & kHasName)
+    {
+        lnk.description = readStringData(reader, isUnicode);
+    }
+
+    if (linkFlags & kHasRelativePath)
+    {
+        lnk.relativePath = readStringData(reader, isUnicode);
+    }
+
+    if (linkFlags & kHasWorkingDir)
+    {
+        lnk.workingDirectory = readStringData(reader, isUnicode);
+    }
+
+    if (linkFlags & kHasArguments)
+    {
+        lnk.arguments = readStringData(reader, isUnicode);
+    }
+
+    if (linkFlags & kHasIconLocation)
+    {
+        lnk.iconLocation = readStringData(reader, isUnicode);
+    }
+
+    // ExtraData is a sequence of blocks, terminated by a block smaller than 4 bytes.
+    // Some writers omit the terminal block, so running out of data is fine too.
+    while (reader.remaining() >= 4)
+    {
+        size_t const blockStart = reader.position();
+        uint32_t const blockSize = reader.readU32();
+
+        if (blockSize < 8)
+        {
+            break;
+        }
+
+        reader.seek(blockStart);
+        auto const block = reader.readBytes(blockSize);
+        uint32_t const signature = loadU32(block, 4);
+
+        if (signature == kEnvironmentVariableDataBlockSignature)
+        {
+            lnk.environmentTargetPath = pathFromEnvironmentDataBlock(block);
+        }
+        else if (signature == kIconEnvironmentDataBlockSignature)
+        {
+            lnk.environmentIconLocation = pathFromEnvironmentDataBlock(block);
+        }
+    }
+
+    return lnk;
+}
+
+LnkFile
+readLnkFile(std::filesystem::path const& lnkFilePath)
+{
+    std::ifstream strm(lnkFilePath, std::ios::binary);
+
+    if (!strm)
+    {
+        throw std::runtime_error("Failed to open " + lnkFilePath.string());
+    }
+
+    std::vector<uint8_t> const data(
+        (std::istreambuf_iterator<char>(strm)), std::istreambuf_iterator<char>());
+
+    if (strm.bad())
+    {
+        throw std::runtime_error("I/O error reading " + lnkFilePath.string());
+    }
+
+    return parseLnkFile(data);
+}
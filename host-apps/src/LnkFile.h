@@ -0,0 +1,82 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+/**
+ * The contents of a Windows shell link (.lnk) file, as specified in [MS-SHLLINK].
+ *
+ * All strings are converted to UTF-8. Paths are Windows paths and may contain
+ * unexpanded environment variables like %ProgramFiles%.
+ */
+struct LnkFile
+{
+    /** The target path reconstructed from the LinkTargetIDList, if any. */
+    std::optional<std::string> idListPath;
+
+    /** LocalBasePath + CommonPathSuffix from the LinkInfo structure, if any. */
+    std::optional<std::string> linkInfoPath;
+
+    /** The target path from the EnvironmentVariableDataBlock, if any. */
+    std::optional<std::string> environmentTargetPath;
+
+    /** The icon path from the IconEnvironmentDataBlock, if any. */
+    std::optional<std::string> environmentIconLocation;
+
+    std::optional<std::string> description;
+    std::optional<std::string> relativePath;
+    std::optional<std::string> workingDirectory;
+    std::optional<std::string> arguments;
+    std::optional<std::string> iconLocation;
+
+    int32_t iconIndex = 0;
+    uint32_t showCommand = 0;
+
+    /**
+     * The best guess at the link's target. Windows prefers the environment variable block,
+     * then LinkInfo and then the IDList, and so do we.
+     */
+    std::optional<std::string> targetPath() const;
+
+    /**
+     * The icon location, preferring the one from the IconEnvironmentDataBlock.
+     */
+    std::optional<std::string> effectiveIconLocation() const;
+};
+
+/**
+ * Parses a .lnk file held in memory.
+ *
+ * Unknown shell items in the IDList and unknown extra data blocks are skipped.
+ *
+ * @throw std::runtime_error If the data is not a valid shell link.
+ */
+LnkFile parseLnkFile(std::span<uint8_t const> data);
+
+/**
+ * Reads and parses a .lnk file.
+ *
+ * @throw std::runtime_error If the file can't be read or is not a valid shell link.
+ */
+LnkFile readLnkFile(std::filesystem::path const& lnkFilePath);
@@ -0,0 +1,73 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+MappedFile::MappedFile(std::filesystem::path const& filePath)
+{
+    int const fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Failed to open " + filePath.string());
+    }
+
+    if (fstat(fd, &mStatus) == -1)
+    {
+        int const savedErrno = errno;
+        close(fd);
+        throw std::system_error(
+            savedErrno, std::generic_category(), "fstat() failed on " + filePath.string());
+    }
+
+    mSize = static_cast<size_t>(mStatus.st_size);
+
+    // mmap() refuses zero-length mappings.
+    if (mSize != 0)
+    {
+        void* const addr = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            int const savedErrno = errno;
+            close(fd);
+            throw std::system_error(
+                savedErrno, std::generic_category(), "mmap() failed on " + filePath.string());
+        }
+
+        mData = static_cast<uint8_t const*>(addr);
+    }
+
+    // The mapping stays valid after the file descriptor is closed.
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mData)
+    {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+}
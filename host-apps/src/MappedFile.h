@@ -0,0 +1,60 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include <sys/stat.h>
+
+/**
+ * A read-only memory mapping of a whole file.
+ */
+class MappedFile
+{
+public:
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    /**
+     * Maps the file into memory.
+     *
+     * @throw std::system_error If the file can't be opened or mapped.
+     */
+    explicit MappedFile(std::filesystem::path const& filePath);
+
+    ~MappedFile();
+
+    std::span<uint8_t const> data() const { return {mData, mSize}; }
+
+    std::string_view text() const { return {reinterpret_cast<char const*>(mData), mSize}; }
+
+    /**
+     * The status of the file at the time it was mapped.
+     */
+    struct stat const& status() const { return mStatus; }
+
+private:
+    struct stat mStatus = {};
+    uint8_t const* mData = nullptr;
+    size_t mSize = 0;
+};
@@ -0,0 +1,209 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelDirWalker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+using EntryCallback = std::function<bool(std::filesystem::path const&, struct stat const&)>;
+
+struct PendingDir
+{
+    std::filesystem::path path;
+    struct stat status;
+};
+
+class WalkState
+{
+public:
+    WalkState(EntryCallback const& onEntry, EntryCallback const& onDir)
+        : mOnEntry(onEntry)
+        , mOnDir(onDir)
+    {
+    }
+
+    void push(PendingDir dir)
+    {
+        {
+            std::lock_guard<std::mutex> const lock(mMutex);
+            mQueue.push_back(std::move(dir));
+        }
+        mCondition.notify_one();
+    }
+
+    void runWorker()
+    {
+        for (;;)
+        {
+            PendingDir dir;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return !mQueue.empty() || mNumBusy == 0; });
+
+                if (mQueue.empty())
+                {
+                    // Nobody is busy, so nobody can add more work.
+                    mCondition.notify_all();
+                    return;
+                }
+
+                dir = std::move(mQueue.front());
+                mQueue.pop_front();
+                ++mNumBusy;
+            }
+
+            listDir(dir);
+
+            {
+                std::lock_guard<std::mutex> const lock(mMutex);
+                --mNumBusy;
+            }
+            mCondition.notify_all();
+        }
+    }
+
+    size_t numErrors() const { return mNumErrors; }
+
+private:
+    void listDir(PendingDir const& dir)
+    {
+        bool const wantNonDirs = !mOnDir || mOnDir(dir.path, dir.status);
+
+        int const dirFd = open(dir.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+        if (dirFd == -1)
+        {
+            ++mNumErrors;
+            return;
+        }
+
+        DIR* const dirStream = fdopendir(dirFd);
+        if (!dirStream)
+        {
+            close(dirFd);
+            ++mNumErrors;
+            return;
+        }
+
+        while (dirent const* entry = readdir(dirStream))
+        {
+            std::string_view const name = entry->d_name;
+            if (name == "." || name == "..")
+            {
+                continue;
+            }
+
+            if (!wantNonDirs && entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN)
+            {
+                continue;
+            }
+
+            struct stat st;
+            if (fstatat(dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1)
+            {
+                ++mNumErrors;
+                continue;
+            }
+
+            if (!wantNonDirs && !S_ISDIR(st.st_mode))
+            {
+                continue;
+            }
+
+            std::filesystem::path entryPath = dir.path / name;
+            bool const descend = mOnEntry(entryPath, st);
+
+            if (descend && S_ISDIR(st.st_mode) && st.st_dev == dir.status.st_dev)
+            {
+                push({std::move(entryPath), st});
+            }
+        }
+
+        closedir(dirStream);
+    }
+
+    EntryCallback const& mOnEntry;
+    EntryCallback const& mOnDir;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<PendingDir> mQueue;
+    unsigned mNumBusy = 0;
+    std::atomic<size_t> mNumErrors = 0;
+};
+
+} // namespace
+
+size_t
+walkTreesInParallel(
+    std::vector<std::filesystem::path> const& roots, unsigned numThreads,
+    EntryCallback const& onEntry)
+{
+    return walkTreesInParallel(roots, numThreads, onEntry, nullptr);
+}
+
+size_t
+walkTreesInParallel(
+    std::vector<std::filesystem::path> const& roots, unsigned numThreads,
+    EntryCallback const& onEntry, EntryCallback const& onDir)
+{
+    WalkState state(onEntry, onDir);
+    size_t numRootErrors = 0;
+
+    for (std::filesystem::path const& root : roots)
+    {
+        struct stat st;
+        if (stat(root.c_str(), &st) == -1 || !S_ISDIR(st.st_mode))
+        {
+            ++numRootErrors;
+            continue;
+        }
+        state.push({root, st});
+    }
+
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([&state] { state.runWorker(); });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return numRootErrors + state.numErrors();
+}
@@ -0,0 +1,53 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include <sys/stat.h>
+
+/**
+ * Walks directory trees with a pool of threads, each one listing a different directory.
+ *
+ * @p onEntry is called for every entry below the roots (but not the roots themselves), with
+ * the status of the entry itself rather than what it may link to. Symbolic links are not
+ * followed, and neither are mount points crossed. It's called concurrently from worker
+ * threads, so it must be thread-safe. Returning false from it for a directory prevents
+ * descending into that directory.
+ *
+ * @param numThreads 0 means the number of CPUs.
+ * @return The number of entries that couldn't be listed or stat'ed. These are skipped.
+ */
+size_t walkTreesInParallel(
+    std::vector<std::filesystem::path> const& roots, unsigned numThreads,
+    std::function<bool(std::filesystem::path const&, struct stat const&)> const& onEntry);
+
+/**
+ * Like the above, but also calls @p onDir for every directory about to be listed, including
+ * the roots. Returning false from it means the entries of that directory that aren't
+ * directories themselves are of no interest. Those are then neither stat'ed nor passed to
+ * @p onEntry, which makes walking a tree whose files are already known a lot cheaper.
+ */
+size_t walkTreesInParallel(
+    std::vector<std::filesystem::path> const& roots, unsigned numThreads,
+    std::function<bool(std::filesystem::path const&, struct stat const&)> const& onEntry,
+    std::function<bool(std::filesystem::path const&, struct stat const&)> const& onDir);
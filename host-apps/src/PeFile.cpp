@@ -0,0 +1,210 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PeFile.h"
+
+#include "LittleEndianReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+uint16_t const kPe32Magic = 0x10b;
+uint16_t const kPe32PlusMagic = 0x20b;
+size_t const kResourceDataDirIndex = 2;
+size_t const kSectionHeaderSize = 40;
+
+uint32_t const kResourceSubdirFlag = 0x80000000;
+
+/**
+ * Returns the offset (within the resource section) of the first entry matching @p id,
+ * or of the very first entry if @p id is not given. The returned offset still has
+ * kResourceSubdirFlag set if it points to a subdirectory.
+ */
+std::optional<uint32_t>
+findResourceDirEntry(
+    std::span<uint8_t const> resources, uint32_t dirOffset, std::optional<uint16_t> id)
+{
+    uint16_t const numNamedEntries = loadU16(resources, dirOffset + 12);
+    uint16_t const numIdEntries = loadU16(resources, dirOffset + 14);
+    size_t const entriesOffset = dirOffset + 16;
+
+    for (size_t i = 0; i < size_t(numNamedEntries) + numIdEntries; ++i)
+    {
+        size_t const entryOffset = entriesOffset + i * 8;
+        uint32_t const name = loadU32(resources, entryOffset);
+        uint32_t const offsetToData = loadU32(resources, entryOffset + 4);
+
+        bool const isNamed = name & kResourceSubdirFlag;
+        if (!id || (!isNamed && name == *id))
+        {
+            return offsetToData;
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace
+
+std::optional<PeHeaders>
+parsePeHeaders(std::span<uint8_t const> headData)
+{
+    try
+    {
+        if (headData.size() < 64 || headData[0] != 'M' || headData[1] != 'Z')
+        {
+            return std::nullopt;
+        }
+
+        uint32_t const peOffset = loadU32(headData, 0x3c);
+        if (loadU32(headData, peOffset) != 0x00004550) // "PE\0\0"
+        {
+            return std::nullopt;
+        }
+
+        LittleEndianReader reader(headData);
+        reader.seek(peOffset + 4);
+
+        PeHeaders headers;
+        headers.machine = reader.readU16();
+        uint16_t const numSections = reader.readU16();
+        reader.skip(12); // TimeDateStamp, PointerToSymbolTable, NumberOfSymbols
+        uint16_t const optionalHeaderSize = reader.readU16();
+        headers.characteristics = reader.readU16();
+
+        size_t const optionalHeaderOffset = reader.position();
+        uint16_t const magic = loadU16(headData, optionalHeaderOffset);
+        if (magic != kPe32Magic && magic != kPe32PlusMagic)
+        {
+            return std::nullopt;
+        }
+
+        headers.is64Bit = magic == kPe32PlusMagic;
+        headers.subsystem = loadU16(headData, optionalHeaderOffset + 68);
+
+        size_t const numDataDirsOffset = optionalHeaderOffset + (headers.is64Bit ? 108 : 92);
+        uint32_t const numDataDirs = loadU32(headData, numDataDirsOffset);
+        if (numDataDirs > kResourceDataDirIndex)
+        {
+            size_t const resourceDirOffset = numDataDirsOffset + 4 + kResourceDataDirIndex * 8;
+            headers.resourceDirRva = loadU32(headData, resourceDirOffset);
+            headers.resourceDirSize = loadU32(headData, resourceDirOffset + 4);
+        }
+
+        reader.seek(optionalHeaderOffset + optionalHeaderSize);
+        for (uint16_t i = 0; i < numSections; ++i)
+        {
+            std::span<uint8_t const> const sectionHeader = reader.readBytes(kSectionHeaderSize);
+            headers.sections.push_back(PeSection{
+                .virtualAddress = loadU32(sectionHeader, 12),
+                .virtualSize = loadU32(sectionHeader, 8),
+                .rawDataOffset = loadU32(sectionHeader, 20),
+                .rawDataSize = loadU32(sectionHeader, 16),
+            });
+        }
+
+        return headers;
+    }
+    catch (std::runtime_error const&)
+    {
+        // Cut short.
+        return std::nullopt;
+    }
+}
+
+std::optional<size_t>
+peRvaToFileOffset(PeHeaders const& headers, uint32_t rva)
+{
+    for (PeSection const& section : headers.sections)
+    {
+        uint32_t const size = std::max(section.virtualSize, section.rawDataSize);
+        if (rva >= section.virtualAddress && rva - section.virtualAddress < size)
+        {
+            uint32_t const offsetInSection = rva - section.virtualAddress;
+            if (offsetInSection >= section.rawDataSize)
+            {
+                // Not backed by the file.
+                return std::nullopt;
+            }
+            return size_t(section.rawDataOffset) + offsetInSection;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::span<uint8_t const>>
+findPeResource(
+    std::span<uint8_t const> image, PeHeaders const& headers, PeResourceType type,
+    std::optional<uint16_t> id)
+{
+    if (headers.resourceDirRva == 0)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<size_t> const resourcesOffset =
+        peRvaToFileOffset(headers, headers.resourceDirRva);
+    if (!resourcesOffset || *resourcesOffset >= image.size())
+    {
+        return std::nullopt;
+    }
+
+    // The resource section may be larger than the data directory says, as data entries
+    // are allowed to follow the directory. So we let it extend to the end of the file.
+    std::span<uint8_t const> const resources = image.subspan(*resourcesOffset);
+
+    // The directory tree has three levels: types, names and languages.
+    std::optional<uint16_t> const typeAndNameIds[] = {static_cast<uint16_t>(type), id};
+
+    uint32_t offset = 0;
+    for (std::optional<uint16_t> const& levelId : typeAndNameIds)
+    {
+        std::optional<uint32_t> const entry = findResourceDirEntry(resources, offset, levelId);
+        if (!entry)
+        {
+            return std::nullopt;
+        }
+        else if (!(*entry & kResourceSubdirFlag))
+        {
+            throw std::runtime_error("Malformed PE resource directory");
+        }
+        offset = *entry & ~kResourceSubdirFlag;
+    }
+
+    // Entries at the language level point to data entries.
+    std::optional<uint32_t> const dataEntry = findResourceDirEntry(resources, offset, std::nullopt);
+    if (!dataEntry || (*dataEntry & kResourceSubdirFlag))
+    {
+        throw std::runtime_error("Malformed PE resource directory");
+    }
+
+    uint32_t const dataRva = loadU32(resources, *dataEntry);
+    uint32_t const dataSize = loadU32(resources, *dataEntry + 4);
+
+    std::optional<size_t> const dataOffset = peRvaToFileOffset(headers, dataRva);
+    if (!dataOffset || *dataOffset > image.size() || image.size() - *dataOffset < dataSize)
+    {
+        throw std::runtime_error("PE resource data is out of bounds");
+    }
+
+    return image.subspan(*dataOffset, dataSize);
+}
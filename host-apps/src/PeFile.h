@@ -0,0 +1,96 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct PeSection
+{
+    uint32_t virtualAddress = 0;
+    uint32_t virtualSize = 0;
+    uint32_t rawDataOffset = 0;
+    uint32_t rawDataSize = 0;
+};
+
+/**
+ * What we need to know from the headers of a Portable Executable.
+ */
+struct PeHeaders
+{
+    uint16_t machine = 0;
+    uint16_t characteristics = 0;
+    uint16_t subsystem = 0;
+    bool is64Bit = false;
+
+    uint32_t resourceDirRva = 0;
+    uint32_t resourceDirSize = 0;
+
+    std::vector<PeSection> sections;
+
+    bool isDll() const { return characteristics & kImageFileDll; }
+
+    bool isGui() const { return subsystem == kSubsystemWindowsGui; }
+
+    static uint16_t const kImageFileDll = 0x2000;
+    static uint16_t const kSubsystemWindowsGui = 2;
+    static uint16_t const kSubsystemWindowsCui = 3;
+};
+
+/**
+ * Resource types we are interested in.
+ */
+enum class PeResourceType : uint16_t
+{
+    Icon = 3,
+    GroupIcon = 14,
+    Version = 16,
+};
+
+/**
+ * Parses the DOS, COFF and optional headers and the section table.
+ *
+ * All of those are normally found within the first page of the file, so that's all
+ * @p headData needs to contain.
+ *
+ * @return std::nullopt If the data doesn't start with the headers of a Portable Executable
+ *         or they are cut short.
+ */
+std::optional<PeHeaders> parsePeHeaders(std::span<uint8_t const> headData);
+
+/**
+ * Maps a relative virtual address to an offset within the file.
+ */
+std::optional<size_t> peRvaToFileOffset(PeHeaders const& headers, uint32_t rva);
+
+/**
+ * Finds a resource in the image of a whole PE file.
+ *
+ * @param id The integer ID of the resource. If not given, the first resource of that type
+ *        is returned, whether it's identified by an integer or by a name.
+ * @return The resource data in the first language available, or std::nullopt if there
+ *         is no such resource.
+ * @throw std::runtime_error If the resource directory is malformed.
+ */
+std::optional<std::span<uint8_t const>> findPeResource(
+    std::span<uint8_t const> image, PeHeaders const& headers, PeResourceType type,
+    std::optional<uint16_t> id = std::nullopt);
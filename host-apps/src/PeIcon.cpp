@@ -0,0 +1,174 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PeIcon.h"
+
+#include "LittleEndianReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+uint8_t const kPngSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+size_t const kGroupIconDirHeaderSize = 6;
+size_t const kGroupIconDirEntrySize = 14;
+size_t const kBitmapInfoHeaderSize = 40;
+size_t const kBitmapFileHeaderSize = 14;
+
+struct GroupIconEntry
+{
+    int size;
+    uint16_t bitCount;
+    uint16_t iconId;
+};
+
+void
+appendU16(std::vector<uint8_t>& out, uint16_t value)
+{
+    out.push_back(value & 0xff);
+    out.push_back(value >> 8);
+}
+
+void
+appendU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    appendU16(out, value & 0xffff);
+    appendU16(out, value >> 16);
+}
+
+/**
+ * Converts a 32-bit icon DIB (a BITMAPINFOHEADER with twice the actual height, followed by
+ * the color bitmap and the AND mask) into a BMP file.
+ */
+std::optional<std::vector<uint8_t>>
+dibToBmp(std::span<uint8_t const> dib)
+{
+    uint32_t const headerSize = loadU32(dib, 0);
+    int32_t const width = static_cast<int32_t>(loadU32(dib, 4));
+    int32_t const doubleHeight = static_cast<int32_t>(loadU32(dib, 8));
+    uint16_t const bitCount = loadU16(dib, 14);
+    uint32_t const compression = loadU32(dib, 16);
+
+    if (headerSize < kBitmapInfoHeaderSize || bitCount != 32 || compression != 0 || width <= 0 ||
+        doubleHeight <= 0 || width > 1024 || doubleHeight > 2048)
+    {
+        return std::nullopt;
+    }
+
+    int32_t const height = doubleHeight / 2;
+    size_t const colorBitmapSize = size_t(width) * height * 4;
+    if (dib.size() < headerSize + colorBitmapSize)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> bmp;
+    bmp.reserve(kBitmapFileHeaderSize + headerSize + colorBitmapSize);
+
+    bmp.push_back('B');
+    bmp.push_back('M');
+    appendU32(bmp, kBitmapFileHeaderSize + headerSize + colorBitmapSize);
+    appendU32(bmp, 0);
+    appendU32(bmp, kBitmapFileHeaderSize + headerSize);
+
+    size_t const infoHeaderOffset = bmp.size();
+    bmp.insert(bmp.end(), dib.begin(), dib.begin() + headerSize);
+
+    // Only the color bitmap goes into the BMP, so the height has to be the real one.
+    bmp[infoHeaderOffset + 8] = height & 0xff;
+    bmp[infoHeaderOffset + 9] = (height >> 8) & 0xff;
+    bmp[infoHeaderOffset + 10] = (height >> 16) & 0xff;
+    bmp[infoHeaderOffset + 11] = (height >> 24) & 0xff;
+
+    // biSizeImage
+    bmp[infoHeaderOffset + 20] = colorBitmapSize & 0xff;
+    bmp[infoHeaderOffset + 21] = (colorBitmapSize >> 8) & 0xff;
+    bmp[infoHeaderOffset + 22] = (colorBitmapSize >> 16) & 0xff;
+    bmp[infoHeaderOffset + 23] = (colorBitmapSize >> 24) & 0xff;
+
+    bmp.insert(
+        bmp.end(), dib.begin() + headerSize, dib.begin() + headerSize + colorBitmapSize);
+
+    return bmp;
+}
+
+} // namespace
+
+std::optional<PeIconImage>
+extractPeIcon(std::span<uint8_t const> image, PeHeaders const& headers)
+{
+    try
+    {
+        std::optional<std::span<uint8_t const>> const group =
+            findPeResource(image, headers, PeResourceType::GroupIcon);
+        if (!group)
+        {
+            return std::nullopt;
+        }
+
+        uint16_t const numEntries = loadU16(*group, 4);
+
+        std::vector<GroupIconEntry> entries;
+        for (uint16_t i = 0; i < numEntries; ++i)
+        {
+            size_t const offset = kGroupIconDirHeaderSize + i * kGroupIconDirEntrySize;
+            uint16_t const iconId = loadU16(*group, offset + 12); // Checks the bounds too.
+            uint8_t const width = (*group)[offset];
+            entries.push_back(GroupIconEntry{
+                .size = width == 0 ? 256 : width,
+                .bitCount = loadU16(*group, offset + 6),
+                .iconId = iconId,
+            });
+        }
+
+        // The largest and most colorful first.
+        std::sort(entries.begin(), entries.end(), [](auto const& lhs, auto const& rhs) {
+            return lhs.size != rhs.size ? lhs.size > rhs.size : lhs.bitCount > rhs.bitCount;
+        });
+
+        for (GroupIconEntry const& entry : entries)
+        {
+            std::optional<std::span<uint8_t const>> const icon =
+                findPeResource(image, headers, PeResourceType::Icon, entry.iconId);
+            if (!icon)
+            {
+                continue;
+            }
+
+            if (icon->size() > sizeof(kPngSignature) &&
+                std::equal(std::begin(kPngSignature), std::end(kPngSignature), icon->begin()))
+            {
+                return PeIconImage{"png", entry.size, {icon->begin(), icon->end()}};
+            }
+
+            if (std::optional<std::vector<uint8_t>> bmp = dibToBmp(*icon))
+            {
+                return PeIconImage{"bmp", entry.size, std::move(*bmp)};
+            }
+        }
+    }
+    catch (std::runtime_error const&)
+    {
+        // A malformed resource directory means no icon.
+    }
+
+    return std::nullopt;
+}
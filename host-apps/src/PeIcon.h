@@ -0,0 +1,50 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PeFile.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * An icon image in a format that can be displayed without further conversion.
+ */
+struct PeIconImage
+{
+    /** "png" or "bmp". */
+    std::string format;
+
+    int size = 0;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * Takes the first icon group of an executable and returns its largest image.
+ *
+ * Large icons tend to be stored as PNG, which is returned as is. Images in the DIB format are
+ * turned into BMP files, dropping the AND mask. That's only done for 32-bit images, where
+ * the alpha channel makes the mask redundant.
+ *
+ * @return std::nullopt If the executable has no icon we can convert.
+ */
+std::optional<PeIconImage> extractPeIcon(std::span<uint8_t const> image, PeHeaders const& headers);
@@ -0,0 +1,159 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PeVersionInfo.h"
+
+#include "LittleEndianReader.h"
+#include "TextEncoding.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+namespace
+{
+
+/**
+ * One node of the VS_VERSIONINFO tree. Every node has the same layout: wLength, wValueLength,
+ * wType, a NUL-terminated UTF-16 key, the value and the child nodes, the latter two aligned
+ * on 4 bytes.
+ */
+struct VersionNode
+{
+    std::string key;
+
+    /** Everything between the key and the children. */
+    std::span<uint8_t const> value;
+
+    std::span<uint8_t const> children;
+
+    /** Where the next sibling starts, relative to the start of this node. */
+    size_t nextSiblingOffset = 0;
+};
+
+size_t
+alignTo4(size_t offset)
+{
+    return (offset + 3) & ~size_t(3);
+}
+
+std::optional<VersionNode>
+parseVersionNode(std::span<uint8_t const> data)
+{
+    try
+    {
+        uint16_t const length = loadU16(data, 0);
+        uint16_t const valueLength = loadU16(data, 2);
+        uint16_t const type = loadU16(data, 4);
+
+        if (length < 6 || length > data.size())
+        {
+            return std::nullopt;
+        }
+
+        std::span<uint8_t const> const node = data.first(length);
+        std::span<uint8_t const> const keyBytes = untilUtf16Terminator(node.subspan(6));
+
+        VersionNode result;
+        result.key = utf16LeToUtf8(keyBytes);
+        result.nextSiblingOffset = alignTo4(length);
+
+        size_t const valueOffset = std::min(alignTo4(6 + keyBytes.size() + 2), node.size());
+
+        // Text values have their length in characters. Not every compiler got that right,
+        // so we don't rely on it beyond telling where the children start.
+        size_t const valueSize = type == 1 ? valueLength * size_t(2) : valueLength;
+        size_t const childrenOffset = std::min(alignTo4(valueOffset + valueSize), node.size());
+
+        result.value = node.subspan(valueOffset, childrenOffset - valueOffset);
+        result.children = node.subspan(childrenOffset);
+        return result;
+    }
+    catch (std::runtime_error const&)
+    {
+        return std::nullopt;
+    }
+}
+
+/**
+ * Calls @p callback for each child node, stopping at the first malformed one.
+ */
+template <typename Callback>
+void
+forEachChildNode(std::span<uint8_t const> children, Callback const& callback)
+{
+    while (!children.empty())
+    {
+        std::optional<VersionNode> const child = parseVersionNode(children);
+        if (!child)
+        {
+            break;
+        }
+
+        callback(*child);
+
+        if (child->nextSiblingOffset >= children.size())
+        {
+            break;
+        }
+        children = children.subspan(child->nextSiblingOffset);
+    }
+}
+
+} // namespace
+
+std::map<std::string, std::string>
+parseVersionStrings(std::span<uint8_t const> versionResource)
+{
+    std::map<std::string, std::string> strings;
+
+    std::optional<VersionNode> const root = parseVersionNode(versionResource);
+    if (!root || root->key != "VS_VERSION_INFO")
+    {
+        return strings;
+    }
+
+    forEachChildNode(root->children, [&strings](VersionNode const& fileInfo) {
+        if (fileInfo.key != "StringFileInfo" || !strings.empty())
+        {
+            return;
+        }
+
+        // There is a string table per language. The first one will do.
+        std::optional<VersionNode> const table = parseVersionNode(fileInfo.children);
+        if (!table)
+        {
+            return;
+        }
+
+        forEachChildNode(table->children, [&strings](VersionNode const& string) {
+            // The value is better taken to extend to the end of the node than trusting
+            // wValueLength, which is sometimes in bytes rather than characters.
+            std::span<uint8_t const> const rest(
+                string.value.data(), string.children.data() + string.children.size());
+            std::string value = utf16LeToUtf8(untilUtf16Terminator(rest));
+
+            if (!string.key.empty() && !value.empty())
+            {
+                strings.emplace(string.key, std::move(value));
+            }
+        });
+    });
+
+    return strings;
+}
@@ -0,0 +1,35 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+
+/**
+ * Extracts the strings (FileDescription, ProductName, CompanyName and such) from
+ * the first string table of a VS_VERSIONINFO resource.
+ *
+ * Malformed parts are skipped rather than reported, as plenty of executables in the wild
+ * have slightly broken version resources that Windows tolerates.
+ *
+ * @return Keys and values, converted to UTF-8.
+ */
+std::map<std::string, std::string> parseVersionStrings(std::span<uint8_t const> versionResource);
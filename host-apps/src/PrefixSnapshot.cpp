@@ -0,0 +1,438 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PrefixSnapshot.h"
+
+#include "SnapshotManifest.h"
+#include "Xxh64.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+char const kTreeDirName[] = "tree";
+char const kManifestFileName[] = "manifest.tsv";
+
+[[noreturn]] void
+throwErrno(std::string const& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+int64_t
+mtimeNs(struct stat const& st)
+{
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+}
+
+SnapshotManifestEntry::Type
+entryType(struct stat const& st)
+{
+    if (S_ISDIR(st.st_mode))
+    {
+        return SnapshotManifestEntry::Type::Directory;
+    }
+    else if (S_ISLNK(st.st_mode))
+    {
+        return SnapshotManifestEntry::Type::Symlink;
+    }
+    else
+    {
+        return SnapshotManifestEntry::Type::RegularFile;
+    }
+}
+
+std::string
+readSymlink(fs::path const& path)
+{
+    std::string target(PATH_MAX, '\0');
+
+    ssize_t const targetLength = readlink(path.c_str(), target.data(), target.size());
+    if (targetLength == -1)
+    {
+        throwErrno("Failed to read the symlink " + path.string());
+    }
+
+    target.resize(static_cast<size_t>(targetLength));
+    return target;
+}
+
+/**
+ * Rejects ids that could escape the snapshots directory or refer to a partial snapshot.
+ */
+fs::path
+snapshotDir(fs::path const& snapshotsDir, std::string const& snapshotId)
+{
+    if (snapshotId.empty() || snapshotId.starts_with('.') ||
+        snapshotId.find('/') != std::string::npos)
+    {
+        throw std::invalid_argument("Invalid snapshot id: " + snapshotId);
+    }
+
+    return snapshotsDir / snapshotId;
+}
+
+std::string
+newSnapshotId(fs::path const& snapshotsDir, std::time_t now)
+{
+    char timestamp[32];
+    struct tm tm;
+    strftime(timestamp, sizeof(timestamp), "%Y%m%dT%H%M%SZ", gmtime_r(&now, &tm));
+
+    std::string id = timestamp;
+    for (int suffix = 2; fs::exists(snapshotsDir / id); ++suffix)
+    {
+        id = std::string(timestamp) + "-" + std::to_string(suffix);
+    }
+
+    return id;
+}
+
+/**
+ * Removes entries of the prefix that the manifest doesn't have, or has with a different type.
+ */
+void
+removeUnknownEntries(
+    fs::path const& prefixDir, fs::path const& dir,
+    std::unordered_map<std::string, SnapshotManifestEntry const*> const& entriesByPath,
+    SnapshotRestoreStats& stats)
+{
+    std::vector<fs::path> children;
+    for (fs::directory_entry const& child : fs::directory_iterator(dir))
+    {
+        children.push_back(child.path());
+    }
+
+    for (fs::path const& child : children)
+    {
+        struct stat st;
+        if (lstat(child.c_str(), &st) == -1)
+        {
+            throwErrno("Failed to stat " + child.string());
+        }
+
+        auto const it = entriesByPath.find(child.lexically_relative(prefixDir).string());
+        if (it == entriesByPath.end() || it->second->type != entryType(st))
+        {
+            fs::remove_all(child);
+            ++stats.numRemoved;
+        }
+        else if (S_ISDIR(st.st_mode))
+        {
+            removeUnknownEntries(prefixDir, child, entriesByPath, stats);
+        }
+    }
+}
+
+/**
+ * Decides whether a regular file in the prefix still matches its manifest entry.
+ */
+bool
+isFileUnchanged(
+    fs::path const& livePath, struct stat const& liveStatus, fs::path const& snapshotPath,
+    SnapshotManifestEntry& entry)
+{
+    if (static_cast<uint64_t>(liveStatus.st_size) != entry.size)
+    {
+        return false;
+    }
+
+    if (liveStatus.st_ino == entry.inode && mtimeNs(liveStatus) == entry.mtimeNs)
+    {
+        return true;
+    }
+
+    if (!entry.hash)
+    {
+        entry.hash = xxh64File(snapshotPath);
+    }
+
+    if (xxh64File(livePath) != *entry.hash)
+    {
+        return false;
+    }
+
+    // Same contents, so the next restore may as well recognize the file by its metadata.
+    entry.inode = liveStatus.st_ino;
+    entry.mtimeNs = mtimeNs(liveStatus);
+    return true;
+}
+
+void
+restoreFile(fs::path const& snapshotPath, fs::path const& livePath)
+{
+    // Clone next to the destination and rename over it, so that the file is never missing
+    // or half-written.
+    fs::path tempPath = livePath;
+    tempPath += ".winebar-restore";
+    fs::remove(tempPath);
+
+    cloneRegularFile(snapshotPath, tempPath);
+
+    if (rename(tempPath.c_str(), livePath.c_str()) == -1)
+    {
+        int const savedErrno = errno;
+        unlink(tempPath.c_str());
+        errno = savedErrno;
+        throwErrno("Failed to replace " + livePath.string());
+    }
+}
+
+} // namespace
+
+std::string
+createSnapshot(
+    fs::path const& snapshotsDir, fs::path const& prefixDir, std::string const& label,
+    CloneTreeStats* cloneStats)
+{
+    fs::create_directories(snapshotsDir);
+
+    std::time_t const now = std::time(nullptr);
+    std::string const id = newSnapshotId(snapshotsDir, now);
+    fs::path const partialDir = snapshotsDir / ("." + id + ".partial");
+
+    SnapshotManifest manifest;
+    manifest.createdAt = now;
+    manifest.label = label;
+
+    CloneTreeOptions options;
+    options.hardlinkReadOnlyFiles = true;
+    options.onEntry = [&](fs::path const& relativePath, struct stat const& st) {
+        SnapshotManifestEntry entry;
+        entry.type = entryType(st);
+        entry.path = relativePath.string();
+        entry.mode = st.st_mode & 07777;
+        entry.inode = st.st_ino;
+        entry.size = S_ISREG(st.st_mode) ? static_cast<uint64_t>(st.st_size) : 0;
+        entry.mtimeNs = mtimeNs(st);
+        if (S_ISLNK(st.st_mode))
+        {
+            entry.linkTarget = readSymlink(prefixDir / relativePath);
+        }
+        manifest.entries.push_back(std::move(entry));
+    };
+
+    try
+    {
+        fs::remove_all(partialDir);
+        fs::create_directory(partialDir);
+
+        CloneTreeStats const stats = cloneTree(prefixDir, partialDir / kTreeDirName, options);
+        if (cloneStats)
+        {
+            *cloneStats = stats;
+        }
+
+        std::sort(
+            manifest.entries.begin(), manifest.entries.end(),
+            [](auto const& lhs, auto const& rhs) { return lhs.path < rhs.path; });
+        writeSnapshotManifest(partialDir / kManifestFileName, manifest);
+
+        fs::rename(partialDir, snapshotsDir / id);
+    }
+    catch (...)
+    {
+        std::error_code ec;
+        fs::remove_all(partialDir, ec);
+        throw;
+    }
+
+    return id;
+}
+
+std::vector<SnapshotInfo>
+listSnapshots(fs::path const& snapshotsDir)
+{
+    std::vector<SnapshotInfo> snapshots;
+
+    if (!fs::exists(snapshotsDir))
+    {
+        return snapshots;
+    }
+
+    for (fs::directory_entry const& dirEntry : fs::directory_iterator(snapshotsDir))
+    {
+        std::string const id = dirEntry.path().filename().string();
+        fs::path const manifestPath = dirEntry.path() / kManifestFileName;
+
+        if (id.starts_with('.') || !fs::exists(manifestPath))
+        {
+            continue;
+        }
+
+        SnapshotManifest const manifest = readSnapshotManifest(manifestPath);
+
+        SnapshotInfo info;
+        info.id = id;
+        info.label = manifest.label;
+        info.createdAt = manifest.createdAt;
+        for (SnapshotManifestEntry const& entry : manifest.entries)
+        {
+            if (entry.type == SnapshotManifestEntry::Type::RegularFile)
+            {
+                ++info.numFiles;
+                info.numBytes += entry.size;
+            }
+        }
+        snapshots.push_back(std::move(info));
+    }
+
+    std::sort(snapshots.begin(), snapshots.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.createdAt != rhs.createdAt ? lhs.createdAt < rhs.createdAt : lhs.id < rhs.id;
+    });
+
+    return snapshots;
+}
+
+SnapshotRestoreStats
+restoreSnapshot(
+    fs::path const& snapshotsDir, std::string const& snapshotId, fs::path const& prefixDir)
+{
+    fs::path const dir = snapshotDir(snapshotsDir, snapshotId);
+    fs::path const treeDir = dir / kTreeDirName;
+    fs::path const manifestPath = dir / kManifestFileName;
+
+    SnapshotManifest manifest = readSnapshotManifest(manifestPath);
+    SnapshotRestoreStats stats;
+
+    std::unordered_map<std::string, SnapshotManifestEntry const*> entriesByPath;
+    for (SnapshotManifestEntry const& entry : manifest.entries)
+    {
+        entriesByPath.emplace(entry.path, &entry);
+    }
+
+    fs::create_directories(prefixDir);
+    removeUnknownEntries(prefixDir, prefixDir, entriesByPath, stats);
+
+    // Parents come before their contents, as the entries are sorted by path.
+    for (SnapshotManifestEntry& entry : manifest.entries)
+    {
+        fs::path const livePath = prefixDir / entry.path;
+
+        struct stat st;
+        bool const exists = lstat(livePath.c_str(), &st) == 0;
+
+        switch (entry.type)
+        {
+        case SnapshotManifestEntry::Type::Directory:
+            if (exists)
+            {
+                ++stats.numUnchanged;
+                break;
+            }
+            if (mkdir(livePath.c_str(), 0700) == -1)
+            {
+                throwErrno("Failed to create the directory " + livePath.string());
+            }
+            ++stats.numRestored;
+            break;
+
+        case SnapshotManifestEntry::Type::Symlink:
+            if (exists && readSymlink(livePath) == entry.linkTarget)
+            {
+                ++stats.numUnchanged;
+                break;
+            }
+            if (exists)
+            {
+                fs::remove(livePath);
+            }
+            if (symlink(entry.linkTarget.c_str(), livePath.c_str()) == -1)
+            {
+                throwErrno("Failed to create the symlink " + livePath.string());
+            }
+            ++stats.numRestored;
+            break;
+
+        case SnapshotManifestEntry::Type::RegularFile:
+        {
+            fs::path const snapshotPath = treeDir / entry.path;
+
+            if (exists && isFileUnchanged(livePath, st, snapshotPath, entry))
+            {
+                if ((st.st_mode & 07777) != entry.mode)
+                {
+                    chmod(livePath.c_str(), entry.mode);
+                }
+                ++stats.numUnchanged;
+                break;
+            }
+
+            restoreFile(snapshotPath, livePath);
+            ++stats.numRestored;
+
+            // Remember the restored file, so that restoring the same snapshot again
+            // recognizes it without hashing.
+            if (lstat(livePath.c_str(), &st) == 0)
+            {
+                entry.inode = st.st_ino;
+                entry.mtimeNs = mtimeNs(st);
+            }
+            break;
+        }
+        }
+    }
+
+    // Directory permissions and timestamps go last, as populating a directory changes its
+    // timestamps and a read-only directory couldn't be populated.
+    for (auto it = manifest.entries.rbegin(); it != manifest.entries.rend(); ++it)
+    {
+        if (it->type == SnapshotManifestEntry::Type::Directory)
+        {
+            fs::path const livePath = prefixDir / it->path;
+            struct timespec const times[2] = {
+                {0, UTIME_OMIT},
+                {it->mtimeNs / 1'000'000'000, it->mtimeNs % 1'000'000'000}};
+            chmod(livePath.c_str(), it->mode);
+            utimensat(AT_FDCWD, livePath.c_str(), times, AT_SYMLINK_NOFOLLOW);
+        }
+    }
+
+    writeSnapshotManifest(manifestPath, manifest);
+
+    return stats;
+}
+
+void
+deleteSnapshot(fs::path const& snapshotsDir, std::string const& snapshotId)
+{
+    fs::path const dir = snapshotDir(snapshotsDir, snapshotId);
+    if (!fs::exists(dir / kManifestFileName))
+    {
+        throw std::invalid_argument("No such snapshot: " + snapshotId);
+    }
+
+    // Rename first, so that an interrupted deletion doesn't leave a half-deleted snapshot
+    // that looks complete.
+    fs::path const doomedDir = snapshotsDir / ("." + snapshotId + ".deleting");
+    fs::rename(dir, doomedDir);
+    fs::remove_all(doomedDir);
+}
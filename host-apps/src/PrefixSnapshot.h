@@ -0,0 +1,91 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CloneTree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Snapshots of a Wine prefix directory. Each snapshot is a directory under the snapshots
+// directory, containing:
+//
+//   tree/           A clone of the prefix directory, made with cloneTree().
+//   manifest.tsv    The state of every entry of the prefix at the time. See SnapshotManifest.
+//
+// Snapshots are assembled under a hidden name and renamed into place once complete.
+
+struct SnapshotInfo
+{
+    std::string id;
+    std::string label;
+    int64_t createdAt = 0;
+    size_t numFiles = 0;
+
+    /** The total size of the files, not accounting for any storage shared through reflinks. */
+    uint64_t numBytes = 0;
+};
+
+struct SnapshotRestoreStats
+{
+    size_t numUnchanged = 0;
+    size_t numRestored = 0;
+    size_t numRemoved = 0;
+};
+
+/**
+ * Takes a snapshot of a prefix directory. Wine must not be running in the prefix.
+ *
+ * @return The id of the new snapshot, which is derived from the current time.
+ * @throw std::system_error On failure, in which case no snapshot is left behind.
+ */
+std::string createSnapshot(
+    std::filesystem::path const& snapshotsDir, std::filesystem::path const& prefixDir,
+    std::string const& label, CloneTreeStats* cloneStats = nullptr);
+
+/**
+ * Lists the snapshots, oldest first.
+ *
+ * @throw std::system_error If the snapshots directory exists but can't be read.
+ */
+std::vector<SnapshotInfo> listSnapshots(std::filesystem::path const& snapshotsDir);
+
+/**
+ * Brings a prefix directory back to the state captured by a snapshot. Wine must not be
+ * running in the prefix.
+ *
+ * Only entries that differ from the snapshot are touched. A regular file is considered
+ * unchanged if its inode, size and modification time match the manifest. Failing that,
+ * a file of the same size is compared by hash.
+ *
+ * @throw std::system_error On failure, in which case the prefix may be partially restored.
+ * @throw std::runtime_error If the snapshot is malformed.
+ */
+SnapshotRestoreStats restoreSnapshot(
+    std::filesystem::path const& snapshotsDir, std::string const& snapshotId,
+    std::filesystem::path const& prefixDir);
+
+/**
+ * @throw std::system_error On failure.
+ * @throw std::invalid_argument If there is no such snapshot.
+ */
+void deleteSnapshot(std::filesystem::path const& snapshotsDir, std::string const& snapshotId);
@@ -0,0 +1,181 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RegEdit.h"
+
+#include "RegFile.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The number of seconds between the Windows epoch (1601) and the Unix one (1970).
+ */
+constexpr uint64_t kSecondsFromWindowsToUnixEpoch = 11644473600;
+
+std::string
+formatValueLine(RegEdit const& edit)
+{
+    std::string line;
+
+    if (edit.valueName.empty())
+    {
+        line = "@";
+    }
+    else
+    {
+        line = "\"" + escapeRegString(edit.valueName, "\"") + "\"";
+    }
+
+    line += "=";
+    line += *edit.data;
+    line += "\n";
+
+    return line;
+}
+
+std::string
+formatKeyHeader(std::string_view keyPath, std::time_t now)
+{
+    // Wine writes both the Unix time and the FILETIME (100ns units since 1601) of the last
+    // modification.
+    uint64_t const fileTime =
+        (static_cast<uint64_t>(now) + kSecondsFromWindowsToUnixEpoch) * 10'000'000;
+
+    char timestamps[64];
+    snprintf(
+        timestamps, sizeof(timestamps), " %llu\n#time=%llx\n",
+        static_cast<unsigned long long>(now), static_cast<unsigned long long>(fileTime));
+
+    return "[" + escapeRegString(keyPath, "[]") + "]" + timestamps;
+}
+
+} // namespace
+
+std::string
+formatRegDword(uint32_t value)
+{
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "dword:%08x", static_cast<unsigned>(value));
+    return buffer;
+}
+
+std::string
+formatRegString(std::string_view value)
+{
+    return "\"" + escapeRegString(value, "\"") + "\"";
+}
+
+std::string
+formatRegExpandString(std::string_view value)
+{
+    return "str(2):" + formatRegString(value);
+}
+
+std::string
+applyRegEdit(std::string_view hiveText, RegEdit const& edit, std::time_t now)
+{
+    std::vector<RegKeySection> const sections = scanRegKeySections(hiveText);
+
+    RegKeySection const* section = nullptr;
+    for (RegKeySection const& candidate : sections)
+    {
+        if (regNamesEqual(candidate.path, edit.keyPath))
+        {
+            section = &candidate;
+            break;
+        }
+    }
+
+    std::string newText;
+    newText.reserve(hiveText.size() + 256);
+
+    if (!section)
+    {
+        newText = hiveText;
+
+        if (edit.data)
+        {
+            if (!newText.empty() && !newText.ends_with('\n'))
+            {
+                newText += "\n";
+            }
+            newText += "\n";
+            newText += formatKeyHeader(edit.keyPath, now);
+            newText += formatValueLine(edit);
+        }
+
+        return newText;
+    }
+
+    // The part of the section up to and including the line to insert into or replace.
+    size_t spliceBegin = section->contentEnd;
+    size_t spliceEnd = section->contentEnd;
+    bool valueFound = false;
+
+    for (RegValueLine const& value : scanRegValueLines(hiveText, *section))
+    {
+        if (regNamesEqual(value.name, edit.valueName))
+        {
+            if (edit.data &&
+                hiveText.substr(value.begin, value.end - value.begin) == formatValueLine(edit))
+            {
+                return std::string(hiveText);
+            }
+
+            spliceBegin = value.begin;
+            spliceEnd = value.end;
+            valueFound = true;
+            break;
+        }
+    }
+
+    if (!valueFound && !edit.data)
+    {
+        return std::string(hiveText);
+    }
+
+    // Like Wine, record the modification time of the key. The #time line, if present,
+    // immediately follows the header.
+    size_t bodyBegin = section->headerEnd;
+    if (hiveText.substr(bodyBegin).starts_with("#time="))
+    {
+        size_t const lineEnd = hiveText.find('\n', bodyBegin);
+        bodyBegin = lineEnd == std::string_view::npos ? hiveText.size() : lineEnd + 1;
+    }
+
+    newText.append(hiveText.substr(0, section->begin));
+    newText += formatKeyHeader(section->path, now);
+    newText.append(hiveText.substr(bodyBegin, spliceBegin - bodyBegin));
+
+    if (!valueFound && !newText.ends_with('\n'))
+    {
+        newText += "\n";
+    }
+    if (edit.data)
+    {
+        newText += formatValueLine(edit);
+    }
+
+    newText.append(hiveText.substr(spliceEnd));
+
+    return newText;
+}
@@ -0,0 +1,72 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * A change to a single registry value.
+ */
+struct RegEdit
+{
+    /** The key path relative to the root of the hive, like "Control Panel\Desktop". */
+    std::string keyPath;
+
+    /** The value name. Empty for the default value. */
+    std::string valueName;
+
+    /**
+     * The value data in .reg syntax, as produced by the formatRegXxx() functions.
+     * std::nullopt deletes the value.
+     */
+    std::optional<std::string> data;
+};
+
+/**
+ * Produces REG_DWORD data, like dword:00000060.
+ */
+std::string formatRegDword(uint32_t value);
+
+/**
+ * Produces REG_SZ data from a UTF-8 string.
+ */
+std::string formatRegString(std::string_view value);
+
+/**
+ * Produces REG_EXPAND_SZ data from a UTF-8 string.
+ */
+std::string formatRegExpandString(std::string_view value);
+
+/**
+ * Applies an edit to the contents of a .reg file and returns the new contents.
+ *
+ * Everything not affected by the edit is copied verbatim. A value that exists is replaced
+ * in place, a new value is appended to the end of its key, and a new key is appended
+ * to the end of the file, the same way Wine would add it. The modification time of
+ * the key is updated, as Wine would do. Deleting a value that doesn't exist or setting
+ * a value to what it already is is a no-op.
+ *
+ * @param now The modification time to record for the key.
+ * @throw std::runtime_error If @p hiveText is not a Wine registry file.
+ */
+std::string applyRegEdit(std::string_view hiveText, RegEdit const& edit, std::time_t now);
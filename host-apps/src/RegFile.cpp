@@ -0,0 +1,442 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RegFile.h"
+
+#include "TextEncoding.h"
+
+#include <stdexcept>
+
+namespace
+{
+
+std::string_view const kRegFileHeader = "WINE REGISTRY Version 2";
+
+/**
+ * Returns the offset right past the line terminator of the line starting at @p pos,
+ * or the size of the text if it's the last line.
+ */
+size_t
+nextLineStart(std::string_view text, size_t pos)
+{
+    size_t const newline = text.find('\n', pos);
+    return newline == std::string_view::npos ? text.size() : newline + 1;
+}
+
+/**
+ * Returns the line starting at @p pos without its line terminator.
+ */
+std::string_view
+lineAt(std::string_view text, size_t pos)
+{
+    std::string_view line = text.substr(pos, nextLineStart(text, pos) - pos);
+
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+    {
+        line.remove_suffix(1);
+    }
+
+    return line;
+}
+
+bool
+isBlank(std::string_view line)
+{
+    return line.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+/**
+ * Finds the closing delimiter of an escaped string, skipping over escaped characters.
+ * Returns std::string_view::npos if there isn't one.
+ */
+size_t
+findUnescaped(std::string_view str, size_t pos, char delimiter)
+{
+    for (; pos < str.size(); ++pos)
+    {
+        if (str[pos] == '\\')
+        {
+            ++pos;
+        }
+        else if (str[pos] == delimiter)
+        {
+            return pos;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+int
+hexDigitValue(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+    {
+        return ch - '0';
+    }
+    else if (ch >= 'a' && ch <= 'f')
+    {
+        return ch - 'a' + 10;
+    }
+    else if (ch >= 'A' && ch <= 'F')
+    {
+        return ch - 'A' + 10;
+    }
+    else
+    {
+        return -1;
+    }
+}
+
+char
+asciiToLower(char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+} // namespace
+
+std::vector<RegKeySection>
+scanRegKeySections(std::string_view text)
+{
+    if (!text.starts_with(kRegFileHeader))
+    {
+        throw std::runtime_error("Not a Wine registry file");
+    }
+
+    std::vector<RegKeySection> sections;
+
+    size_t pos = nextLineStart(text, 0);
+    while (pos < text.size())
+    {
+        size_t const lineEnd = nextLineStart(text, pos);
+        std::string_view const line = lineAt(text, pos);
+
+        if (line.starts_with('['))
+        {
+            if (!sections.empty())
+            {
+                sections.back().end = pos;
+            }
+
+            size_t const closingBracket = findUnescaped(line, 1, ']');
+            if (closingBracket == std::string_view::npos)
+            {
+                throw std::runtime_error(
+                    "Malformed key header at offset " + std::to_string(pos) + ": " +
+                    std::string(line));
+            }
+
+            RegKeySection section;
+            section.path = unescapeRegString(line.substr(1, closingBracket - 1));
+            section.begin = pos;
+            section.headerEnd = lineEnd;
+            section.contentEnd = lineEnd;
+            section.end = text.size();
+            sections.push_back(std::move(section));
+        }
+        else if (!sections.empty() && !isBlank(line))
+        {
+            sections.back().contentEnd = lineEnd;
+        }
+
+        pos = lineEnd;
+    }
+
+    return sections;
+}
+
+std::vector<RegValueLine>
+scanRegValueLines(std::string_view text, RegKeySection const& section)
+{
+    std::vector<RegValueLine> values;
+
+    size_t pos = section.headerEnd;
+    while (pos < section.end)
+    {
+        size_t lineEnd = nextLineStart(text, pos);
+        std::string_view const line = lineAt(text, pos);
+
+        RegValueLine value;
+        size_t equalsSign = std::string_view::npos;
+
+        if (line.starts_with('"'))
+        {
+            size_t const closingQuote = findUnescaped(line, 1, '"');
+            if (closingQuote != std::string_view::npos && closingQuote + 1 < line.size() &&
+                line[closingQuote + 1] == '=')
+            {
+                value.name = unescapeRegString(line.substr(1, closingQuote - 1));
+                equalsSign = closingQuote + 1;
+            }
+        }
+        else if (line.starts_with("@="))
+        {
+            equalsSign = 1;
+        }
+
+        if (equalsSign == std::string_view::npos)
+        {
+            // Comments, metadata like #time= and blank lines.
+            pos = lineEnd;
+            continue;
+        }
+
+        size_t const dataBegin = pos + equalsSign + 1;
+        size_t dataEnd = pos + line.size();
+
+        // Binary data is wrapped with a trailing backslash.
+        bool const isBinary = text.substr(dataBegin, 3) == "hex";
+        std::string_view currentLine = line;
+        while (isBinary && currentLine.ends_with('\\') && lineEnd < section.end)
+        {
+            currentLine = lineAt(text, lineEnd);
+            dataEnd = lineEnd + currentLine.size();
+            lineEnd = nextLineStart(text, lineEnd);
+        }
+
+        value.rawData = text.substr(dataBegin, dataEnd - dataBegin);
+        value.begin = pos;
+        value.end = lineEnd;
+        values.push_back(std::move(value));
+
+        pos = lineEnd;
+    }
+
+    return values;
+}
+
+std::string
+unescapeRegString(std::string_view escaped)
+{
+    std::u16string unescaped;
+    unescaped.reserve(escaped.size());
+
+    size_t pos = 0;
+    while (pos < escaped.size())
+    {
+        char const ch = escaped[pos++];
+
+        if (ch != '\\' || pos == escaped.size())
+        {
+            // Wine treats unescaped bytes as Latin-1.
+            unescaped += static_cast<char16_t>(static_cast<unsigned char>(ch));
+            continue;
+        }
+
+        char const escapedChar = escaped[pos++];
+
+        switch (escapedChar)
+        {
+        case 'a':
+            unescaped += u'\a';
+            break;
+        case 'b':
+            unescaped += u'\b';
+            break;
+        case 'e':
+            unescaped += u'\x1b';
+            break;
+        case 'f':
+            unescaped += u'\f';
+            break;
+        case 'n':
+            unescaped += u'\n';
+            break;
+        case 'r':
+            unescaped += u'\r';
+            break;
+        case 't':
+            unescaped += u'\t';
+            break;
+        case 'v':
+            unescaped += u'\v';
+            break;
+        case 'x':
+        {
+            char16_t codeUnit = 0;
+            int numDigits = 0;
+            while (numDigits < 4 && pos < escaped.size() && hexDigitValue(escaped[pos]) >= 0)
+            {
+                codeUnit = static_cast<char16_t>(codeUnit * 16 + hexDigitValue(escaped[pos++]));
+                ++numDigits;
+            }
+            unescaped += numDigits ? codeUnit : u'x';
+            break;
+        }
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        {
+            char16_t codeUnit = static_cast<char16_t>(escapedChar - '0');
+            for (int i = 0; i < 2 && pos < escaped.size(); ++i)
+            {
+                if (escaped[pos] < '0' || escaped[pos] > '7')
+                {
+                    break;
+                }
+
+                codeUnit = static_cast<char16_t>(codeUnit * 8 + (escaped[pos++] - '0'));
+            }
+            unescaped += codeUnit;
+            break;
+        }
+        default:
+            unescaped += static_cast<char16_t>(static_cast<unsigned char>(escapedChar));
+            break;
+        }
+    }
+
+    return utf16ToUtf8(unescaped);
+}
+
+std::string
+escapeRegString(std::string_view utf8, std::string_view extraCharsToEscape)
+{
+    static char const hexChars[] = "0123456789abcdef";
+
+    constexpr size_t npos = std::string_view::npos;
+
+    std::string escaped;
+    escaped.reserve(utf8.size());
+
+    for (char16_t const ch : utf8ToUtf16(utf8))
+    {
+        if (ch > 127)
+        {
+            // Always using 4 digits avoids ambiguity when a hex digit follows.
+            escaped += "\\x";
+            escaped += hexChars[(ch >> 12) & 0xF];
+            escaped += hexChars[(ch >> 8) & 0xF];
+            escaped += hexChars[(ch >> 4) & 0xF];
+            escaped += hexChars[ch & 0xF];
+        }
+        else if (ch < ' ')
+        {
+            escaped += '\\';
+            switch (ch)
+            {
+            case u'\a':
+                escaped += 'a';
+                break;
+            case u'\b':
+                escaped += 'b';
+                break;
+            case u'\x1b':
+                escaped += 'e';
+                break;
+            case u'\f':
+                escaped += 'f';
+                break;
+            case u'\n':
+                escaped += 'n';
+                break;
+            case u'\r':
+                escaped += 'r';
+                break;
+            case u'\t':
+                escaped += 't';
+                break;
+            case u'\v':
+                escaped += 'v';
+                break;
+            default:
+                escaped += static_cast<char>('0' + ((ch >> 6) & 7));
+                escaped += static_cast<char>('0' + ((ch >> 3) & 7));
+                escaped += static_cast<char>('0' + (ch & 7));
+                break;
+            }
+        }
+        else if (ch == '\\' || extraCharsToEscape.find(static_cast<char>(ch)) != npos)
+        {
+            escaped += '\\';
+            escaped += static_cast<char>(ch);
+        }
+        else
+        {
+            escaped += static_cast<char>(ch);
+        }
+    }
+
+    return escaped;
+}
+
+bool
+regNamesEqual(std::string_view lhs, std::string_view rhs)
+{
+    if (lhs.size() != rhs.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (asciiToLower(lhs[i]) != asciiToLower(rhs[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+parseRegDword(std::string_view rawData, uint32_t& value)
+{
+    std::string_view const kPrefix = "dword:";
+    if (!rawData.starts_with(kPrefix) || rawData.size() != kPrefix.size() + 8)
+    {
+        return false;
+    }
+
+    uint32_t result = 0;
+    for (char const ch : rawData.substr(kPrefix.size()))
+    {
+        int const digit = hexDigitValue(ch);
+        if (digit < 0)
+        {
+            return false;
+        }
+        result = result * 16 + static_cast<uint32_t>(digit);
+    }
+
+    value = result;
+    return true;
+}
+
+bool
+parseRegString(std::string_view rawData, std::string& value)
+{
+    if (rawData.starts_with("str(2):"))
+    {
+        rawData.remove_prefix(7);
+    }
+
+    if (rawData.size() < 2 || !rawData.starts_with('"') || !rawData.ends_with('"'))
+    {
+        return false;
+    }
+
+    value = unescapeRegString(rawData.substr(1, rawData.size() - 2));
+    return true;
+}
@@ -0,0 +1,122 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tokenizer for Wine's text registry format, as found in user.reg, system.reg and userdef.reg:
+//
+//   WINE REGISTRY Version 2
+//   ;; All keys relative to \\Machine
+//
+//   [Software\\Wine] 1700000000
+//   #time=1da1234567890ab
+//   "Version"="win10"
+//   "Blob"=hex:01,02,03
+//
+// Binary data is wrapped onto continuation lines that follow a trailing backslash.
+// All offsets are relative to the beginning of the file.
+
+/**
+ * A [key] section of a .reg file.
+ */
+struct RegKeySection
+{
+    /** The key path with escapes resolved, like "Control Panel\Desktop", in UTF-8. */
+    std::string path;
+
+    /** The offset of the '[' character. */
+    size_t begin = 0;
+
+    /** The offset right past the header line, including its line terminator. */
+    size_t headerEnd = 0;
+
+    /** The offset right past the last non-blank line of the section. */
+    size_t contentEnd = 0;
+
+    /** The offset where the next section begins, or the size of the file. */
+    size_t end = 0;
+};
+
+/**
+ * A "name"=data line of a key section, possibly with continuation lines.
+ */
+struct RegValueLine
+{
+    /** The value name with escapes resolved, in UTF-8. Empty for the default value (@). */
+    std::string name;
+
+    /**
+     * The data as written in the file, like dword:00000060 or "text". Continuation lines
+     * are included verbatim.
+     */
+    std::string_view rawData;
+
+    /** The offset of the first character of the line. */
+    size_t begin = 0;
+
+    /** The offset right past the line terminator of the line or its last continuation line. */
+    size_t end = 0;
+};
+
+/**
+ * Splits the contents of a .reg file into key sections.
+ *
+ * @throw std::runtime_error If the text doesn't start with a Wine registry header.
+ */
+std::vector<RegKeySection> scanRegKeySections(std::string_view text);
+
+/**
+ * Returns the value lines of a key section produced by scanRegKeySections().
+ */
+std::vector<RegValueLine> scanRegValueLines(std::string_view text, RegKeySection const& section);
+
+/**
+ * Resolves the escapes Wine uses in key paths, value names and string data.
+ * The result is UTF-8.
+ */
+std::string unescapeRegString(std::string_view escaped);
+
+/**
+ * Escapes a UTF-8 string the way Wine does. Backslashes, control and non-ASCII characters
+ * are always escaped, and so are the characters in @p extraCharsToEscape.
+ */
+std::string escapeRegString(std::string_view utf8, std::string_view extraCharsToEscape);
+
+/**
+ * Compares registry paths or value names case-insensitively.
+ *
+ * Only ASCII letters are case-folded, which covers everything that matters in practice.
+ */
+bool regNamesEqual(std::string_view lhs, std::string_view rhs);
+
+/**
+ * Decodes REG_DWORD data (dword:0000abcd). Returns false if @p rawData is not a dword.
+ */
+bool parseRegDword(std::string_view rawData, uint32_t& value);
+
+/**
+ * Decodes REG_SZ and REG_EXPAND_SZ data ("text" or str(2):"text") into UTF-8.
+ * Returns false if @p rawData is not a string.
+ */
+bool parseRegString(std::string_view rawData, std::string& value);
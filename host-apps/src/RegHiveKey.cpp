@@ -0,0 +1,85 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RegHiveKey.h"
+
+#include "RegFile.h"
+
+#include <array>
+
+namespace
+{
+
+struct RegRoot
+{
+    std::string_view name;
+    std::string_view hiveFileName;
+    std::string_view keyPrefix;
+};
+
+std::array<RegRoot, 6> const kRegRoots = {{
+    {"HKEY_CURRENT_USER", "user.reg", ""},
+    {"HKCU", "user.reg", ""},
+    {"HKEY_LOCAL_MACHINE", "system.reg", ""},
+    {"HKLM", "system.reg", ""},
+    {"HKEY_CLASSES_ROOT", "system.reg", "Software\\Classes"},
+    {"HKCR", "system.reg", "Software\\Classes"},
+}};
+
+} // namespace
+
+std::optional<RegHiveKey>
+resolveRegHiveKey(std::filesystem::path const& winePrefixDir, std::string_view fullKeyPath)
+{
+    size_t const separator = fullKeyPath.find('\\');
+    std::string_view rootName = fullKeyPath.substr(0, separator);
+    std::string_view subPath;
+    if (separator != std::string_view::npos)
+    {
+        subPath = fullKeyPath.substr(separator + 1);
+    }
+
+    if (rootName.ends_with(':'))
+    {
+        rootName.remove_suffix(1);
+    }
+
+    while (subPath.ends_with('\\'))
+    {
+        subPath.remove_suffix(1);
+    }
+
+    for (RegRoot const& root : kRegRoots)
+    {
+        if (!regNamesEqual(root.name, rootName))
+        {
+            continue;
+        }
+
+        std::string keyPath(root.keyPrefix);
+        if (!keyPath.empty() && !subPath.empty())
+        {
+            keyPath += "\\";
+        }
+        keyPath += subPath;
+
+        return RegHiveKey{winePrefixDir / root.hiveFileName, std::move(keyPath)};
+    }
+
+    return std::nullopt;
+}
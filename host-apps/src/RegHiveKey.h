@@ -0,0 +1,45 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * A registry key located within one of the hive files of a Wine prefix.
+ */
+struct RegHiveKey
+{
+    /** user.reg or system.reg within the prefix. */
+    std::filesystem::path hiveFile;
+
+    /** The key path relative to the root of the hive. */
+    std::string keyPath;
+};
+
+/**
+ * Maps a full key path, like HKCU\Control Panel\Desktop, to the hive file that stores it.
+ *
+ * HKEY_CURRENT_USER (HKCU), HKEY_LOCAL_MACHINE (HKLM) and HKEY_CLASSES_ROOT (HKCR) are
+ * supported, and so is the "HKCU:" spelling. Returns std::nullopt for other roots.
+ */
+std::optional<RegHiveKey> resolveRegHiveKey(
+    std::filesystem::path const& winePrefixDir, std::string_view fullKeyPath);
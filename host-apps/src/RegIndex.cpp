@@ -0,0 +1,416 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RegIndex.h"
+
+#include "LittleEndianReader.h"
+#include "WriteFileAtomically.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+// The layout of an index file, with all integers in little-endian:
+//
+// Header:
+//   char     magic[8];        // "WBREGIX1"
+//   uint64_t hiveSize;
+//   uint64_t hiveMtimeSec;
+//   uint64_t hiveMtimeNsec;
+//   uint64_t hiveInode;
+//   uint32_t numEntries;
+//   uint32_t stringsSize;
+// Entries, sorted by their folded paths:
+//   uint32_t foldedPathOffset;   // Relative to the start of the strings.
+//   uint32_t pathOffset;         // Ditto.
+//   uint32_t pathLength;         // Folding doesn't change the length.
+//   uint32_t reserved;
+//   uint64_t sectionBegin;
+//   uint64_t sectionHeaderEnd;
+//   uint64_t sectionContentEnd;
+//   uint64_t sectionEnd;
+// Strings:
+//   char     strings[stringsSize];
+
+namespace
+{
+
+char const kMagic[8] = {'W', 'B', 'R', 'E', 'G', 'I', 'X', '1'};
+size_t const kHeaderSize = 48;
+size_t const kEntrySize = 48;
+
+/**
+ * Stands in for the path separator in folded paths. Being smaller than any character
+ * that can appear in a key name makes every key sort right before its subtree.
+ */
+char const kFoldedSeparator = '\x01';
+
+std::string
+foldRegPath(std::string_view path)
+{
+    std::string folded(path);
+
+    for (char& ch : folded)
+    {
+        if (ch == '\\')
+        {
+            ch = kFoldedSeparator;
+        }
+        else if (ch >= 'A' && ch <= 'Z')
+        {
+            ch = static_cast<char>(ch - 'A' + 'a');
+        }
+    }
+
+    return folded;
+}
+
+void
+appendU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void
+appendU64(std::vector<uint8_t>& out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void
+appendHeader(std::vector<uint8_t>& out, struct stat const& hiveStatus)
+{
+    out.insert(out.end(), std::begin(kMagic), std::end(kMagic));
+    appendU64(out, static_cast<uint64_t>(hiveStatus.st_size));
+    appendU64(out, static_cast<uint64_t>(hiveStatus.st_mtim.tv_sec));
+    appendU64(out, static_cast<uint64_t>(hiveStatus.st_mtim.tv_nsec));
+    appendU64(out, static_cast<uint64_t>(hiveStatus.st_ino));
+}
+
+/**
+ * Checks that @p index was built from a hive with the given status and is well-formed.
+ */
+bool
+isIndexValidForHive(std::span<uint8_t const> index, struct stat const& hiveStatus)
+{
+    std::vector<uint8_t> expectedHeader;
+    appendHeader(expectedHeader, hiveStatus);
+
+    if (index.size() < kHeaderSize ||
+        memcmp(index.data(), expectedHeader.data(), expectedHeader.size()) != 0)
+    {
+        return false;
+    }
+
+    uint64_t const numEntries = loadU32(index, 40);
+    uint64_t const stringsSize = loadU32(index, 44);
+
+    return index.size() == kHeaderSize + numEntries * kEntrySize + stringsSize;
+}
+
+} // namespace
+
+struct RegIndex::Entry
+{
+    std::string_view foldedPath;
+    std::string_view path;
+    size_t sectionBegin;
+    size_t sectionHeaderEnd;
+    size_t sectionContentEnd;
+    size_t sectionEnd;
+};
+
+RegIndex::RegIndex(MappedFile const& hive, std::filesystem::path const& indexFile)
+    : mHiveText(hive.text())
+{
+    try
+    {
+        mMappedIndex = std::make_unique<MappedFile>(indexFile);
+        if (isIndexValidForHive(mMappedIndex->data(), hive.status()))
+        {
+            mIndex = mMappedIndex->data();
+            return;
+        }
+        mMappedIndex.reset();
+    }
+    catch (std::exception const&)
+    {
+        // A missing index is the same as a stale one.
+    }
+
+    mBuiltIndex = build(mHiveText, hive.status());
+    mIndex = mBuiltIndex;
+    mWasRebuilt = true;
+
+    try
+    {
+        writeFileAtomically(
+            indexFile,
+            {reinterpret_cast<char const*>(mBuiltIndex.data()), mBuiltIndex.size()});
+    }
+    catch (std::exception const&)
+    {
+        // The index is just a cache. We can work without saving it.
+    }
+}
+
+RegIndex::~RegIndex() = default;
+
+size_t
+RegIndex::numKeys() const
+{
+    return loadU32(mIndex, 40);
+}
+
+std::vector<uint8_t>
+RegIndex::build(std::string_view hiveText, struct stat const& hiveStatus)
+{
+    std::vector<RegKeySection> const sections = scanRegKeySections(hiveText);
+
+    std::vector<std::string> foldedPaths;
+    foldedPaths.reserve(sections.size());
+    for (RegKeySection const& section : sections)
+    {
+        foldedPaths.push_back(foldRegPath(section.path));
+    }
+
+    std::vector<size_t> order(sections.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(
+        order.begin(), order.end(),
+        [&](size_t lhs, size_t rhs) { return foldedPaths[lhs] < foldedPaths[rhs]; });
+
+    std::vector<uint8_t> index;
+    appendHeader(index, hiveStatus);
+    appendU32(index, static_cast<uint32_t>(sections.size()));
+    size_t const stringsSizeOffset = index.size();
+    appendU32(index, 0);
+
+    std::string strings;
+
+    for (size_t const i : order)
+    {
+        RegKeySection const& section = sections[i];
+
+        appendU32(index, static_cast<uint32_t>(strings.size()));
+        strings += foldedPaths[i];
+        appendU32(index, static_cast<uint32_t>(strings.size()));
+        strings += section.path;
+        appendU32(index, static_cast<uint32_t>(section.path.size()));
+        appendU32(index, 0);
+        appendU64(index, section.begin);
+        appendU64(index, section.headerEnd);
+        appendU64(index, section.contentEnd);
+        appendU64(index, section.end);
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        index[stringsSizeOffset + i] = static_cast<uint8_t>(strings.size() >> (i * 8));
+    }
+    index.insert(index.end(), strings.begin(), strings.end());
+
+    return index;
+}
+
+RegIndex::Entry
+RegIndex::entry(size_t index) const
+{
+    size_t const entryOffset = kHeaderSize + index * kEntrySize;
+    size_t const stringsOffset = kHeaderSize + numKeys() * kEntrySize;
+    auto const strings = std::string_view(
+        reinterpret_cast<char const*>(mIndex.data() + stringsOffset),
+        mIndex.size() - stringsOffset);
+
+    size_t const pathLength = loadU32(mIndex, entryOffset + 8);
+
+    Entry entry;
+    entry.foldedPath = strings.substr(loadU32(mIndex, entryOffset), pathLength);
+    entry.path = strings.substr(loadU32(mIndex, entryOffset + 4), pathLength);
+    entry.sectionBegin = loadU64(mIndex, entryOffset + 16);
+    entry.sectionHeaderEnd = loadU64(mIndex, entryOffset + 24);
+    entry.sectionContentEnd = loadU64(mIndex, entryOffset + 32);
+    entry.sectionEnd = loadU64(mIndex, entryOffset + 40);
+    return entry;
+}
+
+std::pair<size_t, size_t>
+RegIndex::equalRange(std::string_view foldedPrefix) const
+{
+    size_t first = 0;
+    size_t last = numKeys();
+
+    // Lower bound.
+    for (size_t count = last - first; count > 0;)
+    {
+        size_t const step = count / 2;
+        if (entry(first + step).foldedPath < foldedPrefix)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    // Upper bound, among the entries starting at the lower one.
+    size_t upper = first;
+    for (size_t count = last - first; count > 0;)
+    {
+        size_t const step = count / 2;
+        if (entry(upper + step).foldedPath.starts_with(foldedPrefix))
+        {
+            upper += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return {first, upper};
+}
+
+RegKeySection
+RegIndex::sectionForEntry(Entry const& entry) const
+{
+    if (entry.sectionEnd > mHiveText.size())
+    {
+        throw std::runtime_error("The registry index doesn't match the hive");
+    }
+
+    RegKeySection section;
+    section.path = entry.path;
+    section.begin = entry.sectionBegin;
+    section.headerEnd = entry.sectionHeaderEnd;
+    section.contentEnd = entry.sectionContentEnd;
+    section.end = entry.sectionEnd;
+    return section;
+}
+
+std::optional<RegIndexedKey>
+RegIndex::find(std::string_view keyPath) const
+{
+    std::string const folded = foldRegPath(keyPath);
+    if (folded.empty())
+    {
+        return RegIndexedKey{};
+    }
+
+    auto const [first, last] = equalRange(folded);
+    if (first != last)
+    {
+        Entry const firstEntry = entry(first);
+        if (firstEntry.foldedPath == folded)
+        {
+            return RegIndexedKey{std::string(firstEntry.path), sectionForEntry(firstEntry)};
+        }
+    }
+
+    // The key may still exist as a parent of other keys.
+    auto const [firstDescendant, lastDescendant] = equalRange(folded + kFoldedSeparator);
+    if (firstDescendant == lastDescendant)
+    {
+        return std::nullopt;
+    }
+
+    Entry const descendant = entry(firstDescendant);
+    return RegIndexedKey{std::string(descendant.path.substr(0, folded.size())), std::nullopt};
+}
+
+std::vector<std::string>
+RegIndex::subkeyNames(std::string_view keyPath) const
+{
+    std::string prefix = foldRegPath(keyPath);
+    if (!prefix.empty())
+    {
+        prefix += kFoldedSeparator;
+    }
+
+    auto const [first, last] = equalRange(prefix);
+
+    std::vector<std::string> names;
+    std::string_view previousFoldedName;
+
+    for (size_t i = first; i < last; ++i)
+    {
+        Entry const e = entry(i);
+
+        // Descendants of the same child are adjacent, so deduplicating neighbours is enough.
+        size_t nameEnd = e.foldedPath.find(kFoldedSeparator, prefix.size());
+        if (nameEnd == std::string_view::npos)
+        {
+            nameEnd = e.foldedPath.size();
+        }
+
+        std::string_view const foldedName =
+            e.foldedPath.substr(prefix.size(), nameEnd - prefix.size());
+        if (foldedName.empty() || foldedName == previousFoldedName)
+        {
+            continue;
+        }
+
+        previousFoldedName = foldedName;
+        names.emplace_back(e.path.substr(prefix.size(), nameEnd - prefix.size()));
+    }
+
+    return names;
+}
+
+std::vector<RegKeySection>
+RegIndex::subtree(std::string_view keyPath) const
+{
+    std::string const folded = foldRegPath(keyPath);
+    std::vector<RegKeySection> sections;
+
+    auto const [first, last] = equalRange(folded);
+    for (size_t i = first; i < last; ++i)
+    {
+        Entry const e = entry(i);
+
+        // Skip "Foo\Bar2" when asked for "Foo\Bar".
+        if (folded.empty() || e.foldedPath.size() == folded.size() ||
+            e.foldedPath[folded.size()] == kFoldedSeparator)
+        {
+            sections.push_back(sectionForEntry(e));
+        }
+    }
+
+    return sections;
+}
+
+std::filesystem::path
+regIndexFileForHive(std::filesystem::path const& hiveFile)
+{
+    std::filesystem::path indexFile = hiveFile;
+    indexFile += ".winebar-index";
+    return indexFile;
+}
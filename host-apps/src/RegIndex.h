@@ -0,0 +1,130 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "MappedFile.h"
+#include "RegFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A key found in a RegIndex.
+ */
+struct RegIndexedKey
+{
+    /** The key path, as spelled in the hive. */
+    std::string path;
+
+    /**
+     * The key's section in the hive, or std::nullopt for a key that only exists as a parent
+     * of other keys. Wine doesn't write sections for keys that have subkeys but no values.
+     */
+    std::optional<RegKeySection> section;
+};
+
+/**
+ * An on-disk index of the keys in a .reg file.
+ *
+ * The index is a sorted array of key paths with the offsets of their sections in the hive.
+ * Paths are sorted case-insensitively, with the path separator ordered before any other
+ * character, which places every key right before its subtree. That makes both lookups and
+ * subtree enumerations a binary search over a memory-mapped file.
+ *
+ * The index records the size, modification time and inode of the hive it was built from.
+ * It's rebuilt, in a single pass over the hive, when any of those change.
+ */
+class RegIndex
+{
+public:
+    RegIndex(RegIndex const&) = delete;
+    RegIndex& operator=(RegIndex const&) = delete;
+
+    /**
+     * Loads the index of @p hive from @p indexFile, rebuilding it if it's missing or out
+     * of date. Failing to save a rebuilt index is not an error, as it's only a cache.
+     *
+     * @throw std::runtime_error If the hive is not a Wine registry file.
+     */
+    RegIndex(MappedFile const& hive, std::filesystem::path const& indexFile);
+
+    ~RegIndex();
+
+    /**
+     * Whether the index had to be rebuilt, rather than loaded from the index file.
+     */
+    bool wasRebuilt() const { return mWasRebuilt; }
+
+    /**
+     * The number of key sections in the hive.
+     */
+    size_t numKeys() const;
+
+    /**
+     * Looks up a key by its path, relative to the root of the hive.
+     */
+    std::optional<RegIndexedKey> find(std::string_view keyPath) const;
+
+    /**
+     * Returns the names of the direct subkeys of a key, sorted case-insensitively.
+     * An empty @p keyPath stands for the root of the hive.
+     */
+    std::vector<std::string> subkeyNames(std::string_view keyPath) const;
+
+    /**
+     * Returns the sections of a key and all its descendants, in index order.
+     */
+    std::vector<RegKeySection> subtree(std::string_view keyPath) const;
+
+    /**
+     * Produces a serialized index of a hive.
+     *
+     * @throw std::runtime_error If the hive is not a Wine registry file.
+     */
+    static std::vector<uint8_t> build(std::string_view hiveText, struct stat const& hiveStatus);
+
+private:
+    struct Entry;
+
+    Entry entry(size_t index) const;
+
+    /**
+     * Returns the [first, last) range of entries whose folded path starts with @p foldedPrefix.
+     */
+    std::pair<size_t, size_t> equalRange(std::string_view foldedPrefix) const;
+
+    RegKeySection sectionForEntry(Entry const& entry) const;
+
+    std::string_view mHiveText;
+    std::unique_ptr<MappedFile> mMappedIndex;
+    std::vector<uint8_t> mBuiltIndex;
+    std::span<uint8_t const> mIndex;
+    bool mWasRebuilt = false;
+};
+
+/**
+ * Returns the conventional location of the index file of a hive.
+ */
+std::filesystem::path regIndexFileForHive(std::filesystem::path const& hiveFile);
@@ -0,0 +1,198 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+uint32_t const kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2,
+};
+
+uint32_t
+rotr(uint32_t value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+uint32_t
+loadBigEndian32(uint8_t const* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+void
+storeBigEndian32(uint8_t* p, uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+} // namespace
+
+Sha256::Sha256()
+    : mState{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}
+{
+}
+
+void
+Sha256::update(std::span<uint8_t const> data)
+{
+    uint8_t const* p = data.data();
+    size_t remaining = data.size();
+    mTotalLength += remaining;
+
+    if (mBufferSize > 0)
+    {
+        size_t const toCopy = std::min(remaining, sizeof(mBuffer) - mBufferSize);
+        memcpy(mBuffer + mBufferSize, p, toCopy);
+        mBufferSize += toCopy;
+        p += toCopy;
+        remaining -= toCopy;
+
+        if (mBufferSize < sizeof(mBuffer))
+        {
+            return;
+        }
+
+        processBlock(mBuffer);
+        mBufferSize = 0;
+    }
+
+    for (; remaining >= sizeof(mBuffer); p += sizeof(mBuffer), remaining -= sizeof(mBuffer))
+    {
+        processBlock(p);
+    }
+
+    memcpy(mBuffer, p, remaining);
+    mBufferSize = remaining;
+}
+
+Sha256::Digest
+Sha256::digest()
+{
+    uint64_t const totalBits = mTotalLength * 8;
+
+    // The padding is a single 1 bit, zeros up to 56 bytes into a block and the length in bits.
+    uint8_t padding[72] = {0x80};
+    size_t const paddingSize = (mBufferSize < 56 ? 56 : 120) - mBufferSize;
+    for (int i = 0; i < 8; ++i)
+    {
+        padding[paddingSize + i] = static_cast<uint8_t>(totalBits >> (56 - 8 * i));
+    }
+    update({padding, paddingSize + 8});
+
+    Digest result;
+    for (int i = 0; i < 8; ++i)
+    {
+        storeBigEndian32(result.data() + 4 * i, mState[i]);
+    }
+    return result;
+}
+
+void
+Sha256::processBlock(uint8_t const* block)
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+    {
+        w[i] = loadBigEndian32(block + 4 * i);
+    }
+    for (int i = 16; i < 64; ++i)
+    {
+        uint32_t const s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t const s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = mState[0];
+    uint32_t b = mState[1];
+    uint32_t c = mState[2];
+    uint32_t d = mState[3];
+    uint32_t e = mState[4];
+    uint32_t f = mState[5];
+    uint32_t g = mState[6];
+    uint32_t h = mState[7];
+
+    for (int i = 0; i < 64; ++i)
+    {
+        uint32_t const s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t const ch = (e & f) ^ (~e & g);
+        uint32_t const temp1 = h + s1 + ch + kRoundConstants[i] + w[i];
+        uint32_t const s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t const maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t const temp2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    mState[0] += a;
+    mState[1] += b;
+    mState[2] += c;
+    mState[3] += d;
+    mState[4] += e;
+    mState[5] += f;
+    mState[6] += g;
+    mState[7] += h;
+}
+
+Sha256::Digest
+sha256(std::span<uint8_t const> data)
+{
+    Sha256 hasher;
+    hasher.update(data);
+    return hasher.digest();
+}
+
+std::string
+toHexString(Sha256::Digest const& digest)
+{
+    static char const kHexDigits[] = "0123456789abcdef";
+
+    std::string hex;
+    hex.reserve(digest.size() * 2);
+    for (uint8_t byte : digest)
+    {
+        hex += kHexDigits[byte >> 4];
+        hex += kHexDigits[byte & 0xf];
+    }
+    return hex;
+}
@@ -0,0 +1,61 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * An incremental implementation of SHA-256, as specified in FIPS 180-4.
+ */
+class Sha256
+{
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+
+    void update(std::span<uint8_t const> data);
+
+    /**
+     * Finishes the computation. No further updates are allowed after that.
+     */
+    Digest digest();
+
+private:
+    void processBlock(uint8_t const* block);
+
+    uint32_t mState[8];
+    uint64_t mTotalLength = 0;
+    uint8_t mBuffer[64];
+    size_t mBufferSize = 0;
+};
+
+/**
+ * Hashes a buffer in one go.
+ */
+Sha256::Digest sha256(std::span<uint8_t const> data);
+
+/**
+ * Returns the lowercase hex representation of a digest.
+ */
+std::string toHexString(Sha256::Digest const& digest);
@@ -0,0 +1,222 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SnapshotManifest.h"
+
+#include "MappedFile.h"
+#include "WriteFileAtomically.h"
+
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+
+// Format:
+//
+//   # WineBar snapshot manifest 1
+//   created<TAB><unix time>
+//   label<TAB><label>
+//   <type><TAB><mode><TAB><inode><TAB><size><TAB><mtime><TAB><hash><TAB><path><TAB><target>
+//   ...
+//
+// The mode is in octal, the mtime in nanoseconds and the hash in hex, or "-" if it hasn't
+// been computed yet. The target is only non-empty for symlinks.
+//
+// Backslashes, tabs and newlines within strings are escaped C-style.
+
+namespace
+{
+
+std::string_view const kHeader = "# WineBar snapshot manifest 1";
+
+std::string
+escapeField(std::string_view field)
+{
+    std::string escaped;
+    escaped.reserve(field.size());
+
+    for (char const ch : field)
+    {
+        switch (ch)
+        {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            escaped += ch;
+            break;
+        }
+    }
+
+    return escaped;
+}
+
+std::string
+unescapeField(std::string_view field)
+{
+    std::string unescaped;
+    unescaped.reserve(field.size());
+
+    for (size_t i = 0; i < field.size(); ++i)
+    {
+        if (field[i] != '\\' || i + 1 == field.size())
+        {
+            unescaped += field[i];
+            continue;
+        }
+
+        char const escapedChar = field[++i];
+        unescaped += escapedChar == 't' ? '\t' : escapedChar == 'n' ? '\n' : escapedChar;
+    }
+
+    return unescaped;
+}
+
+std::vector<std::string_view>
+splitFields(std::string_view line)
+{
+    std::vector<std::string_view> fields;
+
+    for (size_t pos = 0;;)
+    {
+        size_t const tab = line.find('\t', pos);
+        fields.push_back(line.substr(pos, tab - pos));
+        if (tab == std::string_view::npos)
+        {
+            return fields;
+        }
+        pos = tab + 1;
+    }
+}
+
+template <typename T>
+T
+parseNumber(std::string_view field, int base)
+{
+    T value = 0;
+    auto const [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value, base);
+    if (ec != std::errc() || end != field.data() + field.size())
+    {
+        throw std::runtime_error("Malformed snapshot manifest: bad number " + std::string(field));
+    }
+    return value;
+}
+
+} // namespace
+
+void
+writeSnapshotManifest(std::filesystem::path const& filePath, SnapshotManifest const& manifest)
+{
+    std::string text(kHeader);
+    text += "\ncreated\t" + std::to_string(manifest.createdAt);
+    text += "\nlabel\t" + escapeField(manifest.label);
+    text += "\n";
+
+    for (SnapshotManifestEntry const& entry : manifest.entries)
+    {
+        char numbers[128];
+        snprintf(
+            numbers, sizeof(numbers), "%c\t%o\t%" PRIu64 "\t%" PRIu64 "\t%" PRId64 "\t",
+            static_cast<char>(entry.type), static_cast<unsigned>(entry.mode), entry.inode,
+            entry.size, entry.mtimeNs);
+        text += numbers;
+
+        if (entry.hash)
+        {
+            char hash[17];
+            snprintf(hash, sizeof(hash), "%016" PRIx64, *entry.hash);
+            text += hash;
+        }
+        else
+        {
+            text += "-";
+        }
+
+        text += "\t" + escapeField(entry.path);
+        text += "\t" + escapeField(entry.linkTarget);
+        text += "\n";
+    }
+
+    writeFileAtomically(filePath, text);
+}
+
+SnapshotManifest
+readSnapshotManifest(std::filesystem::path const& filePath)
+{
+    MappedFile const file(filePath);
+    std::string_view text = file.text();
+
+    if (!text.starts_with(kHeader))
+    {
+        throw std::runtime_error("Not a snapshot manifest: " + filePath.string());
+    }
+
+    SnapshotManifest manifest;
+
+    while (!text.empty())
+    {
+        size_t const newline = text.find('\n');
+        std::string_view const line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+        if (line.empty() || line.starts_with('#'))
+        {
+            continue;
+        }
+
+        std::vector<std::string_view> const fields = splitFields(line);
+
+        if (fields[0] == "created" && fields.size() == 2)
+        {
+            manifest.createdAt = parseNumber<int64_t>(fields[1], 10);
+        }
+        else if (fields[0] == "label" && fields.size() == 2)
+        {
+            manifest.label = unescapeField(fields[1]);
+        }
+        else if (fields[0].size() == 1 && fields.size() == 8)
+        {
+            SnapshotManifestEntry entry;
+            entry.type = static_cast<SnapshotManifestEntry::Type>(fields[0][0]);
+            entry.mode = parseNumber<uint32_t>(fields[1], 8);
+            entry.inode = parseNumber<uint64_t>(fields[2], 10);
+            entry.size = parseNumber<uint64_t>(fields[3], 10);
+            entry.mtimeNs = parseNumber<int64_t>(fields[4], 10);
+            if (fields[5] != "-")
+            {
+                entry.hash = parseNumber<uint64_t>(fields[5], 16);
+            }
+            entry.path = unescapeField(fields[6]);
+            entry.linkTarget = unescapeField(fields[7]);
+            manifest.entries.push_back(std::move(entry));
+        }
+        else
+        {
+            throw std::runtime_error("Malformed snapshot manifest line: " + std::string(line));
+        }
+    }
+
+    return manifest;
+}
@@ -0,0 +1,81 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * The state of a file or directory at the time a snapshot was taken.
+ */
+struct SnapshotManifestEntry
+{
+    enum class Type : char
+    {
+        Directory = 'd',
+        RegularFile = 'f',
+        Symlink = 'l',
+    };
+
+    Type type = Type::RegularFile;
+
+    /** Relative to the root of the snapshotted directory. */
+    std::string path;
+
+    /** Permission bits. */
+    uint32_t mode = 0;
+
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+
+    /**
+     * The XXH64 hash of a regular file's contents. Hashing is deferred until a restore
+     * needs it, so this starts out empty.
+     */
+    std::optional<uint64_t> hash;
+
+    /** The target of a symlink, as it was in the snapshotted directory. */
+    std::string linkTarget;
+};
+
+struct SnapshotManifest
+{
+    int64_t createdAt = 0;
+    std::string label;
+
+    /** Sorted by path, which puts every directory before its contents. */
+    std::vector<SnapshotManifestEntry> entries;
+};
+
+/**
+ * Writes a manifest as a tab-separated text file.
+ *
+ * @throw std::system_error On failure.
+ */
+void writeSnapshotManifest(std::filesystem::path const& filePath, SnapshotManifest const& manifest);
+
+/**
+ * @throw std::system_error If the file can't be read.
+ * @throw std::runtime_error If the file is malformed.
+ */
+SnapshotManifest readSnapshotManifest(std::filesystem::path const& filePath);
@@ -0,0 +1,389 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "StreamDecompressor.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+#include <zstd.h>
+
+namespace
+{
+
+size_t const kChunkSize = 1024 * 1024;
+
+bool
+startsWith(std::span<uint8_t const> data, std::span<uint8_t const> prefix)
+{
+    return data.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), data.begin());
+}
+
+[[noreturn]] void
+throwCorrupted(CompressionFormat format, std::string const& details = std::string())
+{
+    std::string message = std::string("Corrupted ") + compressionFormatName(format) + " stream";
+    if (!details.empty())
+    {
+        message += ": " + details;
+    }
+    throw std::runtime_error(message);
+}
+
+void
+copyStream(DecompressionSource const& source, DecompressionSink const& sink)
+{
+    std::vector<uint8_t> buffer(kChunkSize);
+    while (size_t const size = source(buffer))
+    {
+        sink(std::span(buffer.data(), size));
+    }
+}
+
+void
+decompressGzip(DecompressionSource const& source, DecompressionSink const& sink)
+{
+    struct Stream : z_stream
+    {
+        Stream() : z_stream{}
+        {
+            // Accept the gzip wrapper only.
+            if (inflateInit2(this, 16 + MAX_WBITS) != Z_OK)
+            {
+                throw std::runtime_error("Failed to initialize zlib");
+            }
+        }
+
+        ~Stream() { inflateEnd(this); }
+    } stream;
+
+    std::vector<uint8_t> input(kChunkSize);
+    std::vector<uint8_t> output(kChunkSize);
+    bool memberEnded = false;
+    bool outputFull = false;
+
+    while (true)
+    {
+        if (stream.avail_in == 0 && !outputFull)
+        {
+            size_t const size = source(input);
+            if (size == 0)
+            {
+                break;
+            }
+            stream.next_in = input.data();
+            stream.avail_in = static_cast<uInt>(size);
+        }
+
+        if (memberEnded)
+        {
+            // Another gzip member follows, as produced by pigz and the like.
+            inflateReset(&stream);
+            memberEnded = false;
+        }
+
+        stream.next_out = output.data();
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        int const ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+        {
+            memberEnded = true;
+        }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            throwCorrupted(CompressionFormat::Gzip, stream.msg ? stream.msg : "");
+        }
+
+        outputFull = stream.avail_out == 0;
+        sink(std::span(output.data(), output.size() - stream.avail_out));
+    }
+
+    if (!memberEnded)
+    {
+        throwCorrupted(CompressionFormat::Gzip, "unexpected end of stream");
+    }
+}
+
+void
+decompressBzip2(DecompressionSource const& source, DecompressionSink const& sink)
+{
+    struct Stream : bz_stream
+    {
+        Stream() : bz_stream{} { init(); }
+
+        ~Stream() { BZ2_bzDecompressEnd(this); }
+
+        void init()
+        {
+            if (BZ2_bzDecompressInit(this, 0, 0) != BZ_OK)
+            {
+                throw std::runtime_error("Failed to initialize libbz2");
+            }
+        }
+    } stream;
+
+    std::vector<uint8_t> input(kChunkSize);
+    std::vector<uint8_t> output(kChunkSize);
+    bool streamEnded = false;
+    bool outputFull = false;
+
+    while (true)
+    {
+        if (stream.avail_in == 0 && !outputFull)
+        {
+            size_t const size = source(input);
+            if (size == 0)
+            {
+                break;
+            }
+            stream.next_in = reinterpret_cast<char*>(input.data());
+            stream.avail_in = static_cast<unsigned>(size);
+        }
+
+        if (streamEnded)
+        {
+            // Concatenated streams, as produced by pbzip2.
+            char* const nextIn = stream.next_in;
+            unsigned const availIn = stream.avail_in;
+            BZ2_bzDecompressEnd(&stream);
+            stream.init();
+            stream.next_in = nextIn;
+            stream.avail_in = availIn;
+            streamEnded = false;
+        }
+
+        stream.next_out = reinterpret_cast<char*>(output.data());
+        stream.avail_out = static_cast<unsigned>(output.size());
+
+        int const ret = BZ2_bzDecompress(&stream);
+        if (ret == BZ_STREAM_END)
+        {
+            streamEnded = true;
+        }
+        else if (ret != BZ_OK)
+        {
+            throwCorrupted(CompressionFormat::Bzip2);
+        }
+
+        outputFull = stream.avail_out == 0;
+        sink(std::span(output.data(), output.size() - stream.avail_out));
+    }
+
+    if (!streamEnded)
+    {
+        throwCorrupted(CompressionFormat::Bzip2, "unexpected end of stream");
+    }
+}
+
+void
+decompressXz(unsigned numThreads, DecompressionSource const& source, DecompressionSink const& sink)
+{
+    struct Stream : lzma_stream
+    {
+        Stream() : lzma_stream(LZMA_STREAM_INIT) {}
+
+        ~Stream() { lzma_end(this); }
+    } stream;
+
+#if LZMA_VERSION >= 50040002
+    lzma_mt options = {};
+    options.flags = LZMA_CONCATENATED;
+    options.threads = std::max(numThreads, 1u);
+    options.timeout = 0;
+    // Fall back to fewer threads rather than take too much memory.
+    options.memlimit_threading = std::max<uint64_t>(lzma_physmem() / 4, 64 << 20);
+    options.memlimit_stop = UINT64_MAX;
+
+    lzma_ret const initRet = lzma_stream_decoder_mt(&stream, &options);
+#else
+    (void)numThreads;
+    lzma_ret const initRet = lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED);
+#endif
+
+    if (initRet != LZMA_OK)
+    {
+        throw std::runtime_error("Failed to initialize liblzma");
+    }
+
+    std::vector<uint8_t> input(kChunkSize);
+    std::vector<uint8_t> output(kChunkSize);
+    lzma_action action = LZMA_RUN;
+
+    while (true)
+    {
+        if (stream.avail_in == 0 && action == LZMA_RUN)
+        {
+            size_t const size = source(input);
+            if (size == 0)
+            {
+                action = LZMA_FINISH;
+            }
+            stream.next_in = input.data();
+            stream.avail_in = size;
+        }
+
+        stream.next_out = output.data();
+        stream.avail_out = output.size();
+
+        lzma_ret const ret = lzma_code(&stream, action);
+        sink(std::span(output.data(), output.size() - stream.avail_out));
+
+        if (ret == LZMA_STREAM_END)
+        {
+            break;
+        }
+        else if (ret != LZMA_OK)
+        {
+            throwCorrupted(
+                CompressionFormat::Xz,
+                ret == LZMA_BUF_ERROR ? "unexpected end of stream"
+                                      : "error code " + std::to_string(ret));
+        }
+    }
+}
+
+void
+decompressZstd(DecompressionSource const& source, DecompressionSink const& sink)
+{
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> const context(
+        ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    if (!context)
+    {
+        throw std::runtime_error("Failed to initialize libzstd");
+    }
+
+    std::vector<uint8_t> input(kChunkSize);
+    std::vector<uint8_t> output(kChunkSize);
+    ZSTD_inBuffer inBuffer = {input.data(), 0, 0};
+    size_t lastRet = 1;
+    bool outputFull = false;
+
+    while (true)
+    {
+        if (inBuffer.pos == inBuffer.size && !outputFull)
+        {
+            size_t const size = source(input);
+            if (size == 0)
+            {
+                break;
+            }
+            inBuffer = {input.data(), size, 0};
+        }
+
+        ZSTD_outBuffer outBuffer = {output.data(), output.size(), 0};
+
+        // Returns 0 once a frame is fully decoded and flushed.
+        lastRet = ZSTD_decompressStream(context.get(), &outBuffer, &inBuffer);
+        if (ZSTD_isError(lastRet))
+        {
+            throwCorrupted(CompressionFormat::Zstd, ZSTD_getErrorName(lastRet));
+        }
+
+        outputFull = outBuffer.pos == outBuffer.size;
+        sink(std::span(output.data(), outBuffer.pos));
+    }
+
+    if (lastRet != 0)
+    {
+        throwCorrupted(CompressionFormat::Zstd, "unexpected end of stream");
+    }
+}
+
+} // namespace
+
+CompressionFormat
+detectCompressionFormat(std::span<uint8_t const> start)
+{
+    static constexpr std::array<uint8_t, 2> kGzipMagic = {0x1f, 0x8b};
+    static constexpr std::array<uint8_t, 3> kBzip2Magic = {'B', 'Z', 'h'};
+    static constexpr std::array<uint8_t, 6> kXzMagic = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+    static constexpr std::array<uint8_t, 4> kZstdMagic = {0x28, 0xb5, 0x2f, 0xfd};
+
+    if (startsWith(start, kGzipMagic))
+    {
+        return CompressionFormat::Gzip;
+    }
+    else if (startsWith(start, kBzip2Magic))
+    {
+        return CompressionFormat::Bzip2;
+    }
+    else if (startsWith(start, kXzMagic))
+    {
+        return CompressionFormat::Xz;
+    }
+    else if (startsWith(start, kZstdMagic))
+    {
+        return CompressionFormat::Zstd;
+    }
+    else
+    {
+        return CompressionFormat::None;
+    }
+}
+
+char const*
+compressionFormatName(CompressionFormat format)
+{
+    switch (format)
+    {
+    case CompressionFormat::None:
+        return "none";
+    case CompressionFormat::Gzip:
+        return "gzip";
+    case CompressionFormat::Bzip2:
+        return "bzip2";
+    case CompressionFormat::Xz:
+        return "xz";
+    case CompressionFormat::Zstd:
+        return "zstd";
+    }
+    return "unknown";
+}
+
+void
+decompressStream(
+    CompressionFormat format, unsigned numThreads,
+    DecompressionSource const& source, DecompressionSink const& sink)
+{
+    switch (format)
+    {
+    case CompressionFormat::None:
+        copyStream(source, sink);
+        break;
+    case CompressionFormat::Gzip:
+        decompressGzip(source, sink);
+        break;
+    case CompressionFormat::Bzip2:
+        decompressBzip2(source, sink);
+        break;
+    case CompressionFormat::Xz:
+        decompressXz(numThreads, source, sink);
+        break;
+    case CompressionFormat::Zstd:
+        decompressZstd(source, sink);
+        break;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+enum class CompressionFormat
+{
+    None,
+    Gzip,
+    Bzip2,
+    Xz,
+    Zstd,
+};
+
+/**
+ * Detects the compression format by the magic bytes at the start of a stream.
+ * Streams that are too short or don't start with any known signature are
+ * reported as CompressionFormat::None.
+ */
+CompressionFormat detectCompressionFormat(std::span<uint8_t const> start);
+
+char const* compressionFormatName(CompressionFormat format);
+
+/**
+ * Fills the buffer it's given with the next piece of input, returning the number of bytes
+ * written into it, or 0 at the end of input.
+ */
+using DecompressionSource = std::function<size_t(std::span<uint8_t> buffer)>;
+
+using DecompressionSink = std::function<void(std::span<uint8_t const> data)>;
+
+/**
+ * Decompresses a whole stream pulled from @p source, pushing the output to @p sink.
+ *
+ * xz streams consisting of multiple blocks are decoded by up to @p numThreads threads.
+ * The other formats, as well as single-block xz streams, don't allow parallel decoding.
+ * Concatenated gzip members and zstd frames are decoded one after another.
+ *
+ * @throw std::runtime_error If the stream is corrupted or truncated.
+ */
+void decompressStream(
+    CompressionFormat format, unsigned numThreads,
+    DecompressionSource const& source, DecompressionSink const& sink);
@@ -0,0 +1,759 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TarExtractor.h"
+#include "ContentStore.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+size_t const kBlockSize = 512;
+
+/**
+ * Long names and pax headers are small. Anything bigger is not something we want to buffer.
+ */
+uint64_t const kMaxMetaDataSize = 1024 * 1024;
+
+/**
+ * With a store, files up to this size are held in memory until their hash is known.
+ */
+uint64_t const kMaxBufferedFileSize = 64 * 1024 * 1024;
+
+[[noreturn]] void
+throwErrno(std::string const& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+std::string
+stringField(uint8_t const* header, size_t offset, size_t size)
+{
+    char const* const begin = reinterpret_cast<char const*>(header + offset);
+    return std::string(begin, std::find(begin, begin + size, '\0'));
+}
+
+/**
+ * Parses an octal field or, for large values, a GNU base-256 one.
+ */
+uint64_t
+numericField(uint8_t const* header, size_t offset, size_t size)
+{
+    uint8_t const* field = header + offset;
+
+    if (field[0] & 0x80)
+    {
+        uint64_t value = field[0] & 0x7f;
+        for (size_t i = 1; i < size; ++i)
+        {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+
+    uint64_t value = 0;
+    size_t i = 0;
+    while (i < size && field[i] == ' ')
+    {
+        ++i;
+    }
+    for (; i < size && field[i] >= '0' && field[i] <= '7'; ++i)
+    {
+        value = (value << 3) | (field[i] - '0');
+    }
+    return value;
+}
+
+bool
+isChecksumValid(uint8_t const* header)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kBlockSize; ++i)
+    {
+        // The checksum field itself counts as spaces.
+        sum += (i >= 148 && i < 156) ? ' ' : header[i];
+    }
+    return sum == numericField(header, 148, 8);
+}
+
+/**
+ * Makes a path relative to the extraction directory, dropping "." components.
+ *
+ * @throw std::runtime_error If the path is absolute or has ".." components.
+ */
+std::string
+sanitizePath(std::string_view path)
+{
+    if (path.starts_with('/'))
+    {
+        throw std::runtime_error("Absolute path in the archive: " + std::string(path));
+    }
+
+    std::string sanitized;
+    while (!path.empty())
+    {
+        size_t const slash = path.find('/');
+        std::string_view const component = path.substr(0, slash);
+        path.remove_prefix(slash == std::string_view::npos ? path.size() : slash + 1);
+
+        if (component.empty() || component == ".")
+        {
+            continue;
+        }
+        else if (component == "..")
+        {
+            throw std::runtime_error("Path escaping the extraction directory in the archive");
+        }
+
+        if (!sanitized.empty())
+        {
+            sanitized += '/';
+        }
+        sanitized += component;
+    }
+
+    return sanitized;
+}
+
+/**
+ * Parses "<length> <key>=<value>\n" records of a pax extended header.
+ */
+template <typename Callback>
+void
+forEachPaxRecord(std::string_view data, Callback const& callback)
+{
+    while (!data.empty())
+    {
+        size_t length = 0;
+        auto const [end, ec] = std::from_chars(data.data(), data.data() + data.size(), length);
+        if (ec != std::errc() || length == 0 || length > data.size())
+        {
+            throw std::runtime_error("Malformed pax header in the archive");
+        }
+
+        std::string_view record = data.substr(0, length);
+        data.remove_prefix(length);
+
+        record.remove_prefix(end - record.data());
+        if (!record.starts_with(' ') || !record.ends_with('\n'))
+        {
+            throw std::runtime_error("Malformed pax header in the archive");
+        }
+        record = record.substr(1, record.size() - 2);
+
+        size_t const equals = record.find('=');
+        if (equals != std::string_view::npos)
+        {
+            callback(record.substr(0, equals), record.substr(equals + 1));
+        }
+    }
+}
+
+int64_t
+parseDecimal(std::string_view str)
+{
+    int64_t value = 0;
+    std::from_chars(str.data(), str.data() + str.size(), value);
+    return value;
+}
+
+} // namespace
+
+TarExtractor::TarExtractor(std::filesystem::path const& destDir, ContentStore* store)
+    : mRootFd(open(destDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+    , mStore(store)
+{
+    if (mRootFd == -1)
+    {
+        throwErrno("Failed to open " + destDir.string());
+    }
+}
+
+TarExtractor::~TarExtractor()
+{
+    for (int fd : {mFileFd, mCachedDirFd, mRootFd})
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+}
+
+void
+TarExtractor::consume(std::span<uint8_t const> data)
+{
+    while (!data.empty())
+    {
+        switch (mState)
+        {
+        case State::Header:
+        {
+            size_t const toCopy = std::min(data.size(), kBlockSize - mHeaderSize);
+            std::copy_n(data.begin(), toCopy, mHeader + mHeaderSize);
+            mHeaderSize += toCopy;
+            data = data.subspan(toCopy);
+
+            if (mHeaderSize == kBlockSize)
+            {
+                mHeaderSize = 0;
+                processHeader();
+            }
+            break;
+        }
+        case State::FileData:
+        {
+            size_t const toWrite = std::min<uint64_t>(data.size(), mRemaining);
+            std::span<uint8_t const> const piece = data.first(toWrite);
+
+            if (mHashingFile)
+            {
+                mFileHasher.update(piece);
+            }
+
+            if (mBufferingFile)
+            {
+                mFileBuffer.insert(mFileBuffer.end(), piece.begin(), piece.end());
+            }
+            else
+            {
+                writeToFile(piece);
+            }
+
+            data = data.subspan(toWrite);
+            mRemaining -= toWrite;
+            mStats.numBytes += toWrite;
+
+            if (mRemaining == 0)
+            {
+                finishFile();
+                startPadding();
+            }
+            break;
+        }
+        case State::MetaData:
+        case State::SkippedData:
+        {
+            size_t const toTake = std::min<uint64_t>(data.size(), mRemaining);
+            if (mState == State::MetaData)
+            {
+                mMetaData.append(reinterpret_cast<char const*>(data.data()), toTake);
+            }
+
+            data = data.subspan(toTake);
+            mRemaining -= toTake;
+
+            if (mRemaining == 0)
+            {
+                if (mState == State::MetaData)
+                {
+                    finishMetaData();
+                }
+                startPadding();
+            }
+            break;
+        }
+        case State::Padding:
+        {
+            size_t const toSkip = std::min(data.size(), mPadding);
+            data = data.subspan(toSkip);
+            mPadding -= toSkip;
+
+            if (mPadding == 0)
+            {
+                mState = State::Header;
+            }
+            break;
+        }
+        case State::End:
+            // Whatever follows the end-of-archive marker is of no interest.
+            return;
+        }
+    }
+}
+
+void
+TarExtractor::finish()
+{
+    if (mState != State::End && (mState != State::Header || mHeaderSize != 0))
+    {
+        throw std::runtime_error("The archive is truncated");
+    }
+
+    if (mCachedDirFd != -1)
+    {
+        close(mCachedDirFd);
+        mCachedDirFd = -1;
+    }
+
+    // Deeper directories first, so that making a parent read-only doesn't get in the way.
+    std::sort(mPendingDirs.begin(), mPendingDirs.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.path > rhs.path;
+    });
+
+    for (PendingDir const& dir : mPendingDirs)
+    {
+        int const fd = openDir(dir.path, false);
+        timespec const times[2] = {{dir.mtime, 0}, {dir.mtime, 0}};
+        bool const ok = fchmod(fd, dir.mode & 0777) == 0 && futimens(fd, times) == 0;
+        close(fd);
+
+        if (!ok)
+        {
+            throwErrno("Failed to set the attributes of " + dir.path);
+        }
+    }
+
+    // One sync for everything rather than one per file.
+    if (syncfs(mRootFd) == -1)
+    {
+        throwErrno("Failed to sync the extracted files");
+    }
+}
+
+void
+TarExtractor::processHeader()
+{
+    if (std::all_of(mHeader, mHeader + kBlockSize, [](uint8_t byte) { return byte == 0; }))
+    {
+        mState = State::End;
+        return;
+    }
+
+    if (!isChecksumValid(mHeader))
+    {
+        throw std::runtime_error("Corrupted tar header");
+    }
+
+    char const typeFlag = static_cast<char>(mHeader[156]);
+    uint32_t const mode = static_cast<uint32_t>(numericField(mHeader, 100, 8));
+    uint64_t size = numericField(mHeader, 124, 12);
+    int64_t mtime = static_cast<int64_t>(numericField(mHeader, 136, 12));
+
+    std::string path = stringField(mHeader, 0, 100);
+    std::string linkPath = stringField(mHeader, 157, 100);
+
+    if (stringField(mHeader, 257, 6) == "ustar")
+    {
+        std::string const prefix = stringField(mHeader, 345, 155);
+        if (!prefix.empty())
+        {
+            path = prefix + "/" + path;
+        }
+    }
+
+    bool const isMetaData =
+        typeFlag == 'L' || typeFlag == 'K' || typeFlag == 'x' || typeFlag == 'g';
+
+    if (isMetaData)
+    {
+        if (size > kMaxMetaDataSize)
+        {
+            throw std::runtime_error("Oversized tar metadata entry");
+        }
+
+        mMetaDataType = typeFlag;
+        mMetaData.clear();
+        mRemaining = size;
+        mPadding = (kBlockSize - size % kBlockSize) % kBlockSize;
+        mState = State::MetaData;
+
+        if (size == 0)
+        {
+            finishMetaData();
+            startPadding();
+        }
+        return;
+    }
+
+    // Long names and pax headers apply to the entry that follows them.
+    if (!mNextPath.empty())
+    {
+        path = std::move(mNextPath);
+    }
+    if (!mNextLinkPath.empty())
+    {
+        linkPath = std::move(mNextLinkPath);
+    }
+    if (mNextSize >= 0)
+    {
+        size = static_cast<uint64_t>(mNextSize);
+    }
+    if (mNextMtime >= 0)
+    {
+        mtime = mNextMtime;
+    }
+    mNextPath.clear();
+    mNextLinkPath.clear();
+    mNextSize = -1;
+    mNextMtime = -1;
+
+    mRemaining = size;
+    mPadding = (kBlockSize - size % kBlockSize) % kBlockSize;
+    mState = State::SkippedData;
+
+    std::string const relPath = sanitizePath(path);
+
+    switch (typeFlag)
+    {
+    case '0':
+    case '\0':
+    case '7': // Contiguous file, which is a regular file for all practical purposes.
+    {
+        mFilePath = relPath;
+        mFileSize = size;
+        mHashingFile = mStore && size > 0;
+        mBufferingFile = mHashingFile && size <= kMaxBufferedFileSize;
+
+        if (mHashingFile)
+        {
+            mFileHasher = Sha256();
+        }
+
+        if (mBufferingFile)
+        {
+            // Held back until it's known whether the store already has these contents.
+            mFileBuffer.clear();
+            mFileBuffer.reserve(size);
+        }
+        else
+        {
+            createFile(relPath, size);
+        }
+
+        mFileMode = mode;
+        mFileMtime = mtime;
+        ++mStats.numFiles;
+
+        mState = State::FileData;
+        if (size == 0)
+        {
+            finishFile();
+            startPadding();
+        }
+        return;
+    }
+    case '1':
+    {
+        std::string const relTarget = sanitizePath(linkPath);
+        if (relTarget.empty())
+        {
+            throw std::runtime_error("A hard link without a target in the archive: " + relPath);
+        }
+
+        // Resolving the target relative to the root would follow any symlink the archive
+        // has put on the way, letting the link reach files outside the extraction directory.
+        // openDir() refuses to follow them.
+        size_t const targetSlash = relTarget.rfind('/');
+        std::string const targetName = relTarget.substr(targetSlash + 1);
+        int const targetDirFd = openDir(
+            targetSlash == std::string::npos ? std::string() : relTarget.substr(0, targetSlash),
+            false);
+
+        std::string name;
+        int const dirFd = parentDirFd(relPath, name);
+
+        bool ok = linkat(targetDirFd, targetName.c_str(), dirFd, name.c_str(), 0) == 0;
+        if (!ok && errno == EEXIST && unlinkat(dirFd, name.c_str(), 0) == 0)
+        {
+            ok = linkat(targetDirFd, targetName.c_str(), dirFd, name.c_str(), 0) == 0;
+        }
+
+        int const savedErrno = errno;
+        close(targetDirFd);
+
+        if (!ok)
+        {
+            errno = savedErrno;
+            throwErrno("Failed to create the hard link " + relPath);
+        }
+        ++mStats.numHardlinks;
+        break;
+    }
+    case '2':
+    {
+        std::string name;
+        int const dirFd = parentDirFd(relPath, name);
+
+        if (symlinkat(linkPath.c_str(), dirFd, name.c_str()) == -1)
+        {
+            if (errno != EEXIST || unlinkat(dirFd, name.c_str(), 0) == -1 ||
+                symlinkat(linkPath.c_str(), dirFd, name.c_str()) == -1)
+            {
+                throwErrno("Failed to create the symlink " + relPath);
+            }
+        }
+
+        timespec const times[2] = {{mtime, 0}, {mtime, 0}};
+        utimensat(dirFd, name.c_str(), times, AT_SYMLINK_NOFOLLOW);
+        ++mStats.numSymlinks;
+        break;
+    }
+    case '5':
+    {
+        if (!relPath.empty())
+        {
+            close(openDir(relPath, true));
+            mPendingDirs.push_back({relPath, mode, mtime});
+        }
+        ++mStats.numDirs;
+        break;
+    }
+    default:
+        // Device nodes, FIFOs and whatever else have no place in a Wine build.
+        ++mStats.numSkipped;
+        break;
+    }
+
+    if (mRemaining == 0)
+    {
+        startPadding();
+    }
+}
+
+void
+TarExtractor::finishMetaData()
+{
+    std::string_view const data = mMetaData;
+
+    switch (mMetaDataType)
+    {
+    case 'L':
+        mNextPath = data.substr(0, data.find('\0'));
+        break;
+    case 'K':
+        mNextLinkPath = data.substr(0, data.find('\0'));
+        break;
+    case 'x':
+        forEachPaxRecord(data, [this](std::string_view key, std::string_view value) {
+            if (key == "path")
+            {
+                mNextPath = value;
+            }
+            else if (key == "linkpath")
+            {
+                mNextLinkPath = value;
+            }
+            else if (key == "size")
+            {
+                mNextSize = parseDecimal(value);
+            }
+            else if (key == "mtime")
+            {
+                // Fractional seconds are dropped.
+                mNextMtime = parseDecimal(value);
+            }
+        });
+        break;
+    default:
+        // Global pax headers carry nothing we need.
+        break;
+    }
+
+    mMetaData.clear();
+}
+
+void
+TarExtractor::createFile(std::string const& path, uint64_t size)
+{
+    std::string name;
+    int const dirFd = parentDirFd(path, name);
+
+    // Whatever is already there gets replaced rather than written to. It may be a symlink
+    // or a hard link to a file outside the extraction directory, or an object of the store.
+    if (unlinkat(dirFd, name.c_str(), 0) == -1 && errno != ENOENT)
+    {
+        throwErrno("Failed to replace " + path);
+    }
+
+    int const flags = O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC;
+    mFileFd = openat(dirFd, name.c_str(), flags, 0600);
+    if (mFileFd == -1)
+    {
+        throwErrno("Failed to create " + path);
+    }
+
+    if (size > 0)
+    {
+        // Not every filesystem supports that, and that's fine.
+        fallocate(mFileFd, 0, 0, static_cast<off_t>(size));
+    }
+}
+
+void
+TarExtractor::writeToFile(std::span<uint8_t const> data)
+{
+    for (size_t written = 0; written < data.size();)
+    {
+        ssize_t const result = write(mFileFd, data.data() + written, data.size() - written);
+        if (result == -1 && errno != EINTR)
+        {
+            throwErrno("Failed to write " + mFilePath);
+        }
+        written += std::max<ssize_t>(result, 0);
+    }
+}
+
+void
+TarExtractor::finishFile()
+{
+    bool const executable = (mFileMode & S_IXUSR) != 0;
+    Sha256::Digest digest;
+
+    if (mHashingFile)
+    {
+        digest = mFileHasher.digest();
+
+        std::string name;
+        int const dirFd = parentDirFd(mFilePath, name);
+
+        if (mStore->materialize(digest, executable, dirFd, name))
+        {
+            if (mFileFd != -1)
+            {
+                // Too big to have been held back, so it's been written for nothing.
+                close(mFileFd);
+                mFileFd = -1;
+            }
+
+            mHashingFile = false;
+            mBufferingFile = false;
+            mFileBuffer.clear();
+            ++mStats.numFilesFromStore;
+            mStats.numBytesFromStore += mFileSize;
+            return;
+        }
+    }
+
+    if (mBufferingFile)
+    {
+        createFile(mFilePath, mFileSize);
+        writeToFile(mFileBuffer);
+        mBufferingFile = false;
+        mFileBuffer.clear();
+    }
+
+    timespec const times[2] = {{mFileMtime, 0}, {mFileMtime, 0}};
+    bool const ok = fchmod(mFileFd, mFileMode & 0777) == 0 && futimens(mFileFd, times) == 0;
+    int const savedErrno = errno;
+
+    close(mFileFd);
+    mFileFd = -1;
+
+    if (!ok)
+    {
+        errno = savedErrno;
+        throwErrno("Failed to set the attributes of " + mFilePath);
+    }
+
+    if (mHashingFile)
+    {
+        mHashingFile = false;
+
+        std::string name;
+        int const dirFd = parentDirFd(mFilePath, name);
+        mStore->addFile(digest, executable, dirFd, name);
+    }
+}
+
+void
+TarExtractor::startPadding()
+{
+    mState = mPadding ? State::Padding : State::Header;
+}
+
+int
+TarExtractor::parentDirFd(std::string const& path, std::string& name)
+{
+    if (path.empty())
+    {
+        throw std::runtime_error("An entry without a name in the archive");
+    }
+
+    size_t const slash = path.rfind('/');
+    std::string const dirPath = slash == std::string::npos ? std::string() : path.substr(0, slash);
+    name = path.substr(slash + 1);
+
+    if (mCachedDirFd == -1 || dirPath != mCachedDirPath)
+    {
+        if (mCachedDirFd != -1)
+        {
+            close(mCachedDirFd);
+            mCachedDirFd = -1;
+        }
+        mCachedDirFd = openDir(dirPath, true);
+        mCachedDirPath = dirPath;
+    }
+
+    return mCachedDirFd;
+}
+
+int
+TarExtractor::openDir(std::string const& path, bool create)
+{
+    int fd = fcntl(mRootFd, F_DUPFD_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        throwErrno("Failed to duplicate a file descriptor");
+    }
+
+    std::string_view rest = path;
+    while (!rest.empty())
+    {
+        size_t const slash = rest.find('/');
+        std::string const component(rest.substr(0, slash));
+        rest.remove_prefix(slash == std::string_view::npos ? rest.size() : slash + 1);
+
+        int const flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+        int childFd = openat(fd, component.c_str(), flags);
+        if (childFd == -1 && errno == ENOENT && create)
+        {
+            // Owner access is needed to extract into it. The archived mode is applied later.
+            if (mkdirat(fd, component.c_str(), 0755) == -1 && errno != EEXIST)
+            {
+                int const savedErrno = errno;
+                close(fd);
+                errno = savedErrno;
+                throwErrno("Failed to create the directory " + path);
+            }
+            childFd = openat(fd, component.c_str(), flags);
+        }
+
+        int const savedErrno = errno;
+        close(fd);
+
+        if (childFd == -1)
+        {
+            errno = savedErrno;
+            throwErrno("Failed to open the directory " + path);
+        }
+        fd = childFd;
+    }
+
+    return fd;
+}
@@ -0,0 +1,157 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Sha256.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+struct TarExtractionStats
+{
+    size_t numFiles = 0;
+    size_t numDirs = 0;
+    size_t numSymlinks = 0;
+    size_t numHardlinks = 0;
+
+    /** Entry types we don't extract, like device nodes. */
+    size_t numSkipped = 0;
+
+    uint64_t numBytes = 0;
+
+    /** Files linked from a ContentStore rather than written out. */
+    size_t numFilesFromStore = 0;
+    uint64_t numBytesFromStore = 0;
+};
+
+class ContentStore;
+
+/**
+ * Extracts a tar stream (ustar, with GNU long names and pax headers) fed to it in chunks
+ * of any size, so that it can sit at the end of a decompression pipeline without the stream
+ * ever being buffered in full.
+ *
+ * Files are preallocated and written straight from the fed chunks. Modes and modification
+ * times of regular files are set through their open descriptors, while those of directories
+ * are applied by finish(), as extracting into a directory would change its modification time.
+ * Rather than syncing every file, finish() syncs the whole filesystem once.
+ *
+ * Entries with absolute paths or ".." components are rejected, and no path component
+ * created by the archive is followed if it's a symbolic link.
+ *
+ * Given a ContentStore, regular files are hashed and become links to its objects. Files
+ * small enough are held in memory until their hash is known, so that the ones the store
+ * already has are never written out.
+ */
+class TarExtractor
+{
+public:
+    TarExtractor(TarExtractor const&) = delete;
+    TarExtractor& operator=(TarExtractor const&) = delete;
+
+    /**
+     * @param store Optional. Must outlive the extractor.
+     * @throw std::system_error If @p destDir can't be opened.
+     */
+    explicit TarExtractor(std::filesystem::path const& destDir, ContentStore* store = nullptr);
+
+    ~TarExtractor();
+
+    /**
+     * @throw std::runtime_error If the stream is malformed or contains unsafe paths.
+     * @throw std::system_error If writing fails.
+     */
+    void consume(std::span<uint8_t const> data);
+
+    /**
+     * @throw std::runtime_error If the stream ended prematurely.
+     * @throw std::system_error If applying the metadata or syncing fails.
+     */
+    void finish();
+
+    TarExtractionStats const& stats() const { return mStats; }
+
+private:
+    enum class State
+    {
+        Header,
+        FileData,
+        MetaData,
+        SkippedData,
+        Padding,
+        End,
+    };
+
+    struct PendingDir
+    {
+        std::string path;
+        uint32_t mode;
+        int64_t mtime;
+    };
+
+    void processHeader();
+    void finishMetaData();
+    void createFile(std::string const& path, uint64_t size);
+    void writeToFile(std::span<uint8_t const> data);
+    void finishFile();
+    void startPadding();
+    int parentDirFd(std::string const& path, std::string& name);
+    int openDir(std::string const& path, bool create);
+
+    int mRootFd = -1;
+    ContentStore* mStore = nullptr;
+    State mState = State::Header;
+
+    uint8_t mHeader[512];
+    size_t mHeaderSize = 0;
+
+    uint64_t mRemaining = 0;
+    size_t mPadding = 0;
+
+    char mMetaDataType = 0;
+    std::string mMetaData;
+
+    // Set by GNU long name and pax headers for the next entry.
+    std::string mNextPath;
+    std::string mNextLinkPath;
+    int64_t mNextSize = -1;
+    int64_t mNextMtime = -1;
+
+    std::string mFilePath;
+    int mFileFd = -1;
+    uint32_t mFileMode = 0;
+    int64_t mFileMtime = 0;
+    uint64_t mFileSize = 0;
+
+    // Only used with a store.
+    bool mHashingFile = false;
+    Sha256 mFileHasher;
+    bool mBufferingFile = false;
+    std::vector<uint8_t> mFileBuffer;
+
+    std::string mCachedDirPath;
+    int mCachedDirFd = -1;
+
+    std::vector<PendingDir> mPendingDirs;
+    TarExtractionStats mStats;
+};
@@ -0,0 +1,231 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TextEncoding.h"
+
+namespace
+{
+
+char32_t const kReplacementCharacter = 0xFFFD;
+
+// Code points for bytes 0x80 to 0x9F in Windows-1252. The rest of the code page
+// matches ISO-8859-1. Zeros mark undefined bytes.
+char16_t const kWindows1252HighControls[32] = {
+    0x20AC, 0x0000, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160,
+    0x2039, 0x0152, 0x0000, 0x017D, 0x0000, 0x0000, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022,
+    0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x0000, 0x017E, 0x0178};
+
+} // namespace
+
+void
+appendUtf8(std::string& out, char32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        out += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+std::string
+utf16ToUtf8(std::u16string_view str)
+{
+    std::string out;
+    out.reserve(str.size());
+
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        char32_t const unit = str[i];
+
+        if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < str.size())
+        {
+            char32_t const nextUnit = str[i + 1];
+            if (nextUnit >= 0xDC00 && nextUnit <= 0xDFFF)
+            {
+                appendUtf8(out, 0x10000 + ((unit - 0xD800) << 10) + (nextUnit - 0xDC00));
+                ++i;
+                continue;
+            }
+        }
+
+        if (unit >= 0xD800 && unit <= 0xDFFF)
+        {
+            appendUtf8(out, kReplacementCharacter);
+        }
+        else
+        {
+            appendUtf8(out, unit);
+        }
+    }
+
+    return out;
+}
+
+std::string
+utf16LeToUtf8(std::span<uint8_t const> bytes)
+{
+    std::u16string units(bytes.size() / 2, u'\0');
+
+    for (size_t i = 0; i < units.size(); ++i)
+    {
+        units[i] = static_cast<char16_t>(bytes[i * 2] | (bytes[i * 2 + 1] << 8));
+    }
+
+    return utf16ToUtf8(units);
+}
+
+std::u16string
+utf8ToUtf16(std::string_view str)
+{
+    std::u16string out;
+    out.reserve(str.size());
+
+    size_t i = 0;
+    while (i < str.size())
+    {
+        auto const lead = static_cast<unsigned char>(str[i]);
+
+        size_t numContinuationBytes = 0;
+        char32_t codePoint = 0;
+
+        if (lead < 0x80)
+        {
+            codePoint = lead;
+        }
+        else if ((lead & 0xE0) == 0xC0)
+        {
+            numContinuationBytes = 1;
+            codePoint = lead & 0x1F;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            numContinuationBytes = 2;
+            codePoint = lead & 0x0F;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            numContinuationBytes = 3;
+            codePoint = lead & 0x07;
+        }
+        else
+        {
+            out += static_cast<char16_t>(kReplacementCharacter);
+            ++i;
+            continue;
+        }
+
+        bool valid = i + numContinuationBytes < str.size();
+        for (size_t j = 1; valid && j <= numContinuationBytes; ++j)
+        {
+            auto const byte = static_cast<unsigned char>(str[i + j]);
+            valid = (byte & 0xC0) == 0x80;
+            codePoint = (codePoint << 6) | (byte & 0x3F);
+        }
+
+        if (!valid || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+        {
+            out += static_cast<char16_t>(kReplacementCharacter);
+            ++i;
+            continue;
+        }
+
+        if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            out += static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            out += static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        }
+        else
+        {
+            out += static_cast<char16_t>(codePoint);
+        }
+
+        i += numContinuationBytes + 1;
+    }
+
+    return out;
+}
+
+std::string
+ansiToUtf8(std::span<uint8_t const> bytes)
+{
+    std::string out;
+    out.reserve(bytes.size());
+
+    for (uint8_t const byte : bytes)
+    {
+        if (byte >= 0x80 && byte <= 0x9F)
+        {
+            char16_t const codePoint = kWindows1252HighControls[byte - 0x80];
+            appendUtf8(out, codePoint != 0 ? codePoint : kReplacementCharacter);
+        }
+        else
+        {
+            appendUtf8(out, byte);
+        }
+    }
+
+    return out;
+}
+
+std::span<uint8_t const>
+untilUtf16Terminator(std::span<uint8_t const> bytes)
+{
+    size_t const numUnits = bytes.size() / 2;
+
+    for (size_t i = 0; i < numUnits; ++i)
+    {
+        if (bytes[i * 2] == 0 && bytes[i * 2 + 1] == 0)
+        {
+            return bytes.first(i * 2);
+        }
+    }
+
+    return bytes.first(numUnits * 2);
+}
+
+std::span<uint8_t const>
+untilAnsiTerminator(std::span<uint8_t const> bytes)
+{
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        if (bytes[i] == 0)
+        {
+            return bytes.first(i);
+        }
+    }
+
+    return bytes;
+}
@@ -0,0 +1,66 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+/**
+ * Converts UTF-16LE bytes to UTF-8. Unpaired surrogates are replaced with U+FFFD.
+ * A trailing odd byte is ignored.
+ */
+std::string utf16LeToUtf8(std::span<uint8_t const> bytes);
+
+/**
+ * Converts UTF-16 code units to UTF-8. Unpaired surrogates are replaced with U+FFFD.
+ */
+std::string utf16ToUtf8(std::u16string_view str);
+
+/**
+ * Converts UTF-8 to UTF-16 code units. Malformed sequences are replaced with U+FFFD.
+ */
+std::u16string utf8ToUtf16(std::string_view str);
+
+/**
+ * Converts bytes in the Windows "ANSI" code page to UTF-8.
+ *
+ * We have no way of knowing which ANSI code page the file was written with, so we assume
+ * Windows-1252, which is what Wine uses for English locales. Undefined code points
+ * are replaced with U+FFFD.
+ */
+std::string ansiToUtf8(std::span<uint8_t const> bytes);
+
+/**
+ * Returns the prefix of @p bytes up to (but not including) the first 16-bit NUL character.
+ * If there is no terminator, the whole (even-sized) span is returned.
+ */
+std::span<uint8_t const> untilUtf16Terminator(std::span<uint8_t const> bytes);
+
+/**
+ * Returns the prefix of @p bytes up to (but not including) the first NUL byte.
+ * If there is no terminator, the whole span is returned.
+ */
+std::span<uint8_t const> untilAnsiTerminator(std::span<uint8_t const> bytes);
+
+/**
+ * Appends the UTF-8 encoding of @p codePoint to @p out.
+ */
+void appendUtf8(std::string& out, char32_t codePoint);
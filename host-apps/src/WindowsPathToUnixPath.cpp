@@ -0,0 +1,271 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WindowsPathToUnixPath.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+
+char
+asciiToLower(char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+bool
+equalsIgnoringAsciiCase(std::string_view a, std::string_view b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+        return asciiToLower(x) == asciiToLower(y);
+    });
+}
+
+/**
+ * Returns the name of the user's profile directory under drive_c/users.
+ *
+ * Wine names it after the Unix user, but the prefix might have been created by a
+ * different user, so we look at what's actually there.
+ */
+std::string
+userProfileName(std::filesystem::path const& winePrefixDir)
+{
+    auto const usersDir = winePrefixDir / "drive_c" / "users";
+    char const* unixUser = std::getenv("USER");
+
+    std::error_code ec;
+    if (unixUser && std::filesystem::is_directory(usersDir / unixUser, ec))
+    {
+        return unixUser;
+    }
+
+    for (auto const& entry : std::filesystem::directory_iterator(usersDir, ec))
+    {
+        std::string const name = entry.path().filename().string();
+        if (entry.is_directory(ec) && !equalsIgnoringAsciiCase(name, "Public"))
+        {
+            return name;
+        }
+    }
+
+    return unixUser ? unixUser : "user";
+}
+
+std::optional<std::string>
+envVarValue(std::filesystem::path const& winePrefixDir, std::string_view name)
+{
+    struct Variable
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // These are the values Wine sets up in a fresh prefix.
+    static Variable const kFixedVariables[] = {
+        {"SystemDrive", "C:"},
+        {"SystemRoot", "C:\\windows"},
+        {"windir", "C:\\windows"},
+        {"ProgramFiles", "C:\\Program Files"},
+        {"ProgramW6432", "C:\\Program Files"},
+        {"ProgramFiles(x86)", "C:\\Program Files (x86)"},
+        {"CommonProgramFiles", "C:\\Program Files\\Common Files"},
+        {"CommonProgramW6432", "C:\\Program Files\\Common Files"},
+        {"CommonProgramFiles(x86)", "C:\\Program Files (x86)\\Common Files"},
+        {"ProgramData", "C:\\ProgramData"},
+        {"ALLUSERSPROFILE", "C:\\ProgramData"},
+        {"PUBLIC", "C:\\users\\Public"},
+    };
+
+    for (auto const& variable : kFixedVariables)
+    {
+        if (equalsIgnoringAsciiCase(name, variable.name))
+        {
+            return std::string(variable.value);
+        }
+    }
+
+    struct UserVariable
+    {
+        std::string_view name;
+        std::string_view suffix;
+    };
+
+    static UserVariable const kUserVariables[] = {
+        {"USERPROFILE", ""},
+        {"APPDATA", "\\AppData\\Roaming"},
+        {"LOCALAPPDATA", "\\AppData\\Local"},
+        {"TEMP", "\\AppData\\Local\\Temp"},
+        {"TMP", "\\AppData\\Local\\Temp"},
+    };
+
+    for (auto const& variable : kUserVariables)
+    {
+        if (equalsIgnoringAsciiCase(name, variable.name))
+        {
+            return "C:\\users\\" + userProfileName(winePrefixDir) + std::string(variable.suffix);
+        }
+    }
+
+    if (equalsIgnoringAsciiCase(name, "USERNAME"))
+    {
+        return userProfileName(winePrefixDir);
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Finds a directory entry in @p dir matching @p name case-insensitively, preferring
+ * an exact match.
+ */
+std::string
+resolveComponentCase(std::filesystem::path const& dir, std::string const& name)
+{
+    std::error_code ec;
+    if (std::filesystem::exists(std::filesystem::symlink_status(dir / name, ec)))
+    {
+        return name;
+    }
+
+    for (auto const& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        std::string const entryName = entry.path().filename().string();
+        if (equalsIgnoringAsciiCase(entryName, name))
+        {
+            return entryName;
+        }
+    }
+
+    return name;
+}
+
+} // namespace
+
+std::string
+expandWindowsEnvVars(std::filesystem::path const& winePrefixDir, std::string_view path)
+{
+    std::string expanded;
+    expanded.reserve(path.size());
+
+    size_t pos = 0;
+    while (pos < path.size())
+    {
+        size_t const start = path.find('%', pos);
+        if (start == std::string_view::npos)
+        {
+            break;
+        }
+
+        size_t const end = path.find('%', start + 1);
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+
+        expanded.append(path.substr(pos, start - pos));
+
+        auto const name = path.substr(start + 1, end - start - 1);
+        if (auto value = envVarValue(winePrefixDir, name))
+        {
+            expanded += *value;
+            pos = end + 1;
+        }
+        else
+        {
+            // Keep the opening '%' and retry from the closing one, as it might
+            // start a valid reference.
+            expanded += '%';
+            expanded.append(name);
+            pos = end;
+        }
+    }
+
+    expanded.append(path.substr(pos));
+
+    return expanded;
+}
+
+std::optional<std::filesystem::path>
+windowsPathToUnixPath(std::filesystem::path const& winePrefixDir, std::string_view windowsPath)
+{
+    std::string path = expandWindowsEnvVars(winePrefixDir, windowsPath);
+    std::replace(path.begin(), path.end(), '/', '\\');
+
+    // Strip the \\?\ prefix of long paths.
+    std::string_view const kLongPathPrefix = "\\\\?\\";
+    if (path.starts_with(kLongPathPrefix))
+    {
+        path.erase(0, kLongPathPrefix.size());
+    }
+
+    if (path.size() < 2 || path[1] != ':' || !std::isalpha(static_cast<unsigned char>(path[0])))
+    {
+        return std::nullopt;
+    }
+
+    std::string const driveName = std::string(1, asciiToLower(path[0])) + ":";
+    std::filesystem::path unixPath = winePrefixDir / "dosdevices" / driveName;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(unixPath, ec))
+    {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> components;
+    size_t pos = 2;
+    while (pos <= path.size())
+    {
+        size_t end = path.find('\\', pos);
+        if (end == std::string::npos)
+        {
+            end = path.size();
+        }
+
+        std::string component = path.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (component.empty() || component == ".")
+        {
+            continue;
+        }
+        else if (component == "..")
+        {
+            if (!components.empty())
+            {
+                components.pop_back();
+            }
+        }
+        else
+        {
+            components.push_back(std::move(component));
+        }
+    }
+
+    for (auto const& component : components)
+    {
+        unixPath /= resolveComponentCase(unixPath, component);
+    }
+
+    return unixPath;
+}
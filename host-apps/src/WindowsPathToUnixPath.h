@@ -0,0 +1,47 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * Expands %VARIABLE% references in a Windows path, using the values Wine assigns
+ * to them in @p winePrefixDir. Variable names are case-insensitive. Unknown variables
+ * are left as is.
+ */
+std::string expandWindowsEnvVars(std::filesystem::path const& winePrefixDir, std::string_view path);
+
+/**
+ * Maps a Windows path like "C:\Program Files\App\app.exe" to a path in the filesystem
+ * of the host, going through the prefix's dosdevices symlinks.
+ *
+ * Windows paths are case-insensitive while the host's ones are not, so every path
+ * component is matched case-insensitively against the existing directory entries.
+ * Components that don't exist are kept as they are.
+ *
+ * Environment variables in @p windowsPath are expanded first.
+ *
+ * @return std::nullopt if the path is not an absolute drive-letter path or if there is
+ *         no such drive in the prefix.
+ */
+std::optional<std::filesystem::path>
+windowsPathToUnixPath(std::filesystem::path const& winePrefixDir, std::string_view windowsPath);
@@ -0,0 +1,103 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "WineserverLock.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ * Creates a directory only accessible by us, unless it exists already. wineserver refuses
+ * to use its directories if they are accessible by other users.
+ */
+void
+createPrivateDir(std::string const& dirPath)
+{
+    if (mkdir(dirPath.c_str(), 0700) == -1 && errno != EEXIST)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to create " + dirPath);
+    }
+}
+
+} // namespace
+
+WineserverLock::WineserverLock(std::filesystem::path const& winePrefixDir)
+{
+    struct stat st;
+    if (stat(winePrefixDir.c_str(), &st) == -1)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Failed to stat " + winePrefixDir.string());
+    }
+
+    char serverDirPath[128];
+    snprintf(
+        serverDirPath, sizeof(serverDirPath), "/tmp/.wine-%u/server-%llx-%llx",
+        static_cast<unsigned>(getuid()), static_cast<unsigned long long>(st.st_dev),
+        static_cast<unsigned long long>(st.st_ino));
+
+    std::string const serverDir = serverDirPath;
+    createPrivateDir(serverDir.substr(0, serverDir.rfind('/')));
+    createPrivateDir(serverDir);
+
+    std::string const lockFilePath = serverDir + "/lock";
+
+    int const fd = open(lockFilePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open " + lockFilePath);
+    }
+
+    struct flock lock = {};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+
+    if (fcntl(fd, F_SETLK, &lock) == -1)
+    {
+        int const savedErrno = errno;
+        close(fd);
+
+        if (savedErrno == EACCES || savedErrno == EAGAIN)
+        {
+            // A wineserver is holding it.
+            return;
+        }
+
+        throw std::system_error(
+            savedErrno, std::generic_category(), "Failed to lock " + lockFilePath);
+    }
+
+    mFd = fd;
+}
+
+WineserverLock::~WineserverLock()
+{
+    if (mFd != -1)
+    {
+        // Closing the file releases the lock.
+        close(mFd);
+    }
+}
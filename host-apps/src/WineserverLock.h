@@ -0,0 +1,64 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <filesystem>
+
+/**
+ * Keeps a wineserver from starting in a prefix for as long as the object is alive,
+ * so that files wineserver would otherwise overwrite, like the registry hives, can be
+ * rewritten safely.
+ *
+ * wineserver keeps its socket and a lock file in /tmp/.wine-<uid>/server-<dev>-<inode>,
+ * where dev and inode identify the prefix directory, and holds an fcntl() write lock
+ * on the lock file for as long as it runs. We take the same lock. A wineserver started
+ * while we hold it exits right away, and Wine waits for the lock to be released before
+ * starting another one.
+ *
+ * Note that a wineserver running inside a muvm virtual machine has its own /tmp
+ * and can't be detected or held off this way.
+ */
+class WineserverLock
+{
+public:
+    WineserverLock(WineserverLock const&) = delete;
+    WineserverLock& operator=(WineserverLock const&) = delete;
+
+    /**
+     * Tries to take the lock, creating the lock file and the directories leading to it
+     * if they don't exist yet, the same way wineserver does.
+     *
+     * @throw std::system_error If the prefix directory doesn't exist or the lock file can't
+     *        be created or locked for reasons other than a wineserver holding it.
+     */
+    explicit WineserverLock(std::filesystem::path const& winePrefixDir);
+
+    /**
+     * Releases the lock, if it was taken.
+     */
+    ~WineserverLock();
+
+    /**
+     * Returns false if a wineserver is running in the prefix, in which case the lock
+     * was not taken.
+     */
+    bool acquired() const { return mFd != -1; }
+
+private:
+    int mFd = -1;
+};
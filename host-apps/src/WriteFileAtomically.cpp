@@ -0,0 +1,92 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WriteFileAtomically.h"
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+[[noreturn]] void
+throwErrno(std::string const& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+void
+writeFileAtomically(std::filesystem::path const& filePath, std::string_view contents)
+{
+    std::string tempPath = filePath.string() + ".XXXXXX";
+
+    int const fd = mkstemp(tempPath.data());
+    if (fd == -1)
+    {
+        throwErrno("Failed to create a temporary file next to " + filePath.string());
+    }
+
+    try
+    {
+        struct stat st;
+        if (stat(filePath.c_str(), &st) == 0 && fchmod(fd, st.st_mode & 07777) == -1)
+        {
+            throwErrno("Failed to set permissions on " + tempPath);
+        }
+
+        while (!contents.empty())
+        {
+            ssize_t const written = write(fd, contents.data(), contents.size());
+            if (written == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throwErrno("Failed to write " + tempPath);
+            }
+            contents.remove_prefix(static_cast<size_t>(written));
+        }
+
+        if (fsync(fd) == -1)
+        {
+            throwErrno("Failed to flush " + tempPath);
+        }
+    }
+    catch (...)
+    {
+        close(fd);
+        unlink(tempPath.c_str());
+        throw;
+    }
+
+    if (close(fd) == -1 || rename(tempPath.c_str(), filePath.c_str()) == -1)
+    {
+        int const savedErrno = errno;
+        unlink(tempPath.c_str());
+        errno = savedErrno;
+        throwErrno("Failed to replace " + filePath.string());
+    }
+}
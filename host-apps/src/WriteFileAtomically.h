@@ -0,0 +1,32 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+/**
+ * Replaces the contents of a file in a way that never leaves it partially written.
+ *
+ * The new contents go to a temporary file in the same directory, which gets the permissions
+ * of the file being replaced (if it exists), is fsync()'ed and then renamed over the original.
+ *
+ * @throw std::system_error On failure, in which case the original file is left untouched.
+ */
+void writeFileAtomically(std::filesystem::path const& filePath, std::string_view contents);
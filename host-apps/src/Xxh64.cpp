@@ -0,0 +1,228 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Xxh64.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// See https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md for the algorithm.
+
+namespace
+{
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+uint64_t
+rotl(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t
+read64(uint8_t const* p)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+uint32_t
+read32(uint8_t const* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t
+round(uint64_t acc, uint64_t lane)
+{
+    acc += lane * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+uint64_t
+mergeAccumulator(uint64_t acc, uint64_t accN)
+{
+    acc ^= round(0, accN);
+    return acc * kPrime1 + kPrime4;
+}
+
+} // namespace
+
+Xxh64::Xxh64(uint64_t seed) : mSeed(seed)
+{
+    mAcc[0] = seed + kPrime1 + kPrime2;
+    mAcc[1] = seed + kPrime2;
+    mAcc[2] = seed;
+    mAcc[3] = seed - kPrime1;
+}
+
+void
+Xxh64::update(std::span<uint8_t const> data)
+{
+    mTotalLength += data.size();
+
+    uint8_t const* p = data.data();
+    uint8_t const* const end = p + data.size();
+
+    if (mBufferSize + data.size() < sizeof(mBuffer))
+    {
+        memcpy(mBuffer + mBufferSize, p, data.size());
+        mBufferSize += data.size();
+        return;
+    }
+
+    if (mBufferSize > 0)
+    {
+        size_t const toFill = sizeof(mBuffer) - mBufferSize;
+        memcpy(mBuffer + mBufferSize, p, toFill);
+        p += toFill;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            mAcc[i] = round(mAcc[i], read64(mBuffer + i * 8));
+        }
+        mBufferSize = 0;
+    }
+
+    for (; end - p >= 32; p += 32)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            mAcc[i] = round(mAcc[i], read64(p + i * 8));
+        }
+    }
+
+    mBufferSize = static_cast<size_t>(end - p);
+    memcpy(mBuffer, p, mBufferSize);
+}
+
+uint64_t
+Xxh64::digest() const
+{
+    uint64_t acc;
+
+    if (mTotalLength >= 32)
+    {
+        acc = rotl(mAcc[0], 1) + rotl(mAcc[1], 7) + rotl(mAcc[2], 12) + rotl(mAcc[3], 18);
+        for (int i = 0; i < 4; ++i)
+        {
+            acc = mergeAccumulator(acc, mAcc[i]);
+        }
+    }
+    else
+    {
+        acc = mSeed + kPrime5;
+    }
+
+    acc += mTotalLength;
+
+    uint8_t const* p = mBuffer;
+    uint8_t const* const end = mBuffer + mBufferSize;
+
+    for (; end - p >= 8; p += 8)
+    {
+        acc ^= round(0, read64(p));
+        acc = rotl(acc, 27) * kPrime1 + kPrime4;
+    }
+
+    if (end - p >= 4)
+    {
+        acc ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        acc = rotl(acc, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+    {
+        acc ^= *p * kPrime5;
+        acc = rotl(acc, 11) * kPrime1;
+    }
+
+    acc ^= acc >> 33;
+    acc *= kPrime2;
+    acc ^= acc >> 29;
+    acc *= kPrime3;
+    acc ^= acc >> 32;
+
+    return acc;
+}
+
+uint64_t
+xxh64(std::span<uint8_t const> data, uint64_t seed)
+{
+    Xxh64 hasher(seed);
+    hasher.update(data);
+    return hasher.digest();
+}
+
+uint64_t
+xxh64File(std::filesystem::path const& filePath)
+{
+    int const fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Failed to open " + filePath.string());
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    Xxh64 hasher;
+    std::vector<uint8_t> buffer(1 << 20);
+
+    for (;;)
+    {
+        ssize_t const numRead = read(fd, buffer.data(), buffer.size());
+        if (numRead == 0)
+        {
+            break;
+        }
+        else if (numRead == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            int const savedErrno = errno;
+            close(fd);
+            throw std::system_error(
+                savedErrno, std::generic_category(), "Failed to read " + filePath.string());
+        }
+
+        hasher.update({buffer.data(), static_cast<size_t>(numRead)});
+    }
+
+    close(fd);
+    return hasher.digest();
+}
@@ -0,0 +1,59 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+/**
+ * An incremental implementation of the XXH64 hash function.
+ *
+ * XXH64 is not a cryptographic hash. We use it to tell whether two files we already
+ * suspect of being equal actually are.
+ */
+class Xxh64
+{
+public:
+    explicit Xxh64(uint64_t seed = 0);
+
+    void update(std::span<uint8_t const> data);
+
+    uint64_t digest() const;
+
+private:
+    uint64_t mAcc[4];
+    uint64_t mSeed;
+    uint64_t mTotalLength = 0;
+    uint8_t mBuffer[32];
+    size_t mBufferSize = 0;
+};
+
+/**
+ * Hashes a buffer in one go.
+ */
+uint64_t xxh64(std::span<uint8_t const> data, uint64_t seed = 0);
+
+/**
+ * Hashes the contents of a file.
+ *
+ * @throw std::system_error If the file can't be read.
+ */
+uint64_t xxh64File(std::filesystem::path const& filePath);
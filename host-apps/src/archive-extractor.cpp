@@ -0,0 +1,376 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ContentStore.h"
+#include "EscapeAndQuoteJsonString.h"
+#include "Sha256.h"
+#include "StreamDecompressor.h"
+#include "TarExtractor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+size_t const kReadChunkSize = 1024 * 1024;
+
+/**
+ * The number of chunks a pipeline stage may get ahead of the next one.
+ */
+size_t const kQueueCapacity = 16;
+
+using Chunk = std::vector<uint8_t>;
+
+/**
+ * Connects two pipeline stages running in different threads.
+ */
+class ChunkQueue
+{
+public:
+    /**
+     * Blocks while the queue is full. Returns false if the queue was aborted.
+     */
+    bool push(Chunk chunk)
+    {
+        std::unique_lock lock(mMutex);
+        mNotFull.wait(lock, [this] { return mAborted || mChunks.size() < kQueueCapacity; });
+        if (mAborted)
+        {
+            return false;
+        }
+        mChunks.push_back(std::move(chunk));
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * Blocks while the queue is empty. Returns std::nullopt once the queue is closed
+     * and drained, or if it was aborted.
+     */
+    std::optional<Chunk> pop()
+    {
+        std::unique_lock lock(mMutex);
+        mNotEmpty.wait(lock, [this] { return mAborted || mClosed || !mChunks.empty(); });
+        if (mAborted || mChunks.empty())
+        {
+            return std::nullopt;
+        }
+        Chunk chunk = std::move(mChunks.front());
+        mChunks.pop_front();
+        mNotFull.notify_one();
+        return chunk;
+    }
+
+    /**
+     * Signals that nothing more is going to be pushed.
+     */
+    void close()
+    {
+        std::lock_guard lock(mMutex);
+        mClosed = true;
+        mNotEmpty.notify_all();
+    }
+
+    /**
+     * Unblocks both sides, discarding whatever is queued.
+     */
+    void abort()
+    {
+        std::lock_guard lock(mMutex);
+        mAborted = true;
+        mNotEmpty.notify_all();
+        mNotFull.notify_all();
+    }
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::deque<Chunk> mChunks;
+    bool mClosed = false;
+    bool mAborted = false;
+};
+
+class Pipeline
+{
+public:
+    void run(std::filesystem::path const& destDir, ContentStore* store)
+    {
+        std::thread reader([this] { guarded([this] { readInput(); }); });
+        std::thread decompressor([this] { guarded([this] { decompress(); }); });
+
+        TarExtractor extractor(destDir, store);
+        guarded([&] {
+            while (std::optional<Chunk> const chunk = mDecompressedQueue.pop())
+            {
+                extractor.consume(*chunk);
+            }
+        });
+
+        reader.join();
+        decompressor.join();
+
+        if (mError)
+        {
+            std::rethrow_exception(mError);
+        }
+
+        extractor.finish();
+        mExtractionStats = extractor.stats();
+    }
+
+    CompressionFormat format() const { return mFormat; }
+
+    uint64_t numCompressedBytes() const { return mNumCompressedBytes; }
+
+    Sha256::Digest const& digest() const { return mDigest; }
+
+    TarExtractionStats const& extractionStats() const { return mExtractionStats; }
+
+private:
+    /**
+     * Runs a pipeline stage, stopping the whole pipeline if it fails.
+     */
+    template <typename Stage>
+    void guarded(Stage const& stage)
+    {
+        try
+        {
+            stage();
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mErrorMutex);
+            if (!mError)
+            {
+                mError = std::current_exception();
+            }
+            mCompressedQueue.abort();
+            mDecompressedQueue.abort();
+        }
+    }
+
+    /**
+     * Reads the compressed stream from stdin, hashing it along the way.
+     */
+    void readInput()
+    {
+        Sha256 hasher;
+        bool eof = false;
+
+        while (!eof)
+        {
+            Chunk chunk(kReadChunkSize);
+            size_t size = 0;
+
+            // Format detection needs the magic bytes to be in the first chunk.
+            size_t const minSize = mNumCompressedBytes == 0 ? 6 : 1;
+            while (size < minSize)
+            {
+                ssize_t const result = read(STDIN_FILENO, chunk.data() + size, chunk.size() - size);
+                if (result == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                else if (result == -1)
+                {
+                    throw std::system_error(errno, std::generic_category(), "Failed to read stdin");
+                }
+                else if (result == 0)
+                {
+                    eof = true;
+                    break;
+                }
+                size += static_cast<size_t>(result);
+            }
+
+            if (size == 0)
+            {
+                break;
+            }
+
+            chunk.resize(size);
+            hasher.update(chunk);
+            mNumCompressedBytes += size;
+
+            if (!mCompressedQueue.push(std::move(chunk)))
+            {
+                return;
+            }
+        }
+
+        mDigest = hasher.digest();
+        mCompressedQueue.close();
+    }
+
+    void decompress()
+    {
+        std::optional<Chunk> pending = mCompressedQueue.pop();
+        if (!pending)
+        {
+            throw std::runtime_error("The archive is empty");
+        }
+
+        mFormat = detectCompressionFormat(*pending);
+        size_t pendingOffset = 0;
+
+        auto source = [&](std::span<uint8_t> buffer) -> size_t {
+            if (pending && pendingOffset == pending->size())
+            {
+                pending = mCompressedQueue.pop();
+                pendingOffset = 0;
+            }
+            if (!pending)
+            {
+                return 0;
+            }
+
+            size_t const size = std::min(buffer.size(), pending->size() - pendingOffset);
+            std::copy_n(pending->begin() + pendingOffset, size, buffer.begin());
+            pendingOffset += size;
+            return size;
+        };
+
+        auto sink = [this](std::span<uint8_t const> data) {
+            if (!data.empty() && !mDecompressedQueue.push(Chunk(data.begin(), data.end())))
+            {
+                throw std::runtime_error("Extraction was aborted");
+            }
+        };
+
+        decompressStream(mFormat, std::thread::hardware_concurrency(), source, sink);
+        mDecompressedQueue.close();
+    }
+
+    ChunkQueue mCompressedQueue;
+    ChunkQueue mDecompressedQueue;
+
+    std::mutex mErrorMutex;
+    std::exception_ptr mError;
+
+    CompressionFormat mFormat = CompressionFormat::None;
+    uint64_t mNumCompressedBytes = 0;
+    Sha256::Digest mDigest = {};
+    TarExtractionStats mExtractionStats;
+};
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [--store <store_dir>] <dest_dir>\n"
+        "\n"
+        "Extracts a tar archive, compressed with gzip, bzip2, xz or zstd, or not at all,\n"
+        "read from stdin. Prints the SHA-256 of the stream it read and extraction stats.\n"
+        "\n"
+        "  --store  Make the extracted files hard links into a content-addressed store,\n"
+        "           only writing out what the store doesn't have yet. The store must be\n"
+        "           on the same filesystem as the destination, or it's not used.\n",
+        programName);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program replaces "tar -x" for installing Wine builds while they are being downloaded.
+    // Reading, decompression and writing to disk happen in separate threads, so that
+    // the slowest of them sets the pace rather than the sum of all three.
+
+    char const* storeDir = nullptr;
+    int argIdx = 1;
+
+    if (argIdx + 1 < argc && strcmp(argv[argIdx], "--store") == 0)
+    {
+        storeDir = argv[argIdx + 1];
+        argIdx += 2;
+    }
+
+    if (argc - argIdx != 1)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path const destDir = argv[argIdx];
+
+    try
+    {
+        std::optional<ContentStoreLock> storeLock;
+        std::optional<ContentStore> store;
+        if (storeDir)
+        {
+            // Waits for wine-build-store to finish ingesting or collecting garbage.
+            storeLock.emplace(storeDir, ContentStoreLock::Mode::Extraction);
+            store.emplace(storeDir);
+
+            struct stat storeStatus;
+            struct stat destStatus;
+            if (fstat(store->objectsDirFd(), &storeStatus) == -1 ||
+                stat(destDir.c_str(), &destStatus) == -1 ||
+                storeStatus.st_dev != destStatus.st_dev)
+            {
+                // Hard links can't cross filesystems.
+                fprintf(stderr, "Not using the store at %s\n", storeDir);
+                store.reset();
+                storeLock.reset();
+            }
+        }
+
+        Pipeline pipeline;
+        pipeline.run(destDir, store ? &*store : nullptr);
+
+        TarExtractionStats const& stats = pipeline.extractionStats();
+
+        std::cout << "{\"format\": "
+                  << escapeAndQuoteJsonString(compressionFormatName(pipeline.format()))
+                  << ", \"sha256\": " << escapeAndQuoteJsonString(toHexString(pipeline.digest()))
+                  << ", \"compressedBytes\": " << pipeline.numCompressedBytes()
+                  << ", \"files\": " << stats.numFiles << ", \"dirs\": " << stats.numDirs
+                  << ", \"symlinks\": " << stats.numSymlinks
+                  << ", \"hardlinks\": " << stats.numHardlinks
+                  << ", \"skipped\": " << stats.numSkipped << ", \"bytes\": " << stats.numBytes
+                  << ", \"filesFromStore\": " << stats.numFilesFromStore
+                  << ", \"bytesFromStore\": " << stats.numBytesFromStore << "}" << std::endl;
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
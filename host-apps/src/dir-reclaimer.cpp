@@ -0,0 +1,122 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DirReclaimer.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <future>
+#include <iostream>
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+// From linux/ioprio.h, which older kernel headers don't have.
+int const kIoprioWhoProcess = 1;
+int const kIoprioClassIdle = 3;
+int const kIoprioClassShift = 13;
+
+/**
+ * Makes this process, and the threads it's going to start, only use the CPU and the disk
+ * when nothing else wants them.
+ */
+void
+becomeIdlePriority()
+{
+    sched_param const param = {};
+    if (sched_setscheduler(0, SCHED_IDLE, &param) == -1)
+    {
+        perror("sched_setscheduler");
+    }
+
+    if (syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift) == -1)
+    {
+        perror("ioprio_set");
+    }
+}
+
+void
+printProgress(DirReclaimProgress const& progress, bool done)
+{
+    std::cout << "{\"files\": " << progress.numFiles << ", \"dirs\": " << progress.numDirs
+              << ", \"errors\": " << progress.numErrors
+              << ", \"done\": " << (done ? "true" : "false") << "}" << std::endl;
+}
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s <dir>\n"
+        "\n"
+        "Removes everything inside the given directory at idle CPU and I/O priority,\n"
+        "printing progress as JSON lines.\n",
+        programName);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // The app moves directories it wants gone into a trash directory, which is instant,
+    // and has this program empty it in the background, so that startup doesn't wait
+    // for thousands of leftover temporary directories to be removed.
+
+    if (argc != 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // We may outlive the app, and with it, whoever reads our output.
+    signal(SIGPIPE, SIG_IGN);
+
+    becomeIdlePriority();
+
+    try
+    {
+        DirReclaimProgress progress;
+
+        auto removal = std::async(std::launch::async, [&] {
+            removeDirContents(argv[1], 0, progress);
+        });
+
+        while (removal.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+        {
+            printProgress(progress, false);
+        }
+
+        removal.get();
+        printProgress(progress, true);
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
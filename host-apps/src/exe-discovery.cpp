@@ -0,0 +1,141 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EscapeAndQuoteJsonString.h"
+#include "ExeDiscovery.h"
+#include "WriteFileAtomically.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [--icons-dir <dir>] <drive_c_dir> [<extra_dir>...]\n"
+        "\n"
+        "Looks for executables worth pinning under the Program Files directories of\n"
+        "<drive_c_dir> and under any extra directories, printing them as JSON, the most\n"
+        "likely ones first. With --icons-dir, their icons are written there as PNG or BMP\n"
+        "files.\n",
+        programName);
+}
+
+std::string
+optionalJsonString(std::string const& str)
+{
+    return str.empty() ? "null" : escapeAndQuoteJsonString(str);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program suggests executables to pin after something has been installed
+    // into a prefix, so that the user doesn't have to go looking for them.
+
+    fs::path iconsDir;
+
+    int argIdx = 1;
+    if (argc > 2 && strcmp(argv[1], "--icons-dir") == 0)
+    {
+        iconsDir = argv[2];
+        argIdx = 3;
+    }
+
+    if (argIdx >= argc)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::vector<fs::path> roots = programFilesDirs(argv[argIdx]);
+        for (++argIdx; argIdx < argc; ++argIdx)
+        {
+            roots.push_back(argv[argIdx]);
+        }
+
+        ExeDiscoveryOptions options;
+        options.extractIcons = !iconsDir.empty();
+
+        std::vector<ExeCandidate> const candidates =
+            roots.empty() ? std::vector<ExeCandidate>() : discoverExecutables(roots, options);
+
+        if (!iconsDir.empty())
+        {
+            fs::create_directories(iconsDir);
+        }
+
+        std::cout << "[";
+
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            ExeCandidate const& candidate = candidates[i];
+
+            std::string iconPath;
+            if (candidate.icon)
+            {
+                iconPath = iconsDir / (std::to_string(i) + "." + candidate.icon->format);
+                writeFileAtomically(
+                    iconPath,
+                    std::string_view(
+                        reinterpret_cast<char const*>(candidate.icon->data.data()),
+                        candidate.icon->data.size()));
+            }
+
+            auto versionString = [&candidate](std::string const& key) {
+                auto const it = candidate.versionStrings.find(key);
+                return optionalJsonString(
+                    it == candidate.versionStrings.end() ? std::string() : it->second);
+            };
+
+            std::cout << (i ? ",\n  " : "\n  ")
+                      << "{\"path\": " << escapeAndQuoteJsonString(candidate.path.string())
+                      << ", \"label\": " << escapeAndQuoteJsonString(candidate.label())
+                      << ", \"productName\": " << versionString("ProductName")
+                      << ", \"companyName\": " << versionString("CompanyName")
+                      << ", \"is64Bit\": " << (candidate.is64Bit ? "true" : "false")
+                      << ", \"size\": " << candidate.size << ", \"score\": " << candidate.score
+                      << ", \"icon\": " << optionalJsonString(iconPath) << "}";
+        }
+
+        std::cout << "\n]" << std::endl;
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EscapeAndQuoteJsonString.h"
+#include "LnkFile.h"
+#include "WindowsPathToUnixPath.h"
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+
+namespace
+{
+
+std::string
+jsonStringOrNull(std::optional<std::string> const& value)
+{
+    return value ? escapeAndQuoteJsonString(*value) : "null";
+}
+
+std::optional<std::string>
+unixPathString(std::filesystem::path const& winePrefixDir, std::optional<std::string> const& path)
+{
+    if (!path)
+    {
+        return std::nullopt;
+    }
+
+    auto const unixPath = windowsPathToUnixPath(winePrefixDir, *path);
+    if (!unixPath)
+    {
+        return std::nullopt;
+    }
+
+    return unixPath->string();
+}
+
+std::string
+resolveLnkFileToJson(
+    std::filesystem::path const& winePrefixDir, std::filesystem::path const& lnkFilePath)
+{
+    std::string json = "{\"lnkFile\": " + escapeAndQuoteJsonString(lnkFilePath.string());
+
+    try
+    {
+        LnkFile const lnk = readLnkFile(lnkFilePath);
+
+        std::optional<std::string> windowsTargetPath = lnk.targetPath();
+        if (windowsTargetPath)
+        {
+            windowsTargetPath = expandWindowsEnvVars(winePrefixDir, *windowsTargetPath);
+        }
+
+        std::optional<std::string> windowsIconPath = lnk.effectiveIconLocation();
+        if (windowsIconPath)
+        {
+            windowsIconPath = expandWindowsEnvVars(winePrefixDir, *windowsIconPath);
+        }
+
+        json += ", \"label\": " + escapeAndQuoteJsonString(lnkFilePath.stem().string());
+        json += ", \"description\": " + jsonStringOrNull(lnk.description);
+        json += ", \"windowsTargetPath\": " + jsonStringOrNull(windowsTargetPath);
+        json += ", \"unixTargetPath\": " +
+                jsonStringOrNull(unixPathString(winePrefixDir, windowsTargetPath));
+        json += ", \"arguments\": " + jsonStringOrNull(lnk.arguments);
+        json += ", \"windowsWorkingDirectory\": " + jsonStringOrNull(lnk.workingDirectory);
+        json += ", \"unixWorkingDirectory\": " +
+                jsonStringOrNull(unixPathString(winePrefixDir, lnk.workingDirectory));
+        json += ", \"windowsIconPath\": " + jsonStringOrNull(windowsIconPath);
+        json += ", \"unixIconPath\": " +
+                jsonStringOrNull(unixPathString(winePrefixDir, windowsIconPath));
+        json += ", \"iconIndex\": " + std::to_string(lnk.iconIndex);
+    }
+    catch (std::exception const& e)
+    {
+        json += ", \"error\": " + escapeAndQuoteJsonString(e.what());
+    }
+
+    json += "}";
+
+    return json;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program resolves Windows shortcuts without starting Wine. It prints a JSON array
+    // with an object per .lnk file. Files that fail to parse get an "error" key instead
+    // of the rest of the fields.
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <wine_prefix_dir> <lnk_file> [<lnk_file> ...]\n", argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path const winePrefixDir = argv[1];
+
+    std::cout << "[";
+
+    for (int i = 2; i < argc; ++i)
+    {
+        if (i > 2)
+        {
+            std::cout << ",";
+        }
+
+        std::cout << "\n  " << resolveLnkFileToJson(winePrefixDir, argv[i]);
+    }
+
+    std::cout << "\n]" << std::endl;
+
+    return std::cout ? 0 : 1;
+}
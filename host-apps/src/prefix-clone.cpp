@@ -0,0 +1,152 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CloneTree.h"
+#include "MappedFile.h"
+#include "RegFile.h"
+#include "WriteFileAtomically.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * Replaces all occurrences of each pattern with its replacement.
+ * Returns whether anything was replaced.
+ */
+bool
+replaceAll(std::string& text, std::vector<std::pair<std::string, std::string>> const& replacements)
+{
+    bool replaced = false;
+
+    for (auto const& [from, to] : replacements)
+    {
+        for (size_t pos = text.find(from); pos != std::string::npos;
+             pos = text.find(from, pos + to.size()))
+        {
+            text.replace(pos, from.size(), to);
+            replaced = true;
+        }
+    }
+
+    return replaced;
+}
+
+/**
+ * The Z: drive spelling of a Unix path, which is how Wine refers to host paths
+ * outside of drive_c.
+ */
+std::string
+zDrivePath(fs::path const& unixPath)
+{
+    std::string path = "Z:" + unixPath.string();
+    std::replace(path.begin(), path.end(), '/', '\\');
+    return path;
+}
+
+/**
+ * Rewrites references to the source directory in the registry hives of the clone.
+ *
+ * The hives live either right in the prefix directory or, for Proton, in its pfx
+ * subdirectory. Returns the number of hives that were modified.
+ */
+int
+relocateRegFiles(fs::path const& sourceDir, fs::path const& destDir)
+{
+    std::vector<std::pair<std::string, std::string>> const replacements = {
+        {escapeRegString(sourceDir.string(), "\""), escapeRegString(destDir.string(), "\"")},
+        {escapeRegString(zDrivePath(sourceDir), "\""), escapeRegString(zDrivePath(destDir), "\"")},
+    };
+
+    int numRelocated = 0;
+
+    for (fs::path const& dir : {destDir, destDir / "pfx"})
+    {
+        std::error_code ec;
+        for (fs::directory_entry const& entry : fs::directory_iterator(dir, ec))
+        {
+            if (entry.path().extension() != ".reg" || !entry.is_regular_file())
+            {
+                continue;
+            }
+
+            std::string text;
+            {
+                MappedFile const hive(entry.path());
+                text = hive.text();
+            }
+
+            if (replaceAll(text, replacements))
+            {
+                writeFileAtomically(entry.path(), text);
+                ++numRelocated;
+            }
+        }
+    }
+
+    return numRelocated;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program creates a Wine prefix from a template (or a template from a prefix)
+    // by cloning its directory tree. It's how we avoid running "wineboot -u" for every
+    // new prefix. A JSON object with statistics is printed on success.
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <source_dir> <dest_dir>\n", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        fs::path const sourceDir = fs::absolute(argv[1]).lexically_normal();
+        fs::path const destDir = fs::absolute(argv[2]).lexically_normal();
+
+        CloneTreeStats const stats = cloneTree(sourceDir, destDir);
+        int const numRelocatedRegFiles = relocateRegFiles(sourceDir, destDir);
+
+        std::cout << "{\"dirs\": " << stats.numDirs << ", \"symlinks\": " << stats.numSymlinks
+                  << ", \"reflinkedFiles\": " << stats.numReflinkedFiles
+                  << ", \"copiedFiles\": " << stats.numCopiedFiles
+                  << ", \"bytes\": " << stats.numBytes
+                  << ", \"relocatedRegFiles\": " << numRelocatedRegFiles << "}" << std::endl;
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Dedupe.h"
+#include "DedupeState.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [--hardlink] [--dry-run] <state_file> <dir>...\n"
+        "\n"
+        "Makes identical files under the given directories share storage. The state file\n"
+        "remembers file hashes between runs and is created if missing.\n"
+        "\n"
+        "  --hardlink  Where the filesystem can't share extents, replace duplicates with\n"
+        "              read-only hard links.\n"
+        "  --dry-run   Only report the duplicates.\n",
+        programName);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program is meant to be run over all Wine prefixes and Wine builds at once.
+    // They tend to contain many identical DLLs and runtime redistributables.
+
+    DedupeOptions options;
+    int argIdx = 1;
+
+    for (; argIdx < argc && argv[argIdx][0] == '-'; ++argIdx)
+    {
+        if (strcmp(argv[argIdx], "--hardlink") == 0)
+        {
+            options.allowHardlinks = true;
+        }
+        else if (strcmp(argv[argIdx], "--dry-run") == 0)
+        {
+            options.dryRun = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (argc - argIdx < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::filesystem::path const stateFile = argv[argIdx++];
+
+        std::vector<std::filesystem::path> roots;
+        for (; argIdx < argc; ++argIdx)
+        {
+            // The state is keyed by absolute paths.
+            roots.push_back(std::filesystem::absolute(argv[argIdx]).lexically_normal());
+        }
+
+        DedupeState state = readDedupeState(stateFile);
+        DedupeStats const stats = dedupeTrees(roots, options, state);
+
+        if (!options.dryRun)
+        {
+            writeDedupeState(stateFile, state);
+        }
+
+        std::cout << "{\"filesScanned\": " << stats.numFilesScanned
+                  << ", \"filesHashed\": " << stats.numFilesHashed
+                  << ", \"bytesHashed\": " << stats.numBytesHashed
+                  << ", \"duplicates\": " << stats.numDuplicates
+                  << ", \"alreadyShared\": " << stats.numDuplicatesAlreadyShared
+                  << ", \"reflinked\": " << stats.numReflinked
+                  << ", \"hardlinked\": " << stats.numHardlinked
+                  << ", \"bytesSaved\": " << stats.numBytesSaved
+                  << ", \"errors\": " << stats.numErrors << "}" << std::endl;
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DiskUsage.h"
+#include "EscapeAndQuoteJsonString.h"
+#include "WriteFileAtomically.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [--cache <cache_file>] [--output <json_file>] [--depth <n>] [--top <n>] "
+        "<dir>\n"
+        "\n"
+        "Prints (or writes to <json_file>) a JSON report of what takes space under <dir>.\n"
+        "The cache file makes subsequent scans only list the directories that changed.\n",
+        programName);
+}
+
+void
+writeTotals(std::ostream& out, DiskUsageTotals const& totals)
+{
+    out << "\"files\":" << totals.numFiles << ",\"apparentBytes\":" << totals.apparentBytes
+        << ",\"allocatedBytes\":" << totals.allocatedBytes
+        << ",\"sharedBytes\":" << totals.sharedBytes;
+}
+
+void
+writeTree(
+    std::ostream& out, std::string const& relPath, DiskUsageSummary const& summary,
+    std::map<std::string, std::vector<std::string>> const& children, int depthLeft)
+{
+    std::string const name = relPath.substr(relPath.rfind('/') + 1);
+
+    out << "{\"name\":" << escapeAndQuoteJsonString(name) << ",";
+    writeTotals(out, summary.dirTotals.at(relPath));
+
+    auto const it = children.find(relPath);
+    if (depthLeft > 0 && it != children.end())
+    {
+        out << ",\"children\":[";
+        bool first = true;
+        for (std::string const& child : it->second)
+        {
+            out << (first ? "" : ",");
+            writeTree(out, child, summary, children, depthLeft - 1);
+            first = false;
+        }
+        out << "]";
+    }
+
+    out << "}";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program tells what takes space in a Wine prefix. Prefixes easily have hundreds
+    // of thousands of files, which is why this is done natively and in parallel.
+
+    fs::path cacheFile;
+    fs::path outputFile;
+    int maxDepth = 4;
+    size_t maxLargestFiles = 50;
+
+    int argIdx = 1;
+    for (; argIdx + 1 < argc && argv[argIdx][0] == '-'; argIdx += 2)
+    {
+        if (strcmp(argv[argIdx], "--cache") == 0)
+        {
+            cacheFile = argv[argIdx + 1];
+        }
+        else if (strcmp(argv[argIdx], "--output") == 0)
+        {
+            outputFile = argv[argIdx + 1];
+        }
+        else if (strcmp(argv[argIdx], "--depth") == 0)
+        {
+            maxDepth = atoi(argv[argIdx + 1]);
+        }
+        else if (strcmp(argv[argIdx], "--top") == 0)
+        {
+            maxLargestFiles = strtoul(argv[argIdx + 1], nullptr, 10);
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (argIdx + 1 != argc)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        fs::path const rootDir = argv[argIdx];
+
+        DiskUsageScan const previousScan =
+            cacheFile.empty() ? DiskUsageScan() : readDiskUsageScan(cacheFile);
+
+        DiskUsageScanStats stats;
+        DiskUsageScan const scan = scanDiskUsage(rootDir, previousScan, 0, &stats);
+
+        if (!cacheFile.empty())
+        {
+            writeDiskUsageScan(cacheFile, scan);
+        }
+
+        DiskUsageSummary const summary = summarizeDiskUsage(scan, maxLargestFiles);
+
+        // Children go from the largest to the smallest.
+        std::map<std::string, std::vector<std::string>> children;
+        for (auto const& [relPath, totals] : summary.dirTotals)
+        {
+            if (!relPath.empty())
+            {
+                size_t const slash = relPath.rfind('/');
+                children[slash == std::string::npos ? "" : relPath.substr(0, slash)].push_back(
+                    relPath);
+            }
+        }
+        for (auto& [parent, dirs] : children)
+        {
+            std::stable_sort(dirs.begin(), dirs.end(), [&](auto const& lhs, auto const& rhs) {
+                return summary.dirTotals.at(lhs).allocatedBytes >
+                       summary.dirTotals.at(rhs).allocatedBytes;
+            });
+        }
+
+        std::ostringstream json;
+        json << "{\"scannedAt\":" << time(nullptr) << ",\"dirsListed\":" << stats.numDirsListed
+             << ",\"dirsReused\":" << stats.numDirsReused << ",\"errors\":" << stats.numErrors
+             << ",\"tree\":";
+        writeTree(json, "", summary, children, maxDepth);
+
+        json << ",\"largestFiles\":[";
+        for (size_t i = 0; i < summary.largestFiles.size(); ++i)
+        {
+            LargeFile const& file = summary.largestFiles[i];
+            json << (i ? "," : "") << "{\"path\":" << escapeAndQuoteJsonString(file.path)
+                 << ",\"size\":" << file.size << ",\"allocatedBytes\":" << file.allocatedBytes
+                 << "}";
+        }
+
+        json << "],\"categories\":[";
+        for (size_t i = 0; i < summary.categoryTotals.size(); ++i)
+        {
+            json << (i ? "," : "") << "{\"category\":"
+                 << escapeAndQuoteJsonString(fileCategoryName(static_cast<FileCategory>(i)))
+                 << ",";
+            writeTotals(json, summary.categoryTotals[i]);
+            json << "}";
+        }
+        json << "]}\n";
+
+        if (outputFile.empty())
+        {
+            std::cout << json.str() << std::flush;
+        }
+        else
+        {
+            writeFileAtomically(outputFile, json.str());
+        }
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
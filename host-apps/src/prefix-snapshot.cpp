@@ -0,0 +1,154 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EscapeAndQuoteJsonString.h"
+#include "PrefixSnapshot.h"
+#include "WineserverLock.h"
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+/**
+ * The exit code that tells the caller Wine has to be stopped first.
+ */
+int const kExitCodeWineserverRunning = 2;
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s <snapshots_dir> create <wine_prefix_dir> [<label>]\n"
+        "       %s <snapshots_dir> list\n"
+        "       %s <snapshots_dir> restore <snapshot_id> <wine_prefix_dir>\n"
+        "       %s <snapshots_dir> delete <snapshot_id>\n"
+        "\n"
+        "Results are printed as JSON. create and restore exit with code %d without touching\n"
+        "anything if wineserver is running in the prefix.\n",
+        programName, programName, programName, programName, kExitCodeWineserverRunning);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program makes restore points of a Wine prefix, for example before running
+    // an installer. On filesystems with reflink support (btrfs, XFS), snapshots take
+    // little time and next to no space.
+
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path const snapshotsDir = argv[1];
+    std::string_view const command = argv[2];
+
+    try
+    {
+        if (command == "create" && (argc == 4 || argc == 5))
+        {
+            std::filesystem::path const prefixDir = argv[3];
+
+            // Held until the snapshot is complete, so that a wineserver can't start
+            // and modify the prefix while it's being copied.
+            WineserverLock const wineserverLock(prefixDir);
+            if (!wineserverLock.acquired())
+            {
+                fprintf(stderr, "wineserver is running in %s\n", argv[3]);
+                return kExitCodeWineserverRunning;
+            }
+
+            CloneTreeStats stats;
+            std::string const id =
+                createSnapshot(snapshotsDir, prefixDir, argc == 5 ? argv[4] : "", &stats);
+
+            std::cout << "{\"id\": " << escapeAndQuoteJsonString(id)
+                      << ", \"reflinkedFiles\": " << stats.numReflinkedFiles
+                      << ", \"hardlinkedFiles\": " << stats.numHardlinkedFiles
+                      << ", \"copiedFiles\": " << stats.numCopiedFiles
+                      << ", \"bytes\": " << stats.numBytes << "}" << std::endl;
+        }
+        else if (command == "list" && argc == 3)
+        {
+            std::cout << "[";
+            bool first = true;
+            for (SnapshotInfo const& info : listSnapshots(snapshotsDir))
+            {
+                std::cout << (first ? "\n  " : ",\n  ")
+                          << "{\"id\": " << escapeAndQuoteJsonString(info.id)
+                          << ", \"label\": " << escapeAndQuoteJsonString(info.label)
+                          << ", \"createdAt\": " << info.createdAt
+                          << ", \"files\": " << info.numFiles << ", \"bytes\": " << info.numBytes
+                          << "}";
+                first = false;
+            }
+            std::cout << "\n]" << std::endl;
+        }
+        else if (command == "restore" && argc == 5)
+        {
+            std::filesystem::path const prefixDir = argv[4];
+
+            // Held until the restore is complete, so that a wineserver can't start and
+            // load a half-restored prefix. No wineserver can be running in a prefix that
+            // doesn't exist yet.
+            std::optional<WineserverLock> wineserverLock;
+            if (std::filesystem::exists(prefixDir))
+            {
+                wineserverLock.emplace(prefixDir);
+                if (!wineserverLock->acquired())
+                {
+                    fprintf(stderr, "wineserver is running in %s\n", argv[4]);
+                    return kExitCodeWineserverRunning;
+                }
+            }
+
+            SnapshotRestoreStats const stats = restoreSnapshot(snapshotsDir, argv[3], prefixDir);
+
+            std::cout << "{\"unchanged\": " << stats.numUnchanged
+                      << ", \"restored\": " << stats.numRestored
+                      << ", \"removed\": " << stats.numRemoved << "}" << std::endl;
+        }
+        else if (command == "delete" && argc == 4)
+        {
+            deleteSnapshot(snapshotsDir, argv[3]);
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
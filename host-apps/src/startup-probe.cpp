@@ -0,0 +1,105 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EscapeAndQuoteJsonString.h"
+#include "HostProbe.h"
+#include "WriteFileAtomically.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+std::string
+toJson(HostProbe const& probe)
+{
+    auto const boolean = [](bool value) { return value ? "true" : "false"; };
+
+    std::ostringstream json;
+    json << "{\"bootId\": " << escapeAndQuoteJsonString(probe.bootId)
+         << ", \"pageSize\": " << probe.pageSize
+         << ", \"arch\": " << escapeAndQuoteJsonString(probe.arch)
+         << ", \"cpus\": " << probe.numCpus
+         << ", \"muvmAvailable\": " << boolean(probe.muvmAvailable)
+         << ", \"fexAvailable\": " << boolean(probe.fexAvailable)
+         << ", \"pidfdSupported\": " << boolean(probe.pidfdSupported)
+         << ", \"ioUringSupported\": " << boolean(probe.ioUringSupported)
+         << ", \"reflinksSupported\": " << boolean(probe.reflinksSupported) << "}\n";
+    return json.str();
+}
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [--cache <cache_file>] <data_dir>\n"
+        "\n"
+        "Prints facts about the host as JSON. With --cache, also saves them to the given\n"
+        "file, which stays valid until the next reboot, as it's keyed by the boot ID.\n",
+        programName);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program replaces the getconf, uname and which processes the app used to start
+    // one after another on startup. It doesn't start any processes itself.
+
+    char const* cacheFile = nullptr;
+    int argIdx = 1;
+
+    if (argIdx + 1 < argc && strcmp(argv[argIdx], "--cache") == 0)
+    {
+        cacheFile = argv[argIdx + 1];
+        argIdx += 2;
+    }
+
+    if (argc - argIdx != 1)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::string const json = toJson(probeHost(argv[argIdx]));
+
+        if (cacheFile)
+        {
+            writeFileAtomically(cacheFile, json);
+        }
+
+        std::cout << json << std::flush;
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ContentStore.h"
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The exit code that tells the caller an extraction into the store is in progress.
+ */
+int const kExitCodeStoreBusy = 2;
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s <store_dir> ingest <dir>...\n"
+        "       %s <store_dir> gc\n"
+        "\n"
+        "ingest turns the files under the given directories into hard links to the objects\n"
+        "of the content-addressed store, adding the contents it doesn't have yet.\n"
+        "gc removes the objects no longer linked from anywhere.\n"
+        "Results are printed as JSON. Both exit with code %d without touching anything\n"
+        "if an extraction into the store is in progress.\n",
+        programName, programName, kExitCodeStoreBusy);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // Wine builds are stored once per distinct file rather than once per release.
+    // archive-extractor populates the store while installing a build. This program
+    // brings in builds installed otherwise and cleans up after deleted ones.
+
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path const storeDir = argv[1];
+    std::string_view const command = argv[2];
+
+    try
+    {
+        // Held until the command is complete, so that no extraction writes to the files
+        // being hashed or links to the objects being removed.
+        ContentStoreLock const storeLock(storeDir, ContentStoreLock::Mode::Maintenance);
+        if (!storeLock.acquired())
+        {
+            fprintf(stderr, "An extraction into %s is in progress\n", argv[1]);
+            return kExitCodeStoreBusy;
+        }
+
+        if (command == "ingest" && argc >= 4)
+        {
+            std::vector<std::filesystem::path> const roots(argv + 3, argv + argc);
+            ContentStoreIngestStats const stats = ingestTrees(storeDir, roots);
+
+            std::cout << "{\"files\": " << stats.numFiles
+                      << ", \"newObjects\": " << stats.numNewObjects
+                      << ", \"sharedFiles\": " << stats.numSharedFiles
+                      << ", \"bytesShared\": " << stats.numBytesShared
+                      << ", \"errors\": " << stats.numErrors << "}" << std::endl;
+        }
+        else if (command == "gc" && argc == 3)
+        {
+            ContentStoreGcStats const stats = collectGarbage(storeDir);
+
+            std::cout << "{\"objects\": " << stats.numObjects
+                      << ", \"removedObjects\": " << stats.numRemovedObjects
+                      << ", \"bytesFreed\": " << stats.numBytesFreed << "}" << std::endl;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+#include "RegEdit.h"
+#include "RegHiveKey.h"
+#include "WineserverLock.h"
+#include "WriteFileAtomically.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+/**
+ * The exit code that tells the caller to fall back to reg.exe.
+ */
+int const kExitCodeWineserverRunning = 2;
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s <wine_prefix_dir> set-dword <key> <value_name> <number>\n"
+        "       %s <wine_prefix_dir> set-sz <key> <value_name> <string>\n"
+        "       %s <wine_prefix_dir> set-expand-sz <key> <value_name> <string>\n"
+        "       %s <wine_prefix_dir> delete-value <key> <value_name>\n"
+        "\n"
+        "<key> starts with HKCU, HKLM or HKCR. A <value_name> of @ refers to the default value.\n"
+        "Exits with code %d without touching anything if wineserver is running in the prefix.\n",
+        programName, programName, programName, programName, kExitCodeWineserverRunning);
+}
+
+std::optional<uint32_t>
+parseDword(std::string_view str)
+{
+    std::string const nullTerminated(str);
+    char* end = nullptr;
+
+    errno = 0;
+    unsigned long long const value = strtoull(nullTerminated.c_str(), &end, 0);
+
+    if (nullTerminated.empty() || *end != '\0' || errno != 0 || value > 0xFFFFFFFFull)
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<uint32_t>(value);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program edits user.reg / system.reg of a Wine prefix directly, which takes
+    // milliseconds rather than the seconds it takes to spin up wineserver and run reg.exe.
+    // That's only safe while no wineserver is running in the prefix, as wineserver keeps
+    // the registry in memory and overwrites the hive files when it saves them.
+
+    if (argc < 5)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path const winePrefixDir = argv[1];
+    std::string_view const command = argv[2];
+    std::string_view const fullKeyPath = argv[3];
+    std::string_view const valueName = argv[4];
+
+    bool const isDeletion = command == "delete-value";
+    if (argc != (isDeletion ? 5 : 6))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::optional<RegHiveKey> const hiveKey = resolveRegHiveKey(winePrefixDir, fullKeyPath);
+        if (!hiveKey)
+        {
+            fprintf(stderr, "Unsupported registry key: %s\n", argv[3]);
+            return 1;
+        }
+
+        RegEdit edit;
+        edit.keyPath = hiveKey->keyPath;
+        edit.valueName = valueName == "@" ? std::string() : std::string(valueName);
+
+        if (command == "set-dword")
+        {
+            std::optional<uint32_t> const value = parseDword(argv[5]);
+            if (!value)
+            {
+                fprintf(stderr, "Not a valid DWORD: %s\n", argv[5]);
+                return 1;
+            }
+            edit.data = formatRegDword(*value);
+        }
+        else if (command == "set-sz")
+        {
+            edit.data = formatRegString(argv[5]);
+        }
+        else if (command == "set-expand-sz")
+        {
+            edit.data = formatRegExpandString(argv[5]);
+        }
+        else if (!isDeletion)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        // Held until the new hive file is in place, so that a wineserver can't start
+        // in the meantime and load the old one.
+        WineserverLock const wineserverLock(winePrefixDir);
+        if (!wineserverLock.acquired())
+        {
+            fprintf(stderr, "wineserver is running in %s\n", argv[1]);
+            return kExitCodeWineserverRunning;
+        }
+
+        std::string newHiveText;
+        {
+            MappedFile const hive(hiveKey->hiveFile);
+            newHiveText = applyRegEdit(hive.text(), edit, std::time(nullptr));
+
+            if (newHiveText == hive.text())
+            {
+                return 0;
+            }
+        }
+
+        writeFileAtomically(hiveKey->hiveFile, newHiveText);
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EscapeAndQuoteJsonString.h"
+#include "MappedFile.h"
+#include "RegFile.h"
+#include "RegHiveKey.h"
+#include "RegIndex.h"
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+void
+printUsage(char const* programName)
+{
+    fprintf(
+        stderr,
+        "Usage: %s <wine_prefix_dir> get <key> [<value_name>]\n"
+        "       %s <wine_prefix_dir> subkeys <key>\n"
+        "       %s <wine_prefix_dir> tree <key>\n"
+        "\n"
+        "<key> starts with HKCU, HKLM or HKCR. A <value_name> of @ refers to the default value.\n"
+        "Results are printed as JSON, with null standing for a missing key or value.\n",
+        programName, programName, programName);
+}
+
+/**
+ * Joins the continuation lines of binary data.
+ */
+std::string
+joinContinuationLines(std::string_view rawData)
+{
+    std::string joined;
+    joined.reserve(rawData.size());
+
+    size_t pos = 0;
+    while (pos < rawData.size())
+    {
+        size_t const continuation = rawData.find("\\\n", pos);
+        if (continuation == std::string_view::npos)
+        {
+            joined.append(rawData.substr(pos));
+            break;
+        }
+
+        joined.append(rawData.substr(pos, continuation - pos));
+        pos = rawData.find_first_not_of(" \t", continuation + 2);
+        if (pos == std::string_view::npos)
+        {
+            break;
+        }
+    }
+
+    return joined;
+}
+
+std::string
+valueToJson(RegValueLine const& value)
+{
+    std::string json = "{\"name\": " + escapeAndQuoteJsonString(value.name);
+
+    uint32_t dword = 0;
+    std::string str;
+
+    if (parseRegDword(value.rawData, dword))
+    {
+        json += ", \"type\": \"REG_DWORD\", \"data\": " + std::to_string(dword);
+    }
+    else if (parseRegString(value.rawData, str))
+    {
+        json += value.rawData.starts_with('"') ? ", \"type\": \"REG_SZ\""
+                                               : ", \"type\": \"REG_EXPAND_SZ\"";
+        json += ", \"data\": " + escapeAndQuoteJsonString(str);
+    }
+    else
+    {
+        // Binary and other types are passed through in .reg syntax.
+        json += ", \"type\": null, \"raw\": " +
+                escapeAndQuoteJsonString(joinContinuationLines(value.rawData));
+    }
+
+    json += "}";
+    return json;
+}
+
+std::string
+keyToJson(std::string_view hiveText, std::string_view keyPath, RegKeySection const* section)
+{
+    std::string json = "{\"key\": " + escapeAndQuoteJsonString(keyPath) + ", \"values\": [";
+
+    if (section)
+    {
+        bool first = true;
+        for (RegValueLine const& value : scanRegValueLines(hiveText, *section))
+        {
+            json += first ? "" : ", ";
+            json += valueToJson(value);
+            first = false;
+        }
+    }
+
+    json += "]}";
+    return json;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // This program reads the registry of a Wine prefix without starting Wine. Lookups go
+    // through an index that's kept next to each hive file and rebuilt whenever the hive
+    // changes. See RegIndex for details.
+
+    if (argc < 4)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::filesystem::path const winePrefixDir = argv[1];
+    std::string_view const command = argv[2];
+    std::string_view const fullKeyPath = argv[3];
+
+    if (argc > (command == "get" ? 5 : 4))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::optional<RegHiveKey> const hiveKey = resolveRegHiveKey(winePrefixDir, fullKeyPath);
+        if (!hiveKey)
+        {
+            fprintf(stderr, "Unsupported registry key: %s\n", argv[3]);
+            return 1;
+        }
+
+        MappedFile const hive(hiveKey->hiveFile);
+        RegIndex const index(hive, regIndexFileForHive(hiveKey->hiveFile));
+
+        std::optional<RegIndexedKey> const key = index.find(hiveKey->keyPath);
+
+        if (!key)
+        {
+            std::cout << "null" << std::endl;
+        }
+        else if (command == "get" && argc == 5)
+        {
+            std::string_view const valueName = argv[4] == std::string_view("@") ? "" : argv[4];
+            std::optional<std::string> json;
+
+            if (key->section)
+            {
+                for (RegValueLine const& value : scanRegValueLines(hive.text(), *key->section))
+                {
+                    if (regNamesEqual(value.name, valueName))
+                    {
+                        json = valueToJson(value);
+                        break;
+                    }
+                }
+            }
+
+            std::cout << json.value_or("null") << std::endl;
+        }
+        else if (command == "get")
+        {
+            RegKeySection const* section = key->section ? &*key->section : nullptr;
+            std::cout << keyToJson(hive.text(), key->path, section) << std::endl;
+        }
+        else if (command == "subkeys")
+        {
+            std::cout << "[";
+            bool first = true;
+            for (std::string const& name : index.subkeyNames(key->path))
+            {
+                std::cout << (first ? "" : ", ") << escapeAndQuoteJsonString(name);
+                first = false;
+            }
+            std::cout << "]" << std::endl;
+        }
+        else if (command == "tree")
+        {
+            std::cout << "[";
+            bool first = true;
+            for (RegKeySection const& section : index.subtree(key->path))
+            {
+                std::cout << (first ? "\n  " : ",\n  ")
+                          << keyToJson(hive.text(), section.path, &section);
+                first = false;
+            }
+            std::cout << "\n]" << std::endl;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return std::cout ? 0 : 1;
+}
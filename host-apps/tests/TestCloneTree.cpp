@@ -0,0 +1,155 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CloneTree.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestCloneTree.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+    fs::path const source = tempDir / "source";
+
+    fs::create_directories(source / "drive_c" / "windows");
+    fs::create_directories(source / "dosdevices");
+    std::ofstream(source / "system.reg") << "WINE REGISTRY Version 2\n";
+    std::ofstream(source / "drive_c" / "windows" / "win.ini") << "[fonts]\n";
+    fs::permissions(source / "system.reg", fs::perms::owner_read | fs::perms::owner_write);
+    fs::create_directory_symlink("../drive_c", source / "dosdevices" / "c:");
+    fs::create_directory_symlink("/", source / "dosdevices" / "z:");
+    fs::create_directory_symlink(source / "drive_c" / "windows", source / "windows");
+
+    *state = new fs::path(tempDir);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+std::string
+readFile(fs::path const& path)
+{
+    std::ostringstream contents;
+    contents << std::ifstream(path).rdbuf();
+    return contents.str();
+}
+
+void
+tree_is_cloned_with_metadata(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const source = tempDir / "source";
+    fs::path const dest = tempDir / "dest1";
+
+    CloneTreeStats const stats = cloneTree(source, dest);
+
+    assert_int_equal(stats.numDirs, 4);
+    assert_int_equal(stats.numSymlinks, 3);
+    assert_int_equal(stats.numReflinkedFiles + stats.numCopiedFiles, 2);
+
+    assert_string_equal(readFile(dest / "system.reg").c_str(), "WINE REGISTRY Version 2\n");
+    assert_string_equal(
+        readFile(dest / "drive_c" / "windows" / "win.ini").c_str(), "[fonts]\n");
+
+    assert_true(
+        fs::status(dest / "system.reg").permissions() ==
+        (fs::perms::owner_read | fs::perms::owner_write));
+    assert_true(
+        fs::last_write_time(dest / "system.reg") == fs::last_write_time(source / "system.reg"));
+}
+
+void
+symlinks_into_the_source_are_redirected(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const dest = tempDir / "dest2";
+
+    // A trailing slash must not confuse the redirection.
+    cloneTree(tempDir / "source/", dest);
+
+    assert_string_equal(fs::read_symlink(dest / "dosdevices" / "c:").c_str(), "../drive_c");
+    assert_string_equal(fs::read_symlink(dest / "dosdevices" / "z:").c_str(), "/");
+    assert_string_equal(
+        fs::read_symlink(dest / "windows").c_str(), (dest / "drive_c" / "windows").c_str());
+}
+
+void
+existing_destination_is_rejected(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::create_directory(tempDir / "dest3");
+
+    bool threw = false;
+    try
+    {
+        cloneTree(tempDir / "source", tempDir / "dest3");
+    }
+    catch (std::system_error const&)
+    {
+        threw = true;
+    }
+
+    assert_true(threw);
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(tree_is_cloned_with_metadata),
+        cmocka_unit_test(symlinks_into_the_source_are_redirected),
+        cmocka_unit_test(existing_destination_is_rejected),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
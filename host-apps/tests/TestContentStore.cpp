@@ -0,0 +1,174 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ContentStore.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+void
+writeFile(fs::path const& path, std::string const& contents)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << contents;
+}
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestContentStore.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+
+    writeFile(tempDir / "wine-9.0" / "lib" / "ntdll.dll", "ntdll 9.0");
+    writeFile(tempDir / "wine-9.0" / "lib" / "kernel32.dll", "kernel32");
+    writeFile(tempDir / "wine-9.0" / "bin" / "wine", "wine loader");
+    writeFile(tempDir / "wine-9.1" / "lib" / "ntdll.dll", "ntdll 9.1");
+    writeFile(tempDir / "wine-9.1" / "lib" / "kernel32.dll", "kernel32");
+    writeFile(tempDir / "wine-9.1" / "bin" / "wine", "wine loader");
+    writeFile(tempDir / "wine-9.1" / "bin" / "empty", "");
+
+    // Same contents, different mode.
+    fs::permissions(tempDir / "wine-9.1" / "bin" / "wine", static_cast<fs::perms>(0755));
+
+    *state = new fs::path(tempDir);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+void
+identical_files_share_objects(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const storeDir = tempDir / "store";
+
+    ContentStoreIngestStats stats = ingestTrees(storeDir, {tempDir / "wine-9.0"}, 2);
+    assert_int_equal(stats.numFiles, 3);
+    assert_int_equal(stats.numNewObjects, 3);
+    assert_int_equal(stats.numErrors, 0);
+
+    stats = ingestTrees(storeDir, {tempDir / "wine-9.1"}, 2);
+    assert_int_equal(stats.numFiles, 3);
+    assert_int_equal(stats.numNewObjects, 2);
+    assert_int_equal(stats.numSharedFiles, 1);
+    assert_int_equal(stats.numBytesShared, 8);
+
+    assert_true(fs::equivalent(
+        tempDir / "wine-9.0" / "lib" / "kernel32.dll",
+        tempDir / "wine-9.1" / "lib" / "kernel32.dll"));
+    assert_false(fs::equivalent(
+        tempDir / "wine-9.0" / "bin" / "wine", tempDir / "wine-9.1" / "bin" / "wine"));
+    assert_int_equal(fs::hard_link_count(tempDir / "wine-9.1" / "bin" / "empty"), 1);
+
+    assert_true(
+        fs::status(tempDir / "wine-9.1" / "bin" / "wine").permissions() ==
+        static_cast<fs::perms>(0555));
+    assert_true(
+        fs::status(tempDir / "wine-9.1" / "lib" / "ntdll.dll").permissions() ==
+        static_cast<fs::perms>(0444));
+
+    // Ingesting again changes nothing.
+    stats = ingestTrees(storeDir, {tempDir / "wine-9.1"}, 2);
+    assert_int_equal(stats.numNewObjects, 0);
+    assert_int_equal(stats.numSharedFiles, 0);
+}
+
+void
+gc_removes_unreferenced_objects(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const storeDir = tempDir / "store";
+
+    ContentStoreGcStats stats = collectGarbage(storeDir);
+    assert_int_equal(stats.numObjects, 5);
+    assert_int_equal(stats.numRemovedObjects, 0);
+
+    fs::remove_all(tempDir / "wine-9.0");
+
+    stats = collectGarbage(storeDir);
+    assert_int_equal(stats.numObjects, 5);
+    assert_int_equal(stats.numRemovedObjects, 2);
+    assert_int_equal(stats.numBytesFreed, 9 + 11);
+
+    assert_int_equal(fs::hard_link_count(tempDir / "wine-9.1" / "lib" / "kernel32.dll"), 2);
+}
+
+void
+maintenance_waits_for_extractions(void** state)
+{
+    fs::path const storeDir = *static_cast<fs::path*>(*state) / "lock" / "store";
+
+    {
+        ContentStoreLock const extraction1(storeDir, ContentStoreLock::Mode::Extraction);
+        ContentStoreLock const extraction2(storeDir, ContentStoreLock::Mode::Extraction);
+        assert_true(extraction1.acquired());
+        assert_true(extraction2.acquired());
+
+        ContentStoreLock const maintenance(storeDir, ContentStoreLock::Mode::Maintenance);
+        assert_false(maintenance.acquired());
+    }
+
+    ContentStoreLock const maintenance(storeDir, ContentStoreLock::Mode::Maintenance);
+    assert_true(maintenance.acquired());
+
+    ContentStoreLock const otherMaintenance(storeDir, ContentStoreLock::Mode::Maintenance);
+    assert_false(otherMaintenance.acquired());
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(identical_files_share_objects),
+        cmocka_unit_test(gc_removes_unreferenced_objects),
+        cmocka_unit_test(maintenance_waits_for_extractions),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
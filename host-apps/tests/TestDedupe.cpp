@@ -0,0 +1,180 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Dedupe.h"
+#include "DedupeState.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+void
+writeFile(fs::path const& path, char fill, size_t size)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << std::string(size, fill);
+}
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestDedupe.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+
+    writeFile(tempDir / "prefix1" / "system32" / "mfc42.dll", 'a', 64 * 1024);
+    writeFile(tempDir / "prefix2" / "system32" / "mfc42.dll", 'a', 64 * 1024);
+    writeFile(tempDir / "prefix2" / "system32" / "msvcp60.dll", 'b', 64 * 1024);
+    writeFile(tempDir / "prefix1" / "small.ini", 'c', 100);
+    writeFile(tempDir / "prefix2" / "small.ini", 'c', 100);
+
+    *state = new fs::path(tempDir);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+std::vector<fs::path>
+roots(fs::path const& tempDir)
+{
+    return {tempDir / "prefix1", tempDir / "prefix2"};
+}
+
+void
+dry_run_finds_duplicates(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+
+    DedupeOptions options;
+    options.dryRun = true;
+    options.numThreads = 2;
+
+    DedupeState dedupeState;
+    DedupeStats const stats = dedupeTrees(roots(tempDir), options, dedupeState);
+
+    // The small files are below the size threshold.
+    assert_int_equal(stats.numFilesScanned, 3);
+    assert_int_equal(stats.numFilesHashed, 3);
+    assert_int_equal(stats.numDuplicates, 1);
+    assert_int_equal(stats.numReflinked + stats.numHardlinked, 0);
+    assert_int_equal(stats.numErrors, 0);
+    assert_int_equal(dedupeState.size(), 3);
+
+    assert_true(
+        (fs::status(tempDir / "prefix1" / "system32" / "mfc42.dll").permissions() &
+         fs::perms::owner_write) != fs::perms::none);
+}
+
+void
+state_round_trips_and_saves_hashing(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const stateFile = tempDir / "dedupe-state";
+
+    DedupeOptions options;
+    options.dryRun = true;
+
+    DedupeState dedupeState;
+    dedupeTrees(roots(tempDir), options, dedupeState);
+    writeDedupeState(stateFile, dedupeState);
+
+    DedupeState reloadedState = readDedupeState(stateFile);
+    assert_int_equal(reloadedState.size(), dedupeState.size());
+    for (auto const& [path, entry] : dedupeState)
+    {
+        assert_int_equal(reloadedState.at(path).hash, entry.hash);
+        assert_int_equal(reloadedState.at(path).mtimeNs, entry.mtimeNs);
+    }
+
+    DedupeStats const stats = dedupeTrees(roots(tempDir), options, reloadedState);
+    assert_int_equal(stats.numFilesHashed, 0);
+    assert_int_equal(stats.numDuplicates, 1);
+
+    assert_true(readDedupeState(tempDir / "no-such-file").empty());
+}
+
+void
+duplicates_share_storage(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const file1 = tempDir / "prefix1" / "system32" / "mfc42.dll";
+    fs::path const file2 = tempDir / "prefix2" / "system32" / "mfc42.dll";
+
+    DedupeOptions options;
+    options.allowHardlinks = true;
+
+    DedupeState dedupeState;
+    DedupeStats stats = dedupeTrees(roots(tempDir), options, dedupeState);
+
+    assert_int_equal(stats.numReflinked + stats.numHardlinked, 1);
+    assert_int_equal(stats.numBytesSaved, 64 * 1024);
+    assert_int_equal(stats.numErrors, 0);
+
+    if (stats.numHardlinked)
+    {
+        assert_true(fs::equivalent(file1, file2));
+        assert_true((fs::status(file1).permissions() & fs::perms::owner_write) == fs::perms::none);
+    }
+
+    // Nothing is left to do on the second run.
+    stats = dedupeTrees(roots(tempDir), options, dedupeState);
+    assert_int_equal(stats.numFilesHashed, 0);
+    assert_int_equal(stats.numReflinked + stats.numHardlinked, 0);
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(dry_run_finds_duplicates),
+        cmocka_unit_test(state_round_trips_and_saves_hashing),
+        cmocka_unit_test(duplicates_share_storage),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
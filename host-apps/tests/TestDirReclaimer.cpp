@@ -0,0 +1,130 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DirReclaimer.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestDirReclaimer.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    *state = new fs::path(dirTemplate);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+void
+contents_are_removed_but_not_followed(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const trashDir = tempDir / "trash";
+    fs::path const outsideFile = tempDir / "outside" / "keep.txt";
+
+    fs::create_directories(outsideFile.parent_path());
+    std::ofstream(outsideFile) << "keep";
+
+    // The app moves its temporary directory to the trash on startup, so the trash usually
+    // has a single entry, with all the work below it.
+    fs::path const trashedTempDir = trashDir / "temp-1760000000000000";
+    int const numProcessOutDirs = 200;
+
+    for (int i = 0; i < numProcessOutDirs; ++i)
+    {
+        fs::path const dir = trashedTempDir / ("process-outdir-" + std::to_string(i));
+        fs::create_directories(dir);
+        std::ofstream(dir / "status.txt") << "0";
+        std::ofstream(dir / "stdout.log") << "log";
+        std::ofstream(dir / "stderr.log") << "log";
+    }
+
+    fs::path const readOnlyDir = trashedTempDir / "pins-0" / "read-only";
+    fs::create_directories(readOnlyDir / "inner");
+    std::ofstream(readOnlyDir / "inner" / "file") << "data";
+    fs::permissions(readOnlyDir / "inner", static_cast<fs::perms>(0555));
+    fs::permissions(readOnlyDir, static_cast<fs::perms>(0555));
+
+    fs::path deepDir = trashedTempDir / "deep";
+    for (int i = 0; i < 50; ++i)
+    {
+        deepDir /= "d";
+    }
+    fs::create_directories(deepDir);
+    std::ofstream(deepDir / "file") << "data";
+
+    fs::create_directory_symlink(outsideFile.parent_path(), trashedTempDir / "link");
+    std::ofstream(trashDir / "loose-file") << "data";
+
+    DirReclaimProgress progress;
+    removeDirContents(trashDir, 8, progress);
+
+    assert_true(fs::exists(trashDir));
+    assert_true(fs::is_empty(trashDir));
+    assert_true(fs::exists(outsideFile));
+
+    // Process output files, the read-only one, the deep one, the link and the loose file.
+    assert_int_equal(progress.numFiles, numProcessOutDirs * 3 + 1 + 1 + 1 + 1);
+
+    // The temp dir, the process output dirs, pins-0 and the two below it, "deep"
+    // and the chain below it.
+    assert_int_equal(progress.numDirs, 1 + numProcessOutDirs + 3 + 1 + 50);
+    assert_int_equal(progress.numErrors, 0);
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(contents_are_removed_but_not_followed),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
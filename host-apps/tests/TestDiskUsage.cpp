@@ -0,0 +1,174 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DiskUsage.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+void
+writeFile(fs::path const& path, size_t size)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+}
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestDiskUsage.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+    fs::path const prefix = tempDir / "prefix";
+
+    writeFile(prefix / "system.reg", 1000);
+    writeFile(prefix / "drive_c" / "windows" / "system32" / "kernel32.dll", 300'000);
+    writeFile(prefix / "drive_c" / "windows" / "Fonts" / "tahoma.ttf", 200'000);
+    writeFile(prefix / "drive_c" / "Program Files" / "Game" / "game.EXE", 500'000);
+    fs::create_hard_link(
+        prefix / "drive_c" / "Program Files" / "Game" / "game.EXE",
+        prefix / "drive_c" / "Program Files" / "Game" / "game-copy.exe");
+    fs::create_directory_symlink("../drive_c", prefix / "c:");
+
+    *state = new fs::path(tempDir);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+void
+files_are_categorized_by_extension(void**)
+{
+    assert_true(categorizeFile("KERNEL32.DLL") == FileCategory::Executables);
+    assert_true(categorizeFile("tahoma.ttf") == FileCategory::Fonts);
+    assert_true(categorizeFile("vcredist.msi") == FileCategory::Installers);
+    assert_true(categorizeFile("readme.txt") == FileCategory::Documents);
+    assert_true(categorizeFile("system.reg") == FileCategory::Other);
+    assert_true(categorizeFile("noextension") == FileCategory::Other);
+}
+
+void
+scan_is_summarized(void** state)
+{
+    fs::path const prefix = *static_cast<fs::path*>(*state) / "prefix";
+
+    DiskUsageScanStats stats;
+    DiskUsageScan const scan = scanDiskUsage(prefix, {}, 2, &stats);
+    assert_int_equal(stats.numErrors, 0);
+    assert_int_equal(stats.numDirsReused, 0);
+    assert_int_equal(stats.numDirsListed, scan.size());
+    assert_true(scan.count("drive_c/windows/system32"));
+
+    DiskUsageSummary const summary = summarizeDiskUsage(scan, 2);
+
+    // The hard link is only counted once. The symlink counts, but isn't a file.
+    DiskUsageTotals const& rootTotals = summary.dirTotals.at("");
+    assert_int_equal(rootTotals.numFiles, 4);
+    assert_int_equal(rootTotals.apparentBytes, 1000 + 300'000 + 200'000 + 500'000 + 10);
+    assert_true(rootTotals.allocatedBytes >= rootTotals.apparentBytes);
+
+    DiskUsageTotals const& windowsTotals = summary.dirTotals.at("drive_c/windows");
+    assert_int_equal(windowsTotals.numFiles, 2);
+    assert_int_equal(windowsTotals.apparentBytes, 500'000);
+
+    assert_int_equal(summary.largestFiles.size(), 2);
+    assert_string_equal(
+        summary.largestFiles[0].path.c_str(), "drive_c/Program Files/Game/game-copy.exe");
+    assert_string_equal(
+        summary.largestFiles[1].path.c_str(), "drive_c/windows/system32/kernel32.dll");
+
+    auto const& executables =
+        summary.categoryTotals[static_cast<size_t>(FileCategory::Executables)];
+    assert_int_equal(executables.numFiles, 2);
+    assert_int_equal(executables.apparentBytes, 800'000);
+}
+
+void
+cached_dirs_are_not_listed_again(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state);
+    fs::path const prefix = tempDir / "prefix";
+    fs::path const cacheFile = tempDir / "disk-usage-cache";
+
+    DiskUsageScan const firstScan = scanDiskUsage(prefix, {});
+    writeDiskUsageScan(cacheFile, firstScan);
+    DiskUsageScan const cachedScan = readDiskUsageScan(cacheFile);
+    assert_int_equal(cachedScan.size(), firstScan.size());
+    assert_int_equal(
+        cachedScan.at("drive_c/windows/Fonts").entries.at(0).size,
+        firstScan.at("drive_c/windows/Fonts").entries.at(0).size);
+
+    // Make sure the new file changes the directory's mtime.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    writeFile(prefix / "drive_c" / "windows" / "system32" / "user32.dll", 100'000);
+
+    DiskUsageScanStats stats;
+    DiskUsageScan const secondScan = scanDiskUsage(prefix, cachedScan, 0, &stats);
+    assert_int_equal(stats.numDirsListed, 1);
+    assert_int_equal(stats.numDirsReused, firstScan.size() - 1);
+    assert_int_equal(secondScan.at("drive_c/windows/system32").entries.size(), 2);
+
+    DiskUsageSummary const summary = summarizeDiskUsage(secondScan, 0);
+    assert_int_equal(summary.dirTotals.at("").numFiles, 5);
+
+    assert_true(readDiskUsageScan(tempDir / "no-such-file").empty());
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(files_are_categorized_by_extension),
+        cmocka_unit_test(scan_is_summarized),
+        cmocka_unit_test(cached_dirs_are_not_listed_again),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
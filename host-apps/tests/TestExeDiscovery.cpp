@@ -0,0 +1,457 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ExeDiscovery.h"
+#include "PeFile.h"
+#include "PeIcon.h"
+#include "PeVersionInfo.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * Assembles little-endian binary structures.
+ */
+class ByteBuilder
+{
+public:
+    std::vector<uint8_t> bytes;
+
+    void u8(uint8_t value) { bytes.push_back(value); }
+
+    void u16(uint16_t value)
+    {
+        u8(value & 0xFF);
+        u8(value >> 8);
+    }
+
+    void u32(uint32_t value)
+    {
+        u16(value & 0xFFFF);
+        u16(value >> 16);
+    }
+
+    void zeros(size_t count) { bytes.insert(bytes.end(), count, 0); }
+
+    void alignTo(size_t alignment) { zeros((alignment - bytes.size() % alignment) % alignment); }
+
+    // Only handles ASCII, which is enough for the tests.
+    void utf16(std::string_view str)
+    {
+        for (char ch : str)
+        {
+            u16(static_cast<uint8_t>(ch));
+        }
+        u16(0);
+    }
+
+    void append(std::vector<uint8_t> const& other)
+    {
+        bytes.insert(bytes.end(), other.begin(), other.end());
+    }
+
+    void patchU16(size_t offset, uint16_t value)
+    {
+        bytes[offset] = value & 0xFF;
+        bytes[offset + 1] = value >> 8;
+    }
+
+    void patchU32(size_t offset, uint32_t value)
+    {
+        patchU16(offset, value & 0xFFFF);
+        patchU16(offset + 2, value >> 16);
+    }
+};
+
+uint32_t const kResourceRva = 0x1000;
+
+/**
+ * Builds a VS_VERSIONINFO node with the given value and children.
+ */
+std::vector<uint8_t>
+versionNode(
+    std::string_view key, std::vector<uint8_t> const& value, uint16_t valueLength, uint16_t type,
+    std::vector<std::vector<uint8_t>> const& children)
+{
+    ByteBuilder b;
+    b.u16(0); // wLength, patched below
+    b.u16(valueLength);
+    b.u16(type);
+    b.utf16(key);
+    b.alignTo(4);
+    b.append(value);
+    for (auto const& child : children)
+    {
+        b.alignTo(4);
+        b.append(child);
+    }
+    b.patchU16(0, b.bytes.size());
+    return b.bytes;
+}
+
+std::vector<uint8_t>
+versionStringNode(std::string_view key, std::string_view value)
+{
+    ByteBuilder text;
+    text.utf16(value);
+    return versionNode(key, text.bytes, value.size() + 1, 1, {});
+}
+
+std::vector<uint8_t>
+versionResource(std::vector<std::pair<std::string_view, std::string_view>> const& strings)
+{
+    ByteBuilder fixedFileInfo;
+    fixedFileInfo.u32(0xFEEF04BD);
+    fixedFileInfo.zeros(48);
+
+    std::vector<std::vector<uint8_t>> stringNodes;
+    for (auto const& [key, value] : strings)
+    {
+        stringNodes.push_back(versionStringNode(key, value));
+    }
+
+    std::vector<uint8_t> const stringTable = versionNode("040904b0", {}, 0, 1, stringNodes);
+    std::vector<uint8_t> const stringFileInfo =
+        versionNode("StringFileInfo", {}, 0, 1, {stringTable});
+    return versionNode("VS_VERSION_INFO", fixedFileInfo.bytes, 52, 0, {stringFileInfo});
+}
+
+/**
+ * A 256px icon group with a single (fake) PNG image.
+ */
+std::pair<std::vector<uint8_t>, std::vector<uint8_t>>
+iconResources()
+{
+    ByteBuilder icon;
+    for (uint8_t byte : {0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a}) // The PNG signature
+    {
+        icon.u8(byte);
+    }
+    icon.zeros(100);
+
+    ByteBuilder group;
+    group.u16(0); // idReserved
+    group.u16(1); // idType
+    group.u16(1); // idCount
+    group.u8(0);  // bWidth, 0 meaning 256
+    group.u8(0);  // bHeight
+    group.u8(0);  // bColorCount
+    group.u8(0);  // bReserved
+    group.u16(1); // wPlanes
+    group.u16(32);
+    group.u32(icon.bytes.size());
+    group.u16(1); // nId
+
+    return {group.bytes, icon.bytes};
+}
+
+/**
+ * Builds a resource section with a single resource (ID 1, language 0) of each type.
+ * The types must be in ascending order.
+ */
+std::vector<uint8_t>
+resourceSection(std::vector<std::pair<PeResourceType, std::vector<uint8_t>>> const& resources)
+{
+    size_t const numTypes = resources.size();
+    size_t const rootDirSize = 16 + numTypes * 8;
+    size_t const nameDirsOffset = rootDirSize;
+    size_t const langDirsOffset = nameDirsOffset + numTypes * 24;
+    size_t const dataEntriesOffset = langDirsOffset + numTypes * 24;
+    size_t const dataOffset = dataEntriesOffset + numTypes * 16;
+
+    ByteBuilder b;
+
+    auto appendDir = [&b](uint32_t id, uint32_t target) {
+        b.zeros(12);
+        b.u16(0); // NumberOfNamedEntries
+        b.u16(1); // NumberOfIdEntries
+        b.u32(id);
+        b.u32(target);
+    };
+
+    b.zeros(12);
+    b.u16(0);
+    b.u16(numTypes);
+    for (size_t i = 0; i < numTypes; ++i)
+    {
+        b.u32(static_cast<uint32_t>(resources[i].first));
+        b.u32(0x80000000 | (nameDirsOffset + i * 24));
+    }
+    for (size_t i = 0; i < numTypes; ++i)
+    {
+        appendDir(1, 0x80000000 | (langDirsOffset + i * 24));
+    }
+    for (size_t i = 0; i < numTypes; ++i)
+    {
+        appendDir(0, dataEntriesOffset + i * 16);
+    }
+
+    size_t nextDataOffset = dataOffset;
+    for (auto const& [type, data] : resources)
+    {
+        b.u32(kResourceRva + nextDataOffset);
+        b.u32(data.size());
+        b.u32(0); // CodePage
+        b.u32(0); // Reserved
+        nextDataOffset += (data.size() + 3) & ~size_t(3);
+    }
+
+    for (auto const& [type, data] : resources)
+    {
+        b.append(data);
+        b.alignTo(4);
+    }
+
+    return b.bytes;
+}
+
+/**
+ * Builds a 64-bit PE file with a single .rsrc section.
+ */
+std::vector<uint8_t>
+peFile(uint16_t subsystem, uint16_t characteristics, std::vector<uint8_t> const& resources)
+{
+    uint16_t const optionalHeaderSize = 112 + 16 * 8;
+
+    ByteBuilder b;
+    b.u8('M');
+    b.u8('Z');
+    b.zeros(0x3a);
+    b.u32(0x40); // e_lfanew
+
+    b.u32(0x00004550); // "PE\0\0"
+    b.u16(0x8664);     // Machine
+    b.u16(1);          // NumberOfSections
+    b.zeros(12);
+    b.u16(optionalHeaderSize);
+    b.u16(characteristics);
+
+    size_t const optionalHeaderOffset = b.bytes.size();
+    b.u16(0x20b);
+    b.zeros(optionalHeaderSize - 2);
+    b.patchU16(optionalHeaderOffset + 68, subsystem);
+    b.patchU32(optionalHeaderOffset + 108, 16);
+    b.patchU32(optionalHeaderOffset + 112 + 2 * 8, resources.empty() ? 0 : kResourceRva);
+    b.patchU32(optionalHeaderOffset + 112 + 2 * 8 + 4, resources.size());
+
+    b.u8('.');
+    b.u8('r');
+    b.u8('s');
+    b.u8('r');
+    b.u8('c');
+    b.zeros(3);
+    b.u32(resources.size()); // VirtualSize
+    b.u32(kResourceRva);     // VirtualAddress
+    b.u32(resources.size()); // SizeOfRawData
+    b.u32(kResourceRva);     // PointerToRawData
+    b.zeros(16);
+
+    b.zeros(kResourceRva - b.bytes.size());
+    b.append(resources);
+
+    // Tiny executables are ignored.
+    b.zeros(32 * 1024);
+
+    return b.bytes;
+}
+
+std::vector<uint8_t>
+gameExe()
+{
+    auto const [group, icon] = iconResources();
+    return peFile(
+        PeHeaders::kSubsystemWindowsGui, 0x22,
+        resourceSection({
+            {PeResourceType::Icon, icon},
+            {PeResourceType::GroupIcon, group},
+            {PeResourceType::Version,
+             versionResource({{"FileDescription", "The Game"}, {"ProductName", "Game"}})},
+        }));
+}
+
+void
+writeFile(fs::path const& path, std::vector<uint8_t> const& data)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<char const*>(data.data()), data.size());
+}
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestExeDiscovery.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+    fs::path const driveC = tempDir / "drive_c";
+
+    std::vector<uint8_t> const plainGuiExe = peFile(PeHeaders::kSubsystemWindowsGui, 0x22, {});
+
+    writeFile(driveC / "Program Files" / "Game" / "game.exe", gameExe());
+    writeFile(driveC / "Program Files" / "Game" / "unins000.exe", plainGuiExe);
+    writeFile(driveC / "Program Files" / "Game" / "tools" / "editor.exe", plainGuiExe);
+    writeFile(
+        driveC / "Program Files" / "Game" / "server.exe",
+        peFile(PeHeaders::kSubsystemWindowsCui, 0x22, {}));
+    writeFile(
+        driveC / "Program Files" / "Game" / "plugin.exe",
+        peFile(PeHeaders::kSubsystemWindowsGui, 0x2022, {}));
+    writeFile(driveC / "program files (x86)" / "Game" / "_CommonRedist" / "x.exe", plainGuiExe);
+    writeFile(driveC / "Program Files (x86)" / "Game" / "readme.exe", {'M', 'Z'});
+    writeFile(
+        driveC / "Program Files (x86)" / "Runtime" / "runtime.exe",
+        peFile(
+            PeHeaders::kSubsystemWindowsGui, 0x22,
+            resourceSection(
+                {{PeResourceType::Version,
+                  versionResource({{"ProductName", "Runtime Redistributable"}})}})));
+
+    *state = new fs::path(tempDir);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+void
+pe_headers_and_resources_are_parsed(void**)
+{
+    std::vector<uint8_t> const image = gameExe();
+
+    std::optional<PeHeaders> const headers = parsePeHeaders(std::span(image).first(4096));
+    assert_true(headers.has_value());
+    assert_true(headers->is64Bit);
+    assert_true(headers->isGui());
+    assert_false(headers->isDll());
+    assert_int_equal(headers->sections.size(), 1);
+
+    auto const version = findPeResource(image, *headers, PeResourceType::Version);
+    assert_true(version.has_value());
+
+    auto const strings = parseVersionStrings(*version);
+    assert_int_equal(strings.size(), 2);
+    assert_string_equal(strings.at("FileDescription").c_str(), "The Game");
+    assert_string_equal(strings.at("ProductName").c_str(), "Game");
+
+    assert_false(findPeResource(image, *headers, PeResourceType::Icon, 2).has_value());
+
+    std::optional<PeIconImage> const icon = extractPeIcon(image, *headers);
+    assert_true(icon.has_value());
+    assert_string_equal(icon->format.c_str(), "png");
+    assert_int_equal(icon->size, 256);
+    assert_int_equal(icon->data.size(), 108);
+}
+
+void
+non_pe_files_are_rejected(void**)
+{
+    std::vector<uint8_t> data(4096);
+    assert_false(parsePeHeaders(data).has_value());
+
+    data[0] = 'M';
+    data[1] = 'Z';
+    assert_false(parsePeHeaders(data).has_value());
+
+    // e_lfanew pointing past the end.
+    data[0x3c] = 0xff;
+    data[0x3d] = 0xff;
+    assert_false(parsePeHeaders(data).has_value());
+}
+
+void
+noise_is_recognized(void**)
+{
+    assert_true(isNoiseDirectory("_CommonRedist"));
+    assert_false(isNoiseDirectory("Game"));
+
+    assert_true(isNoiseExecutable("Setup.exe", {}));
+    assert_true(isNoiseExecutable("UnityCrashHandler64.exe", {}));
+    assert_true(isNoiseExecutable(
+        "vc.exe", {{"FileDescription", "Microsoft Visual C++ 2019 Redistributable (x64)"}}));
+    assert_false(isNoiseExecutable("game.exe", {{"ProductName", "Game"}}));
+}
+
+void
+executables_are_discovered_and_ranked(void** state)
+{
+    fs::path const driveC = *static_cast<fs::path*>(*state) / "drive_c";
+
+    std::vector<fs::path> const roots = programFilesDirs(driveC);
+    assert_int_equal(roots.size(), 3);
+
+    std::vector<ExeCandidate> const candidates = discoverExecutables(roots, {});
+    assert_int_equal(candidates.size(), 2);
+
+    assert_true(candidates[0].path == driveC / "Program Files" / "Game" / "game.exe");
+    assert_string_equal(candidates[0].label().c_str(), "The Game");
+    assert_true(candidates[0].icon.has_value());
+
+    assert_true(candidates[1].path == driveC / "Program Files" / "Game" / "tools" / "editor.exe");
+    assert_string_equal(candidates[1].label().c_str(), "editor");
+    assert_false(candidates[1].icon.has_value());
+
+    assert_true(candidates[0].score > candidates[1].score);
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(pe_headers_and_resources_are_parsed),
+        cmocka_unit_test(non_pe_files_are_rejected),
+        cmocka_unit_test(noise_is_recognized),
+        cmocka_unit_test(executables_are_discovered_and_ranked),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
@@ -0,0 +1,71 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HostProbe.h"
+
+#include <filesystem>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <unistd.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+void
+probe_reports_basic_facts(void**)
+{
+    HostProbe const probe = probeHost(fs::temp_directory_path() / "does" / "not" / "exist");
+
+    // A UUID, like 0899c123-2e20-448b-be15-ac463ef60ebb.
+    assert_int_equal(probe.bootId.size(), 36);
+    assert_string_equal(probe.bootId.c_str(), readBootId().c_str());
+
+    assert_int_equal(probe.pageSize, sysconf(_SC_PAGESIZE));
+    assert_false(probe.arch.empty());
+    assert_true(probe.numCpus >= 1);
+}
+
+void
+executables_are_found_in_path(void**)
+{
+    assert_true(isExecutableInPath("sh"));
+    assert_false(isExecutableInPath("surely-no-such-executable"));
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(probe_reports_basic_facts),
+        cmocka_unit_test(executables_are_found_in_path),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
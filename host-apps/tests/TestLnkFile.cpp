@@ -0,0 +1,379 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LnkFile.h"
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace
+{
+
+/**
+ * Assembles little-endian binary structures for feeding to the parser.
+ */
+class ByteBuilder
+{
+public:
+    std::vector<uint8_t> bytes;
+
+    void u8(uint8_t value) { bytes.push_back(value); }
+
+    void u16(uint16_t value)
+    {
+        u8(value & 0xFF);
+        u8(value >> 8);
+    }
+
+    void u32(uint32_t value)
+    {
+        u16(value & 0xFFFF);
+        u16(value >> 16);
+    }
+
+    void zeros(size_t count) { bytes.insert(bytes.end(), count, 0); }
+
+    void ansi(std::string_view str, bool nulTerminate = true)
+    {
+        bytes.insert(bytes.end(), str.begin(), str.end());
+        if (nulTerminate)
+        {
+            u8(0);
+        }
+    }
+
+    // Only handles ASCII, which is enough for the tests.
+    void utf16(std::string_view str, bool nulTerminate = true)
+    {
+        for (char ch : str)
+        {
+            u16(static_cast<uint8_t>(ch));
+        }
+        if (nulTerminate)
+        {
+            u16(0);
+        }
+    }
+
+    void append(std::vector<uint8_t> const& other)
+    {
+        bytes.insert(bytes.end(), other.begin(), other.end());
+    }
+
+    void patchU16(size_t offset, uint16_t value)
+    {
+        bytes[offset] = value & 0xFF;
+        bytes[offset + 1] = value >> 8;
+    }
+
+    void patchU32(size_t offset, uint32_t value)
+    {
+        patchU16(offset, value & 0xFFFF);
+        patchU16(offset + 2, value >> 16);
+    }
+};
+
+uint32_t const kHasLinkTargetIdList = 0x01;
+uint32_t const kHasLinkInfo = 0x02;
+uint32_t const kHasName = 0x04;
+uint32_t const kHasWorkingDir = 0x10;
+uint32_t const kHasArguments = 0x20;
+uint32_t const kHasIconLocation = 0x40;
+uint32_t const kIsUnicode = 0x80;
+uint32_t const kHasExpString = 0x200;
+
+void
+appendHeader(ByteBuilder& b, uint32_t linkFlags, int32_t iconIndex)
+{
+    b.u32(0x4C);
+    uint8_t const clsid[] = {
+        0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46};
+    b.bytes.insert(b.bytes.end(), std::begin(clsid), std::end(clsid));
+    b.u32(linkFlags);
+    b.u32(0x20);             // FileAttributes
+    b.zeros(8 + 8 + 8);      // Creation, access and write times
+    b.u32(0);                // FileSize
+    b.u32(static_cast<uint32_t>(iconIndex));
+    b.u32(1);                // ShowCommand
+    b.zeros(2 + 2 + 4 + 4);  // HotKey and reserved fields
+}
+
+void
+appendAnsiLinkInfo(ByteBuilder& b, std::string_view localBasePath, std::string_view suffix)
+{
+    size_t const start = b.bytes.size();
+    size_t const headerSize = 0x1C;
+
+    b.u32(0); // LinkInfoSize, patched below
+    b.u32(headerSize);
+    b.u32(1); // VolumeIDAndLocalBasePath
+    b.u32(0); // VolumeIDOffset, patched below
+    b.u32(0); // LocalBasePathOffset, patched below
+    b.u32(0); // CommonNetworkRelativeLinkOffset
+    b.u32(0); // CommonPathSuffixOffset, patched below
+
+    b.patchU32(start + 12, static_cast<uint32_t>(b.bytes.size() - start));
+    b.u32(0x10); // VolumeIDSize
+    b.u32(3);    // DRIVE_FIXED
+    b.u32(0x12345678);
+    b.u32(0x10); // VolumeLabelOffset
+    b.u8(0);     // Empty volume label
+    b.zeros(3);
+
+    b.patchU32(start + 16, static_cast<uint32_t>(b.bytes.size() - start));
+    b.ansi(localBasePath);
+
+    b.patchU32(start + 24, static_cast<uint32_t>(b.bytes.size() - start));
+    b.ansi(suffix);
+
+    b.patchU32(start, static_cast<uint32_t>(b.bytes.size() - start));
+}
+
+void
+appendUnicodeStringData(ByteBuilder& b, std::string_view str)
+{
+    b.u16(static_cast<uint16_t>(str.size()));
+    b.utf16(str, false);
+}
+
+void
+appendEnvironmentBlock(ByteBuilder& b, uint32_t signature, std::string_view target)
+{
+    size_t const start = b.bytes.size();
+    b.u32(0x314);
+    b.u32(signature);
+    b.ansi(target);
+    b.zeros(260 - target.size() - 1);
+    b.utf16(target);
+    b.zeros(520 - (target.size() + 1) * 2);
+    assert_int_equal(b.bytes.size() - start, 0x314);
+}
+
+std::vector<uint8_t>
+fileEntryItem(std::string_view shortName, std::string_view longName, bool isDirectory)
+{
+    ByteBuilder item;
+    item.u16(0); // Size, patched below
+    item.u8(isDirectory ? 0x31 : 0x32);
+    item.u8(0);
+    item.u32(0);  // File size
+    item.u32(0);  // Modification time
+    item.u16(isDirectory ? 0x10 : 0x20);
+    item.ansi(shortName);
+    if (item.bytes.size() % 2)
+    {
+        item.u8(0);
+    }
+
+    size_t const extensionStart = item.bytes.size();
+    item.u16(0); // Extension size, patched below
+    item.u16(9); // Version
+    item.u32(0xBEEF0004);
+    item.u32(0); // Creation time
+    item.u32(0); // Access time
+    item.u16(0x2E);
+    item.u16(0);
+    item.zeros(8); // File reference
+    item.zeros(8);
+    item.u16(0); // Long string size
+    item.u32(0); // Version 9 field
+    item.u32(0); // Version 8 field
+    item.utf16(longName);
+    item.u16(static_cast<uint16_t>(extensionStart));
+    item.patchU16(extensionStart, static_cast<uint16_t>(item.bytes.size() - extensionStart));
+
+    item.patchU16(0, static_cast<uint16_t>(item.bytes.size()));
+    return item.bytes;
+}
+
+void
+appendIdList(ByteBuilder& b)
+{
+    ByteBuilder idList;
+
+    // My Computer
+    idList.u16(0x14);
+    idList.u8(0x1F);
+    idList.u8(0x50);
+    uint8_t const myComputerClsid[] = {
+        0xE0, 0x4F, 0xD0, 0x20, 0xEA, 0x3A, 0x69, 0x10,
+        0xA2, 0xD8, 0x08, 0x00, 0x2B, 0x30, 0x30, 0x9D};
+    idList.bytes.insert(idList.bytes.end(), std::begin(myComputerClsid), std::end(myComputerClsid));
+
+    // Volume
+    idList.u16(0x19);
+    idList.u8(0x2F);
+    idList.ansi("C:\\");
+    idList.zeros(0x19 - 3 - 4);
+
+    idList.append(fileEntryItem("PROGRA~1", "Program Files", true));
+    idList.append(fileEntryItem("MYAPP~1", "My App", true));
+    idList.append(fileEntryItem("MYAPP~1.EXE", "My App.exe", false));
+
+    idList.u16(0); // TerminalID
+
+    b.u16(static_cast<uint16_t>(idList.bytes.size()));
+    b.append(idList.bytes);
+}
+
+void
+link_info_and_string_data_are_parsed(void** state)
+{
+    (void)state;
+
+    ByteBuilder b;
+    appendHeader(
+        b, kHasLinkInfo | kHasName | kHasWorkingDir | kHasArguments | kHasIconLocation | kIsUnicode,
+        3);
+    appendAnsiLinkInfo(b, "C:\\Program Files\\App", "app.exe");
+    appendUnicodeStringData(b, "Launches the app");
+    appendUnicodeStringData(b, "C:\\Program Files\\App");
+    appendUnicodeStringData(b, "--fullscreen");
+    appendUnicodeStringData(b, "C:\\Program Files\\App\\app.ico");
+    b.u32(0); // TerminalBlock
+
+    LnkFile const lnk = parseLnkFile(b.bytes);
+
+    assert_true(lnk.targetPath().has_value());
+    assert_string_equal(lnk.targetPath()->c_str(), "C:\\Program Files\\App\\app.exe");
+    assert_false(lnk.idListPath.has_value());
+    assert_string_equal(lnk.description->c_str(), "Launches the app");
+    assert_string_equal(lnk.workingDirectory->c_str(), "C:\\Program Files\\App");
+    assert_string_equal(lnk.arguments->c_str(), "--fullscreen");
+    assert_string_equal(
+        lnk.effectiveIconLocation()->c_str(), "C:\\Program Files\\App\\app.ico");
+    assert_int_equal(lnk.iconIndex, 3);
+}
+
+void
+id_list_uses_long_names(void** state)
+{
+    (void)state;
+
+    ByteBuilder b;
+    appendHeader(b, kHasLinkTargetIdList | kIsUnicode, 0);
+    appendIdList(b);
+
+    LnkFile const lnk = parseLnkFile(b.bytes);
+
+    assert_true(lnk.idListPath.has_value());
+    assert_string_equal(lnk.idListPath->c_str(), "C:\\Program Files\\My App\\My App.exe");
+    assert_string_equal(lnk.targetPath()->c_str(), "C:\\Program Files\\My App\\My App.exe");
+    assert_false(lnk.effectiveIconLocation().has_value());
+}
+
+void
+environment_blocks_take_precedence(void** state)
+{
+    (void)state;
+
+    ByteBuilder b;
+    appendHeader(b, kHasLinkTargetIdList | kHasLinkInfo | kHasIconLocation | kHasExpString, -1);
+    appendIdList(b);
+    appendAnsiLinkInfo(b, "C:\\Program Files\\App", "app.exe");
+    b.u16(static_cast<uint16_t>(std::string_view("C:\\app.ico").size()));
+    b.ansi("C:\\app.ico", false);
+    appendEnvironmentBlock(b, 0xA0000001, "%ProgramFiles%\\App\\app.exe");
+    appendEnvironmentBlock(b, 0xA0000007, "%SystemRoot%\\system32\\shell32.dll");
+    b.u32(0); // TerminalBlock
+
+    LnkFile const lnk = parseLnkFile(b.bytes);
+
+    assert_string_equal(lnk.targetPath()->c_str(), "%ProgramFiles%\\App\\app.exe");
+    assert_string_equal(lnk.linkInfoPath->c_str(), "C:\\Program Files\\App\\app.exe");
+    assert_string_equal(lnk.iconLocation->c_str(), "C:\\app.ico");
+    assert_string_equal(
+        lnk.effectiveIconLocation()->c_str(), "%SystemRoot%\\system32\\shell32.dll");
+    assert_int_equal(lnk.iconIndex, -1);
+}
+
+void
+bad_header_is_rejected(void** state)
+{
+    (void)state;
+
+    ByteBuilder b;
+    appendHeader(b, 0, 0);
+    b.bytes[4] = 0xFF; // Corrupt the CLSID
+
+    bool threw = false;
+    try
+    {
+        parseLnkFile(b.bytes);
+    }
+    catch (std::runtime_error const&)
+    {
+        threw = true;
+    }
+
+    assert_true(threw);
+}
+
+void
+truncated_file_is_rejected(void** state)
+{
+    (void)state;
+
+    ByteBuilder b;
+    appendHeader(b, kHasLinkInfo, 0);
+    appendAnsiLinkInfo(b, "C:\\Program Files\\App", "app.exe");
+    b.bytes.resize(b.bytes.size() - 5);
+
+    bool threw = false;
+    try
+    {
+        parseLnkFile(b.bytes);
+    }
+    catch (std::runtime_error const&)
+    {
+        threw = true;
+    }
+
+    assert_true(threw);
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(link_info_and_string_data_are_parsed),
+        cmocka_unit_test(id_list_uses_long_names),
+        cmocka_unit_test(environment_blocks_take_precedence),
+        cmocka_unit_test(bad_header_is_rejected),
+        cmocka_unit_test(truncated_file_is_rejected),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,181 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PrefixSnapshot.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+struct TestDirs
+{
+    fs::path prefixDir;
+    fs::path snapshotsDir;
+};
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestPrefixSnapshot.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+    fs::path const prefixDir = tempDir / "prefix";
+
+    fs::create_directories(prefixDir / "drive_c" / "windows");
+    fs::create_directories(prefixDir / "dosdevices");
+    std::ofstream(prefixDir / "system.reg") << "WINE REGISTRY Version 2\n";
+    std::ofstream(prefixDir / "drive_c" / "windows" / "win.ini") << "[fonts]\n";
+    fs::create_directory_symlink("../drive_c", prefixDir / "dosdevices" / "c:");
+
+    *state = new TestDirs{prefixDir, tempDir / "snapshots"};
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* dirs = static_cast<TestDirs*>(*state);
+    fs::remove_all(dirs->prefixDir.parent_path());
+    delete dirs;
+    return 0;
+}
+
+std::string
+readFile(fs::path const& path)
+{
+    std::ostringstream contents;
+    contents << std::ifstream(path).rdbuf();
+    return contents.str();
+}
+
+void
+restore_undoes_changes(void** state)
+{
+    auto const& dirs = *static_cast<TestDirs*>(*state);
+
+    std::string const id = createSnapshot(dirs.snapshotsDir, dirs.prefixDir, "clean");
+
+    auto const snapshots = listSnapshots(dirs.snapshotsDir);
+    assert_int_equal(snapshots.size(), 1);
+    assert_string_equal(snapshots[0].id.c_str(), id.c_str());
+    assert_string_equal(snapshots[0].label.c_str(), "clean");
+    assert_int_equal(snapshots[0].numFiles, 2);
+
+    // An installer modifies, adds and removes things.
+    std::ofstream(dirs.prefixDir / "system.reg") << "WINE REGISTRY Version 2\n[Installed]\n";
+    fs::create_directories(dirs.prefixDir / "drive_c" / "Program Files" / "App");
+    std::ofstream(dirs.prefixDir / "drive_c" / "Program Files" / "App" / "app.exe") << "MZ";
+    fs::remove(dirs.prefixDir / "drive_c" / "windows" / "win.ini");
+    fs::remove(dirs.prefixDir / "dosdevices" / "c:");
+    fs::create_directory_symlink("/elsewhere", dirs.prefixDir / "dosdevices" / "c:");
+
+    SnapshotRestoreStats const stats = restoreSnapshot(dirs.snapshotsDir, id, dirs.prefixDir);
+
+    assert_int_equal(stats.numRestored, 3);
+    assert_int_equal(stats.numRemoved, 1);
+    assert_string_equal(
+        readFile(dirs.prefixDir / "system.reg").c_str(), "WINE REGISTRY Version 2\n");
+    assert_string_equal(
+        readFile(dirs.prefixDir / "drive_c" / "windows" / "win.ini").c_str(), "[fonts]\n");
+    assert_false(fs::exists(dirs.prefixDir / "drive_c" / "Program Files"));
+    assert_string_equal(
+        fs::read_symlink(dirs.prefixDir / "dosdevices" / "c:").c_str(), "../drive_c");
+
+    // Nothing left to do the second time.
+    SnapshotRestoreStats const secondStats =
+        restoreSnapshot(dirs.snapshotsDir, id, dirs.prefixDir);
+    assert_int_equal(secondStats.numRestored, 0);
+    assert_int_equal(secondStats.numRemoved, 0);
+
+    deleteSnapshot(dirs.snapshotsDir, id);
+    assert_int_equal(listSnapshots(dirs.snapshotsDir).size(), 0);
+}
+
+void
+rewritten_files_with_same_contents_are_left_alone(void** state)
+{
+    auto const& dirs = *static_cast<TestDirs*>(*state);
+
+    std::string const id = createSnapshot(dirs.snapshotsDir, dirs.prefixDir, "");
+
+    // Same contents, but a new inode and modification time.
+    fs::path const iniPath = dirs.prefixDir / "drive_c" / "windows" / "win.ini";
+    fs::remove(iniPath);
+    std::ofstream(iniPath) << "[fonts]\n";
+
+    SnapshotRestoreStats const stats = restoreSnapshot(dirs.snapshotsDir, id, dirs.prefixDir);
+    assert_int_equal(stats.numRestored, 0);
+    assert_int_equal(stats.numRemoved, 0);
+
+    deleteSnapshot(dirs.snapshotsDir, id);
+}
+
+void
+snapshot_ids_are_validated(void** state)
+{
+    auto const& dirs = *static_cast<TestDirs*>(*state);
+
+    bool threw = false;
+    try
+    {
+        deleteSnapshot(dirs.snapshotsDir, "../prefix");
+    }
+    catch (std::invalid_argument const&)
+    {
+        threw = true;
+    }
+
+    assert_true(threw);
+    assert_true(fs::exists(dirs.prefixDir));
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(restore_undoes_changes),
+        cmocka_unit_test(rewritten_files_with_same_contents_are_left_alone),
+        cmocka_unit_test(snapshot_ids_are_validated),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
@@ -0,0 +1,220 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RegEdit.h"
+#include "RegFile.h"
+#include "RegHiveKey.h"
+
+#include <string>
+#include <string_view>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace
+{
+
+// 2024-01-01 00:00:00 UTC.
+std::time_t const kNow = 1704067200;
+
+std::string_view const kHive = "WINE REGISTRY Version 2\n"
+                               ";; All keys relative to \\\\User\\\\S-1-5-21-0-0-0-1000\n"
+                               "\n"
+                               "#arch=win64\n"
+                               "\n"
+                               "[Control Panel\\\\Desktop] 1700000000\n"
+                               "#time=1da0c0c0c0c0c0c\n"
+                               "\"FontSmoothing\"=\"2\"\n"
+                               "\"LogPixels\"=dword:00000060\n"
+                               "\"UserPreferencesMask\"=hex:9e,1e,07,80,12,00,00,\\\n"
+                               "  00\n"
+                               "\n"
+                               "[Software\\\\Wine\\\\Fonts\\\\Replacements] 1700000000\n"
+                               "#time=1da0c0c0c0c0c0c\n"
+                               "@=\"default\"\n"
+                               "\"\\x5b8b\\x4f53\"=\"Arial\"\n";
+
+/**
+ * Returns the hive with the modification time of the Control Panel\Desktop key set to kNow.
+ */
+std::string
+restampDesktopKey(std::string_view hive)
+{
+    std::string_view const oldHeader = "[Control Panel\\\\Desktop] 1700000000\n"
+                                       "#time=1da0c0c0c0c0c0c\n";
+    std::string_view const newHeader = "[Control Panel\\\\Desktop] 1704067200\n"
+                                       "#time=1da3c457689c000\n";
+
+    std::string restamped(hive);
+    restamped.replace(restamped.find(oldHeader), oldHeader.size(), newHeader);
+    return restamped;
+}
+
+void
+sections_and_values_are_tokenized(void** state)
+{
+    (void)state;
+
+    auto const sections = scanRegKeySections(kHive);
+    assert_int_equal(sections.size(), 2);
+    assert_string_equal(sections[0].path.c_str(), "Control Panel\\Desktop");
+    assert_string_equal(sections[1].path.c_str(), "Software\\Wine\\Fonts\\Replacements");
+    assert_int_equal(sections[0].end, sections[1].begin);
+    assert_int_equal(sections[1].end, kHive.size());
+
+    auto const desktopValues = scanRegValueLines(kHive, sections[0]);
+    assert_int_equal(desktopValues.size(), 3);
+    assert_string_equal(desktopValues[2].name.c_str(), "UserPreferencesMask");
+    assert_string_equal(
+        std::string(desktopValues[2].rawData).c_str(), "hex:9e,1e,07,80,12,00,00,\\\n  00");
+
+    uint32_t logPixels = 0;
+    assert_true(parseRegDword(desktopValues[1].rawData, logPixels));
+    assert_int_equal(logPixels, 96);
+
+    auto const replacementValues = scanRegValueLines(kHive, sections[1]);
+    assert_int_equal(replacementValues.size(), 2);
+    assert_string_equal(replacementValues[0].name.c_str(), "");
+    assert_string_equal(replacementValues[1].name.c_str(), "\u5b8b\u4f53");
+}
+
+void
+strings_survive_an_escaping_round_trip(void** state)
+{
+    (void)state;
+
+    std::string const original = "C:\\Program Files\\\"Quoted\"\n\u00e9\u5b8b[x]";
+    std::string const escaped = escapeRegString(original, "\"[]");
+
+    assert_string_equal(
+        escaped.c_str(),
+        "C:\\\\Program Files\\\\\\\"Quoted\\\"\\n\\x00e9\\x5b8b\\[x\\]");
+    assert_string_equal(unescapeRegString(escaped).c_str(), original.c_str());
+}
+
+void
+existing_values_are_replaced_in_place(void** state)
+{
+    (void)state;
+
+    RegEdit const edit{"control panel\\desktop", "logpixels", formatRegDword(144)};
+    std::string const newHive = applyRegEdit(kHive, edit, kNow);
+
+    std::string expected = restampDesktopKey(kHive);
+    expected.replace(
+        expected.find("\"LogPixels\"=dword:00000060"), 26, "\"logpixels\"=dword:00000090");
+    assert_string_equal(newHive.c_str(), expected.c_str());
+
+    // Setting a value to what it already is changes nothing, not even the timestamps.
+    RegEdit const noopEdit{"Control Panel\\Desktop", "LogPixels", formatRegDword(96)};
+    assert_string_equal(applyRegEdit(kHive, noopEdit, kNow).c_str(), std::string(kHive).c_str());
+}
+
+void
+new_values_are_appended_to_their_key(void** state)
+{
+    (void)state;
+
+    RegEdit const edit{"Control Panel\\Desktop", "Wallpaper", formatRegString("C:\\a.bmp")};
+    std::string const newHive = applyRegEdit(kHive, edit, kNow);
+
+    std::string expected = restampDesktopKey(kHive);
+    expected.insert(expected.find("  00\n") + 5, "\"Wallpaper\"=\"C:\\\\a.bmp\"\n");
+    assert_string_equal(newHive.c_str(), expected.c_str());
+}
+
+void
+new_keys_are_appended_to_the_file(void** state)
+{
+    (void)state;
+
+    RegEdit const edit{"Software\\[Brackets]", "", formatRegExpandString("%WINDIR%")};
+    std::string const newHive = applyRegEdit(kHive, edit, kNow);
+
+    std::string const expected = std::string(kHive) +
+                                 "\n[Software\\\\\\[Brackets\\]] 1704067200\n"
+                                 "#time=1da3c457689c000\n"
+                                 "@=str(2):\"%WINDIR%\"\n";
+    assert_string_equal(newHive.c_str(), expected.c_str());
+
+    // The result must be readable by our own tokenizer.
+    auto const sections = scanRegKeySections(newHive);
+    assert_int_equal(sections.size(), 3);
+    assert_string_equal(sections[2].path.c_str(), "Software\\[Brackets]");
+}
+
+void
+values_are_deleted(void** state)
+{
+    (void)state;
+
+    RegEdit const edit{"Control Panel\\Desktop", "UserPreferencesMask", std::nullopt};
+    std::string const newHive = applyRegEdit(kHive, edit, kNow);
+
+    std::string expected = restampDesktopKey(kHive);
+    size_t const lineBegin = expected.find("\"UserPreferencesMask\"");
+    expected.erase(lineBegin, expected.find("  00\n") + 5 - lineBegin);
+    assert_string_equal(newHive.c_str(), expected.c_str());
+
+    // Deleting something that doesn't exist changes nothing.
+    RegEdit const noopEdit{"No\\Such\\Key", "Value", std::nullopt};
+    assert_string_equal(applyRegEdit(kHive, noopEdit, kNow).c_str(), std::string(kHive).c_str());
+}
+
+void
+root_keys_are_mapped_to_hive_files(void** state)
+{
+    (void)state;
+
+    auto const hkcu = resolveRegHiveKey("/prefix", "HKEY_CURRENT_USER\\Control Panel\\Desktop");
+    assert_true(hkcu.has_value());
+    assert_string_equal(hkcu->hiveFile.c_str(), "/prefix/user.reg");
+    assert_string_equal(hkcu->keyPath.c_str(), "Control Panel\\Desktop");
+
+    auto const hkcr = resolveRegHiveKey("/prefix", "HKCR\\.txt");
+    assert_true(hkcr.has_value());
+    assert_string_equal(hkcr->hiveFile.c_str(), "/prefix/system.reg");
+    assert_string_equal(hkcr->keyPath.c_str(), "Software\\Classes\\.txt");
+
+    assert_false(resolveRegHiveKey("/prefix", "HKEY_USERS\\.Default").has_value());
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(sections_and_values_are_tokenized),
+        cmocka_unit_test(strings_survive_an_escaping_round_trip),
+        cmocka_unit_test(existing_values_are_replaced_in_place),
+        cmocka_unit_test(new_values_are_appended_to_their_key),
+        cmocka_unit_test(new_keys_are_appended_to_the_file),
+        cmocka_unit_test(values_are_deleted),
+        cmocka_unit_test(root_keys_are_mapped_to_hive_files),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,193 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+#include "RegIndex.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+char const kHive[] = "WINE REGISTRY Version 2\n"
+                     ";; All keys relative to \\\\Machine\n"
+                     "\n"
+                     "[Software\\\\Classes\\\\.txt] 1700000000\n"
+                     "@=\"txtfile\"\n"
+                     "\n"
+                     "[Software\\\\Vendor\\\\Uninstall\\\\B] 1700000000\n"
+                     "\"DisplayName\"=\"B\"\n"
+                     "\n"
+                     "[Software\\\\Vendor\\\\Uninstall\\\\a] 1700000000\n"
+                     "\"DisplayName\"=\"a\"\n"
+                     "\n"
+                     "[Software\\\\Vendor\\\\Uninstall\\\\a\\\\Sub] 1\n"
+                     "\n"
+                     "[Software\\\\Vendor\\\\Uninstall2] 1700000000\n"
+                     "\"X\"=\"Y\"\n";
+
+std::string const kUninstallKey = "Software\\Vendor\\Uninstall";
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestRegIndex.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const tempDir = dirTemplate;
+    std::ofstream(tempDir / "system.reg") << kHive;
+
+    *state = new fs::path(tempDir);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+fs::path
+hiveFile(void** state)
+{
+    return *static_cast<fs::path*>(*state) / "system.reg";
+}
+
+void
+keys_are_found_case_insensitively(void** state)
+{
+    MappedFile const hive(hiveFile(state));
+    RegIndex const index(hive, regIndexFileForHive(hiveFile(state)));
+
+    assert_int_equal(index.numKeys(), 5);
+
+    auto const key = index.find("SOFTWARE\\classes\\.TXT");
+    assert_true(key.has_value());
+    assert_string_equal(key->path.c_str(), "Software\\Classes\\.txt");
+    assert_true(key->section.has_value());
+    assert_true(hive.text().substr(key->section->begin).starts_with("[Software\\\\Classes"));
+
+    assert_false(index.find("Software\\Classes\\.tx").has_value());
+    assert_false(index.find("Software\\Nothing").has_value());
+}
+
+void
+parent_keys_without_sections_are_found(void** state)
+{
+    MappedFile const hive(hiveFile(state));
+    RegIndex const index(hive, regIndexFileForHive(hiveFile(state)));
+
+    auto const key = index.find("software\\VENDOR\\uninstall");
+    assert_true(key.has_value());
+    assert_string_equal(key->path.c_str(), kUninstallKey.c_str());
+    assert_false(key->section.has_value());
+}
+
+void
+subkeys_are_listed_once_and_sorted(void** state)
+{
+    MappedFile const hive(hiveFile(state));
+    RegIndex const index(hive, regIndexFileForHive(hiveFile(state)));
+
+    auto const names = index.subkeyNames(kUninstallKey);
+    assert_int_equal(names.size(), 2);
+    assert_string_equal(names[0].c_str(), "a");
+    assert_string_equal(names[1].c_str(), "B");
+
+    auto const rootNames = index.subkeyNames("");
+    assert_int_equal(rootNames.size(), 1);
+    assert_string_equal(rootNames[0].c_str(), "Software");
+}
+
+void
+subtrees_exclude_sibling_prefixes(void** state)
+{
+    MappedFile const hive(hiveFile(state));
+    RegIndex const index(hive, regIndexFileForHive(hiveFile(state)));
+
+    auto const sections = index.subtree(kUninstallKey);
+    assert_int_equal(sections.size(), 3);
+    assert_string_equal(sections[0].path.c_str(), (kUninstallKey + "\\a").c_str());
+    assert_string_equal(sections[1].path.c_str(), (kUninstallKey + "\\a\\Sub").c_str());
+    assert_string_equal(sections[2].path.c_str(), (kUninstallKey + "\\B").c_str());
+}
+
+void
+index_is_reused_until_hive_changes(void** state)
+{
+    fs::path const indexFile = regIndexFileForHive(hiveFile(state));
+    fs::remove(indexFile);
+
+    {
+        MappedFile const hive(hiveFile(state));
+        RegIndex const index(hive, indexFile);
+        assert_true(index.wasRebuilt());
+    }
+
+    {
+        MappedFile const hive(hiveFile(state));
+        RegIndex const index(hive, indexFile);
+        assert_false(index.wasRebuilt());
+    }
+
+    std::ofstream(hiveFile(state), std::ios::app) << "\n[Software\\\\New] 1\n";
+
+    {
+        MappedFile const hive(hiveFile(state));
+        RegIndex const index(hive, indexFile);
+        assert_true(index.wasRebuilt());
+        assert_true(index.find("Software\\New").has_value());
+    }
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(keys_are_found_case_insensitively),
+        cmocka_unit_test(parent_keys_without_sections_are_found),
+        cmocka_unit_test(subkeys_are_listed_once_and_sorted),
+        cmocka_unit_test(subtrees_exclude_sibling_prefixes),
+        cmocka_unit_test(index_is_reused_until_hive_changes),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
@@ -0,0 +1,395 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ContentStore.h"
+#include "TarExtractor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+using Archive = std::vector<uint8_t>;
+
+void
+putOctal(Archive& archive, size_t offset, size_t size, uint64_t value)
+{
+    // Zero-padded to size - 1 digits, followed by a NUL.
+    std::string digits(size - 1, '0');
+    for (size_t i = digits.size(); i > 0 && value != 0; --i, value >>= 3)
+    {
+        digits[i - 1] = static_cast<char>('0' + (value & 7));
+    }
+    std::copy(digits.begin(), digits.end(), archive.begin() + offset);
+    archive[offset + digits.size()] = 0;
+}
+
+void
+addEntry(
+    Archive& archive, std::string const& name, char typeFlag, std::string const& data = "",
+    std::string const& linkName = "", uint32_t mode = 0644)
+{
+    size_t const offset = archive.size();
+    archive.resize(offset + 512);
+
+    std::copy_n(name.begin(), std::min<size_t>(name.size(), 100), archive.begin() + offset);
+    putOctal(archive, offset + 100, 8, mode);
+    putOctal(archive, offset + 124, 12, data.size());
+    putOctal(archive, offset + 136, 12, 1000000000);
+    archive[offset + 156] = static_cast<uint8_t>(typeFlag);
+    std::copy(linkName.begin(), linkName.end(), archive.begin() + offset + 157);
+    std::copy_n("ustar\00000", 8, archive.begin() + offset + 257);
+
+    std::fill_n(archive.begin() + offset + 148, 8, ' ');
+    uint32_t checksum = 0;
+    for (size_t i = offset; i < offset + 512; ++i)
+    {
+        checksum += archive[i];
+    }
+    putOctal(archive, offset + 148, 7, checksum);
+
+    archive.insert(archive.end(), data.begin(), data.end());
+    archive.resize((archive.size() + 511) / 512 * 512);
+}
+
+void
+addEnd(Archive& archive)
+{
+    archive.resize(archive.size() + 1024);
+}
+
+std::string
+paxRecord(std::string const& key, std::string const& value)
+{
+    // The length includes its own digits.
+    size_t const baseLength = key.size() + value.size() + 3;
+    size_t length = baseLength + std::to_string(baseLength).size();
+    length = baseLength + std::to_string(length).size();
+    return std::to_string(length) + " " + key + "=" + value + "\n";
+}
+
+std::string
+readFile(fs::path const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+/**
+ * Feeds the archive in small chunks that don't line up with tar blocks.
+ */
+TarExtractionStats
+extract(Archive const& archive, fs::path const& destDir, ContentStore* store = nullptr)
+{
+    fs::create_directories(destDir);
+    TarExtractor extractor(destDir, store);
+
+    std::span<uint8_t const> remaining = archive;
+    while (!remaining.empty())
+    {
+        size_t const size = std::min<size_t>(remaining.size(), 777);
+        extractor.consume(remaining.first(size));
+        remaining = remaining.subspan(size);
+    }
+
+    extractor.finish();
+    return extractor.stats();
+}
+
+int
+setUpTempDir(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestTarExtractor.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    *state = new fs::path(dirTemplate);
+    return 0;
+}
+
+int
+tearDownTempDir(void** state)
+{
+    auto* tempDir = static_cast<fs::path*>(*state);
+    std::error_code ec;
+    fs::permissions(
+        *tempDir / "basic" / "bin" / "ro", fs::perms::owner_all, fs::perm_options::add, ec);
+    fs::remove_all(*tempDir);
+    delete tempDir;
+    return 0;
+}
+
+void
+extracts_files_dirs_and_links(void** state)
+{
+    fs::path const destDir = *static_cast<fs::path*>(*state) / "basic";
+
+    Archive archive;
+    addEntry(archive, "./bin/", '5', "", "", 0755);
+    addEntry(archive, "./bin/wine", '0', std::string(3000, 'w'), "", 0755);
+    addEntry(archive, "./bin/wine64", '2', "", "wine");
+    addEntry(archive, "./bin/wine-copy", '1', "", "./bin/wine");
+    addEntry(archive, "./bin/ro/", '5', "", "", 0555);
+    addEntry(archive, "./share/empty", '0');
+    addEntry(archive, "./dev/null", '3');
+    addEnd(archive);
+
+    TarExtractionStats const stats = extract(archive, destDir);
+
+    assert_int_equal(stats.numFiles, 2);
+    assert_int_equal(stats.numDirs, 2);
+    assert_int_equal(stats.numSymlinks, 1);
+    assert_int_equal(stats.numHardlinks, 1);
+    assert_int_equal(stats.numSkipped, 1);
+    assert_int_equal(stats.numBytes, 3000);
+
+    assert_true(readFile(destDir / "bin" / "wine") == std::string(3000, 'w'));
+    assert_true(readFile(destDir / "share" / "empty").empty());
+    assert_true(fs::read_symlink(destDir / "bin" / "wine64") == "wine");
+    assert_true(fs::equivalent(destDir / "bin" / "wine", destDir / "bin" / "wine-copy"));
+    assert_false(fs::exists(destDir / "dev" / "null"));
+
+    assert_true(
+        fs::status(destDir / "bin" / "wine").permissions() ==
+        static_cast<fs::perms>(0755));
+    assert_true(
+        fs::status(destDir / "bin" / "ro").permissions() == static_cast<fs::perms>(0555));
+
+    // Directory modification times are set after everything inside is extracted.
+    struct stat dirStat;
+    assert_int_equal(stat((destDir / "bin").c_str(), &dirStat), 0);
+    assert_int_equal(dirStat.st_mtime, 1000000000);
+}
+
+void
+long_names_are_honored(void** state)
+{
+    fs::path const destDir = *static_cast<fs::path*>(*state) / "long_names";
+    std::string const gnuName = "lib/" + std::string(150, 'g') + ".dll";
+    std::string const paxName = "lib/" + std::string(150, 'p') + ".dll";
+
+    Archive archive;
+    addEntry(archive, "././@LongLink", 'L', gnuName + '\0');
+    addEntry(archive, "truncated", '0', "gnu");
+    addEntry(archive, "PaxHeaders/x", 'x', paxRecord("path", paxName));
+    addEntry(archive, "truncated", '0', "pax");
+    addEnd(archive);
+
+    extract(archive, destDir);
+
+    assert_true(readFile(destDir / gnuName) == "gnu");
+    assert_true(readFile(destDir / paxName) == "pax");
+    assert_false(fs::exists(destDir / "truncated"));
+}
+
+void
+parent_dir_components_are_rejected(void** state)
+{
+    fs::path const destDir = *static_cast<fs::path*>(*state) / "parent_dir";
+
+    Archive archive;
+    addEntry(archive, "lib/../../escaped", '0', "data");
+    addEnd(archive);
+
+    bool thrown = false;
+    try
+    {
+        extract(archive, destDir);
+    }
+    catch (std::runtime_error const&)
+    {
+        thrown = true;
+    }
+
+    assert_true(thrown);
+    assert_false(fs::exists(destDir.parent_path() / "escaped"));
+}
+
+void
+hard_links_through_symlinks_are_rejected(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state) / "hardlink_through_symlink";
+    fs::path const destDir = tempDir / "dest";
+    fs::path const outsideFile = tempDir / "outside" / ".bashrc";
+
+    fs::create_directories(outsideFile.parent_path());
+    std::ofstream(outsideFile) << "outside";
+
+    Archive archive;
+    addEntry(archive, "a", '2', "", "../outside");
+    addEntry(archive, "x", '1', "", "a/.bashrc");
+    addEntry(archive, "x", '0', "overwritten");
+    addEnd(archive);
+
+    bool thrown = false;
+    try
+    {
+        extract(archive, destDir);
+    }
+    catch (std::runtime_error const&)
+    {
+        thrown = true;
+    }
+
+    assert_true(thrown);
+    assert_false(fs::exists(destDir / "x"));
+    assert_int_equal(fs::hard_link_count(outsideFile), 1);
+    assert_true(readFile(outsideFile) == "outside");
+}
+
+void
+files_replace_existing_links(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state) / "replace_links";
+    fs::path const destDir = tempDir / "dest";
+    fs::path const outsideFile = tempDir / "outside";
+
+    // Left behind by an earlier extraction into the same directory.
+    fs::create_directories(destDir);
+    std::ofstream(outsideFile) << "outside";
+    fs::create_hard_link(outsideFile, destDir / "x");
+
+    Archive archive;
+    addEntry(archive, "x", '0', "overwritten");
+    addEntry(archive, "lib/a", '0', "a");
+    addEntry(archive, "y", '1', "", "lib/a");
+    addEntry(archive, "y", '0', "overwritten");
+    addEnd(archive);
+
+    extract(archive, destDir);
+
+    assert_true(readFile(outsideFile) == "outside");
+    assert_true(readFile(destDir / "x") == "overwritten");
+    assert_true(readFile(destDir / "lib" / "a") == "a");
+    assert_true(readFile(destDir / "y") == "overwritten");
+    assert_false(fs::equivalent(destDir / "lib" / "a", destDir / "y"));
+}
+
+void
+corrupted_header_is_rejected(void** state)
+{
+    fs::path const destDir = *static_cast<fs::path*>(*state) / "corrupted";
+
+    Archive archive;
+    addEntry(archive, "file", '0', "data");
+    addEnd(archive);
+    archive[0] = 'F';
+
+    bool thrown = false;
+    try
+    {
+        extract(archive, destDir);
+    }
+    catch (std::runtime_error const&)
+    {
+        thrown = true;
+    }
+
+    assert_true(thrown);
+}
+
+void
+truncated_archive_is_rejected(void** state)
+{
+    fs::path const destDir = *static_cast<fs::path*>(*state) / "truncated";
+
+    Archive archive;
+    addEntry(archive, "file", '0', std::string(2000, 'd'));
+    archive.resize(1000);
+
+    bool thrown = false;
+    try
+    {
+        extract(archive, destDir);
+    }
+    catch (std::runtime_error const&)
+    {
+        thrown = true;
+    }
+
+    assert_true(thrown);
+}
+
+void
+files_known_to_the_store_are_linked(void** state)
+{
+    fs::path const tempDir = *static_cast<fs::path*>(*state) / "store";
+    ContentStore store(tempDir / "store");
+
+    Archive archive;
+    addEntry(archive, "bin/wine", '0', std::string(3000, 'w'), "", 0755);
+    addEntry(archive, "share/empty", '0');
+    addEnd(archive);
+
+    TarExtractionStats stats = extract(archive, tempDir / "wine-9.0", &store);
+    assert_int_equal(stats.numFilesFromStore, 0);
+
+    stats = extract(archive, tempDir / "wine-9.1", &store);
+    assert_int_equal(stats.numFiles, 2);
+    assert_int_equal(stats.numFilesFromStore, 1);
+    assert_int_equal(stats.numBytesFromStore, 3000);
+
+    fs::path const wine90 = tempDir / "wine-9.0" / "bin" / "wine";
+    fs::path const wine91 = tempDir / "wine-9.1" / "bin" / "wine";
+    assert_true(fs::equivalent(wine90, wine91));
+    assert_true(readFile(wine91) == std::string(3000, 'w'));
+    assert_true(fs::status(wine91).permissions() == static_cast<fs::perms>(0555));
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(extracts_files_dirs_and_links),
+        cmocka_unit_test(long_names_are_honored),
+        cmocka_unit_test(parent_dir_components_are_rejected),
+        cmocka_unit_test(hard_links_through_symlinks_are_rejected),
+        cmocka_unit_test(files_replace_existing_links),
+        cmocka_unit_test(corrupted_header_is_rejected),
+        cmocka_unit_test(truncated_archive_is_rejected),
+        cmocka_unit_test(files_known_to_the_store_are_linked),
+    };
+
+    return cmocka_run_group_tests(tests, setUpTempDir, tearDownTempDir);
+}
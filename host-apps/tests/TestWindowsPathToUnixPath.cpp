@@ -0,0 +1,141 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WindowsPathToUnixPath.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+// cmocka is a C library.
+extern "C"
+{
+#include <cmocka.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * Creates a skeleton of a Wine prefix in a temporary directory.
+ */
+int
+setUpPrefix(void** state)
+{
+    std::string dirTemplate = (fs::temp_directory_path() / "TestWindowsPathToUnixPath.XXXXXX");
+    if (!mkdtemp(dirTemplate.data()))
+    {
+        return -1;
+    }
+
+    fs::path const prefixDir = dirTemplate;
+
+    fs::create_directories(prefixDir / "dosdevices");
+    fs::create_directories(prefixDir / "drive_c" / "Program Files" / "My App");
+    fs::create_directories(prefixDir / "drive_c" / "users" / "Public");
+    fs::create_directories(prefixDir / "drive_c" / "users" / "someone" / "AppData" / "Roaming");
+    fs::create_directory_symlink("../drive_c", prefixDir / "dosdevices" / "c:");
+    std::ofstream(prefixDir / "drive_c" / "Program Files" / "My App" / "App.exe");
+
+    *state = new fs::path(prefixDir);
+    return 0;
+}
+
+int
+tearDownPrefix(void** state)
+{
+    auto* prefixDir = static_cast<fs::path*>(*state);
+    fs::remove_all(*prefixDir);
+    delete prefixDir;
+    return 0;
+}
+
+fs::path const&
+prefixDir(void** state)
+{
+    return *static_cast<fs::path*>(*state);
+}
+
+void
+path_components_are_matched_case_insensitively(void** state)
+{
+    auto const unixPath =
+        windowsPathToUnixPath(prefixDir(state), "c:\\PROGRAM FILES\\my app\\app.EXE");
+
+    assert_true(unixPath.has_value());
+    assert_string_equal(
+        unixPath->c_str(),
+        (prefixDir(state) / "dosdevices/c:/Program Files/My App/App.exe").c_str());
+}
+
+void
+missing_components_are_kept_as_is(void** state)
+{
+    auto const unixPath =
+        windowsPathToUnixPath(prefixDir(state), "C:/Program Files/Other App/./../New App/x.exe");
+
+    assert_true(unixPath.has_value());
+    assert_string_equal(
+        unixPath->c_str(),
+        (prefixDir(state) / "dosdevices/c:/Program Files/New App/x.exe").c_str());
+}
+
+void
+environment_variables_are_expanded(void** state)
+{
+    assert_string_equal(
+        expandWindowsEnvVars(prefixDir(state), "%programfiles%\\My App\\%UNKNOWN%\\%windir%")
+            .c_str(),
+        "C:\\Program Files\\My App\\%UNKNOWN%\\C:\\windows");
+
+    // The profile directory is detected from the prefix, unless it matches $USER.
+    setenv("USER", "nobody-in-particular", 1);
+    assert_string_equal(
+        expandWindowsEnvVars(prefixDir(state), "%APPDATA%\\app.ini").c_str(),
+        "C:\\users\\someone\\AppData\\Roaming\\app.ini");
+}
+
+void
+unmappable_paths_are_rejected(void** state)
+{
+    assert_false(windowsPathToUnixPath(prefixDir(state), "relative\\path.exe").has_value());
+    assert_false(windowsPathToUnixPath(prefixDir(state), "\\\\server\\share\\a.exe").has_value());
+    assert_false(windowsPathToUnixPath(prefixDir(state), "Q:\\a.exe").has_value());
+}
+
+} // namespace
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(path_components_are_matched_case_insensitively),
+        cmocka_unit_test(missing_components_are_kept_as_is),
+        cmocka_unit_test(environment_variables_are_expanded),
+        cmocka_unit_test(unmappable_paths_are_rejected),
+    };
+
+    return cmocka_run_group_tests(tests, setUpPrefix, tearDownPrefix);
+}
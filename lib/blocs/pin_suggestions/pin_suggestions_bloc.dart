@@ -0,0 +1,276 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:bloc/bloc.dart';
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+import 'package:path/path.dart' as path;
+import 'package:winebar/exceptions/generic_exception.dart';
+import 'package:winebar/models/pin_suggestion.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/services/utility_service.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
+import 'package:winebar/utils/recursive_delete_and_log_errors.dart';
+import 'package:winebar/utils/startup_data.dart';
+
+import 'pin_suggestions_state.dart';
+
+/// Looks for executables worth pinning in a prefix with exe-discovery and
+/// lnk-resolver, neither of which needs Wine to be running.
+class PinSuggestionsBloc extends Cubit<PinSuggestionsState> {
+  final logger = GetIt.I.get<Logger>();
+  final StartupData startupData;
+  final WinePrefix winePrefix;
+
+  /// Where exe-discovery writes the icons of the suggestions. It's deleted
+  /// when the bloc is closed.
+  Directory? _iconsDir;
+
+  PinSuggestionsBloc({required this.startupData, required this.winePrefix})
+    : super(const PinSuggestionsState.initialState()) {
+    unawaited(_findSuggestions());
+  }
+
+  Future<void> _findSuggestions() async {
+    try {
+      final wineInstDescriptor = await GetIt.I
+          .get<UtilityService>()
+          .wineInstallationDescriptorForWineInstallDir(
+            winePrefix.descriptor.getAbsPathToWineInstall(
+              toplevelDataDir: startupData.localStoragePaths.toplevelDataDir,
+            ),
+          );
+
+      final innermostPrefixDir = wineInstDescriptor.getInnermostPrefixDir(
+        prefixDirStructure: winePrefix.dirStructure,
+      );
+
+      final executableSuggestions = await _runExeDiscovery(
+        driveCDir: path.join(innermostPrefixDir, 'drive_c'),
+      );
+
+      final shortcutSuggestions = await _resolveShortcuts(
+        innermostPrefixDir: innermostPrefixDir,
+        executableSuggestions: executableSuggestions,
+      );
+
+      // Shortcuts go first, as they are the entry points the installers
+      // themselves advertise. The executables they point to are not listed
+      // a second time.
+      final shortcutTargets = {
+        for (final shortcut in shortcutSuggestions) shortcut.targetPath,
+      };
+      final suggestions = [
+        ...shortcutSuggestions.map((s) => s.suggestion),
+        ...executableSuggestions.where(
+          (s) => !shortcutTargets.contains(s.executablePath),
+        ),
+      ];
+
+      if (!isClosed) {
+        emit(
+          state.copyWith(
+            status: PinSuggestionsStatus.succeeded,
+            suggestions: suggestions,
+          ),
+        );
+      }
+    } catch (e, stackTrace) {
+      logger.e(
+        'Failed to look for executables to pin',
+        error: e,
+        stackTrace: stackTrace,
+      );
+
+      if (!isClosed) {
+        emit(
+          state.copyWith(
+            status: PinSuggestionsStatus.failed,
+            failureMessageGetter: () => e.toString(),
+          ),
+        );
+      }
+    }
+  }
+
+  Future<List<PinSuggestion>> _runExeDiscovery({
+    required String driveCDir,
+  }) async {
+    final iconsDir = _iconsDir = await Directory(
+      startupData.localStoragePaths.tempDir,
+    ).createTemp('pin-suggestions-');
+
+    final processResult = await Process.run(
+      LocalStoragePaths.exeDiscoveryPath,
+      ['--icons-dir', iconsDir.path, driveCDir],
+    );
+
+    if (processResult.exitCode != 0) {
+      throw GenericException(
+        'exe-discovery exited with code ${processResult.exitCode}: '
+        '${processResult.stderr}',
+      );
+    }
+
+    // This is to be kept in sync with exe-discovery.cpp
+    final candidates = (jsonDecode(processResult.stdout as String) as List)
+        .cast<Map<String, dynamic>>();
+
+    return [
+      for (final candidate in candidates)
+        PinSuggestion(
+          label: candidate['label'] as String,
+          executablePath: candidate['path'] as String,
+          iconFilePath: candidate['icon'] as String?,
+        ),
+    ];
+  }
+
+  /// Resolves the .lnk files on the desktops and in the start menus of the
+  /// prefix with lnk-resolver. A shortcut borrows the icon of the matching
+  /// executable suggestion, if there is one.
+  Future<List<({PinSuggestion suggestion, String targetPath})>>
+  _resolveShortcuts({
+    required String innermostPrefixDir,
+    required List<PinSuggestion> executableSuggestions,
+  }) async {
+    final lnkFiles = await _findLnkFiles(
+      driveCDir: path.join(innermostPrefixDir, 'drive_c'),
+    );
+    if (lnkFiles.isEmpty) {
+      return [];
+    }
+
+    final processResult = await Process.run(
+      LocalStoragePaths.lnkResolverPath,
+      [innermostPrefixDir, ...lnkFiles],
+    );
+
+    if (processResult.exitCode != 0) {
+      logger.w(
+        'lnk-resolver exited with code ${processResult.exitCode}: '
+        '${processResult.stderr}',
+      );
+      return [];
+    }
+
+    final iconsByExecutablePath = {
+      for (final suggestion in executableSuggestions)
+        suggestion.executablePath: suggestion.iconFilePath,
+    };
+
+    // This is to be kept in sync with lnk-resolver.cpp
+    final resolvedShortcuts =
+        (jsonDecode(processResult.stdout as String) as List)
+            .cast<Map<String, dynamic>>();
+
+    final result = <({PinSuggestion suggestion, String targetPath})>[];
+    final seenTargetPaths = <String>{};
+
+    for (final shortcut in resolvedShortcuts) {
+      final error = shortcut['error'] as String?;
+      if (error != null) {
+        logger.w('Failed to resolve ${shortcut['lnkFile']}: $error');
+        continue;
+      }
+
+      final targetPath = shortcut['unixTargetPath'] as String?;
+      if (targetPath == null ||
+          !targetPath.toLowerCase().endsWith('.exe') ||
+          !await File(targetPath).exists() ||
+          !seenTargetPaths.add(targetPath)) {
+        continue;
+      }
+
+      result.add((
+        suggestion: PinSuggestion(
+          label: shortcut['label'] as String,
+          executablePath: shortcut['lnkFile'] as String,
+          iconFilePath: iconsByExecutablePath[targetPath],
+        ),
+        targetPath: targetPath,
+      ));
+    }
+
+    return result;
+  }
+
+  static Future<List<String>> _findLnkFiles({required String driveCDir}) async {
+    final shortcutDirs = [
+      path.join(driveCDir, 'ProgramData', 'Microsoft', 'Windows', 'Start Menu'),
+    ];
+
+    final usersDir = Directory(path.join(driveCDir, 'users'));
+    if (await usersDir.exists()) {
+      await for (final userDir in usersDir.list(followLinks: false)) {
+        if (userDir is! Directory) {
+          continue;
+        }
+
+        shortcutDirs.add(path.join(userDir.path, 'Desktop'));
+        shortcutDirs.add(
+          path.join(
+            userDir.path,
+            'AppData',
+            'Roaming',
+            'Microsoft',
+            'Windows',
+            'Start Menu',
+          ),
+        );
+      }
+    }
+
+    final lnkFiles = <String>[];
+
+    for (final shortcutDir in shortcutDirs) {
+      final dir = Directory(shortcutDir);
+      if (!await dir.exists()) {
+        continue;
+      }
+
+      // The desktop directory may be a symlink to the desktop of the host
+      // user. The root is followed, but nothing below it.
+      await for (final entity in dir.list(
+        recursive: true,
+        followLinks: false,
+      )) {
+        if (entity is File &&
+            path.extension(entity.path).toLowerCase() == '.lnk') {
+          lnkFiles.add(entity.path);
+        }
+      }
+    }
+
+    return lnkFiles;
+  }
+
+  @override
+  Future<void> close() async {
+    final iconsDir = _iconsDir;
+    if (iconsDir != null) {
+      await recursiveDeleteAndLogErrors(iconsDir);
+    }
+
+    return super.close();
+  }
+}
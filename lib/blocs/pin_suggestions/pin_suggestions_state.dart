@@ -0,0 +1,63 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'package:equatable/equatable.dart';
+import 'package:flutter/foundation.dart';
+import 'package:winebar/models/pin_suggestion.dart';
+
+enum PinSuggestionsStatus { searching, succeeded, failed }
+
+@immutable
+class PinSuggestionsState extends Equatable {
+  final PinSuggestionsStatus status;
+
+  /// The most likely candidates come first.
+  final List<PinSuggestion> suggestions;
+
+  final String? failureMessage;
+
+  const PinSuggestionsState({
+    required this.status,
+    required this.suggestions,
+    required this.failureMessage,
+  });
+
+  const PinSuggestionsState.initialState()
+    : this(
+        status: PinSuggestionsStatus.searching,
+        suggestions: const [],
+        failureMessage: null,
+      );
+
+  @override
+  List<Object?> get props => [status, suggestions, failureMessage];
+
+  PinSuggestionsState copyWith({
+    PinSuggestionsStatus? status,
+    List<PinSuggestion>? suggestions,
+    ValueGetter<String?>? failureMessageGetter,
+  }) {
+    return PinSuggestionsState(
+      status: status ?? this.status,
+      suggestions: suggestions ?? this.suggestions,
+      failureMessage: failureMessageGetter != null
+          ? failureMessageGetter()
+          : failureMessage,
+    );
+  }
+}
@@ -25,9 +25,8 @@ import 'package:logger/logger.dart';
 import 'package:winebar/models/pinned_executable.dart';
 import 'package:winebar/models/wine_prefix.dart';
 import 'package:winebar/repositories/running_executables_repo.dart';
-import 'package:winebar/services/utility_service.dart';
+import 'package:winebar/services/pin_launch_service.dart';
 import 'package:winebar/services/wine_process_runner_service.dart';
-import 'package:winebar/utils/command_line_to_wine_args.dart';
 import 'package:winebar/utils/startup_data.dart';
 
 import 'pinned_executable_state.dart';
@@ -36,6 +35,7 @@ class PinnedExecutableBloc extends Cubit<PinnedExecutableState> {
   final logger = GetIt.I.get<Logger>();
   final runningPinnedExecutablesRepo = GetIt.I
       .get<RunningExecutablesRepo<PinnedExecutable>>();
+  final pinLaunchService = GetIt.I.get<PinLaunchService>();
   final StartupData startupData;
   final WinePrefix winePrefix;
   final PinnedExecutable pinnedExecutable;
@@ -47,18 +47,36 @@ class PinnedExecutableBloc extends Cubit<PinnedExecutableState> {
     required this.winePrefix,
     required this.pinnedExecutable,
   }) : super(PinnedExecutableState.defaultState()) {
-    final runningProcess = runningPinnedExecutablesRepo.tryFindRunningProcess(
-      prefix: winePrefix,
-      slot: pinnedExecutable,
-    );
+    _attachToProcessStartedElsewhere();
 
-    if (runningProcess != null) {
-      _attachToRunningProcess(runningProcess);
-    }
+    // The process may also get started by `winebar --launch`, in which case
+    // the request is forwarded to PinLaunchService.
+    runningPinnedExecutablesRepo.addListener(_attachToProcessStartedElsewhere);
+
+    // This keeps launch.json in line with the prefix settings, as the bloc
+    // is re-created whenever those change.
+    unawaited(
+      pinLaunchService
+          .writeLaunchFile(
+            winePrefix: winePrefix,
+            pinnedExecutable: pinnedExecutable,
+          )
+          .catchError((e, stackTrace) {
+            logger.w(
+              'Failed to write ${pinnedExecutable.launchJsonFilePath}',
+              error: e,
+              stackTrace: stackTrace,
+            );
+          }),
+    );
   }
 
   @override
   Future<void> close() async {
+    runningPinnedExecutablesRepo.removeListener(
+      _attachToProcessStartedElsewhere,
+    );
+
     if (_cancellableProcessResultGetter != null) {
       await _cancellableProcessResultGetter!.cancel();
       _cancellableProcessResultGetter = null;
@@ -66,6 +84,21 @@ class PinnedExecutableBloc extends Cubit<PinnedExecutableState> {
     return super.close();
   }
 
+  void _attachToProcessStartedElsewhere() {
+    if (_runningProcess != null) {
+      return;
+    }
+
+    final runningProcess = runningPinnedExecutablesRepo.tryFindRunningProcess(
+      prefix: winePrefix,
+      slot: pinnedExecutable,
+    );
+
+    if (runningProcess != null) {
+      _attachToRunningProcess(runningProcess);
+    }
+  }
+
   void _attachToRunningProcess(WineProcess runningProcess) {
     assert(_runningProcess == null);
     assert(_cancellableProcessResultGetter == null);
@@ -74,7 +107,7 @@ class PinnedExecutableBloc extends Cubit<PinnedExecutableState> {
     _runningProcess = runningProcess;
 
     if (!state.isRunning) {
-      // This happens when we are called from a constructor.
+      // This happens when the process was started elsewhere.
       emit(state.copyWith(isRunning: true));
     }
 
@@ -124,14 +157,19 @@ class PinnedExecutableBloc extends Cubit<PinnedExecutableState> {
     emit(state.copyWith(isRunning: true));
 
     unawaited(
-      _startProcess()
+      pinLaunchService
+          .startPinnedExecutable(
+            winePrefix: winePrefix,
+            pinnedExecutable: pinnedExecutable,
+          )
           .then((runningProcess) {
+            // This gets us attached to it through
+            // _attachToProcessStartedElsewhere().
             runningPinnedExecutablesRepo.addRunningProcess(
               prefix: winePrefix,
               slot: pinnedExecutable,
               wineProcess: runningProcess,
             );
-            _attachToRunningProcess(runningProcess);
           })
           .catchError((e, stackTrace) {
             logger.w(
@@ -145,43 +183,4 @@ class PinnedExecutableBloc extends Cubit<PinnedExecutableState> {
           }),
     );
   }
-
-  Future<WineProcess> _startProcess() async {
-    final utilityService = GetIt.I.get<UtilityService>();
-
-    final wineInstDescriptor = await utilityService
-        .wineInstallationDescriptorForWineInstallDir(
-          winePrefix.descriptor.getAbsPathToWineInstall(
-            toplevelDataDir: startupData.localStoragePaths.toplevelDataDir,
-          ),
-        );
-
-    List<String> wineArgsForLaunchingExecutable(String executablePath) {
-      return commandLineToWineArgs([executablePath]);
-    }
-
-    final processOutputDir = await startupData.localStoragePaths
-        .createProcessOutputDir();
-
-    final wineProcess = await startupData.wineProcessRunnerService.start(
-      processOutputDir: processOutputDir,
-      commandLine: wineInstDescriptor.buildWineInvocationCommand(
-        winePrefix: winePrefix,
-        wineArgs: wineArgsForLaunchingExecutable(
-          pinnedExecutable.windowsPathToExecutable,
-        ),
-      ),
-      envVars: wineInstDescriptor.getEnvVarsForWine(
-        winePrefix: winePrefix,
-        processOutputDir: processOutputDir.path,
-        forWinetricks: false,
-
-        // For maximum performance, we disable capturing logs from pinned
-        // executables.
-        disableLogs: true,
-      ),
-    );
-
-    return wineProcess;
-  }
 }
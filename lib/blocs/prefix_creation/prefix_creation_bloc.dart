@@ -34,6 +34,7 @@ import 'package:winebar/repositories/running_executables_repo.dart';
 import 'package:winebar/services/app_settings_service.dart';
 import 'package:winebar/services/utility_service.dart';
 import 'package:winebar/utils/get_single_child_dir.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
 import 'package:winebar/utils/prefix_descriptor.dart';
 import 'package:winebar/utils/recursive_delete_and_log_errors.dart';
 import 'package:winebar/utils/startup_data.dart';
@@ -457,7 +458,7 @@ class PrefixCreationBloc extends Cubit<PrefixCreationState> {
       final wineInstDescriptor = await utilityService
           .wineInstallationDescriptorForWineInstallDir(wineInstallDir.path);
 
-      await Directory(prefixDirStructure.innerDir).create(recursive: true);
+      await Directory(prefixDirStructure.outerDir).create(recursive: true);
 
       final relWineInstallPath = path.relative(
         wineInstallDir.path,
@@ -469,6 +470,7 @@ class PrefixCreationBloc extends Cubit<PrefixCreationState> {
         relPathToWineInstall: relWineInstallPath,
         hiDpiScale: state.hiDpiScale,
         wow64ModePreferred: state.wow64ModePreferred,
+        warmUpOnOpen: false,
       );
 
       final winePrefix = WinePrefix(
@@ -479,24 +481,49 @@ class PrefixCreationBloc extends Cubit<PrefixCreationState> {
       final runningSpecialExecutablesRepo = GetIt.I
           .get<RunningExecutablesRepo<SpecialExecutableSlot>>();
 
-      // Plain Wine installations (doesn't apply to Proton ones) show GUI
-      // dialogs at prefix creation time. Ideally, we want our HiDPI settings
-      // to apply to those dialogs as well. To set the HiDPI settings in a proper
-      // way, we have to have a prefix already created, which creates a chicken
-      // and egg situation. This method applies those settings in a hacky way,
-      // without the need to hace a prefix already created. Below, we apply
-      // them again the proper way, just in case.
-      await _preApplyHiDpiSettings(
-        wineInstDescriptor: wineInstDescriptor,
+      final prefixTemplateDir = startupData.localStoragePaths
+          .getPrefixTemplateDir(
+            relPathToWineInstall: relWineInstallPath,
+            wow64ModePreferred: state.wow64ModePreferred,
+          );
+
+      // Cloning a template takes seconds, while "wineboot -u" takes tens
+      // of seconds, and much longer under FEX.
+      final clonedFromTemplate = await _tryCloningPrefixTemplate(
+        prefixTemplateDir: prefixTemplateDir,
         prefixDirStructure: prefixDirStructure,
       );
 
-      // Populate the prefix directory.
-      await _initializeWinePrefix(
-        winePrefix: winePrefix,
-        wineInstDescriptor: wineInstDescriptor,
-        runningSpecialExecutablesRepo: runningSpecialExecutablesRepo,
-      );
+      if (!clonedFromTemplate) {
+        await Directory(prefixDirStructure.innerDir).create();
+
+        // Plain Wine installations (doesn't apply to Proton ones) show GUI
+        // dialogs at prefix creation time. Ideally, we want our HiDPI settings
+        // to apply to those dialogs as well. To set the HiDPI settings in a
+        // proper way, we have to have a prefix already created, which creates
+        // a chicken and egg situation. This method applies those settings in
+        // a hacky way, without the need to hace a prefix already created.
+        // Below, we apply them again the proper way, just in case.
+        await _preApplyHiDpiSettings(
+          wineInstDescriptor: wineInstDescriptor,
+          prefixDirStructure: prefixDirStructure,
+        );
+
+        // Populate the prefix directory.
+        await _initializeWinePrefix(
+          winePrefix: winePrefix,
+          wineInstDescriptor: wineInstDescriptor,
+          runningSpecialExecutablesRepo: runningSpecialExecutablesRepo,
+        );
+
+        // Save the freshly initialized prefix for the next prefix to be
+        // created with the same Wine build and WoW64 mode. This has to happen
+        // before anything prefix-specific, like home isolation, is applied.
+        await _trySavingPrefixTemplate(
+          prefixTemplateDir: prefixTemplateDir,
+          prefixDirStructure: prefixDirStructure,
+        );
+      }
 
       // This time, apply the HiDPI settings the proper way.
       await _applyHiDpiSettings(
@@ -571,6 +598,7 @@ class PrefixCreationBloc extends Cubit<PrefixCreationState> {
           archiveUri: Uri.parse(downloadUrl),
           archiveType: state.selectedWineBuild!.archiveType,
           extractionDir: extractionDir.path,
+          contentStoreDir: startupData.localStoragePaths.wineBuildStoreDir,
           progressCallback: _updateDownloadAndExtractionProgress,
         );
 
@@ -613,6 +641,86 @@ class PrefixCreationBloc extends Cubit<PrefixCreationState> {
     }
   }
 
+  /// Populates [WinePrefixDirStructure.innerDir] by cloning a prefix template
+  /// with the prefix-clone tool. Returns false if there is no template or
+  /// cloning it failed, in which case the inner directory doesn't exist.
+  Future<bool> _tryCloningPrefixTemplate({
+    required String prefixTemplateDir,
+    required WinePrefixDirStructure prefixDirStructure,
+  }) async {
+    if (!await Directory(prefixTemplateDir).exists()) {
+      return false;
+    }
+
+    final processResult = await Process.run(LocalStoragePaths.prefixClonePath, [
+      prefixTemplateDir,
+      prefixDirStructure.innerDir,
+    ]);
+
+    if (processResult.exitCode != 0) {
+      logger.w(
+        'Failed to clone the prefix template at $prefixTemplateDir, '
+        'falling back to initializing the prefix: ${processResult.stderr}',
+      );
+      await recursiveDeleteAndLogErrors(
+        Directory(prefixDirStructure.innerDir),
+      );
+      return false;
+    }
+
+    logger.i('Cloned a prefix template: ${processResult.stdout}');
+    return true;
+  }
+
+  /// Clones [WinePrefixDirStructure.innerDir] into [prefixTemplateDir],
+  /// unless a template is already there. Failures are logged but otherwise
+  /// ignored, as templates are only an optimization.
+  Future<void> _trySavingPrefixTemplate({
+    required String prefixTemplateDir,
+    required WinePrefixDirStructure prefixDirStructure,
+  }) async {
+    if (await Directory(prefixTemplateDir).exists()) {
+      return;
+    }
+
+    final prefixTemplatesDir = Directory(
+      startupData.localStoragePaths.prefixTemplatesDir,
+    );
+
+    Directory? stagingDir;
+
+    try {
+      await prefixTemplatesDir.create();
+
+      // Clone into a staging directory next to the final one and rename it
+      // into place, so that a half-written template is never picked up.
+      stagingDir = await prefixTemplatesDir.createTemp('staging-');
+      final stagedTemplateDir = path.join(stagingDir.path, 'template');
+
+      final processResult = await Process.run(
+        LocalStoragePaths.prefixClonePath,
+        [prefixDirStructure.innerDir, stagedTemplateDir],
+      );
+
+      if (processResult.exitCode != 0) {
+        logger.w('Failed to save a prefix template: ${processResult.stderr}');
+        return;
+      }
+
+      await Directory(stagedTemplateDir).rename(prefixTemplateDir);
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to save a prefix template',
+        error: e,
+        stackTrace: stackTrace,
+      );
+    } finally {
+      if (stagingDir != null) {
+        await recursiveDeleteAndLogErrors(stagingDir);
+      }
+    }
+  }
+
   /// The DPI of 96 corresponds to a scale of 1 in Windows.
   int get _logPixels => (state.hiDpiScale * 96).round();
 
@@ -657,6 +765,14 @@ class PrefixCreationBloc extends Cubit<PrefixCreationState> {
     required RunningExecutablesRepo<SpecialExecutableSlot>
     runningSpecialExecutablesRepo,
   }) async {
+    if (await trySettingHiDpiScaleNatively(
+      hiDpiScale: state.hiDpiScale,
+      winePrefix: winePrefix,
+      wineInstDescriptor: wineInstDescriptor,
+    )) {
+      return;
+    }
+
     final process = await startTaskOfSettingHiDpiScale(
       hiDpiScale: state.hiDpiScale,
       startupData: startupData,
@@ -15,13 +15,20 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
+import 'dart:convert';
+import 'dart:io';
 
 import 'package:bloc/bloc.dart';
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
 import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
 
 import 'prefix_details_state.dart';
 
 class PrefixDetailsBloc extends Cubit<PrefixDetailsState> {
+  final logger = GetIt.I.get<Logger>();
+
   PrefixDetailsBloc({required WinePrefix prefix})
     : super(PrefixDetailsState.initialState(prefix: prefix));
 
@@ -32,4 +39,65 @@ class PrefixDetailsBloc extends Cubit<PrefixDetailsState> {
   void setFileSelectionInProgress(bool inProgress) {
     emit(state.copyWith(fileSelectionInProgress: inProgress));
   }
+
+  /// Shows the disk usage from the previous scan right away and then
+  /// rescans the prefix with prefix-du. Thanks to its cache, the rescan only
+  /// lists the directories that have changed since the previous one.
+  Future<void> refreshDiskUsage() async {
+    final dirStructure = state.prefix.dirStructure;
+
+    await _loadDiskUsageReport(dirStructure.diskUsageReportFilePath);
+
+    try {
+      final processResult = await Process.run(
+        LocalStoragePaths.prefixDiskUsagePath,
+        [
+          '--cache',
+          dirStructure.diskUsageCacheFilePath,
+          '--output',
+          dirStructure.diskUsageReportFilePath,
+          dirStructure.innerDir,
+        ],
+      );
+
+      if (processResult.exitCode != 0) {
+        logger.w(
+          'prefix-du exited with code ${processResult.exitCode}: '
+          '${processResult.stderr}',
+        );
+        return;
+      }
+    } catch (e, stackTrace) {
+      logger.w('Failed to run prefix-du', error: e, stackTrace: stackTrace);
+      return;
+    }
+
+    await _loadDiskUsageReport(dirStructure.diskUsageReportFilePath);
+  }
+
+  Future<void> _loadDiskUsageReport(String reportFilePath) async {
+    final reportFile = File(reportFilePath);
+
+    try {
+      if (!await reportFile.exists()) {
+        return;
+      }
+
+      // This is to be kept in sync with prefix-du.cpp
+      final report =
+          jsonDecode(await reportFile.readAsString()) as Map<String, dynamic>;
+      final tree = report['tree'] as Map<String, dynamic>;
+      final diskUsageBytes = tree['allocatedBytes'] as int;
+
+      if (!isClosed) {
+        emit(state.copyWith(diskUsageBytesGetter: () => diskUsageBytes));
+      }
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to load the disk usage report from $reportFilePath',
+        error: e,
+        stackTrace: stackTrace,
+      );
+    }
+  }
 }
@@ -25,25 +25,38 @@ class PrefixDetailsState extends Equatable {
   final WinePrefix prefix;
   final bool fileSelectionInProgress;
 
+  /// The disk space taken by the prefix, as of the last scan. Null until
+  /// a scan result is available.
+  final int? diskUsageBytes;
+
   const PrefixDetailsState({
     required this.prefix,
     required this.fileSelectionInProgress,
+    required this.diskUsageBytes,
   });
 
   const PrefixDetailsState.initialState({required WinePrefix prefix})
-    : this(prefix: prefix, fileSelectionInProgress: false);
+    : this(
+        prefix: prefix,
+        fileSelectionInProgress: false,
+        diskUsageBytes: null,
+      );
 
   @override
-  List<Object?> get props => [prefix, fileSelectionInProgress];
+  List<Object?> get props => [prefix, fileSelectionInProgress, diskUsageBytes];
 
   PrefixDetailsState copyWith({
     WinePrefix? prefix,
     bool? fileSelectionInProgress,
+    ValueGetter<int?>? diskUsageBytesGetter,
   }) {
     return PrefixDetailsState(
       prefix: prefix ?? this.prefix,
       fileSelectionInProgress:
           fileSelectionInProgress ?? this.fileSelectionInProgress,
+      diskUsageBytes: diskUsageBytesGetter != null
+          ? diskUsageBytesGetter()
+          : diskUsageBytes,
     );
   }
 }
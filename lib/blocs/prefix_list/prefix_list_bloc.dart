@@ -25,12 +25,16 @@ import 'package:get_it/get_it.dart';
 import 'package:logger/logger.dart';
 import 'package:winebar/blocs/pinned_executable_set/pinned_executable_set_state.dart';
 import 'package:winebar/blocs/prefix_list/prefix_list_state.dart';
+import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/services/winebar_agent_service.dart';
 import 'package:winebar/utils/recursive_delete_and_log_errors.dart';
 
 import '../../models/wine_prefix.dart';
 
 class PrefixListBloc extends Cubit<PrefixListState> {
   final logger = GetIt.I.get<Logger>();
+  final WineProcessRunnerService wineProcessRunnerService;
+  final WinebarAgentService winebarAgentService;
 
   /// Prefix deletion operations are asynchronous but need to be executed
   /// sequentially. This future corresponds to the completion of the last
@@ -40,8 +44,11 @@ class PrefixListBloc extends Cubit<PrefixListState> {
   CancelableOperation<PinnedExecutableSetState>?
   _ongoingPinnedExecutablesLoadingOp;
 
-  PrefixListBloc(List<WinePrefix> prefixes)
-    : super(PrefixListState.initialState(prefixes: prefixes));
+  PrefixListBloc(
+    List<WinePrefix> prefixes, {
+    required this.wineProcessRunnerService,
+    required this.winebarAgentService,
+  }) : super(PrefixListState.initialState(prefixes: prefixes));
 
   /// See the docs for [PrefixListState.prefixListEvent] for why we need
   /// such a method and when to call it.
@@ -73,6 +80,14 @@ class PrefixListBloc extends Cubit<PrefixListState> {
   Future<void> _deletePrefix(WinePrefix prefixToDelete) async {
     _lastPrefixDeletionOperationCompletion = _lastPrefixDeletionOperationCompletion
         .then((_) async {
+          // Otherwise, the wineserver warmUpPrefix() or the agent keep
+          // running would write the registry into the prefix being deleted
+          // once it exits.
+          await wineProcessRunnerService.stopKeepalive(
+            prefixDir: prefixToDelete.dirStructure.outerDir,
+          );
+          await winebarAgentService.shutDown(winePrefix: prefixToDelete);
+
           await recursiveDeleteAndLogErrors(
             Directory(prefixToDelete.dirStructure.outerDir),
           );
@@ -50,8 +50,49 @@ class PrefixSettingsBloc extends Cubit<PrefixSettingsState> {
            startupData: startupData,
            hiDpiScale: prefix.descriptor.hiDpiScale,
            wow64ModePreferred: prefix.descriptor.wow64ModePreferred,
+           warmUpOnOpen: prefix.descriptor.warmUpOnOpen,
          ),
-       );
+       ) {
+    unawaited(_loadHiDpiScaleFromRegistry());
+  }
+
+  /// The HiDPI scale may have been changed from within the prefix, for
+  /// example through winecfg, in which case prefix.json is out of date.
+  /// We show what the registry has instead, unless the user has picked
+  /// a scale by then.
+  Future<void> _loadHiDpiScaleFromRegistry() async {
+    final initialHiDpiScale = state.hiDpiScale;
+
+    try {
+      final wineInstDescriptor = await GetIt.I
+          .get<UtilityService>()
+          .wineInstallationDescriptorForWineInstallDir(
+            prefix.descriptor.getAbsPathToWineInstall(
+              toplevelDataDir: startupData.localStoragePaths.toplevelDataDir,
+            ),
+          );
+
+      final hiDpiScale = await tryReadingHiDpiScaleNatively(
+        winePrefix: prefix,
+        wineInstDescriptor: wineInstDescriptor,
+      );
+
+      if (hiDpiScale == null ||
+          isClosed ||
+          state.hiDpiScale != initialHiDpiScale ||
+          state.prefixUpdateStatus != PrefixUpdateStatus.notStarted) {
+        return;
+      }
+
+      emit(state.copyWith(hiDpiScaleGetter: () => hiDpiScale));
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to read the HiDPI scale from the registry',
+        error: e,
+        stackTrace: stackTrace,
+      );
+    }
+  }
 
   void setHiDpiScale(double scaleFactor) {
     emit(state.copyWith(hiDpiScaleGetter: () => scaleFactor));
@@ -90,6 +131,10 @@ class PrefixSettingsBloc extends Cubit<PrefixSettingsState> {
     );
   }
 
+  void setWarmUpOnOpen(bool warmUpOnOpen) {
+    emit(state.copyWith(warmUpOnOpen: warmUpOnOpen));
+  }
+
   void startUpdatingPrefix() {
     if (!_validate()) {
       return;
@@ -135,6 +180,13 @@ class PrefixSettingsBloc extends Cubit<PrefixSettingsState> {
       final wineInstDescriptor = await utilityService
           .wineInstallationDescriptorForWineInstallDir(wineInstallDir);
 
+      // The wineserver warmUpPrefix() or the agent keep running would
+      // prevent the registry from being edited directly.
+      await startupData.wineProcessRunnerService.stopKeepalive(
+        prefixDir: prefix.dirStructure.outerDir,
+      );
+      await startupData.winebarAgentService.shutDown(winePrefix: prefix);
+
       // Update the prefix. Eventually it will be passed to the
       // onPrefixUpdated() callback, but we also want the "wine reg"
       // command that runs under the hood of _applyHiDpiSettings()
@@ -144,6 +196,7 @@ class PrefixSettingsBloc extends Cubit<PrefixSettingsState> {
         descriptor: prefix.descriptor.copyWith(
           hiDpiScaleGetter: () => state.hiDpiScale,
           wow64ModePreferredGetter: () => state.wow64ModePreferred,
+          warmUpOnOpen: state.warmUpOnOpen,
         ),
       );
 
@@ -179,6 +232,14 @@ class PrefixSettingsBloc extends Cubit<PrefixSettingsState> {
     required RunningExecutablesRepo<SpecialExecutableSlot>
     runningSpecialExecutablesRepo,
   }) async {
+    if (await trySettingHiDpiScaleNatively(
+      hiDpiScale: state.hiDpiScale!,
+      winePrefix: winePrefix,
+      wineInstDescriptor: wineInstDescriptor,
+    )) {
+      return;
+    }
+
     final process = await startTaskOfSettingHiDpiScale(
       hiDpiScale: state.hiDpiScale!,
       startupData: startupData,
@@ -23,6 +23,7 @@ import 'package:winebar/models/settings_json_file.dart';
 import 'package:winebar/models/wine_arch_warning.dart';
 import 'package:winebar/services/app_settings_service.dart';
 import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/utils/prefix_descriptor.dart';
 import 'package:winebar/utils/startup_data.dart';
 
 enum PrefixUpdateStatus {
@@ -56,6 +57,9 @@ class PrefixSettingsState extends Equatable {
   /// this value plays no role.
   final bool wow64ModePreferenceWarningToBeSuppressed;
 
+  /// See [PrefixDescriptor.warmUpOnOpen].
+  final bool warmUpOnOpen;
+
   final PrefixUpdateStatus prefixUpdateStatus;
   final String? prefixUpdateFailureMessage;
   final WineProcessResult? prefixUpdateFailedProcessResult;
@@ -65,6 +69,7 @@ class PrefixSettingsState extends Equatable {
     required this.wow64ModePreferred,
     required this.wow64ModePreferenceWarning,
     required this.wow64ModePreferenceWarningToBeSuppressed,
+    required this.warmUpOnOpen,
     required this.prefixUpdateStatus,
     required this.prefixUpdateFailureMessage,
     required this.prefixUpdateFailedProcessResult,
@@ -74,6 +79,7 @@ class PrefixSettingsState extends Equatable {
     required StartupData startupData,
     required double? hiDpiScale,
     required bool? wow64ModePreferred,
+    required bool warmUpOnOpen,
   }) : this(
          hiDpiScale: hiDpiScale,
          wow64ModePreferred: wow64ModePreferred,
@@ -82,6 +88,7 @@ class PrefixSettingsState extends Equatable {
            wow64ModeSelected: wow64ModePreferred,
          ),
          wow64ModePreferenceWarningToBeSuppressed: false,
+         warmUpOnOpen: warmUpOnOpen,
          prefixUpdateStatus: PrefixUpdateStatus.notStarted,
          prefixUpdateFailureMessage: null,
          prefixUpdateFailedProcessResult: null,
@@ -93,6 +100,7 @@ class PrefixSettingsState extends Equatable {
     wow64ModePreferred,
     wow64ModePreferenceWarning,
     wow64ModePreferenceWarningToBeSuppressed,
+    warmUpOnOpen,
     prefixUpdateStatus,
     prefixUpdateFailureMessage,
     prefixUpdateFailedProcessResult,
@@ -103,6 +111,7 @@ class PrefixSettingsState extends Equatable {
     ValueGetter<bool?>? wow64ModePreferredGetter,
     ValueGetter<WineArchWarning?>? wow64ModePreferenceWarningGetter,
     bool? wow64ModePreferenceWarningToBeSuppressed,
+    bool? warmUpOnOpen,
     PrefixUpdateStatus? prefixUpdateStatus,
     ValueGetter<String?>? prefixUpdateFailureMessageGetter,
     ValueGetter<WineProcessResult?>? prefixUpdateFailedProcessResultGetter,
@@ -118,6 +127,7 @@ class PrefixSettingsState extends Equatable {
       wow64ModePreferenceWarningToBeSuppressed:
           wow64ModePreferenceWarningToBeSuppressed ??
           this.wow64ModePreferenceWarningToBeSuppressed,
+      warmUpOnOpen: warmUpOnOpen ?? this.warmUpOnOpen,
       prefixUpdateStatus: prefixUpdateStatus ?? this.prefixUpdateStatus,
       prefixUpdateFailureMessage: prefixUpdateFailureMessageGetter != null
           ? prefixUpdateFailureMessageGetter()
@@ -0,0 +1,229 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:bloc/bloc.dart';
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+import 'package:winebar/exceptions/generic_exception.dart';
+import 'package:winebar/models/prefix_snapshot.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/services/utility_service.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
+import 'package:winebar/utils/startup_data.dart';
+
+import 'prefix_snapshots_state.dart';
+
+/// Manages the restore points of a prefix through prefix-snapshot.
+class PrefixSnapshotsBloc extends Cubit<PrefixSnapshotsState> {
+  final logger = GetIt.I.get<Logger>();
+  final StartupData startupData;
+  final WinePrefix winePrefix;
+
+  /// prefix-snapshot exits with this code if wineserver is running in the
+  /// prefix. This is to be kept in sync with prefix-snapshot.cpp
+  static const int _exitCodeWineserverRunning = 2;
+
+  PrefixSnapshotsBloc({required this.startupData, required this.winePrefix})
+    : super(const PrefixSnapshotsState.initialState()) {
+    unawaited(_loadSnapshots());
+  }
+
+  Future<void> createSnapshot({required String label}) async {
+    await _runOperation('Failed to create a restore point', () async {
+      await _stopWineserver();
+      await _runPrefixSnapshot([
+        'create',
+        await _getInnermostPrefixDir(),
+        label,
+      ]);
+    });
+  }
+
+  /// Returns true if the prefix was restored.
+  Future<bool> restoreSnapshot(PrefixSnapshot snapshot) async {
+    return _runOperation('Failed to restore the prefix', () async {
+      await _stopWineserver();
+      await _runPrefixSnapshot([
+        'restore',
+        snapshot.id,
+        await _getInnermostPrefixDir(),
+      ]);
+    });
+  }
+
+  Future<void> deleteSnapshot(PrefixSnapshot snapshot) async {
+    await _runOperation('Failed to delete a restore point', () async {
+      await _runPrefixSnapshot(['delete', snapshot.id]);
+    });
+  }
+
+  Future<void> _loadSnapshots() async {
+    try {
+      final snapshots = await _listSnapshots();
+
+      if (!isClosed) {
+        emit(
+          state.copyWith(
+            status: PrefixSnapshotsStatus.ready,
+            snapshots: snapshots,
+          ),
+        );
+      }
+    } catch (e, stackTrace) {
+      logger.e(
+        'Failed to list restore points',
+        error: e,
+        stackTrace: stackTrace,
+      );
+
+      if (!isClosed) {
+        emit(
+          state.copyWith(
+            status: PrefixSnapshotsStatus.failed,
+            failureMessageGetter: () => e.toString(),
+          ),
+        );
+      }
+    }
+  }
+
+  /// Runs [operation] and then reloads the list of snapshots, whether
+  /// the operation succeeded or not. Returns true on success.
+  Future<bool> _runOperation(
+    String errorMessage,
+    Future<void> Function() operation,
+  ) async {
+    emit(
+      state.copyWith(
+        operationInProgress: true,
+        failureMessageGetter: () => null,
+      ),
+    );
+
+    String? failureMessage;
+
+    try {
+      await operation();
+    } catch (e, stackTrace) {
+      logger.e(errorMessage, error: e, stackTrace: stackTrace);
+      failureMessage = e.toString();
+    }
+
+    try {
+      final snapshots = await _listSnapshots();
+
+      if (!isClosed) {
+        emit(
+          state.copyWith(
+            status: PrefixSnapshotsStatus.ready,
+            snapshots: snapshots,
+            operationInProgress: false,
+            failureMessageGetter: () => failureMessage,
+          ),
+        );
+      }
+    } catch (e, stackTrace) {
+      logger.e(
+        'Failed to list restore points',
+        error: e,
+        stackTrace: stackTrace,
+      );
+
+      if (!isClosed) {
+        emit(
+          state.copyWith(
+            status: PrefixSnapshotsStatus.failed,
+            operationInProgress: false,
+            failureMessageGetter: () => failureMessage ?? e.toString(),
+          ),
+        );
+      }
+    }
+
+    return failureMessage == null;
+  }
+
+  Future<List<PrefixSnapshot>> _listSnapshots() async {
+    final processResult = await _runPrefixSnapshot(['list']);
+
+    // This is to be kept in sync with prefix-snapshot.cpp
+    final snapshots = (jsonDecode(processResult.stdout as String) as List)
+        .cast<Map<String, dynamic>>();
+
+    return [
+      for (final snapshot in snapshots)
+        PrefixSnapshot(
+          id: snapshot['id'] as String,
+          label: snapshot['label'] as String,
+          createdAt: DateTime.fromMillisecondsSinceEpoch(
+            (snapshot['createdAt'] as int) * 1000,
+          ),
+          numFiles: snapshot['files'] as int,
+          numBytes: snapshot['bytes'] as int,
+        ),
+    ];
+  }
+
+  /// The wineserver warmUpPrefix() or the agent keep running would make
+  /// prefix-snapshot refuse to touch the prefix.
+  Future<void> _stopWineserver() async {
+    await startupData.wineProcessRunnerService.stopKeepalive(
+      prefixDir: winePrefix.dirStructure.outerDir,
+    );
+    await startupData.winebarAgentService.shutDown(winePrefix: winePrefix);
+  }
+
+  Future<String> _getInnermostPrefixDir() async {
+    final wineInstDescriptor = await GetIt.I
+        .get<UtilityService>()
+        .wineInstallationDescriptorForWineInstallDir(
+          winePrefix.descriptor.getAbsPathToWineInstall(
+            toplevelDataDir: startupData.localStoragePaths.toplevelDataDir,
+          ),
+        );
+
+    return wineInstDescriptor.getInnermostPrefixDir(
+      prefixDirStructure: winePrefix.dirStructure,
+    );
+  }
+
+  Future<ProcessResult> _runPrefixSnapshot(List<String> args) async {
+    final processResult = await Process.run(
+      LocalStoragePaths.prefixSnapshotPath,
+      [winePrefix.dirStructure.snapshotsDir, ...args],
+    );
+
+    if (processResult.exitCode == _exitCodeWineserverRunning) {
+      throw GenericException(
+        'Wine is still running in this prefix. '
+        'Close the apps running in it and try again.',
+      );
+    } else if (processResult.exitCode != 0) {
+      throw GenericException(
+        'prefix-snapshot exited with code ${processResult.exitCode}: '
+        '${processResult.stderr}',
+      );
+    }
+
+    return processResult;
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'package:equatable/equatable.dart';
+import 'package:flutter/foundation.dart';
+import 'package:winebar/models/prefix_snapshot.dart';
+
+enum PrefixSnapshotsStatus { loading, ready, failed }
+
+@immutable
+class PrefixSnapshotsState extends Equatable {
+  final PrefixSnapshotsStatus status;
+
+  /// Oldest first.
+  final List<PrefixSnapshot> snapshots;
+
+  /// True while a snapshot is being created, restored or deleted.
+  final bool operationInProgress;
+
+  /// Describes why loading the list or the last operation failed.
+  final String? failureMessage;
+
+  const PrefixSnapshotsState({
+    required this.status,
+    required this.snapshots,
+    required this.operationInProgress,
+    required this.failureMessage,
+  });
+
+  const PrefixSnapshotsState.initialState()
+    : this(
+        status: PrefixSnapshotsStatus.loading,
+        snapshots: const [],
+        operationInProgress: false,
+        failureMessage: null,
+      );
+
+  @override
+  List<Object?> get props => [
+    status,
+    snapshots,
+    operationInProgress,
+    failureMessage,
+  ];
+
+  PrefixSnapshotsState copyWith({
+    PrefixSnapshotsStatus? status,
+    List<PrefixSnapshot>? snapshots,
+    bool? operationInProgress,
+    ValueGetter<String?>? failureMessageGetter,
+  }) {
+    return PrefixSnapshotsState(
+      status: status ?? this.status,
+      snapshots: snapshots ?? this.snapshots,
+      operationInProgress: operationInProgress ?? this.operationInProgress,
+      failureMessage: failureMessageGetter != null
+          ? failureMessageGetter()
+          : failureMessage,
+    );
+  }
+}
@@ -16,19 +16,75 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
+
 import 'package:bloc/bloc.dart';
 
+import '../../models/process_log.dart';
 import '../../models/process_output.dart';
 import 'process_output_view_state.dart';
 
 class ProcessOutputViewBloc extends Cubit<ProcessOutputViewState> {
-  ProcessOutputViewBloc({required ProcessOutput processOutput})
-    : super(
-        ProcessOutputViewState(
-          processOutput: processOutput,
-          selectedLogIndex: processOutput.logs.isEmpty ? null : 0,
-        ),
-      );
+  StreamSubscription<ProcessLogChunk>? _liveLogsSubscription;
+
+  /// Decoders of the live logs. Each one holds on to a multi-byte sequence
+  /// split between chunks until the rest of it arrives.
+  final _liveLogDecoders = <String, _LiveLogDecoder>{};
+
+  /// If [liveLogs] is given, the logs of [processOutput] are added to or
+  /// replaced as chunks arrive.
+  ProcessOutputViewBloc({
+    required ProcessOutput processOutput,
+    Stream<ProcessLogChunk>? liveLogs,
+  }) : super(
+         ProcessOutputViewState(
+           processOutput: processOutput,
+           selectedLogIndex: processOutput.logs.isEmpty ? null : 0,
+         ),
+       ) {
+    _liveLogsSubscription = liveLogs?.listen(_onLiveLogChunk);
+  }
+
+  @override
+  Future<void> close() async {
+    await _liveLogsSubscription?.cancel();
+    return super.close();
+  }
+
+  void _onLiveLogChunk(ProcessLogChunk chunk) {
+    final logs = [...state.processOutput.logs];
+    final index = logs.indexWhere((existing) => existing.name == chunk.name);
+
+    var decoder = _liveLogDecoders[chunk.name];
+    if (decoder == null || chunk.replace) {
+      decoder = _liveLogDecoders[chunk.name] = _LiveLogDecoder();
+    }
+
+    // Only the new bytes are decoded. Decoding everything received so far
+    // on every chunk would make following a chatty log quadratic.
+    final previousContent = index == -1 || chunk.replace
+        ? ''
+        : logs[index].content;
+    final log = ProcessLog(
+      name: chunk.name,
+      content: previousContent + decoder.decode(chunk.data),
+    );
+
+    if (index == -1) {
+      logs.add(log);
+    } else {
+      logs[index] = log;
+    }
+
+    emit(
+      state.copyWith(
+        processOutput: ProcessOutput(logs: logs),
+        selectedLogIndexGetter: () => state.selectedLogIndex ?? 0,
+      ),
+    );
+  }
 
   void setSelectedLogIndex(int logIndex) {
     if (logIndex != state.selectedLogIndex) {
@@ -36,3 +92,19 @@ class ProcessOutputViewBloc extends Cubit<ProcessOutputViewState> {
     }
   }
 }
+
+class _LiveLogDecoder {
+  final _decoded = StringBuffer();
+  late final ByteConversionSink _sink = const Utf8Decoder(
+    allowMalformed: true,
+  ).startChunkedConversion(StringConversionSink.fromStringSink(_decoded));
+
+  /// Returns the text decoded from [bytes], which may start with the end of
+  /// a sequence whose beginning came with an earlier call.
+  String decode(Uint8List bytes) {
+    _sink.add(bytes);
+    final text = _decoded.toString();
+    _decoded.clear();
+    return text;
+  }
+}
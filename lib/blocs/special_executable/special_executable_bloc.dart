@@ -17,6 +17,7 @@
  */
 
 import 'dart:async';
+import 'dart:convert';
 import 'dart:io';
 
 import 'package:async/async.dart';
@@ -24,6 +25,7 @@ import 'package:bloc/bloc.dart';
 import 'package:get_it/get_it.dart';
 import 'package:logger/logger.dart';
 import 'package:meta/meta.dart';
+import 'package:path/path.dart' as path;
 import 'package:winebar/blocs/special_executable/special_executable_state.dart';
 import 'package:winebar/exceptions/generic_exception.dart';
 import 'package:winebar/models/pinned_executable.dart';
@@ -66,6 +68,8 @@ abstract class SpecialExecutableBloc extends Cubit<SpecialExecutableState> {
   /// To be implemented in a subclass.
   SpecialExecutableSlot get executableSlot;
 
+  WineProcess? get runningProcess => _runningProcess;
+
   @override
   Future<void> close() async {
     if (_cancellableProcessResultGetter != null) {
@@ -78,6 +82,7 @@ abstract class SpecialExecutableBloc extends Cubit<SpecialExecutableState> {
   /// To be implemented in a subclasses.
   /// In case of launching the winetricks script, the [commandLine] shall
   /// not contain the winetricks script itself, only its arguments.
+  /// The [onProcessStarted] is to be called if a process gets started.
   Future<WineProcessResult> runProcess({
     required List<String> commandLine,
     required WineInstallationDescriptor wineInstDescriptor,
@@ -193,6 +198,13 @@ abstract class SpecialExecutableBloc extends Cubit<SpecialExecutableState> {
       wineInstDescriptor: wineInstDescriptor,
       onProcessStarted: onProcessStarted,
     );
+
+    // Some operations may complete without starting a process (see
+    // PinExecutableBloc), in which case _attachToRunningProcess() isn't there
+    // to reset isRunning.
+    if (_runningProcess == null) {
+      emit(state.copyWith(isRunning: false));
+    }
   }
 }
 
@@ -279,6 +291,15 @@ class PinExecutableBloc extends SpecialExecutableBloc {
     ).createTemp('pin-');
 
     try {
+      if (await _tryFillingPinDirViaAgent(
+        commandLine: commandLine,
+        wineInstDescriptor: wineInstDescriptor,
+        tempPinDir: tempPinDir,
+      )) {
+        await _tryPinningExecutable(tempPinDir: tempPinDir.path);
+        return WineProcessResult(exitCode: 0, logs: []);
+      }
+
       final processOutputDir = await startupData.localStoragePaths
           .createProcessOutputDir();
 
@@ -311,6 +332,37 @@ class PinExecutableBloc extends SpecialExecutableBloc {
     }
   }
 
+  /// Has a winebar-agent.exe running in the prefix do what
+  /// pin-executable-info-extractor.exe would do. Returns false if the agent
+  /// is not available or has failed, in which case we fall back to running
+  /// pin-executable-info-extractor.exe, which also gets its output shown
+  /// to the user.
+  Future<bool> _tryFillingPinDirViaAgent({
+    required List<String> commandLine,
+    required WineInstallationDescriptor wineInstDescriptor,
+    required Directory tempPinDir,
+  }) async {
+    if (commandLine.isEmpty) {
+      return false;
+    }
+
+    try {
+      final results = await startupData.winebarAgentService.request(
+        winePrefix: winePrefix,
+        wineInstDescriptor: wineInstDescriptor,
+        request: ['fill-pin-dir', tempPinDir.path, commandLine.first],
+      );
+      return results != null;
+    } catch (e, stackTrace) {
+      logger.w(
+        'winebar-agent failed to pin ${commandLine.first}',
+        error: e,
+        stackTrace: stackTrace,
+      );
+      return false;
+    }
+  }
+
   List<String> _buildWineArgs({
     required List<String> commandLine,
     required Directory tempPinDir,
@@ -353,6 +405,10 @@ class PinExecutableBloc extends SpecialExecutableBloc {
 }
 
 class RunInstallerBloc extends SpecialExecutableBloc {
+  /// Older job reports in [WinePrefixDirStructure.installerReportsDir] are
+  /// removed once there are more than that many.
+  static const _maxJobReportsToKeep = 10;
+
   final Future<void> Function(PinnedExecutable executablePinnedInTempDir)
   processExecutablePinnedInTempDir;
 
@@ -400,10 +456,21 @@ class RunInstallerBloc extends SpecialExecutableBloc {
         ),
       );
 
+      final stopwatch = Stopwatch()..start();
+
       onProcessStarted(wineProcess);
 
       final processResult = await wineProcess.result;
 
+      stopwatch.stop();
+
+      await _saveJobReport(
+        tempPinsDir: tempPinsDir.path,
+        commandLine: commandLine,
+        exitCode: processResult.exitCode,
+        wallTime: stopwatch.elapsed,
+      );
+
       await for (final tempPinDir in tempPinsDir.list()) {
         if (tempPinDir is Directory) {
           await _tryPinningExecutable(tempPinDir: tempPinDir.path);
@@ -416,6 +483,87 @@ class RunInstallerBloc extends SpecialExecutableBloc {
     }
   }
 
+  /// Takes the job-report.json written by installer-runner, adds to it
+  /// the information necessary to compare installations across Wine builds
+  /// and saves it to [WinePrefixDirStructure.installerReportsDir], keeping
+  /// only the [_maxJobReportsToKeep] most recent reports there.
+  Future<void> _saveJobReport({
+    required String tempPinsDir,
+    required List<String> commandLine,
+    required int? exitCode,
+    required Duration wallTime,
+  }) async {
+    // This is to be kept in sync with WriteJobReportJson.cpp
+    final reportFile = File(path.join(tempPinsDir, 'job-report.json'));
+
+    try {
+      if (!await reportFile.exists()) {
+        logger.w("installer-runner didn't produce a job report");
+        return;
+      }
+
+      final report =
+          jsonDecode(await reportFile.readAsString()) as Map<String, dynamic>;
+
+      final finishedAt = DateTime.now();
+
+      report.addAll({
+        'commandLine': commandLine,
+        'exitCode': exitCode,
+        'wallTimeMs': wallTime.inMilliseconds,
+        'relPathToWineInstall': winePrefix.descriptor.relPathToWineInstall,
+        'wow64ModePreferred': winePrefix.descriptor.wow64ModePreferred,
+        'finishedAt': finishedAt.toIso8601String(),
+      });
+
+      final reportsDir = await Directory(
+        winePrefix.dirStructure.installerReportsDir,
+      ).create(recursive: true);
+
+      // Colons are not welcome in file names.
+      final timestamp = finishedAt.toUtc().toIso8601String().replaceAll(
+        ':',
+        '-',
+      );
+
+      final encoder = JsonEncoder.withIndent('  ');
+      await File(
+        path.join(reportsDir.path, 'job-report-$timestamp.json'),
+      ).writeAsString(encoder.convert(report));
+
+      logger.i('Installer job report:\n${encoder.convert(report)}');
+
+      await _pruneJobReports(reportsDir);
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to save the installer job report',
+        error: e,
+        stackTrace: stackTrace,
+      );
+    }
+  }
+
+  Future<void> _pruneJobReports(Directory reportsDir) async {
+    final reportFiles = await reportsDir.list().where((entity) {
+      final fileName = path.basename(entity.path);
+      return entity is File &&
+          fileName.startsWith('job-report-') &&
+          fileName.endsWith('.json');
+    }).toList();
+
+    if (reportFiles.length <= _maxJobReportsToKeep) {
+      return;
+    }
+
+    // The timestamps in the file names sort chronologically.
+    reportFiles.sort((a, b) => a.path.compareTo(b.path));
+
+    final numToRemove = reportFiles.length - _maxJobReportsToKeep;
+    for (final reportFile in reportFiles.take(numToRemove)) {
+      await reportFile.delete();
+    }
+  }
+
   List<String> _buildWineArgs({
     required List<String> commandLine,
     required Directory tempPinsDir,
@@ -48,16 +48,16 @@ void main() {
 
   final dbusClient = DBusClient.session();
 
-  final runningPinnedExecutablesRepo =
-      RunningExecutablesRepo<PinnedExecutable>();
+  final runningWineProcessesTracker = RunningWineProcessesTracker();
 
-  final runningSpecialExecutablesRepo =
-      RunningExecutablesRepo<SpecialExecutableSlot>();
+  final runningPinnedExecutablesRepo = RunningExecutablesRepo<PinnedExecutable>(
+    tracker: runningWineProcessesTracker,
+  );
 
-  final runningWineProcessesTracker = RunningWineProcessesTracker([
-    runningPinnedExecutablesRepo,
-    runningSpecialExecutablesRepo,
-  ]);
+  final runningSpecialExecutablesRepo =
+      RunningExecutablesRepo<SpecialExecutableSlot>(
+        tracker: runningWineProcessesTracker,
+      );
 
   GetIt.I.registerSingleton<Logger>(logger);
   GetIt.I.registerSingleton<Dio>(dio);
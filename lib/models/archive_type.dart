@@ -17,27 +17,14 @@
  */
 
 enum ArchiveType {
-  tarGz(
-    tarCompressionOption: '--gzip',
-    lowerCaseExtensions: ['.tar.gz', '.tgz'],
-  ),
-  tarBz2(
-    tarCompressionOption: '--bzip2',
-    lowerCaseExtensions: ['.tar.bz2', '.tbz2'],
-  ),
-  tarXz(tarCompressionOption: '--xz', lowerCaseExtensions: ['.tar.xz', '.txz']),
-  tarZstd(
-    tarCompressionOption: '--zstd',
-    lowerCaseExtensions: ['.tar.zst', '.tzst'],
-  );
+  tarGz(lowerCaseExtensions: ['.tar.gz', '.tgz']),
+  tarBz2(lowerCaseExtensions: ['.tar.bz2', '.tbz2']),
+  tarXz(lowerCaseExtensions: ['.tar.xz', '.txz']),
+  tarZstd(lowerCaseExtensions: ['.tar.zst', '.tzst']);
 
-  final String tarCompressionOption;
   final List<String> lowerCaseExtensions;
 
-  const ArchiveType({
-    required this.tarCompressionOption,
-    required this.lowerCaseExtensions,
-  });
+  const ArchiveType({required this.lowerCaseExtensions});
 
   static ArchiveType? fromFileNameOrFilePath(String fileName) {
     final lowerCaseFileName = fileName.toLowerCase();
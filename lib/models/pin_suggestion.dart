@@ -0,0 +1,41 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'package:equatable/equatable.dart';
+import 'package:meta/meta.dart';
+
+/// An executable found in a prefix that the user may want to pin.
+@immutable
+class PinSuggestion extends Equatable {
+  final String label;
+
+  /// The path to the executable or to a .lnk file on the host.
+  final String executablePath;
+
+  /// A PNG or BMP file, or null if the executable has no usable icon.
+  final String? iconFilePath;
+
+  const PinSuggestion({
+    required this.label,
+    required this.executablePath,
+    required this.iconFilePath,
+  });
+
+  @override
+  List<Object?> get props => [label, executablePath, iconFilePath];
+}
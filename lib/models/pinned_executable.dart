@@ -28,34 +28,73 @@ import 'package:path/path.dart' as path;
 class PinnedExecutable extends Equatable
     implements Comparable<PinnedExecutable> {
   /// Inside this directory we have a pin.json file carrying the rest of our fields,
-  /// and also the icon.png file if [hasIcon] is true.
+  /// and also the icon.png file if [hasIcon] is true, plus icon-<size>.png files
+  /// for each of the [iconSizes] other than [_primaryIconSize].
   final String pinDirectory;
 
   final String label;
   final String windowsPathToExecutable;
   final bool hasIcon;
 
+  /// The sizes (in pixels) of icons available in [pinDirectory], in ascending
+  /// order. Pins created by older versions only have the 256px icon.png.
+  final List<int> iconSizes;
+
   // These constants should be kept in sync with those in WritePinnedExecutableJson.cpp.
   static final _labelKey = 'label';
   static final _windowsPathToExecutableKey = 'windowsPathToExecutable';
   static final _hasIconKey = 'hasIcon';
+  static final _iconSizesKey = 'iconSizes';
   static final _jsonFileName = 'pin.json';
 
+  // This is to be kept in sync with linux/runner/pinned_launch.cc.
+  static final _launchJsonFileName = 'launch.json';
+
+  // These constants should be kept in sync with those in FillPinDirectory.cpp.
+  static const _primaryIconSize = 256;
+  static const _primaryIconFileName = 'icon.png';
+
   const PinnedExecutable._({
     required this.pinDirectory,
     required this.label,
     required this.windowsPathToExecutable,
     required this.hasIcon,
+    required this.iconSizes,
   });
 
+  /// The command `winebar --launch` runs for this pin, as written by
+  /// PinLaunchService.
+  String get launchJsonFilePath => path.join(pinDirectory, _launchJsonFileName);
+
   @override
   List<Object> get props => [
     pinDirectory,
     label,
     windowsPathToExecutable,
     hasIcon,
+    iconSizes,
   ];
 
+  /// Returns the path to the smallest icon that's at least [minSize] pixels
+  /// in size, falling back to the largest available one. Returns null if
+  /// [hasIcon] is false.
+  String? iconFilePathForSize(double minSize) {
+    if (!hasIcon) {
+      return null;
+    }
+
+    final size = iconSizes.firstWhere(
+      (size) => size >= minSize,
+      orElse: () => _primaryIconSize,
+    );
+
+    final fileName = size == _primaryIconSize
+        ? _primaryIconFileName
+        : 'icon-$size.png';
+
+    return path.join(pinDirectory, fileName);
+  }
+
   /// Compares by lower-cased [label] and then by lower-cased [windowsPathToExecutable].
   @override
   int compareTo(PinnedExecutable other) {
@@ -79,12 +118,17 @@ class PinnedExecutable extends Equatable
     final label = json[_labelKey] as String;
     final windowsPathToExecutable = json[_windowsPathToExecutableKey] as String;
     final hasIcon = json[_hasIconKey] as bool;
+    final iconSizes =
+        (json[_iconSizesKey] as List<dynamic>?)?.cast<int>().toList() ??
+        (hasIcon ? [_primaryIconSize] : <int>[]);
+    iconSizes.sort();
 
     return PinnedExecutable._(
       pinDirectory: pinDirectory,
       label: label,
       windowsPathToExecutable: windowsPathToExecutable,
       hasIcon: hasIcon,
+      iconSizes: List.unmodifiable(iconSizes),
     );
   }
 
@@ -98,6 +142,7 @@ class PinnedExecutable extends Equatable
       label: label,
       windowsPathToExecutable: windowsPathToExecutable,
       hasIcon: hasIcon,
+      iconSizes: iconSizes,
     );
   }
 }
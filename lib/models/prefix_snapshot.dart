@@ -0,0 +1,44 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'package:equatable/equatable.dart';
+import 'package:meta/meta.dart';
+
+/// A restore point of a prefix, as reported by prefix-snapshot.
+@immutable
+class PrefixSnapshot extends Equatable {
+  final String id;
+  final String label;
+  final DateTime createdAt;
+  final int numFiles;
+
+  /// The total size of the files, not accounting for any storage shared
+  /// with the prefix through reflinks.
+  final int numBytes;
+
+  const PrefixSnapshot({
+    required this.id,
+    required this.label,
+    required this.createdAt,
+    required this.numFiles,
+    required this.numBytes,
+  });
+
+  @override
+  List<Object?> get props => [id, label, createdAt, numFiles, numBytes];
+}
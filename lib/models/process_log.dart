@@ -16,9 +16,53 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+import 'dart:typed_data';
+
+import 'package:winebar/utils/native_log_file.dart';
+
 class ProcessLog {
   final String name;
-  final String content;
+  final String? _content;
+
+  /// Set if the log is backed by a capture file rather than a string.
+  final NativeLogFile? logFile;
+
+  ProcessLog({required this.name, required String content})
+    : _content = content,
+      logFile = null;
+
+  /// The capture stays mapped into memory for as long as the log is alive,
+  /// even after its file is deleted. Its lines are only decoded when they
+  /// are displayed.
+  ProcessLog.fromLogFile({required this.name, required NativeLogFile logFile})
+    : _content = null,
+      logFile = logFile;
+
+  /// Decodes the whole capture if the log is backed by one, so prefer
+  /// [logFile] for those.
+  String get content {
+    final logFile = this.logFile;
+    if (logFile == null) {
+      return _content!;
+    }
+    return logFile.decodedLines(0, logFile.stats.numLines).join('\n');
+  }
+}
+
+/// A change to a log of a process that's still running.
+class ProcessLogChunk {
+  final String name;
+
+  /// Whether [data] replaces what was received for the log so far, rather
+  /// than extending it.
+  final bool replace;
+
+  /// Raw bytes, in UTF-8 as far as we know.
+  final Uint8List data;
 
-  ProcessLog({required this.name, required this.content});
+  ProcessLogChunk({
+    required this.name,
+    required this.replace,
+    required this.data,
+  });
 }
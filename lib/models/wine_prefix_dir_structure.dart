@@ -24,7 +24,11 @@ import 'package:path/path.dart' as path;
 class WinePrefixDirStructure extends Equatable {
   static const String _innerDirName = 'prefix';
   static const String _pinsDirName = 'pins';
+  static const String _installerReportsDirName = 'installer-reports';
+  static const String _snapshotsDirName = 'snapshots';
   static const String _prefixJsonFileName = 'prefix.json';
+  static const String _diskUsageCacheFileName = 'disk-usage-cache.tsv';
+  static const String _diskUsageReportFileName = 'disk-usage.json';
 
   /// Corresponds to '$toplevelDataDir/$prefixName'.
   final String outerDir;
@@ -35,9 +39,26 @@ class WinePrefixDirStructure extends Equatable {
   /// Corresponds to '$toplevelDataDir/$prefixName/pins'.
   String get pinsDir => path.join(outerDir, _pinsDirName);
 
+  /// Corresponds to '$toplevelDataDir/$prefixName/installer-reports'.
+  String get installerReportsDir =>
+      path.join(outerDir, _installerReportsDirName);
+
+  /// Corresponds to '$toplevelDataDir/$prefixName/snapshots'.
+  String get snapshotsDir => path.join(outerDir, _snapshotsDirName);
+
   /// Corresponds to '$toplevelDataDir/$prefixName/prefix.json'.
   String get prefixJsonFilePath => path.join(outerDir, _prefixJsonFileName);
 
+  /// Corresponds to '$toplevelDataDir/$prefixName/disk-usage-cache.tsv'.
+  ///
+  /// Lives outside of [innerDir], as writing it would otherwise invalidate it.
+  String get diskUsageCacheFilePath =>
+      path.join(outerDir, _diskUsageCacheFileName);
+
+  /// Corresponds to '$toplevelDataDir/$prefixName/disk-usage.json'.
+  String get diskUsageReportFilePath =>
+      path.join(outerDir, _diskUsageReportFileName);
+
   const WinePrefixDirStructure.fromOuterDir(this.outerDir);
 
   @override
@@ -20,6 +20,7 @@ import 'dart:async';
 
 import 'package:flutter/foundation.dart';
 import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/services/running_wine_processes_tracker.dart';
 import 'package:winebar/services/wine_process_runner_service.dart';
 
 /// Keeps track of processes of a certain category (defined by SlotType) that
@@ -28,9 +29,14 @@ import 'package:winebar/services/wine_process_runner_service.dart';
 /// The [ChangeNotifier] notifies its listeners whenever a process is added
 /// or removed from the set of tracked processes. Processes are removed from
 /// the set of tracked processes when they finish.
+///
+/// The processes added here are also handed over to the [tracker], which
+/// does the counting across all repos.
 abstract interface class RunningExecutablesRepo<SlotType> with ChangeNotifier {
-  factory RunningExecutablesRepo() {
-    return _RunningExecutablesRepo<SlotType>();
+  factory RunningExecutablesRepo({
+    required RunningWineProcessesTracker tracker,
+  }) {
+    return _RunningExecutablesRepo<SlotType>(tracker: tracker);
   }
 
   void addRunningProcess({
@@ -54,9 +60,12 @@ typedef _RunningExecutablesInPrefix<SlotType> = Map<SlotType, WineProcess>;
 class _RunningExecutablesRepo<SlotType>
     with ChangeNotifier
     implements RunningExecutablesRepo<SlotType> {
+  final RunningWineProcessesTracker tracker;
   final runningExecutablesByPrefix =
       <WinePrefix, _RunningExecutablesInPrefix<SlotType>>{};
 
+  _RunningExecutablesRepo({required this.tracker});
+
   @override
   void addRunningProcess({
     required WinePrefix prefix,
@@ -70,6 +79,7 @@ class _RunningExecutablesRepo<SlotType>
     }
 
     runningExecutablesInPrefix[slot] = wineProcess;
+    tracker.trackProcess(prefix: prefix, wineProcess: wineProcess);
 
     // Remove it when WineProcess has finished.
     unawaited(
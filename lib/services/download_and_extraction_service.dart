@@ -19,10 +19,14 @@
 import '../models/archive_type.dart';
 
 abstract interface class DownloadAndExtractionService {
+  /// If [contentStoreDir] is given, the extracted files become hard links
+  /// into that content-addressed store, and only the files it doesn't have
+  /// yet are written out.
   Future<DownloadAndExtractionProcess> startDownloadAndExtractionProcess({
     required Uri archiveUri,
     required ArchiveType archiveType,
     required String extractionDir,
+    String? contentStoreDir,
     DownloadAndExtractionProgressCallback? progressCallback,
   });
 }
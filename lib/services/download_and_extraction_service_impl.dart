@@ -16,7 +16,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-import 'dart:async';
+import 'dart:convert';
 import 'dart:io';
 
 import 'package:dio/dio.dart';
@@ -25,6 +25,7 @@ import 'package:logger/logger.dart';
 
 import '../exceptions/extraction_failed_exception.dart';
 import '../models/archive_type.dart';
+import '../utils/local_storage_paths.dart';
 import 'download_and_extraction_service.dart';
 
 class DownloadAndExtractionServiceImpl implements DownloadAndExtractionService {
@@ -37,13 +38,17 @@ class DownloadAndExtractionServiceImpl implements DownloadAndExtractionService {
     required Uri archiveUri,
     required ArchiveType archiveType,
     required String extractionDir,
+    String? contentStoreDir,
     DownloadAndExtractionProgressCallback? progressCallback,
   }) async {
-    final extractionProcess = await Process.start('tar', [
-      archiveType.tarCompressionOption,
-      '-xf',
-      '-',
-    ], workingDirectory: extractionDir);
+    // The compression format is detected from the stream itself.
+    final extractionProcess = await Process.start(
+      LocalStoragePaths.archiveExtractorPath,
+      [
+        if (contentStoreDir != null) ...['--store', contentStoreDir],
+        extractionDir,
+      ],
+    );
 
     final downloadCancelToken = CancelToken();
 
@@ -59,8 +64,12 @@ class DownloadAndExtractionServiceImpl implements DownloadAndExtractionService {
             ),
     );
 
-    unawaited(extractionProcess.stdout.drain());
-    unawaited(extractionProcess.stderr.drain());
+    final extractionOutputFuture = extractionProcess.stdout
+        .transform(utf8.decoder)
+        .join();
+    final extractionErrorFuture = extractionProcess.stderr
+        .transform(utf8.decoder)
+        .join();
 
     final downloadCompletionFuture = extractionProcess.stdin
         .addStream(downloadProcess.data.stream)
@@ -73,6 +82,8 @@ class DownloadAndExtractionServiceImpl implements DownloadAndExtractionService {
       downloadCancelToken: downloadCancelToken,
       downloadCompletionFuture: downloadCompletionFuture,
       extractionProcess: extractionProcess,
+      extractionOutputFuture: extractionOutputFuture,
+      extractionErrorFuture: extractionErrorFuture,
     );
   }
 }
@@ -83,6 +94,8 @@ class _DownloadAndExtractionProcess implements DownloadAndExtractionProcess {
   final Response downloadProcess;
   final CancelToken downloadCancelToken;
   final Process extractionProcess;
+  final Future<String> extractionOutputFuture;
+  final Future<String> extractionErrorFuture;
   bool cancelled = false;
 
   @override
@@ -94,10 +107,14 @@ class _DownloadAndExtractionProcess implements DownloadAndExtractionProcess {
     required this.downloadCancelToken,
     required Future downloadCompletionFuture,
     required this.extractionProcess,
+    required this.extractionOutputFuture,
+    required this.extractionErrorFuture,
   }) {
     completionFuture = (
       downloadCompletionFuture,
       extractionProcess.exitCode,
+      extractionOutputFuture,
+      extractionErrorFuture,
     ).wait.then(_handleNormalCompletion, onError: _handleErrorCompletion);
   }
 
@@ -111,16 +128,19 @@ class _DownloadAndExtractionProcess implements DownloadAndExtractionProcess {
   }
 
   DownloadAndExtractionOutcome _handleNormalCompletion(
-    (dynamic, int exitCode) result,
+    (dynamic, int exitCode, String stdout, String stderr) result,
   ) {
     if (cancelled) {
       return DownloadAndExtractionOutcome.cancelled;
     } else if (result.$2 != 0) {
       final errorMessage =
-          'tar has exited with a non-zero exit code of ${result.$2}';
+          'archive-extractor has exited with a non-zero exit code of '
+          '${result.$2}:\n${result.$4}';
       logger.w('Decompression of $archiveUri failed:\n$errorMessage');
       throw ExtractionFailedException();
     } else {
+      // Includes the SHA-256 of the downloaded archive.
+      logger.i('Extracted $archiveUri: ${result.$3.trim()}');
       return DownloadAndExtractionOutcome.succeeded;
     }
   }
@@ -0,0 +1,291 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+import 'package:path/path.dart' as path;
+import 'package:winebar/exceptions/generic_exception.dart';
+import 'package:winebar/models/pinned_executable.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/models/wine_prefix_dir_structure.dart';
+import 'package:winebar/repositories/running_executables_repo.dart';
+import 'package:winebar/services/utility_service.dart';
+import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/utils/command_line_to_wine_args.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
+import 'package:winebar/utils/prefix_descriptor.dart';
+import 'package:winebar/utils/startup_data.dart';
+import 'package:winebar/utils/wine_installation_descriptor.dart';
+
+/// Builds the commands pinned executables are launched with, both for the
+/// app itself and for `winebar --launch <prefix> <pin>`.
+///
+/// The latter doesn't start the Dart side, so each pin directory carries
+/// a launch.json file with the command resolved in advance. The GTK runner
+/// only has to give it a process output directory of its own. If the app is
+/// running, the runner forwards the request to us over the
+/// "winebar/pin_launch" method channel instead, so that the process is
+/// tracked just like one launched from the UI.
+class PinLaunchService {
+  static const _channel = MethodChannel('winebar/pin_launch');
+
+  /// Stands for the process output directory in launch.json.
+  static const _processOutputDirPlaceholder = '@PROCESS_OUTPUT_DIR@';
+
+  final logger = GetIt.I.get<Logger>();
+  final StartupData startupData;
+
+  PinLaunchService({required this.startupData}) {
+    _channel.setMethodCallHandler(_handleMethodCall);
+  }
+
+  /// Starts the [pinnedExecutable] through launch-shim.exe. Registering
+  /// the process is up to the caller.
+  Future<WineProcess> startPinnedExecutable({
+    required WinePrefix winePrefix,
+    required PinnedExecutable pinnedExecutable,
+  }) async {
+    final wineInstDescriptor = await _wineInstDescriptorFor(winePrefix);
+
+    final processOutputDir = await startupData.localStoragePaths
+        .createProcessOutputDir();
+
+    final (:commandLine, :envVars) = _buildWineCommandLineAndEnvVars(
+      wineInstDescriptor: wineInstDescriptor,
+      winePrefix: winePrefix,
+      pinnedExecutable: pinnedExecutable,
+      processOutputDir: processOutputDir.path,
+    );
+
+    return startupData.wineProcessRunnerService.start(
+      processOutputDir: processOutputDir,
+      commandLine: commandLine,
+      envVars: envVars,
+      viaLaunchShim: true,
+    );
+  }
+
+  /// Writes the launch.json file of the [pinnedExecutable], replacing it
+  /// atomically, as `winebar --launch` may be reading it at the same time.
+  Future<void> writeLaunchFile({
+    required WinePrefix winePrefix,
+    required PinnedExecutable pinnedExecutable,
+  }) async {
+    final wineInstDescriptor = await _wineInstDescriptorFor(winePrefix);
+
+    final (:commandLine, :envVars) = _buildWineCommandLineAndEnvVars(
+      wineInstDescriptor: wineInstDescriptor,
+      winePrefix: winePrefix,
+      pinnedExecutable: pinnedExecutable,
+      processOutputDir: _processOutputDirPlaceholder,
+    );
+
+    final command = startupData.wineProcessRunnerService.buildCommand(
+      processOutputDir: _processOutputDirPlaceholder,
+      commandLine: commandLine,
+      envVars: envVars,
+      viaLaunchShim: true,
+    );
+
+    // This is to be kept in sync with linux/runner/pinned_launch.cc.
+    final json = {
+      'tempDir': startupData.localStoragePaths.tempDir,
+      'processOutputDirPlaceholder': _processOutputDirPlaceholder,
+      'executable': command.executable,
+      'args': command.args,
+      'envVars': command.envVars,
+    };
+
+    final launchJsonFile = File(pinnedExecutable.launchJsonFilePath);
+    // The name is unique, as the file may be written for the same pin at
+    // startup and by PinnedExecutableBloc at the same time.
+    final tempFile = File(
+      '${launchJsonFile.path}.${DateTime.now().microsecondsSinceEpoch}.tmp',
+    );
+    await tempFile.writeAsString(jsonEncode(json), flush: true);
+    await tempFile.rename(launchJsonFile.path);
+  }
+
+  /// Brings the launch.json files of all the pins up to date, including
+  /// those of pins created before such files existed. Failures are logged
+  /// and otherwise ignored.
+  Future<void> writeLaunchFilesOfAllPins() async {
+    for (final winePrefix in startupData.winePrefixes) {
+      if (winePrefix.isBroken) {
+        continue;
+      }
+
+      try {
+        final pinsDir = Directory(winePrefix.dirStructure.pinsDir);
+        if (!await pinsDir.exists()) {
+          continue;
+        }
+
+        await for (final entry in pinsDir.list()) {
+          if (entry is! Directory) {
+            continue;
+          }
+
+          final pinnedExecutable = await PinnedExecutable.loadFromPinDirectory(
+            entry.path,
+          );
+
+          await writeLaunchFile(
+            winePrefix: winePrefix,
+            pinnedExecutable: pinnedExecutable,
+          );
+        }
+      } catch (e, stackTrace) {
+        logger.w(
+          'Failed to write the launch files of the pins in '
+          '${winePrefix.dirStructure.outerDir}',
+          error: e,
+          stackTrace: stackTrace,
+        );
+      }
+    }
+  }
+
+  Future<void> _handleMethodCall(MethodCall call) async {
+    if (call.method != 'launchPin') {
+      return;
+    }
+
+    final args = call.arguments as List<Object?>;
+    final prefixDirName = args[0] as String;
+    final pinDirName = args[1] as String;
+
+    try {
+      await _launchPin(prefixDirName: prefixDirName, pinDirName: pinDirName);
+    } catch (e, stackTrace) {
+      logger.e(
+        'Failed to launch pin $pinDirName of prefix $prefixDirName',
+        error: e,
+        stackTrace: stackTrace,
+      );
+      rethrow;
+    }
+  }
+
+  Future<void> _launchPin({
+    required String prefixDirName,
+    required String pinDirName,
+  }) async {
+    if (!_isValidDirName(prefixDirName) || !_isValidDirName(pinDirName)) {
+      throw GenericException('Invalid prefix or pin name');
+    }
+
+    final dirStructure = WinePrefixDirStructure.fromOuterDir(
+      path.join(startupData.localStoragePaths.winePrefixesDir, prefixDirName),
+    );
+
+    final winePrefix = WinePrefix(
+      dirStructure: dirStructure,
+      descriptor: PrefixDescriptor.fromJsonString(
+        await File(dirStructure.prefixJsonFilePath).readAsString(),
+      ),
+    );
+
+    final pinnedExecutable = await PinnedExecutable.loadFromPinDirectory(
+      path.join(dirStructure.pinsDir, pinDirName),
+    );
+
+    final runningPinnedExecutablesRepo = GetIt.I
+        .get<RunningExecutablesRepo<PinnedExecutable>>();
+
+    final runningProcess = runningPinnedExecutablesRepo.tryFindRunningProcess(
+      prefix: winePrefix,
+      slot: pinnedExecutable,
+    );
+
+    if (runningProcess != null) {
+      logger.w(
+        "Not launching pinned executable "
+        "${pinnedExecutable.windowsPathToExecutable} that's already running",
+      );
+      return;
+    }
+
+    final wineProcess = await startPinnedExecutable(
+      winePrefix: winePrefix,
+      pinnedExecutable: pinnedExecutable,
+    );
+
+    runningPinnedExecutablesRepo.addRunningProcess(
+      prefix: winePrefix,
+      slot: pinnedExecutable,
+      wineProcess: wineProcess,
+    );
+  }
+
+  Future<WineInstallationDescriptor> _wineInstDescriptorFor(
+    WinePrefix winePrefix,
+  ) {
+    return GetIt.I
+        .get<UtilityService>()
+        .wineInstallationDescriptorForWineInstallDir(
+          winePrefix.descriptor.getAbsPathToWineInstall(
+            toplevelDataDir: startupData.localStoragePaths.toplevelDataDir,
+          ),
+        );
+  }
+
+  static ({List<String> commandLine, Map<String, String> envVars})
+  _buildWineCommandLineAndEnvVars({
+    required WineInstallationDescriptor wineInstDescriptor,
+    required WinePrefix winePrefix,
+    required PinnedExecutable pinnedExecutable,
+    required String processOutputDir,
+  }) {
+    // The shim waits for the process tree of the executable and nothing else,
+    // using the process output dir as its control directory.
+    final wineArgs = [
+      LocalStoragePaths.launchShimPath,
+      processOutputDir,
+      ...commandLineToWineArgs([pinnedExecutable.windowsPathToExecutable]),
+    ];
+
+    return (
+      commandLine: wineInstDescriptor.buildWineInvocationCommand(
+        winePrefix: winePrefix,
+        wineArgs: wineArgs,
+      ),
+      envVars: wineInstDescriptor.getEnvVarsForWine(
+        winePrefix: winePrefix,
+        processOutputDir: processOutputDir,
+        forWinetricks: false,
+
+        // For maximum performance, we disable capturing logs from pinned
+        // executables.
+        disableLogs: true,
+      ),
+    );
+  }
+
+  static bool _isValidDirName(String name) {
+    return name.isNotEmpty &&
+        !name.contains('/') &&
+        name != '.' &&
+        name != '..';
+  }
+}
@@ -16,38 +16,125 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+import 'dart:async';
+
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
 import 'package:winebar/models/wine_prefix.dart';
-import 'package:winebar/repositories/running_executables_repo.dart';
+import 'package:winebar/services/wine_process_runner_service.dart';
 
 /// Keeps track of the number of wine processes (of any type) that are
 /// currently running either within a given prefix or across all prefixes.
 ///
+/// The counting is done by the process supervisor plugin of the GTK runner,
+/// which watches the processes through pidfds and reports new counts for
+/// the prefixes whose processes have exited. A process is counted here until
+/// the plugin confirms it's counting it, or until it finishes, if the plugin
+/// failed to take it.
+///
 /// The [ChangeNotifier] notifies its listeners whenever a process is added
 /// or removed from the set of tracked processes. Processes are removed from
 /// the set of tracked processes when they finish.
 class RunningWineProcessesTracker with ChangeNotifier {
-  /// These would be [RunningExecutableRepo] instances parametrized with
-  /// different types.
-  final List<RunningExecutablesRepo> typedRepos;
+  static const _channel = MethodChannel('winebar/process_supervisor');
+
+  final logger = GetIt.I.get<Logger>();
+
+  /// As last reported by the plugin, keyed by [_prefixKey].
+  final _supervisedCountsByPrefix = <String, int>{};
+  int _supervisedTotal = 0;
 
-  RunningWineProcessesTracker(this.typedRepos) {
-    for (final repo in typedRepos) {
-      repo.addListener(notifyListeners);
+  final _localCountsByPrefix = <String, int>{};
+  int _localTotal = 0;
+
+  bool _handlerInstalled = false;
+
+  void trackProcess({
+    required WinePrefix prefix,
+    required WineProcess wineProcess,
+  }) {
+    if (!_handlerInstalled) {
+      _channel.setMethodCallHandler(_handleMethodCall);
+      _handlerInstalled = true;
     }
+
+    final prefixKey = _prefixKey(prefix);
+    _adjustLocalCount(prefixKey, 1);
+    notifyListeners();
+
+    unawaited(_supervise(prefixKey, wineProcess));
   }
 
   int numProcessesRunningInPrefix(WinePrefix prefix) {
-    return typedRepos.fold(
-      0,
-      (sum, typedRepo) => sum + typedRepo.numProcessesRunningInPrefix(prefix),
-    );
+    final prefixKey = _prefixKey(prefix);
+    return (_supervisedCountsByPrefix[prefixKey] ?? 0) +
+        (_localCountsByPrefix[prefixKey] ?? 0);
   }
 
   int totalRunningProcesses() {
-    return typedRepos.fold(
-      0,
-      (sum, typedRepo) => sum + typedRepo.totalRunningProcesses(),
-    );
+    return _supervisedTotal + _localTotal;
+  }
+
+  Future<void> _supervise(String prefixKey, WineProcess wineProcess) async {
+    try {
+      final reply = await _channel.invokeMapMethod<String, Object?>(
+        'supervise',
+        [wineProcess.pid, prefixKey],
+      );
+
+      _adjustLocalCount(prefixKey, -1);
+      _setSupervisedCount(prefixKey, reply!['count'] as int);
+      _supervisedTotal = reply['total'] as int;
+      notifyListeners();
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to supervise process ${wineProcess.pid}, '
+        'falling back to waiting for its result',
+        error: e,
+        stackTrace: stackTrace,
+      );
+
+      await wineProcess.result.then((_) {}, onError: (_) {});
+      _adjustLocalCount(prefixKey, -1);
+      notifyListeners();
+    }
   }
+
+  Future<void> _handleMethodCall(MethodCall call) async {
+    if (call.method != 'update') {
+      return;
+    }
+
+    // The pids that have exited are in args['exited'], but we only need the
+    // counts.
+    final args = call.arguments as Map<Object?, Object?>;
+    final counts = args['counts'] as Map<Object?, Object?>;
+    for (final MapEntry(:key, :value) in counts.entries) {
+      _setSupervisedCount(key as String, value as int);
+    }
+    _supervisedTotal = args['total'] as int;
+    notifyListeners();
+  }
+
+  void _adjustLocalCount(String prefixKey, int delta) {
+    final count = (_localCountsByPrefix[prefixKey] ?? 0) + delta;
+    if (count > 0) {
+      _localCountsByPrefix[prefixKey] = count;
+    } else {
+      _localCountsByPrefix.remove(prefixKey);
+    }
+    _localTotal += delta;
+  }
+
+  void _setSupervisedCount(String prefixKey, int count) {
+    if (count > 0) {
+      _supervisedCountsByPrefix[prefixKey] = count;
+    } else {
+      _supervisedCountsByPrefix.remove(prefixKey);
+    }
+  }
+
+  static String _prefixKey(WinePrefix prefix) => prefix.dirStructure.outerDir;
 }
@@ -27,6 +27,8 @@ import 'package:path/path.dart' as path;
 import 'package:winebar/exceptions/generic_exception.dart';
 import 'package:winebar/models/process_log.dart';
 import 'package:winebar/utils/local_storage_paths.dart';
+import 'package:winebar/utils/log_tail.dart';
+import 'package:winebar/utils/native_log_file.dart';
 import 'package:winebar/utils/recursive_delete_and_log_errors.dart';
 
 void _validateCommandLine(List<String> commandLine) {
@@ -35,6 +37,15 @@ void _validateCommandLine(List<String> commandLine) {
   }
 }
 
+/// The log files log-capturing-runner writes into the process output
+/// directory, mapped to the names of the logs.
+const _logNamesByFileName = {
+  'stdout.txt': 'STDOUT',
+  'stderr.txt': 'STDERR',
+  'crash.txt': 'crash',
+  'log-capturing-runner.txt': 'log-capturing-runner',
+};
+
 ProcessLog? _maybeBuildLog(String name, Uint8List content) {
   return content.isEmpty
       ? null
@@ -44,6 +55,35 @@ ProcessLog? _maybeBuildLog(String name, Uint8List content) {
         );
 }
 
+/// Maps a capture of a finished process with [NativeLogFile], rather than
+/// decoding it into a string. Falls back to reading the file if the native
+/// log library can't be used.
+Future<ProcessLog?> _maybeLoadLog(String name, String filePath) async {
+  if (!await File(filePath).exists()) {
+    return null;
+  }
+
+  try {
+    final logFile = NativeLogFile.open(filePath);
+    if (logFile.stats.size == 0) {
+      logFile.close();
+      return null;
+    }
+    return ProcessLog.fromLogFile(name: name, logFile: logFile);
+  } catch (e, stackTrace) {
+    GetIt.I.get<Logger>().w(
+      'Failed to map $filePath',
+      error: e,
+      stackTrace: stackTrace,
+    );
+  }
+
+  final content = await File(
+    filePath,
+  ).readAsBytes().catchError((e) => Uint8List(0));
+  return _maybeBuildLog(name, content);
+}
+
 /// Runs a wine process (or a process that may invoke wine) either directly
 /// or through muvm.
 abstract interface class WineProcessRunnerService {
@@ -71,21 +111,94 @@ abstract interface class WineProcessRunnerService {
   /// It has to be noted that muvm doesn't propagate its environment to the
   /// process it starts inside a virtual machine, but this method works around
   /// that.
+  ///
+  /// Set [viaLaunchShim] if the [commandLine] runs launch-shim.exe with
+  /// [processOutputDir] as its control directory. The shim waits for the
+  /// process tree it starts on its own, so there is no need to wait for every
+  /// process in the prefix to exit, and it can stop that process tree alone.
+  /// Under muvm, this is ignored, as wineserver has to be waited for in order
+  /// for it to exit gracefully, and the stop file may not be noticed inside
+  /// the virtual machine.
+  ///
+  /// A wineserver [startKeepalive] has started in the same prefix is reused
+  /// rather than stopped, as stopping it would take down the processes
+  /// started elsewhere that still use it. Unless [viaLaunchShim] is set, the
+  /// "wineserver -w" that waits for the new process then also waits out the
+  /// keepalive period, which is why that period is kept short.
   Future<WineProcess> start({
     required Directory processOutputDir,
     required List<String> commandLine,
     required Map<String, String> envVars,
+    bool viaLaunchShim = false,
+  });
+
+  /// Returns what [start] would run given the same arguments, without running
+  /// it. This is how the command gets to launchers outside of the app.
+  WineCommand buildCommand({
+    required String processOutputDir,
+    required List<String> commandLine,
+    required Map<String, String> envVars,
+    bool viaLaunchShim = false,
   });
+
+  /// Has log-capturing-runner start a wineserver for a prefix ahead of time,
+  /// so that the Wine processes started there later don't have to wait for
+  /// one to start. That wineserver keeps running until [keepalive] passes
+  /// after the last Wine process in the prefix exits, or until it's stopped
+  /// with [stopKeepalive].
+  ///
+  /// The [processOutputDir] and [envVars] are the same as for [start]. The
+  /// returned process finishes as soon as the wineserver is up, with the
+  /// log-capturing-runner log telling whether the prefix was warm already.
+  /// Only if it was cold is the wineserver considered ours to stop.
+  Future<WineProcess> startKeepalive({
+    required Directory processOutputDir,
+    required Map<String, String> envVars,
+    required Duration keepalive,
+  });
+
+  /// Stops the wineservers [startKeepalive] has started in the prefixes
+  /// located at or under [prefixDir], leaving the ones that Wine processes
+  /// launched through log-capturing-runner still use alone, whether they were
+  /// started by [start] or by a launcher outside of the app. While running,
+  /// a wineserver holds the lock on the prefix and keeps its registry in
+  /// memory.
+  Future<void> stopKeepalive({required String prefixDir});
 }
 
 abstract interface class WineProcess {
+  /// The pid of log-capturing-runner, or muvm if that's what runs it.
+  int get pid;
+
   /// The returned future will complete when the process finishes
   /// one way or another (including getting killed).
   Future<WineProcessResult> get result;
 
   /// Returns true if the signal has been delivered.
   /// Otherwise, the process can be assumed to be already dead.
+  ///
+  /// For processes started via launch-shim.exe, SIGTERM is delivered by
+  /// asking the shim to terminate its process tree, which leaves the other
+  /// processes in the prefix alone.
   bool kill([ProcessSignal signal = ProcessSignal.sigterm]);
+
+  /// Follows the logs while the process is running. The stream ends once
+  /// the process has finished and [result] has collected the final logs.
+  Stream<ProcessLogChunk> watchLogs();
+}
+
+/// A command line along with the environment variables to add to the ones
+/// inherited from the parent process.
+class WineCommand {
+  final String executable;
+  final List<String> args;
+  final Map<String, String> envVars;
+
+  const WineCommand({
+    required this.executable,
+    required this.args,
+    required this.envVars,
+  });
 }
 
 class WineProcessResult {
@@ -98,12 +211,37 @@ class WineProcessResult {
   WineProcessResult({required this.exitCode, required this.logs});
 }
 
+/// A wineserver started by [WineProcessRunnerService.startKeepalive].
+class _Keepalive {
+  final Map<String, String> envVars;
+  final Duration period;
+
+  /// When the wineserver exits on its own, provided no Wine processes get
+  /// started in the prefix before that.
+  DateTime expiresAt;
+
+  /// Set once we've asked the wineserver to exit.
+  Future<void>? stopped;
+
+  _Keepalive({required this.envVars, required this.period})
+    : expiresAt = DateTime.now().add(period);
+}
+
 class _WineProcessRunnerService implements WineProcessRunnerService {
+  static const _wineserverStopTimeout = Duration(seconds: 10);
+
   final logger = GetIt.I.get<Logger>();
   final String toplevelTempDir;
   final String logCapturingRunnerPath;
   final bool runWithMuvm;
 
+  /// Keyed by WINEPREFIX.
+  final _keepalivesByWinePrefix = <String, _Keepalive>{};
+
+  /// The number of processes started by [start] that are still running,
+  /// keyed by WINEPREFIX.
+  final _numProcessesByWinePrefix = <String, int>{};
+
   _WineProcessRunnerService({
     required this.toplevelTempDir,
     required this.logCapturingRunnerPath,
@@ -115,34 +253,268 @@ class _WineProcessRunnerService implements WineProcessRunnerService {
     required Directory processOutputDir,
     required List<String> commandLine,
     required Map<String, String> envVars,
+    bool viaLaunchShim = false,
   }) async {
+    final command = buildCommand(
+      processOutputDir: processOutputDir.path,
+      commandLine: commandLine,
+      envVars: envVars,
+      viaLaunchShim: viaLaunchShim,
+    );
+
+    final wineProcess = await _startLogCapturingRunner(
+      processOutputDir: processOutputDir,
+      command: command,
+      useLaunchShimStopFile: viaLaunchShim && !runWithMuvm,
+    );
+
+    final winePrefixDir = envVars['WINEPREFIX'];
+    if (winePrefixDir != null) {
+      _countProcess(winePrefixDir, wineProcess);
+    }
+
+    return wineProcess;
+  }
+
+  @override
+  WineCommand buildCommand({
+    required String processOutputDir,
+    required List<String> commandLine,
+    required Map<String, String> envVars,
+    bool viaLaunchShim = false,
+  }) {
     _validateCommandLine(commandLine);
 
-    try {
-      final (executable, args) = _buildExecutableAndArgs(
-        commandLine: commandLine,
+    if (viaLaunchShim && !runWithMuvm) {
+      envVars = {
+        ...envVars,
+        'LOG_CAPTURING_RUNNER_SKIP_WINESERVER_WAIT': '1',
+      };
+    }
+
+    return _buildLogCapturingRunnerCommand(
+      processOutputDir: processOutputDir,
+      runnerCommand: commandLine,
+      envVars: envVars,
+    );
+  }
+
+  @override
+  Future<WineProcess> startKeepalive({
+    required Directory processOutputDir,
+    required Map<String, String> envVars,
+    required Duration keepalive,
+  }) async {
+    final wineProcess = await _startLogCapturingRunner(
+      processOutputDir: processOutputDir,
+      command: _buildLogCapturingRunnerCommand(
         processOutputDir: processOutputDir.path,
+        runnerCommand: ['--keepalive', '${keepalive.inSeconds}'],
         envVars: envVars,
+      ),
+      useLaunchShimStopFile: false,
+    );
+
+    // We can't reach the wineserver running inside muvm's virtual machine.
+    final winePrefixDir = envVars['WINEPREFIX'];
+    if (winePrefixDir != null && !runWithMuvm) {
+      unawaited(
+        wineProcess.result.then((result) {
+          // A wineserver that was running already may belong to anyone, and
+          // "-p" doesn't change the persistence delay of a running one.
+          if (result.exitCode == 0 && _startedWineserver(result)) {
+            _keepalivesByWinePrefix[winePrefixDir] = _Keepalive(
+              envVars: envVars,
+              period: keepalive,
+            );
+          }
+        }, onError: (_) {}),
       );
+    }
 
+    return wineProcess;
+  }
+
+  /// Tells from the log-capturing-runner log whether the prefix was cold,
+  /// meaning the wineserver now running there is the one we've started.
+  static bool _startedWineserver(WineProcessResult result) {
+    for (final log in result.logs) {
+      if (log.name == _logNamesByFileName['log-capturing-runner.txt']) {
+        return log.content.contains('Prefix state: cold');
+      }
+    }
+    return false;
+  }
+
+  @override
+  Future<void> stopKeepalive({required String prefixDir}) async {
+    await Future.wait([
+      for (final MapEntry(key: winePrefixDir, value: keepalive)
+          in _keepalivesByWinePrefix.entries.toList())
+        if (path.equals(winePrefixDir, prefixDir) ||
+            path.isWithin(prefixDir, winePrefixDir))
+          _maybeStopKeepalive(winePrefixDir, keepalive),
+    ]);
+  }
+
+  void _countProcess(String winePrefixDir, WineProcess wineProcess) {
+    _numProcessesByWinePrefix.update(
+      winePrefixDir,
+      (count) => count + 1,
+      ifAbsent: () => 1,
+    );
+
+    unawaited(
+      wineProcess.result.then((_) {}, onError: (_) {}).then((_) {
+        final count = _numProcessesByWinePrefix[winePrefixDir]! - 1;
+        if (count > 0) {
+          _numProcessesByWinePrefix[winePrefixDir] = count;
+        } else {
+          _numProcessesByWinePrefix.remove(winePrefixDir);
+        }
+
+        // The wineserver's persistence delay starts over once the last
+        // process exits.
+        final keepalive = _keepalivesByWinePrefix[winePrefixDir];
+        if (keepalive != null) {
+          keepalive.expiresAt = DateTime.now().add(keepalive.period);
+        }
+      }),
+    );
+  }
+
+  /// Has the keepalive wineserver exit, unless Wine processes launched through
+  /// log-capturing-runner are still using it. Processes started otherwise,
+  /// like winebar-agent, don't hold it back.
+  Future<void> _maybeStopKeepalive(
+    String winePrefixDir,
+    _Keepalive keepalive,
+  ) async {
+    final stopped = keepalive.stopped;
+    if (stopped != null) {
+      return stopped;
+    }
+
+    if (DateTime.now().isAfter(keepalive.expiresAt)) {
+      _keepalivesByWinePrefix.remove(winePrefixDir);
+      return;
+    }
+
+    if (_numProcessesByWinePrefix.containsKey(winePrefixDir) ||
+        await _isPrefixInUse(winePrefixDir)) {
+      return;
+    }
+
+    // Someone else may have got there while we were looking.
+    if (keepalive.stopped != null ||
+        _keepalivesByWinePrefix[winePrefixDir] != keepalive) {
+      await keepalive.stopped;
+      return;
+    }
+
+    final newlyStopped = _killWineserver(keepalive.envVars).then((_) {
+      if (_keepalivesByWinePrefix[winePrefixDir] == keepalive) {
+        _keepalivesByWinePrefix.remove(winePrefixDir);
+      }
+    });
+
+    keepalive.stopped = newlyStopped;
+    return newlyStopped;
+  }
+
+  /// Looks for log-capturing-runner processes running something in
+  /// [winePrefixDir], including the ones started by launchers outside of the
+  /// app. A runner stays around for as long as the Wine processes it has
+  /// started do, and it passes WINEPREFIX on its command line.
+  Future<bool> _isPrefixInUse(String winePrefixDir) async {
+    final prefixArg = 'WINEPREFIX=$winePrefixDir';
+
+    try {
+      await for (final entry in Directory('/proc').list()) {
+        final pid = int.tryParse(path.basename(entry.path));
+        if (pid == null) {
+          continue;
+        }
+
+        final List<String> args;
+        try {
+          final cmdline = await File('${entry.path}/cmdline').readAsBytes();
+          args = utf8.decode(cmdline, allowMalformed: true).split('\x00');
+        } on FileSystemException {
+          // The process has exited or isn't ours to look at.
+          continue;
+        }
+
+        if (args.first == logCapturingRunnerPath &&
+            args.contains(prefixArg) &&
+            !args.contains('--keepalive')) {
+          return true;
+        }
+      }
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to look for Wine processes in $winePrefixDir',
+        error: e,
+        stackTrace: stackTrace,
+      );
+      return true;
+    }
+
+    return false;
+  }
+
+  Future<void> _killWineserver(Map<String, String> envVars) async {
+    final wineserverExecutable = envVars['WINESERVER'];
+    if (wineserverExecutable == null) {
+      return;
+    }
+
+    try {
+      logger.i('Stopping the keepalive wineserver in ${envVars['WINEPREFIX']}');
+
+      // "wineserver -k" returns once the wineserver has exited.
+      final result = await Process.run(
+        wineserverExecutable,
+        ['-k'],
+        environment: envVars,
+      ).timeout(_wineserverStopTimeout);
+
+      if (result.exitCode != 0) {
+        logger.w(
+          '"wineserver -k" exited with code ${result.exitCode}: '
+          '${result.stderr}',
+        );
+      }
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to stop the keepalive wineserver',
+        error: e,
+        stackTrace: stackTrace,
+      );
+    }
+  }
+
+  Future<WineProcess> _startLogCapturingRunner({
+    required Directory processOutputDir,
+    required WineCommand command,
+    required bool useLaunchShimStopFile,
+  }) async {
+    try {
       logger.i(
         'Running command:\n'
-        '${[executable, ...args].join(' ')}',
+        '${[command.executable, ...command.args].join(' ')}',
       );
 
       final process = await Process.start(
-        executable,
-        args,
-
-        // Muvm doesn't pass its environment to the child, so in this case,
-        // we pass the environment through the command-line arguments
-        // (see _buildExecutableAndArgs()).
-        environment: runWithMuvm ? null : envVars,
+        command.executable,
+        command.args,
+        environment: command.envVars,
       );
 
       return _WineProcessWithLogCapturingRunner(
         process: process,
         processOutputDir: processOutputDir,
+        useLaunchShimStopFile: useLaunchShimStopFile,
       );
     } catch (e) {
       await recursiveDeleteAndLogErrors(processOutputDir);
@@ -150,9 +522,11 @@ class _WineProcessRunnerService implements WineProcessRunnerService {
     }
   }
 
-  (String, List<String>) _buildExecutableAndArgs({
+  /// The [runnerCommand] is what follows the environment variables on the
+  /// log-capturing-runner's command line.
+  WineCommand _buildLogCapturingRunnerCommand({
     required String processOutputDir,
-    required List<String> commandLine,
+    required List<String> runnerCommand,
     required Map<String, String> envVars,
   }) {
     // Q: Why do we have to pass the environment variables as arguments to
@@ -169,11 +543,15 @@ class _WineProcessRunnerService implements WineProcessRunnerService {
     final logCapturingRunnerArgs = [
       processOutputDir,
       ..._envVarsToLogCapturingRunnerArgs(envVars),
-      ...commandLine,
+      ...runnerCommand,
     ];
 
     if (!runWithMuvm) {
-      return (logCapturingRunnerPath, logCapturingRunnerArgs);
+      return WineCommand(
+        executable: logCapturingRunnerPath,
+        args: logCapturingRunnerArgs,
+        envVars: envVars,
+      );
     } else {
       final muvmArgs = [
         // This option is supposed to forward stdin / stdout from the process
@@ -191,7 +569,9 @@ class _WineProcessRunnerService implements WineProcessRunnerService {
         ...logCapturingRunnerArgs,
       ];
 
-      return ('muvm', muvmArgs);
+      // Muvm doesn't pass its environment to the child, which is why
+      // the variables only go through the command-line arguments here.
+      return WineCommand(executable: 'muvm', args: muvmArgs, envVars: {});
     }
   }
 
@@ -208,13 +588,19 @@ class _WineProcessRunnerService implements WineProcessRunnerService {
 }
 
 class _WineProcessWithLogCapturingRunner implements WineProcess {
+  final logger = GetIt.I.get<Logger>();
   final Process process;
   final Directory processOutputDir;
   final _completer = Completer<WineProcessResult>();
 
+  /// Whether SIGTERM is to be delivered by creating a stop file for
+  /// launch-shim.exe.
+  final bool useLaunchShimStopFile;
+
   _WineProcessWithLogCapturingRunner({
     required this.process,
     required this.processOutputDir,
+    required this.useLaunchShimStopFile,
   }) {
     unawaited(
       process.exitCode
@@ -235,34 +621,27 @@ class _WineProcessWithLogCapturingRunner implements WineProcess {
 
     final exitCode = int.tryParse(statusString.trim());
 
-    // The log files are size-limted, so it's totally fine
-    // to read them into memory.
-    final stdout = await File(
-      path.join(processOutputDir.path, 'stdout.txt'),
-    ).readAsBytes().catchError((e) => Uint8List(0));
-
-    final stderr = await File(
-      path.join(processOutputDir.path, 'stderr.txt'),
-    ).readAsBytes().catchError((e) => Uint8List(0));
-
-    final logCapturingRunnerLog = await File(
-      path.join(processOutputDir.path, 'log-capturing-runner.txt'),
-    ).readAsBytes().catchError((e) => Uint8List(0));
+    // The captures stay mapped after the directory is deleted below.
+    final logs = <ProcessLog>[];
+    for (final MapEntry(key: fileName, value: logName)
+        in _logNamesByFileName.entries) {
+      final log = await _maybeLoadLog(
+        logName,
+        path.join(processOutputDir.path, fileName),
+      );
+      if (log != null) {
+        logs.add(log);
+      }
+    }
 
     await recursiveDeleteAndLogErrors(processOutputDir);
 
-    _completer.complete(
-      WineProcessResult(
-        exitCode: exitCode,
-        logs: [
-          ?_maybeBuildLog('STDOUT', stdout),
-          ?_maybeBuildLog('STDERR', stderr),
-          ?_maybeBuildLog('log-capturing-runner', logCapturingRunnerLog),
-        ],
-      ),
-    );
+    _completer.complete(WineProcessResult(exitCode: exitCode, logs: logs));
   }
 
+  @override
+  int get pid => process.pid;
+
   @override
   Future<WineProcessResult> get result {
     return _completer.future;
@@ -270,6 +649,28 @@ class _WineProcessWithLogCapturingRunner implements WineProcess {
 
   @override
   bool kill([ProcessSignal signal = ProcessSignal.sigterm]) {
+    if (useLaunchShimStopFile &&
+        signal == ProcessSignal.sigterm &&
+        !_completer.isCompleted) {
+      try {
+        File(path.join(processOutputDir.path, 'stop')).createSync();
+        return true;
+      } catch (e) {
+        logger.w('Failed to ask launch-shim to stop', error: e);
+      }
+    }
+
     return process.kill(signal);
   }
+
+  @override
+  Stream<ProcessLogChunk> watchLogs() {
+    return LogTail.watch(processOutputDir.path).map(
+      (chunk) => ProcessLogChunk(
+        name: _logNamesByFileName[chunk.name] ?? chunk.name,
+        replace: chunk.replace,
+        data: chunk.data,
+      ),
+    );
+  }
 }
@@ -0,0 +1,449 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:async';
+import 'dart:collection';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+import 'package:winebar/exceptions/generic_exception.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/services/running_wine_processes_tracker.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
+import 'package:winebar/utils/recursive_delete_and_log_errors.dart';
+import 'package:winebar/utils/wine_installation_descriptor.dart';
+
+/// Serves helper operations through winebar-agent.exe, a long-lived process
+/// that's started once per prefix session. Starting a Wine process takes
+/// seconds, while a request to an already running agent takes milliseconds.
+///
+/// An agent is started on the first request to a prefix and exits by itself
+/// after being idle for a while, in which case the next request starts
+/// another one.
+///
+/// The agent isn't one of the processes [RunningWineProcessesTracker] counts,
+/// as it's not something the user has launched. It does keep wineserver
+/// running though, so it's shut down as soon as a tracked process starts in
+/// its prefix, which would otherwise wait for wineserver to exit. Anything
+/// else that needs wineserver gone has to call [shutDown] first.
+///
+/// See win32-apps/src/winebar-agent.cpp for the supported requests and
+/// AgentMessageChannel.h for the protocol.
+abstract interface class WinebarAgentService {
+  factory WinebarAgentService({
+    required LocalStoragePaths localStoragePaths,
+    required bool runWithMuvm,
+  }) {
+    return _WinebarAgentService(
+      localStoragePaths: localStoragePaths,
+      runWithMuvm: runWithMuvm,
+    );
+  }
+
+  /// Sends [request] (the operation name followed by its arguments) to the
+  /// agent running in [winePrefix], starting one if necessary, and returns
+  /// the results.
+  ///
+  /// Returns null if the agent can't serve requests, in which case the caller
+  /// is to run a dedicated helper executable instead. That's always the case
+  /// under muvm, as it doesn't forward stdin / stdout of the processes it
+  /// runs. Otherwise, that happens if the agent has failed to start or has
+  /// exited before responding, which includes exiting due to inactivity right
+  /// as the request was sent.
+  ///
+  /// Throws [GenericException] if the agent reports the operation failing.
+  Future<List<String>?> request({
+    required WinePrefix winePrefix,
+    required WineInstallationDescriptor wineInstDescriptor,
+    required List<String> request,
+  });
+
+  /// Makes the agent running in [winePrefix], if any, exit, and waits for
+  /// the wineserver it kept running to exit as well.
+  Future<void> shutDown({required WinePrefix winePrefix});
+}
+
+class _AgentSlot {
+  final WinePrefix winePrefix;
+  final Future<_WinebarAgent?> agent;
+
+  /// The number of processes [RunningWineProcessesTracker] reported for the
+  /// prefix the last time we checked.
+  int numTrackedProcesses;
+
+  _AgentSlot({
+    required this.winePrefix,
+    required this.agent,
+    required this.numTrackedProcesses,
+  });
+}
+
+class _WinebarAgentService implements WinebarAgentService {
+  final logger = GetIt.I.get<Logger>();
+  final LocalStoragePaths localStoragePaths;
+  final bool runWithMuvm;
+
+  final runningWineProcessesTracker = GetIt.I
+      .get<RunningWineProcessesTracker>();
+
+  /// Keyed by the prefix's outer directory.
+  final _agentsByPrefix = <String, _AgentSlot>{};
+
+  _WinebarAgentService({
+    required this.localStoragePaths,
+    required this.runWithMuvm,
+  }) {
+    runningWineProcessesTracker.addListener(_onTrackedProcessesChanged);
+  }
+
+  @override
+  Future<List<String>?> request({
+    required WinePrefix winePrefix,
+    required WineInstallationDescriptor wineInstDescriptor,
+    required List<String> request,
+  }) async {
+    if (runWithMuvm) {
+      return null;
+    }
+
+    final agent = await _agentFor(
+      winePrefix: winePrefix,
+      wineInstDescriptor: wineInstDescriptor,
+    );
+    if (agent == null) {
+      return null;
+    }
+
+    final response = await agent.send(request);
+    if (response == null) {
+      return null;
+    }
+
+    if (response.isNotEmpty && response.first == 'ok') {
+      return response.sublist(1);
+    } else if (response.length == 2 && response.first == 'error') {
+      throw GenericException(response[1]);
+    } else {
+      throw GenericException('Malformed response from winebar-agent');
+    }
+  }
+
+  @override
+  Future<void> shutDown({required WinePrefix winePrefix}) async {
+    final slot = _agentsByPrefix.remove(winePrefix.dirStructure.outerDir);
+    final agent = await slot?.agent;
+    await agent?.shutDown(waitForWineserver: true);
+  }
+
+  void _onTrackedProcessesChanged() {
+    for (final slot in _agentsByPrefix.values.toList()) {
+      final numTrackedProcesses = runningWineProcessesTracker
+          .numProcessesRunningInPrefix(slot.winePrefix);
+
+      if (numTrackedProcesses > slot.numTrackedProcesses) {
+        // The wineserver is now shared with the new process, so there is
+        // no point in waiting for it.
+        _agentsByPrefix.remove(slot.winePrefix.dirStructure.outerDir);
+        unawaited(
+          slot.agent.then(
+            (agent) => agent?.shutDown(waitForWineserver: false),
+          ),
+        );
+      } else {
+        slot.numTrackedProcesses = numTrackedProcesses;
+      }
+    }
+  }
+
+  /// Returns the running agent for [winePrefix] or starts a new one.
+  /// Concurrent callers share the agent being started.
+  Future<_WinebarAgent?> _agentFor({
+    required WinePrefix winePrefix,
+    required WineInstallationDescriptor wineInstDescriptor,
+  }) {
+    final prefixKey = winePrefix.dirStructure.outerDir;
+
+    final existingSlot = _agentsByPrefix[prefixKey];
+    if (existingSlot != null) {
+      return existingSlot.agent;
+    }
+
+    late final _AgentSlot newSlot;
+    final newAgent =
+        _startAgent(
+          winePrefix: winePrefix,
+          wineInstDescriptor: wineInstDescriptor,
+        ).then((agent) {
+          void forgetAgent() {
+            if (_agentsByPrefix[prefixKey] == newSlot) {
+              _agentsByPrefix.remove(prefixKey);
+            }
+          }
+
+          if (agent == null) {
+            forgetAgent();
+          } else {
+            unawaited(agent.exited.then((_) => forgetAgent()));
+          }
+
+          return agent;
+        });
+
+    newSlot = _AgentSlot(
+      winePrefix: winePrefix,
+      agent: newAgent,
+      numTrackedProcesses: runningWineProcessesTracker
+          .numProcessesRunningInPrefix(winePrefix),
+    );
+    _agentsByPrefix[prefixKey] = newSlot;
+    return newAgent;
+  }
+
+  Future<_WinebarAgent?> _startAgent({
+    required WinePrefix winePrefix,
+    required WineInstallationDescriptor wineInstDescriptor,
+  }) async {
+    Directory? processOutputDir;
+
+    try {
+      // Proton wants a directory for its STEAM_COMPAT_CLIENT_INSTALL_PATH.
+      processOutputDir = await localStoragePaths.createProcessOutputDir();
+
+      final commandLine = wineInstDescriptor.buildWineInvocationCommand(
+        winePrefix: winePrefix,
+        wineArgs: [LocalStoragePaths.winebarAgentPath],
+      );
+
+      final envVars = wineInstDescriptor.getEnvVarsForWine(
+        winePrefix: winePrefix,
+        processOutputDir: processOutputDir.path,
+        forWinetricks: false,
+        disableLogs: true,
+      );
+
+      logger.i(
+        'Starting winebar-agent:\n'
+        '${commandLine.join(' ')}',
+      );
+
+      final process = await Process.start(
+        commandLine.first,
+        commandLine.sublist(1),
+        environment: envVars,
+      );
+
+      return _WinebarAgent(
+        process: process,
+        processOutputDir: processOutputDir,
+        envVars: envVars,
+      );
+    } catch (e, stackTrace) {
+      logger.w(
+        'Failed to start winebar-agent',
+        error: e,
+        stackTrace: stackTrace,
+      );
+
+      if (processOutputDir != null) {
+        await recursiveDeleteAndLogErrors(processOutputDir);
+      }
+
+      return null;
+    }
+  }
+}
+
+class _WinebarAgent {
+  static const _exitTimeout = Duration(seconds: 10);
+
+  final logger = GetIt.I.get<Logger>();
+  final Process process;
+  final Directory processOutputDir;
+
+  /// The agent's environment, which is what locates its wineserver.
+  final Map<String, String> envVars;
+
+  /// The agent serves requests in order, so the responses complete these
+  /// in order too.
+  final _pendingResponses = Queue<Completer<List<String>?>>();
+
+  final _received = BytesBuilder(copy: false);
+  final _exitedCompleter = Completer<void>();
+
+  _WinebarAgent({
+    required this.process,
+    required this.processOutputDir,
+    required this.envVars,
+  }) {
+    process.stdout.listen(
+      _onStdoutData,
+      onDone: _onStdoutClosed,
+      onError: (e) => _onStdoutClosed(),
+    );
+
+    unawaited(
+      process.stderr
+          .transform(utf8.decoder)
+          .transform(const LineSplitter())
+          .forEach((line) => logger.d('winebar-agent: $line'))
+          .catchError((_) {}),
+    );
+
+    // Writing to a process that has exited fails asynchronously. We find out
+    // about the exit from stdout getting closed anyway.
+    unawaited(process.stdin.done.catchError((_) {}));
+  }
+
+  bool get hasExited => _exitedCompleter.isCompleted;
+
+  /// Completes once the agent has closed its end of the protocol. The process
+  /// itself may linger a bit longer.
+  Future<void> get exited => _exitedCompleter.future;
+
+  /// Closes the agent's stdin, which makes it exit, and waits for that.
+  /// The [waitForWineserver] makes it also wait for the wineserver to exit,
+  /// which happens a few seconds later, provided nothing else is running in
+  /// the prefix.
+  Future<void> shutDown({required bool waitForWineserver}) async {
+    unawaited(process.stdin.close().catchError((_) {}));
+
+    try {
+      await process.exitCode.timeout(_exitTimeout);
+    } on TimeoutException {
+      logger.w("winebar-agent hasn't exited in time, killing it");
+      process.kill(ProcessSignal.sigkill);
+      await process.exitCode;
+    }
+
+    final wineserver = envVars['WINESERVER'];
+    if (!waitForWineserver || wineserver == null) {
+      return;
+    }
+
+    try {
+      final wineserverWait = await Process.start(wineserver, [
+        '-w',
+      ], environment: envVars);
+
+      unawaited(wineserverWait.stdout.drain());
+      unawaited(wineserverWait.stderr.drain());
+
+      await wineserverWait.exitCode.timeout(
+        _exitTimeout,
+        onTimeout: () {
+          wineserverWait.kill();
+          return -1;
+        },
+      );
+    } catch (e) {
+      logger.w('Failed to wait for wineserver to exit', error: e);
+    }
+  }
+
+  /// Returns the response's fields or null if the agent has exited before
+  /// responding.
+  Future<List<String>?> send(List<String> fields) {
+    if (hasExited) {
+      return Future.value(null);
+    }
+
+    final payload = BytesBuilder(copy: false);
+    for (final field in fields) {
+      payload.add(utf8.encode(field));
+      payload.addByte(0);
+    }
+
+    final sizeBytes = ByteData(4)
+      ..setUint32(0, payload.length, Endian.little);
+
+    final completer = Completer<List<String>?>();
+    _pendingResponses.add(completer);
+
+    process.stdin.add(sizeBytes.buffer.asUint8List());
+    process.stdin.add(payload.takeBytes());
+
+    return completer.future;
+  }
+
+  void _onStdoutData(List<int> data) {
+    _received.add(data);
+
+    var buffer = _received.takeBytes();
+    var offset = 0;
+
+    while (buffer.length - offset >= 4) {
+      final size = ByteData.sublistView(
+        buffer,
+        offset,
+        offset + 4,
+      ).getUint32(0, Endian.little);
+
+      if (buffer.length - offset - 4 < size) {
+        break;
+      }
+
+      final payload = buffer.sublist(offset + 4, offset + 4 + size);
+      offset += 4 + size;
+
+      _onMessage(payload);
+    }
+
+    if (offset < buffer.length) {
+      _received.add(Uint8List.sublistView(buffer, offset));
+    }
+  }
+
+  void _onMessage(Uint8List payload) {
+    if (_pendingResponses.isEmpty) {
+      logger.w('Unexpected message from winebar-agent');
+      return;
+    }
+
+    // Every field is terminated by a '\0', so the last element is empty.
+    final fields = utf8.decode(payload, allowMalformed: true).split('\x00');
+    fields.removeLast();
+
+    _pendingResponses.removeFirst().complete(fields);
+  }
+
+  void _onStdoutClosed() {
+    if (hasExited) {
+      return;
+    }
+
+    logger.i('winebar-agent has exited');
+
+    _exitedCompleter.complete();
+
+    while (_pendingResponses.isNotEmpty) {
+      _pendingResponses.removeFirst().complete(null);
+    }
+
+    // If we were the ones to go away, this makes the agent exit as well.
+    unawaited(process.stdin.close().catchError((_) {}));
+
+    unawaited(
+      process.exitCode.then(
+        (_) => recursiveDeleteAndLogErrors(processOutputDir),
+      ),
+    );
+  }
+}
@@ -0,0 +1,128 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+import 'package:meta/meta.dart';
+
+import '../exceptions/generic_exception.dart';
+import 'local_storage_paths.dart';
+
+/// Facts about the host, as collected by the startup-probe tool without
+/// starting any processes.
+@immutable
+class HostProbe {
+  final String bootId;
+  final int pageSize;
+
+  /// As in "uname -m".
+  final String arch;
+
+  final int cpus;
+  final bool muvmAvailable;
+  final bool fexAvailable;
+  final bool pidfdSupported;
+  final bool ioUringSupported;
+
+  /// Whether the filesystem of the data directory supports reflinks.
+  final bool reflinksSupported;
+
+  static const _bootIdFilePath = '/proc/sys/kernel/random/boot_id';
+
+  const HostProbe({
+    required this.bootId,
+    required this.pageSize,
+    required this.arch,
+    required this.cpus,
+    required this.muvmAvailable,
+    required this.fexAvailable,
+    required this.pidfdSupported,
+    required this.ioUringSupported,
+    required this.reflinksSupported,
+  });
+
+  factory HostProbe._fromJsonString(String jsonString) {
+    final json = jsonDecode(jsonString) as Map<String, dynamic>;
+
+    return HostProbe(
+      bootId: json['bootId'] as String,
+      pageSize: json['pageSize'] as int,
+      arch: json['arch'] as String,
+      cpus: json['cpus'] as int,
+      muvmAvailable: json['muvmAvailable'] as bool,
+      fexAvailable: json['fexAvailable'] as bool,
+      pidfdSupported: json['pidfdSupported'] as bool,
+      ioUringSupported: json['ioUringSupported'] as bool,
+      reflinksSupported: json['reflinksSupported'] as bool,
+    );
+  }
+
+  /// Whether Wine has to run under muvm, which is the case on hosts with
+  /// pages larger than 4K, like Asahi Linux.
+  bool get muvmNeeded => pageSize != 4096;
+
+  /// Returns the cached probe if it was made since the last boot, otherwise
+  /// runs the startup-probe tool, which refreshes the cache.
+  static Future<HostProbe> load(LocalStoragePaths localStoragePaths) async {
+    final cacheFile = File(localStoragePaths.hostProbeCacheFilePath);
+
+    try {
+      final bootId = (await File(_bootIdFilePath).readAsString()).trim();
+      final cached = HostProbe._fromJsonString(await cacheFile.readAsString());
+
+      // A missing muvm is not trusted, as the user may have just installed it
+      // in response to our complaint.
+      final muvmProblem = cached.muvmNeeded && !cached.muvmAvailable;
+      if (cached.bootId == bootId && !muvmProblem) {
+        return cached;
+      }
+    } catch (_) {
+      // No cache, or an unusable one.
+    }
+
+    final dataDirExists = await Directory(
+      localStoragePaths.toplevelDataDir,
+    ).exists();
+
+    try {
+      final processResult = await Process.run(
+        LocalStoragePaths.startupProbePath,
+        [
+          if (dataDirExists) ...['--cache', cacheFile.path],
+          localStoragePaths.toplevelDataDir,
+        ],
+      );
+
+      if (processResult.exitCode != 0) {
+        throw GenericException(processResult.stderr.toString().trim());
+      }
+
+      return HostProbe._fromJsonString(processResult.stdout as String);
+    } catch (e, stackTrace) {
+      GetIt.I.get<Logger>().e(
+        'Failed to probe the host',
+        error: e,
+        stackTrace: stackTrace,
+      );
+      throw GenericException('Unable to probe the host: ${e.toString()}');
+    }
+  }
+}
@@ -30,7 +30,13 @@ class LocalStoragePaths {
   static const String _settingsJsonFileName = 'settings.json';
   static const String _wineInstallsDirName = 'wine-installs';
   static const String _winePrefixesDirName = 'wine-prefixes';
+  static const String _prefixTemplatesDirName = 'prefix-templates';
   static const String _tempDirName = 'temp';
+  static const String _trashDirName = 'trash';
+  static const String _dedupeStateFileName = 'dedupe-state.tsv';
+  static const String _wineBuildStoreDirName = 'wine-build-store';
+  static const String _wineBuildStoreIngestedMarkerFileName = 'ingested';
+  static const String _hostProbeCacheFileName = 'host-probe.json';
 
   final String homeDir;
 
@@ -45,8 +51,33 @@ class LocalStoragePaths {
   String get winePrefixesDir =>
       path.join(toplevelDataDir, _winePrefixesDirName);
 
+  String get prefixTemplatesDir =>
+      path.join(toplevelDataDir, _prefixTemplatesDirName);
+
   String get tempDir => path.join(toplevelDataDir, _tempDirName);
 
+  /// Directories moved here get removed in the background by
+  /// [dirReclaimerPath].
+  String get trashDir => path.join(toplevelDataDir, _trashDirName);
+
+  /// Lets [prefixDedupePath] skip hashing files it has already seen.
+  String get dedupeStateFilePath =>
+      path.join(toplevelDataDir, _dedupeStateFileName);
+
+  /// The content-addressed store the files of Wine builds are hard links
+  /// into. See [wineBuildStorePath].
+  String get wineBuildStoreDir =>
+      path.join(toplevelDataDir, _wineBuildStoreDirName);
+
+  /// Created once the builds installed before [wineBuildStoreDir] existed
+  /// have been brought into it.
+  String get wineBuildStoreIngestedMarkerFilePath =>
+      path.join(wineBuildStoreDir, _wineBuildStoreIngestedMarkerFileName);
+
+  /// Written by [startupProbePath] and valid until the next reboot.
+  String get hostProbeCacheFilePath =>
+      path.join(toplevelDataDir, _hostProbeCacheFileName);
+
   LocalStoragePaths({required this.homeDir, required this.toplevelDataDir});
 
   static String get logCapturingRunnerPath {
@@ -57,6 +88,111 @@ class LocalStoragePaths {
     );
   }
 
+  /// The log file indexing library built alongside log-capturing-runner.
+  static String get winebarLogLibraryPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'lib',
+      'libwinebar-log.so',
+    );
+  }
+
+  static String get archiveExtractorPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'archive-extractor',
+    );
+  }
+
+  static String get dirReclaimerPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'dir-reclaimer',
+    );
+  }
+
+  static String get exeDiscoveryPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'exe-discovery',
+    );
+  }
+
+  static String get lnkResolverPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'lnk-resolver',
+    );
+  }
+
+  static String get wineRegEditPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'wine-reg-edit',
+    );
+  }
+
+  static String get wineRegQueryPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'wine-reg-query',
+    );
+  }
+
+  static String get prefixClonePath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'prefix-clone',
+    );
+  }
+
+  static String get prefixDedupePath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'prefix-dedupe',
+    );
+  }
+
+  static String get prefixDiskUsagePath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'prefix-du',
+    );
+  }
+
+  static String get prefixSnapshotPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'prefix-snapshot',
+    );
+  }
+
+  static String get startupProbePath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'startup-probe',
+    );
+  }
+
+  static String get wineBuildStorePath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin',
+      'wine-build-store',
+    );
+  }
+
   static String get pinExecutableInfoExtractorPath {
     return path.join(
       Directory(Platform.resolvedExecutable).parent.path,
@@ -73,6 +209,22 @@ class LocalStoragePaths {
     );
   }
 
+  static String get launchShimPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin-win32',
+      'launch-shim.exe',
+    );
+  }
+
+  static String get winebarAgentPath {
+    return path.join(
+      Directory(Platform.resolvedExecutable).parent.path,
+      'bin-win32',
+      'winebar-agent.exe',
+    );
+  }
+
   static String get versionTxtFilePath {
     return path.join(
       Directory(Platform.resolvedExecutable).parent.path,
@@ -140,6 +292,21 @@ class LocalStoragePaths {
     return WinePrefixDirStructure.fromOuterDir(outerDir);
   }
 
+  /// Returns the directory of the initialized prefix that new prefixes using
+  /// the given Wine installation and WoW64 mode preference are cloned from.
+  String getPrefixTemplateDir({
+    required String relPathToWineInstall,
+    required bool? wow64ModePreferred,
+  }) {
+    final modeSuffix = wow64ModePreferred == true ? 'wow64' : 'default';
+
+    return path.join(
+      toplevelDataDir,
+      _prefixTemplatesDirName,
+      _sanitizeName('$relPathToWineInstall $modeSuffix'),
+    );
+  }
+
   static final _invalidCharsForFsEntities = RegExp(
     r'([^\p{Letter}\p{Mark}\p{Number}\p{Punctuation} ]|[\p{Zs}<>:/\\|?])+',
     unicode: true,
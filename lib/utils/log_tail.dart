@@ -0,0 +1,95 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+import 'package:winebar/models/process_log.dart';
+
+/// Follows the capture files log-capturing-runner writes into a process
+/// output directory, through the log tail plugin of the GTK runner. The
+/// plugin watches the directory with inotify and only hands over the bytes
+/// that changed, leaving it to the caller to decode them.
+abstract final class LogTail {
+  static const _channel = MethodChannel('winebar/log_tail');
+
+  static final _controllersByWatchId =
+      <int, StreamController<ProcessLogChunk>>{};
+
+  static bool _handlerInstalled = false;
+
+  /// Returns a stream of changes to the capture files in [processOutputDir],
+  /// starting with whatever they already contain. The chunks are named after
+  /// the files. The stream ends when the directory is removed.
+  static Stream<ProcessLogChunk> watch(String processOutputDir) {
+    int? watchId;
+    bool cancelled = false;
+    late final StreamController<ProcessLogChunk> controller;
+
+    controller = StreamController<ProcessLogChunk>(
+      onListen: () async {
+        if (!_handlerInstalled) {
+          _channel.setMethodCallHandler(_handleMethodCall);
+          _handlerInstalled = true;
+        }
+
+        try {
+          final id = await _channel.invokeMethod<int>(
+            'watch',
+            processOutputDir,
+          );
+          if (cancelled) {
+            await _channel.invokeMethod('unwatch', id);
+          } else {
+            watchId = id;
+            _controllersByWatchId[id!] = controller;
+          }
+        } catch (e, stackTrace) {
+          controller.addError(e, stackTrace);
+          await controller.close();
+        }
+      },
+      onCancel: () async {
+        cancelled = true;
+        final id = watchId;
+        if (id != null && _controllersByWatchId.remove(id) != null) {
+          await _channel.invokeMethod('unwatch', id);
+        }
+      },
+    );
+
+    return controller.stream;
+  }
+
+  static Future<void> _handleMethodCall(MethodCall call) async {
+    switch (call.method) {
+      case 'chunk':
+        final args = call.arguments as List<Object?>;
+        _controllersByWatchId[args[0] as int]?.add(
+          ProcessLogChunk(
+            name: args[1] as String,
+            replace: args[2] as bool,
+            data: args[3] as Uint8List,
+          ),
+        );
+      case 'closed':
+        await _controllersByWatchId.remove(call.arguments as int)?.close();
+    }
+  }
+}
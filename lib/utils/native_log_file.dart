@@ -0,0 +1,258 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
+
+final class _LogFileLine extends Struct {
+  @Uint64()
+  external int offset;
+
+  @Uint64()
+  external int length;
+}
+
+final class _LogFileStats extends Struct {
+  @Uint64()
+  external int size;
+
+  @Uint64()
+  external int numLines;
+
+  @Uint64()
+  external int longestLineLength;
+
+  @Int64()
+  external int cutMarkerLine;
+}
+
+/// Bindings for log-capturing-runner/src/LogFile.h.
+class _Bindings {
+  final Pointer<NativeFunction<Void Function(Pointer<Void>)>> closePtr;
+
+  final Pointer<Void> Function(Pointer<Utf8>) open;
+
+  final void Function(Pointer<Void>) close;
+
+  final Pointer<Uint8> Function(Pointer<Void>) getData;
+
+  final void Function(Pointer<Void>, Pointer<_LogFileStats>) getStats;
+
+  final int Function(Pointer<Void>, int, int, Pointer<_LogFileLine>) getLines;
+
+  final int Function(Pointer<Void>, int, Pointer<Uint8>, int, int) find;
+
+  factory _Bindings(DynamicLibrary lib) {
+    final closePtr = lib
+        .lookup<NativeFunction<Void Function(Pointer<Void>)>>('logFileClose');
+
+    return _Bindings._(
+      closePtr: closePtr,
+      open: lib.lookupFunction<
+        Pointer<Void> Function(Pointer<Utf8>),
+        Pointer<Void> Function(Pointer<Utf8>)
+      >('logFileOpen'),
+      close: closePtr.asFunction<void Function(Pointer<Void>)>(),
+      getData: lib.lookupFunction<
+        Pointer<Uint8> Function(Pointer<Void>),
+        Pointer<Uint8> Function(Pointer<Void>)
+      >('logFileGetData'),
+      getStats: lib.lookupFunction<
+        Void Function(Pointer<Void>, Pointer<_LogFileStats>),
+        void Function(Pointer<Void>, Pointer<_LogFileStats>)
+      >('logFileGetStats'),
+      getLines: lib.lookupFunction<
+        Uint64 Function(Pointer<Void>, Uint64, Uint64, Pointer<_LogFileLine>),
+        int Function(Pointer<Void>, int, int, Pointer<_LogFileLine>)
+      >('logFileGetLines'),
+      find: lib.lookupFunction<
+        Int64 Function(Pointer<Void>, Uint64, Pointer<Uint8>, Uint64, Uint32),
+        int Function(Pointer<Void>, int, Pointer<Uint8>, int, int)
+      >('logFileFind'),
+    );
+  }
+
+  _Bindings._({
+    required this.closePtr,
+    required this.open,
+    required this.close,
+    required this.getData,
+    required this.getStats,
+    required this.getLines,
+    required this.find,
+  });
+}
+
+class NativeLogFileStats {
+  final int size;
+  final int numLines;
+  final int longestLineLength;
+
+  /// The line consisting of the dashes of the "cut" marker log-capturing-runner
+  /// writes when it had to discard the middle of a stream, or null if nothing
+  /// was discarded.
+  final int? cutMarkerLine;
+
+  const NativeLogFileStats({
+    required this.size,
+    required this.numLines,
+    required this.longestLineLength,
+    required this.cutMarkerLine,
+  });
+}
+
+/// A capture file written by log-capturing-runner, mapped into memory and
+/// indexed by the same C code the runner is built from. Lines are handed out
+/// as views into the mapping, so large logs never get copied into the Dart
+/// heap, let alone decoded into strings in full.
+///
+/// The file is expected to stay unchanged while it's open. The runner rewrites
+/// its captures in place while the process is running, so use this class on
+/// captures of finished processes.
+final class NativeLogFile implements Finalizable {
+  static const findIgnoreCase = 1;
+
+  static final _bindings = _Bindings(
+    DynamicLibrary.open(LocalStoragePaths.winebarLogLibraryPath),
+  );
+
+  static final _finalizer = NativeFinalizer(_bindings.closePtr);
+
+  Pointer<Void> _handle;
+
+  NativeLogFile._(this._handle) {
+    _finalizer.attach(this, _handle, detach: this);
+  }
+
+  /// Throws [FileSystemException] if the file can't be opened or mapped.
+  factory NativeLogFile.open(String filePath) {
+    final nativePath = filePath.toNativeUtf8();
+    try {
+      final handle = _bindings.open(nativePath);
+      if (handle == nullptr) {
+        throw FileSystemException('Failed to open a log file', filePath);
+      }
+      return NativeLogFile._(handle);
+    } finally {
+      malloc.free(nativePath);
+    }
+  }
+
+  /// Unmaps the file. Views returned by [lines] must not be accessed after
+  /// this call. Calling it more than once is allowed.
+  void close() {
+    if (_handle == nullptr) {
+      return;
+    }
+
+    _finalizer.detach(this);
+    _bindings.close(_handle);
+    _handle = nullptr;
+  }
+
+  NativeLogFileStats get stats {
+    final stats = malloc<_LogFileStats>();
+    try {
+      _bindings.getStats(_checkedHandle, stats);
+      return NativeLogFileStats(
+        size: stats.ref.size,
+        numLines: stats.ref.numLines,
+        longestLineLength: stats.ref.longestLineLength,
+        cutMarkerLine: stats.ref.cutMarkerLine < 0
+            ? null
+            : stats.ref.cutMarkerLine,
+      );
+    } finally {
+      malloc.free(stats);
+    }
+  }
+
+  /// Returns up to [maxLines] lines starting from [firstLine], without their
+  /// line terminators. The returned lists are views into the mapped file that
+  /// stay valid until [close] is called.
+  List<Uint8List> lines(int firstLine, int maxLines) {
+    if (maxLines <= 0) {
+      return const [];
+    }
+
+    final handle = _checkedHandle;
+    final nativeLines = malloc<_LogFileLine>(maxLines);
+    try {
+      final numLines = _bindings.getLines(
+        handle,
+        firstLine,
+        maxLines,
+        nativeLines,
+      );
+      final data = _bindings.getData(handle);
+
+      return List.generate(numLines, (i) {
+        final line = nativeLines[i];
+        if (line.length == 0) {
+          return Uint8List(0);
+        }
+        return (data + line.offset).asTypedList(line.length);
+      }, growable: false);
+    } finally {
+      malloc.free(nativeLines);
+    }
+  }
+
+  /// Same as [lines] but decodes the lines, replacing invalid UTF-8 sequences.
+  List<String> decodedLines(int firstLine, int maxLines) {
+    const decoder = Utf8Decoder(allowMalformed: true);
+    return lines(
+      firstLine,
+      maxLines,
+    ).map(decoder.convert).toList(growable: false);
+  }
+
+  /// Returns the first line starting from [firstLine] that contains [needle],
+  /// or null if there is no such line.
+  int? find(String needle, {int firstLine = 0, bool ignoreCase = false}) {
+    final handle = _checkedHandle;
+    final needleBytes = utf8.encode(needle);
+    final nativeNeedle = malloc<Uint8>(max(needleBytes.length, 1));
+    try {
+      nativeNeedle.asTypedList(needleBytes.length).setAll(0, needleBytes);
+      final line = _bindings.find(
+        handle,
+        firstLine,
+        nativeNeedle,
+        needleBytes.length,
+        ignoreCase ? findIgnoreCase : 0,
+      );
+      return line < 0 ? null : line;
+    } finally {
+      malloc.free(nativeNeedle);
+    }
+  }
+
+  Pointer<Void> get _checkedHandle {
+    if (_handle == nullptr) {
+      throw StateError('The log file has been closed');
+    }
+    return _handle;
+  }
+}
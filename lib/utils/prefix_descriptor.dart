@@ -31,6 +31,7 @@ class PrefixDescriptor extends Equatable {
   static const String _relPathToWineInstallKey = 'relPathToWineInstall';
   static const String _hiDpiScaleKey = 'hiDpiScale';
   static const String _wow64ModePreferredKey = 'wow64ModePreferred';
+  static const String _warmUpOnOpenKey = 'warmUpOnOpen';
 
   final String name;
 
@@ -44,6 +45,10 @@ class PrefixDescriptor extends Equatable {
   /// we are using a build that only supports a single mode.
   final bool? wow64ModePreferred;
 
+  /// Whether to start a wineserver for the prefix in advance when its page
+  /// is opened. See warmUpPrefix().
+  final bool warmUpOnOpen;
+
   bool get isBroken => relPathToWineInstall == '';
 
   const PrefixDescriptor({
@@ -51,6 +56,7 @@ class PrefixDescriptor extends Equatable {
     required this.relPathToWineInstall,
     required this.hiDpiScale,
     required this.wow64ModePreferred,
+    required this.warmUpOnOpen,
   });
 
   const PrefixDescriptor.brokenPrefix({required String name})
@@ -59,6 +65,7 @@ class PrefixDescriptor extends Equatable {
         relPathToWineInstall: '',
         hiDpiScale: null,
         wow64ModePreferred: null,
+        warmUpOnOpen: false,
       );
 
   @override
@@ -67,6 +74,7 @@ class PrefixDescriptor extends Equatable {
     relPathToWineInstall,
     hiDpiScale,
     wow64ModePreferred,
+    warmUpOnOpen,
   ];
 
   String getAbsPathToWineInstall({required String toplevelDataDir}) {
@@ -82,12 +90,14 @@ class PrefixDescriptor extends Equatable {
     final relPathToWineInstall = json[_relPathToWineInstallKey] as String;
     final hiDpiScale = json[_hiDpiScaleKey] as double?;
     final wow64ModePreferred = json[_wow64ModePreferredKey] as bool?;
+    final warmUpOnOpen = json[_warmUpOnOpenKey] as bool? ?? false;
 
     return PrefixDescriptor(
       name: name,
       relPathToWineInstall: relPathToWineInstall,
       hiDpiScale: hiDpiScale,
       wow64ModePreferred: wow64ModePreferred,
+      warmUpOnOpen: warmUpOnOpen,
     );
   }
 
@@ -97,6 +107,7 @@ class PrefixDescriptor extends Equatable {
       _relPathToWineInstallKey: relPathToWineInstall,
       _hiDpiScaleKey: hiDpiScale,
       _wow64ModePreferredKey: wow64ModePreferred,
+      _warmUpOnOpenKey: warmUpOnOpen,
     };
 
     final encoder = JsonEncoder.withIndent('  ');
@@ -108,6 +119,7 @@ class PrefixDescriptor extends Equatable {
     String? relPathToWineInstall,
     ValueGetter<double?>? hiDpiScaleGetter,
     ValueGetter<bool?>? wow64ModePreferredGetter,
+    bool? warmUpOnOpen,
   }) {
     return PrefixDescriptor(
       name: name ?? this.name,
@@ -116,6 +128,7 @@ class PrefixDescriptor extends Equatable {
       wow64ModePreferred: wow64ModePreferredGetter != null
           ? wow64ModePreferredGetter()
           : wow64ModePreferred,
+      warmUpOnOpen: warmUpOnOpen ?? this.warmUpOnOpen,
     );
   }
 }
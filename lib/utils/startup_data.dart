@@ -16,14 +16,19 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+import 'dart:async';
+import 'dart:convert';
 import 'dart:io';
 
 import 'package:get_it/get_it.dart';
 import 'package:logger/logger.dart';
+import 'package:path/path.dart' as path;
 import 'package:winebar/exceptions/generic_exception.dart';
 import 'package:winebar/models/wine_prefix_dir_structure.dart';
 import 'package:winebar/services/app_settings_service.dart';
+import 'package:winebar/services/pin_launch_service.dart';
 import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/services/winebar_agent_service.dart';
 import 'package:winebar/utils/prefix_descriptor.dart';
 import 'package:winebar/utils/recursive_delete_and_log_errors.dart';
 import 'package:winebar/utils/settings_file_helper.dart';
@@ -32,71 +37,100 @@ import '../exceptions/data_dir_not_recognized_exception.dart';
 import '../models/settings_json_file.dart';
 import '../models/wine_prefix.dart';
 import 'app_info.dart';
+import 'host_probe.dart';
 import 'local_storage_paths.dart';
+import 'startup_trace.dart';
 
 class StartupData {
   final LocalStoragePaths localStoragePaths;
   final List<WinePrefix> winePrefixes;
   final WineProcessRunnerService wineProcessRunnerService;
+  final WinebarAgentService winebarAgentService;
   final bool isIntelHost;
   final bool wineWillRunUnderMuvm;
+  final HostProbe hostProbe;
 
   StartupData({
     required this.localStoragePaths,
     required this.winePrefixes,
     required this.wineProcessRunnerService,
+    required this.winebarAgentService,
     required this.isIntelHost,
     required this.wineWillRunUnderMuvm,
+    required this.hostProbe,
   });
 
   static Future<StartupData> load() async {
-    final localStoragePaths = await LocalStoragePaths.get();
-    final toplevelDataDirectory = Directory(localStoragePaths.toplevelDataDir);
+    try {
+      return await StartupTrace.span('StartupData.load', _load);
+    } finally {
+      await StartupTrace.flush();
+    }
+  }
 
-    final pageSize = await _getPageSize();
-    final muvmNeeded = pageSize != 4096;
+  static Future<StartupData> _load() async {
+    final localStoragePaths = await StartupTrace.span(
+      'LocalStoragePaths.get',
+      LocalStoragePaths.get,
+    );
+    final toplevelDataDirectory = Directory(localStoragePaths.toplevelDataDir);
 
-    final archName = await _getArchNameFromUname();
+    final hostProbe = await StartupTrace.span(
+      'HostProbe.load',
+      () => HostProbe.load(localStoragePaths),
+    );
+    final muvmNeeded = hostProbe.muvmNeeded;
 
     // See the list of possible string returned from "uname -a":
     // https://stackoverflow.com/a/78630608
-    final isIntelHost = archName.contains('86');
+    final isIntelHost = hostProbe.arch.contains('86');
 
-    if (muvmNeeded) {
-      if (!await _isMuvmAvailable()) {
-        throw GenericException(
-          'This system needs muvm / FEX to be able to run Windows apps. '
-          'Please install it using "sudo dnf install muvm fex-emu" or similar',
-        );
-      }
+    if (muvmNeeded && !hostProbe.muvmAvailable) {
+      throw GenericException(
+        'This system needs muvm / FEX to be able to run Windows apps. '
+        'Please install it using "sudo dnf install muvm fex-emu" or similar',
+      );
     }
 
     final settingsFileHelper = SettingsFileHelper(
       wineWillRunUnderMuvm: muvmNeeded,
     );
 
-    if (await toplevelDataDirectory.exists()) {
-      await _loadSettingsFromExistingDataDir(
-        localStoragePaths: localStoragePaths,
-        settingsFileHelper: settingsFileHelper,
-      );
-    } else {
-      await toplevelDataDirectory.create();
-      await _createNewSettingsJsonFile(
-        localStoragePaths: localStoragePaths,
-        settingsFileHelper: settingsFileHelper,
+    await StartupTrace.span('settings', () async {
+      if (await toplevelDataDirectory.exists()) {
+        await _loadSettingsFromExistingDataDir(
+          localStoragePaths: localStoragePaths,
+          settingsFileHelper: settingsFileHelper,
+        );
+      } else {
+        await toplevelDataDirectory.create();
+        await _createNewSettingsJsonFile(
+          localStoragePaths: localStoragePaths,
+          settingsFileHelper: settingsFileHelper,
+        );
+      }
+    });
+
+    await StartupTrace.span('data dirs', () async {
+      await _moveTempDirToTrash(localStoragePaths: localStoragePaths);
+      await Directory(localStoragePaths.tempDir).create();
+      unawaited(
+        _reclaimTrash(localStoragePaths: localStoragePaths)
+            .then(
+              (_) => _maintainWineBuildStore(
+                localStoragePaths: localStoragePaths,
+              ),
+            )
+            .then((_) => _dedupeFiles(localStoragePaths: localStoragePaths)),
       );
-    }
 
-    final tempDir = Directory(localStoragePaths.tempDir);
-    await recursiveDeleteAndLogErrors(tempDir);
-    await tempDir.create();
+      await Directory(localStoragePaths.wineInstallsDir).create();
+      await Directory(localStoragePaths.winePrefixesDir).create();
+    });
 
-    await Directory(localStoragePaths.wineInstallsDir).create();
-    await Directory(localStoragePaths.winePrefixesDir).create();
-
-    final winePrefixes = await _loadWinePrefixes(
-      localStoragePaths: localStoragePaths,
+    final winePrefixes = await StartupTrace.span(
+      '_loadWinePrefixes',
+      () => _loadWinePrefixes(localStoragePaths: localStoragePaths),
     );
 
     final wineProcessRunningService = WineProcessRunnerService(
@@ -105,62 +139,181 @@ class StartupData {
       runWithMuvm: muvmNeeded,
     );
 
-    return StartupData(
+    final winebarAgentService = WinebarAgentService(
+      localStoragePaths: localStoragePaths,
+      runWithMuvm: muvmNeeded,
+    );
+
+    final startupData = StartupData(
       localStoragePaths: localStoragePaths,
       winePrefixes: winePrefixes,
       wineProcessRunnerService: wineProcessRunningService,
+      winebarAgentService: winebarAgentService,
       isIntelHost: isIntelHost,
       wineWillRunUnderMuvm: muvmNeeded,
+      hostProbe: hostProbe,
     );
+
+    final pinLaunchService = PinLaunchService(startupData: startupData);
+    GetIt.I.registerSingleton<PinLaunchService>(pinLaunchService);
+    unawaited(pinLaunchService.writeLaunchFilesOfAllPins());
+
+    return startupData;
   }
 
-  static Future<int> _getPageSize() async {
+  /// Renaming is instant, however much the previous runs left behind.
+  /// Falls back to removing the temp directory in place.
+  static Future<void> _moveTempDirToTrash({
+    required LocalStoragePaths localStoragePaths,
+  }) async {
+    final tempDir = Directory(localStoragePaths.tempDir);
+    if (!await tempDir.exists()) {
+      return;
+    }
+
     try {
-      final processResult = await Process.run('getconf', ['PAGE_SIZE']);
-      return int.parse(processResult.stdout);
+      await Directory(localStoragePaths.trashDir).create();
+      final uniqueName = 'temp-${DateTime.now().microsecondsSinceEpoch}';
+      await tempDir.rename(path.join(localStoragePaths.trashDir, uniqueName));
     } catch (e, stackTrace) {
-      final logger = GetIt.I.get<Logger>();
-      logger.e(
-        'Failed to get the page size using "getconf PAGE_SIZE"',
+      GetIt.I.get<Logger>().w(
+        'Failed to move ${tempDir.path} to the trash',
         error: e,
         stackTrace: stackTrace,
       );
-      throw GenericException('Unable to get the page size: ${e.toString()}');
+      await recursiveDeleteAndLogErrors(tempDir);
     }
   }
 
-  static Future<String> _getArchNameFromUname() async {
+  /// Has the dir-reclaimer tool empty the trash directory at idle priority.
+  /// Whatever it doesn't get to before the app exits is taken care of on
+  /// the next startup.
+  static Future<void> _reclaimTrash({
+    required LocalStoragePaths localStoragePaths,
+  }) async {
+    final logger = GetIt.I.get<Logger>();
+
+    if (!await Directory(localStoragePaths.trashDir).exists()) {
+      return;
+    }
+
     try {
-      final processResult = await Process.run('uname', ['-m']);
-      return processResult.stdout.toString().trim();
+      final process = await Process.start(LocalStoragePaths.dirReclaimerPath, [
+        localStoragePaths.trashDir,
+      ]);
+
+      unawaited(process.stderr.drain());
+
+      await for (final line
+          in process.stdout
+              .transform(utf8.decoder)
+              .transform(const LineSplitter())) {
+        logger.d('Reclaiming ${localStoragePaths.trashDir}: $line');
+      }
+
+      final exitCode = await process.exitCode;
+      if (exitCode != 0) {
+        logger.w('dir-reclaimer has exited with code $exitCode');
+      }
     } catch (e, stackTrace) {
-      final logger = GetIt.I.get<Logger>();
-      logger.e(
-        'Failed to get the host architecture name using "uname -m"',
+      logger.w(
+        'Failed to reclaim ${localStoragePaths.trashDir}',
         error: e,
         stackTrace: stackTrace,
       );
-      throw GenericException(
-        'Unable to get the architecture name: ${e.toString()}',
-      );
     }
   }
 
-  static Future<bool> _isMuvmAvailable() async {
+  /// Deleting a Wine build, or a failed extraction of one, leaves behind
+  /// objects in the Wine build store nothing links to anymore. That's why
+  /// this runs after the trash is emptied. Builds installed before the store
+  /// existed are brought into it first, which only has to be done once.
+  /// wine-build-store refuses to run while archive-extractor is extracting
+  /// a build into the store, in which case this is retried on next startup.
+  static Future<void> _maintainWineBuildStore({
+    required LocalStoragePaths localStoragePaths,
+  }) async {
+    final logger = GetIt.I.get<Logger>();
+    final storeDir = localStoragePaths.wineBuildStoreDir;
+    final ingestedMarkerFile = File(
+      localStoragePaths.wineBuildStoreIngestedMarkerFilePath,
+    );
+
     try {
-      final result = await Process.run('which', ['muvm']);
-      return result.exitCode == 0;
+      if (!await ingestedMarkerFile.exists()) {
+        final ingested = await _runWineBuildStore([
+          storeDir,
+          'ingest',
+          localStoragePaths.wineInstallsDir,
+        ]);
+        if (ingested) {
+          await ingestedMarkerFile.create();
+        }
+      }
+
+      await _runWineBuildStore([storeDir, 'gc']);
     } catch (e, stackTrace) {
-      // This is not normal. If muvm is not installed, 'which' should just
-      // return a non-zero code.
-      final logger = GetIt.I.get<Logger>();
       logger.w(
-        'Runnining "which muvm" failed',
+        'Failed to maintain the Wine build store at $storeDir',
         error: e,
         stackTrace: stackTrace,
       );
+    }
+  }
+
+  /// Prefixes get their own copies of Wine's DLLs and of the same runtime
+  /// redistributables. Where the filesystem supports it, prefix-dedupe makes
+  /// those copies share storage. The kernel compares the contents before
+  /// sharing anything, so files in use by Wine are safe. Files that were
+  /// hashed on previous runs aren't hashed again, which keeps later runs
+  /// cheap.
+  static Future<void> _dedupeFiles({
+    required LocalStoragePaths localStoragePaths,
+  }) async {
+    final logger = GetIt.I.get<Logger>();
+
+    try {
+      final processResult = await Process.run(
+        LocalStoragePaths.prefixDedupePath,
+        [
+          localStoragePaths.dedupeStateFilePath,
+          localStoragePaths.winePrefixesDir,
+          localStoragePaths.wineInstallsDir,
+        ],
+      );
+
+      if (processResult.exitCode != 0) {
+        logger.w(
+          'prefix-dedupe has exited with code ${processResult.exitCode}: '
+          '${processResult.stderr}',
+        );
+        return;
+      }
+
+      logger.i('prefix-dedupe: ${processResult.stdout}');
+    } catch (e, stackTrace) {
+      logger.w('Failed to run prefix-dedupe', error: e, stackTrace: stackTrace);
+    }
+  }
+
+  static Future<bool> _runWineBuildStore(List<String> args) async {
+    final logger = GetIt.I.get<Logger>();
+
+    final processResult = await Process.run(
+      LocalStoragePaths.wineBuildStorePath,
+      args,
+    );
+
+    if (processResult.exitCode != 0) {
+      logger.w(
+        'wine-build-store ${args.skip(1).join(' ')} has exited with code '
+        '${processResult.exitCode}: ${processResult.stderr}',
+      );
       return false;
     }
+
+    logger.i('wine-build-store ${args[1]}: ${processResult.stdout}');
+    return true;
   }
 
   static Future<void> _loadSettingsFromExistingDataDir({
@@ -0,0 +1,75 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:developer';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+
+/// The Dart side of the opt-in startup trace the GTK runner writes when
+/// the WINEBAR_STARTUP_TRACE environment variable is set. Spans are
+/// collected here and handed over to the runner by [flush].
+abstract final class StartupTrace {
+  static final bool enabled =
+      Platform.environment['WINEBAR_STARTUP_TRACE']?.isNotEmpty ?? false;
+
+  static const _channel = MethodChannel('winebar/startup_trace');
+
+  static final _pendingSpans = <List<Object>>[];
+
+  /// Records how long [body] takes, if tracing is enabled.
+  static Future<T> span<T>(String name, Future<T> Function() body) async {
+    if (!enabled) {
+      return body();
+    }
+
+    final start = Timeline.now;
+    try {
+      return await body();
+    } finally {
+      _pendingSpans.add([name, start, Timeline.now]);
+    }
+  }
+
+  /// Sends the recorded spans to the runner. Failures are logged but
+  /// otherwise ignored.
+  static Future<void> flush() async {
+    if (!enabled || _pendingSpans.isEmpty) {
+      return;
+    }
+
+    final spans = List.of(_pendingSpans);
+    _pendingSpans.clear();
+
+    try {
+      // "now" lets the runner map Timeline.now onto its own clock.
+      await _channel.invokeMethod('addSpans', {
+        'now': Timeline.now,
+        'spans': spans,
+      });
+    } catch (e, stackTrace) {
+      GetIt.I.get<Logger>().w(
+        'Failed to pass the startup trace to the runner',
+        error: e,
+        stackTrace: stackTrace,
+      );
+    }
+  }
+}
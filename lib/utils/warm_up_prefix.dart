@@ -0,0 +1,109 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/services/utility_service.dart';
+import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/utils/prefix_descriptor.dart';
+import 'package:winebar/utils/startup_data.dart';
+
+/// How long the pre-warmed wineserver stays around after the last Wine
+/// process in the prefix exits.
+///
+/// It's kept short, as "wineserver -w", which the launches not going through
+/// launch-shim.exe use to wait for their background processes, waits for the
+/// wineserver itself to exit. Such a launch reuses the pre-warmed wineserver
+/// rather than stopping it, so it gets reported as finished that much later.
+const prefixKeepalive = Duration(seconds: 30);
+
+/// When we last had each prefix warmed up, keyed by the prefix's outer
+/// directory.
+final _lastWarmUps = <String, DateTime>{};
+
+/// Has log-capturing-runner start a wineserver for [winePrefix] ahead of time
+/// and read the core Wine modules into the page cache, so that the launch the
+/// user is about to make doesn't have to wait for either. Call it when the
+/// user is about to do something in the prefix, like opening its page.
+///
+/// This does nothing unless [PrefixDescriptor.warmUpOnOpen] is set for the
+/// prefix, as well as under muvm, where every launch waits for the wineserver
+/// to exit. It never throws.
+Future<void> warmUpPrefix({
+  required StartupData startupData,
+  required WinePrefix winePrefix,
+}) async {
+  if (!winePrefix.descriptor.warmUpOnOpen || startupData.wineWillRunUnderMuvm) {
+    return;
+  }
+
+  final logger = GetIt.I.get<Logger>();
+  final prefixKey = winePrefix.dirStructure.outerDir;
+
+  // A wineserver we started that recently can't have exited yet.
+  final now = DateTime.now();
+  final lastWarmUp = _lastWarmUps[prefixKey];
+  if (lastWarmUp != null && now.difference(lastWarmUp) < prefixKeepalive) {
+    return;
+  }
+  _lastWarmUps[prefixKey] = now;
+
+  try {
+    final utilityService = GetIt.I.get<UtilityService>();
+
+    final wineInstDescriptor = await utilityService
+        .wineInstallationDescriptorForWineInstallDir(
+          winePrefix.descriptor.getAbsPathToWineInstall(
+            toplevelDataDir: startupData.localStoragePaths.toplevelDataDir,
+          ),
+        );
+
+    final processOutputDir = await startupData.localStoragePaths
+        .createProcessOutputDir();
+
+    final envVars = wineInstDescriptor.getEnvVarsForWine(
+      winePrefix: winePrefix,
+      processOutputDir: processOutputDir.path,
+      forWinetricks: false,
+      disableLogs: false,
+    );
+    envVars['LOG_CAPTURING_RUNNER_PRETOUCH'] = '1';
+
+    final wineProcess = await startupData.wineProcessRunnerService
+        .startKeepalive(
+          processOutputDir: processOutputDir,
+          envVars: envVars,
+          keepalive: prefixKeepalive,
+        );
+
+    final result = await wineProcess.result;
+
+    // The log-capturing-runner log tells whether the prefix was warm already.
+    for (final log in result.logs) {
+      logger.d('Warming up $prefixKey, ${log.name}:\n${log.content}');
+    }
+  } catch (e, stackTrace) {
+    _lastWarmUps.remove(prefixKey);
+    logger.w(
+      'Failed to warm up the prefix at $prefixKey',
+      error: e,
+      stackTrace: stackTrace,
+    );
+  }
+}
@@ -16,10 +16,17 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:get_it/get_it.dart';
+import 'package:logger/logger.dart';
 import 'package:winebar/models/special_executable_slot.dart';
 import 'package:winebar/models/wine_prefix.dart';
 import 'package:winebar/repositories/running_executables_repo.dart';
+import 'package:winebar/services/running_wine_processes_tracker.dart';
 import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/utils/local_storage_paths.dart';
 import 'package:winebar/utils/startup_data.dart';
 import 'package:winebar/utils/wine_installation_descriptor.dart';
 
@@ -47,6 +54,107 @@ Future<WineProcess> startTaskOfPrefixInitialization({
   );
 }
 
+/// Tries to set the HiDPI scale by editing the prefix's user.reg directly,
+/// which takes milliseconds rather than the seconds it takes to spin up
+/// wineserver just to run reg.exe.
+///
+/// Returns false if that wasn't possible, in which case the caller is expected
+/// to fall back to [startTaskOfSettingHiDpiScale]. That happens if any of our
+/// Wine processes are running in the prefix, if wine-reg-edit finds a running
+/// wineserver for it, or if wine-reg-edit fails for any other reason.
+Future<bool> trySettingHiDpiScaleNatively({
+  required double hiDpiScale,
+  required WinePrefix winePrefix,
+  required WineInstallationDescriptor wineInstDescriptor,
+}) async {
+  // wineserver keeps the registry in memory and overwrites the hive files
+  // when it exits, so it mustn't be running while we edit them. When running
+  // under muvm, wine-reg-edit can't see wineserver running inside the VM,
+  // which makes this check the only line of defense there.
+  final numProcessesRunningInPrefix = GetIt.I
+      .get<RunningWineProcessesTracker>()
+      .numProcessesRunningInPrefix(winePrefix);
+  if (numProcessesRunningInPrefix > 0) {
+    return false;
+  }
+
+  final logger = GetIt.I.get<Logger>();
+
+  try {
+    final processResult = await Process.run(
+      LocalStoragePaths.wineRegEditPath,
+      [
+        wineInstDescriptor.getInnermostPrefixDir(
+          prefixDirStructure: winePrefix.dirStructure,
+        ),
+        'set-dword',
+        'HKEY_CURRENT_USER\\Control Panel\\Desktop',
+        'LogPixels',
+        _hiDpiScaleToLogPixels(hiDpiScale).toString(),
+      ],
+    );
+
+    if (processResult.exitCode != 0) {
+      logger.i(
+        'wine-reg-edit exited with code ${processResult.exitCode}, '
+        'falling back to reg.exe: ${processResult.stderr}',
+      );
+      return false;
+    }
+
+    return true;
+  } catch (e) {
+    logger.w('Failed to run wine-reg-edit, falling back to reg.exe', error: e);
+    return false;
+  }
+}
+
+/// Reads the HiDPI scale from the prefix's user.reg through wine-reg-query,
+/// which doesn't need Wine to be started.
+///
+/// Returns null if LogPixels is not set or couldn't be read. While Wine runs
+/// in the prefix, the result may lag behind the registry wineserver keeps in
+/// memory.
+Future<double?> tryReadingHiDpiScaleNatively({
+  required WinePrefix winePrefix,
+  required WineInstallationDescriptor wineInstDescriptor,
+}) async {
+  final logger = GetIt.I.get<Logger>();
+
+  try {
+    final processResult = await Process.run(
+      LocalStoragePaths.wineRegQueryPath,
+      [
+        wineInstDescriptor.getInnermostPrefixDir(
+          prefixDirStructure: winePrefix.dirStructure,
+        ),
+        'get',
+        'HKEY_CURRENT_USER\\Control Panel\\Desktop',
+        'LogPixels',
+      ],
+    );
+
+    if (processResult.exitCode != 0) {
+      logger.i(
+        'wine-reg-query exited with code ${processResult.exitCode}: '
+        '${processResult.stderr}',
+      );
+      return null;
+    }
+
+    // This is to be kept in sync with wine-reg-query.cpp
+    final value = jsonDecode(processResult.stdout as String);
+    if (value is! Map<String, dynamic> || value['type'] != 'REG_DWORD') {
+      return null;
+    }
+
+    return _logPixelsToHiDpiScale(value['data'] as int);
+  } catch (e) {
+    logger.w('Failed to read the HiDPI scale through wine-reg-query', error: e);
+    return null;
+  }
+}
+
 Future<WineProcess> startTaskOfSettingHiDpiScale({
   required double hiDpiScale,
   required StartupData startupData,
@@ -69,7 +177,7 @@ Future<WineProcess> startTaskOfSettingHiDpiScale({
       '/t',
       'REG_DWORD',
       '/d',
-      (hiDpiScale * 96).round().toString(),
+      _hiDpiScaleToLogPixels(hiDpiScale).toString(),
       '/f',
     ],
     startupData: startupData,
@@ -80,6 +188,10 @@ Future<WineProcess> startTaskOfSettingHiDpiScale({
   );
 }
 
+int _hiDpiScaleToLogPixels(double hiDpiScale) => (hiDpiScale * 96).round();
+
+double _logPixelsToHiDpiScale(int logPixels) => logPixels / 96;
+
 Future<WineProcess> _startWineProcess<SlotType>({
   required List<String> wineArgs,
   required StartupData startupData,
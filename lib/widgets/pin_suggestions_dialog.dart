@@ -0,0 +1,128 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:io';
+
+import 'package:flutter/material.dart';
+import 'package:flutter_bloc/flutter_bloc.dart';
+import 'package:material_design_icons_flutter/material_design_icons_flutter.dart';
+import 'package:winebar/blocs/pin_suggestions/pin_suggestions_bloc.dart';
+import 'package:winebar/blocs/pin_suggestions/pin_suggestions_state.dart';
+import 'package:winebar/models/pin_suggestion.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/utils/startup_data.dart';
+import 'package:winebar/widgets/error_message_widget.dart';
+
+class PinSuggestionsDialog extends StatelessWidget {
+  final StartupData startupData;
+  final WinePrefix winePrefix;
+
+  /// Called after the dialog is closed as a result of the user picking
+  /// one of the suggestions.
+  final void Function(PinSuggestion) onSuggestionPicked;
+
+  static const double _iconDim = 32.0;
+
+  const PinSuggestionsDialog({
+    super.key,
+    required this.startupData,
+    required this.winePrefix,
+    required this.onSuggestionPicked,
+  });
+
+  @override
+  Widget build(BuildContext context) {
+    return BlocProvider(
+      create: (context) =>
+          PinSuggestionsBloc(startupData: startupData, winePrefix: winePrefix),
+      child: BlocBuilder<PinSuggestionsBloc, PinSuggestionsState>(
+        builder: (context, state) {
+          return AlertDialog(
+            title: const Text('Executables to pin'),
+            content: SizedBox(
+              width: 600.0,
+              height: 400.0,
+              child: _buildContent(context, state),
+            ),
+            actions: <Widget>[
+              TextButton(
+                child: const Text('Close'),
+                onPressed: () {
+                  Navigator.of(context).pop();
+                },
+              ),
+            ],
+          );
+        },
+      ),
+    );
+  }
+
+  Widget _buildContent(BuildContext context, PinSuggestionsState state) {
+    switch (state.status) {
+      case PinSuggestionsStatus.searching:
+        return const Center(child: CircularProgressIndicator());
+      case PinSuggestionsStatus.failed:
+        return Center(
+          child: ErrorMessageWidget(
+            text: state.failureMessage ?? 'Failed to look for executables',
+          ),
+        );
+      case PinSuggestionsStatus.succeeded:
+        if (state.suggestions.isEmpty) {
+          return const Center(
+            child: Text('No executables worth pinning were found'),
+          );
+        }
+        return ListView.builder(
+          itemCount: state.suggestions.length,
+          itemBuilder: (context, index) =>
+              _buildSuggestionTile(context, state.suggestions[index]),
+        );
+    }
+  }
+
+  Widget _buildSuggestionTile(BuildContext context, PinSuggestion suggestion) {
+    final iconFilePath = suggestion.iconFilePath;
+
+    return ListTile(
+      leading: iconFilePath != null
+          ? Image.file(
+              File(iconFilePath),
+              width: _iconDim,
+              height: _iconDim,
+              errorBuilder: (context, error, stackTrace) =>
+                  Icon(MdiIcons.applicationOutline, size: _iconDim),
+            )
+          : Icon(MdiIcons.applicationOutline, size: _iconDim),
+      title: Text(suggestion.label, overflow: TextOverflow.ellipsis),
+      subtitle: Text(
+        suggestion.executablePath,
+        overflow: TextOverflow.ellipsis,
+      ),
+      trailing: TextButton.icon(
+        icon: Icon(MdiIcons.pin),
+        label: const Text('Pin'),
+        onPressed: () {
+          Navigator.of(context).pop();
+          onSuggestionPicked(suggestion);
+        },
+      ),
+    );
+  }
+}
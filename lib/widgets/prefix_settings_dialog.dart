@@ -115,6 +115,7 @@ class PrefixSettingsDialog extends StatelessWidget {
                               state.hiDpiScale == null,
                         ),
                         ?_maybeBuildWow64PreferenceToggle(context, state),
+                        _buildWarmUpToggle(context, state),
                         _buildUpdatePrefixButton(context, state),
                         if (state.prefixUpdateFailureMessage != null)
                           ErrorMessageWidget(
@@ -164,6 +165,39 @@ class PrefixSettingsDialog extends StatelessWidget {
     );
   }
 
+  Widget _buildWarmUpToggle(BuildContext context, PrefixSettingsState state) {
+    final theme = Theme.of(context);
+    final enabled = state.prefixUpdateStatus != PrefixUpdateStatus.inProgress;
+
+    return InputDecorator(
+      decoration: InputDecoration(
+        enabled: enabled,
+        label: const Text('Startup'),
+        border: OutlineInputBorder(borderRadius: BorderRadius.circular(8)),
+      ),
+      child: Row(
+        spacing: 8.0,
+        mainAxisAlignment: MainAxisAlignment.spaceBetween,
+        children: [
+          Flexible(
+            child: Text(
+              'Start Wine in advance when opening this prefix. Apps will '
+              'start faster, but Wine will keep running for a while after '
+              'they exit.',
+              style: enabled ? null : TextStyle(color: theme.disabledColor),
+            ),
+          ),
+          Switch(
+            value: state.warmUpOnOpen,
+            onChanged: enabled
+                ? BlocProvider.of<PrefixSettingsBloc>(context).setWarmUpOnOpen
+                : null,
+          ),
+        ],
+      ),
+    );
+  }
+
   Widget _buildUpdatePrefixButton(
     BuildContext context,
     PrefixSettingsState state,
@@ -0,0 +1,248 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+import 'dart:async';
+
+import 'package:flutter/material.dart';
+import 'package:flutter_bloc/flutter_bloc.dart';
+import 'package:material_design_icons_flutter/material_design_icons_flutter.dart';
+import 'package:winebar/blocs/prefix_snapshots/prefix_snapshots_bloc.dart';
+import 'package:winebar/blocs/prefix_snapshots/prefix_snapshots_state.dart';
+import 'package:winebar/models/prefix_snapshot.dart';
+import 'package:winebar/models/wine_prefix.dart';
+import 'package:winebar/utils/startup_data.dart';
+import 'package:winebar/widgets/error_message_widget.dart';
+
+/// Lets the user create restore points of a prefix, roll the prefix back
+/// to one of them and delete them.
+class PrefixSnapshotsDialog extends StatefulWidget {
+  final StartupData startupData;
+  final WinePrefix prefix;
+
+  /// Called after the prefix was rolled back to a restore point.
+  final void Function() onPrefixRestored;
+
+  const PrefixSnapshotsDialog({
+    super.key,
+    required this.startupData,
+    required this.prefix,
+    required this.onPrefixRestored,
+  });
+
+  @override
+  State<PrefixSnapshotsDialog> createState() => _PrefixSnapshotsDialogState();
+}
+
+class _PrefixSnapshotsDialogState extends State<PrefixSnapshotsDialog> {
+  final _labelController = TextEditingController();
+
+  @override
+  void dispose() {
+    _labelController.dispose();
+    super.dispose();
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return BlocProvider(
+      create: (_) => PrefixSnapshotsBloc(
+        startupData: widget.startupData,
+        winePrefix: widget.prefix,
+      ),
+      child: BlocBuilder<PrefixSnapshotsBloc, PrefixSnapshotsState>(
+        builder: (context, state) {
+          final bloc = BlocProvider.of<PrefixSnapshotsBloc>(context);
+          final failureMessage = state.failureMessage;
+
+          return AlertDialog(
+            title: const Text('Restore points'),
+            content: SizedBox(
+              width: 600.0,
+              height: 400.0,
+              child: Column(
+                spacing: 8.0,
+                children: [
+                  Row(
+                    spacing: 8.0,
+                    children: [
+                      Expanded(
+                        child: TextField(
+                          controller: _labelController,
+                          enabled: !state.operationInProgress,
+                          decoration: const InputDecoration(
+                            labelText: 'Label of a new restore point',
+                          ),
+                        ),
+                      ),
+                      FilledButton.icon(
+                        icon: Icon(MdiIcons.backupRestore),
+                        label: const Text('Create'),
+                        onPressed: state.operationInProgress
+                            ? null
+                            : () {
+                                unawaited(
+                                  bloc.createSnapshot(
+                                    label: _labelController.text.trim(),
+                                  ),
+                                );
+                                _labelController.clear();
+                              },
+                      ),
+                    ],
+                  ),
+                  if (state.operationInProgress)
+                    const LinearProgressIndicator(),
+                  if (failureMessage != null)
+                    ErrorMessageWidget(text: failureMessage),
+                  Expanded(child: _buildSnapshotList(context, state)),
+                ],
+              ),
+            ),
+            actions: <Widget>[
+              TextButton(
+                onPressed: state.operationInProgress
+                    ? null
+                    : () => Navigator.of(context).pop(),
+                child: const Text('Close'),
+              ),
+            ],
+          );
+        },
+      ),
+    );
+  }
+
+  Widget _buildSnapshotList(BuildContext context, PrefixSnapshotsState state) {
+    switch (state.status) {
+      case PrefixSnapshotsStatus.loading:
+        return const Center(child: CircularProgressIndicator());
+      case PrefixSnapshotsStatus.failed:
+        // The failure message is shown above.
+        return const SizedBox.shrink();
+      case PrefixSnapshotsStatus.ready:
+        if (state.snapshots.isEmpty) {
+          return const Center(child: Text('There are no restore points yet'));
+        }
+
+        // Newest first.
+        final snapshots = state.snapshots.reversed.toList();
+
+        return ListView.builder(
+          itemCount: snapshots.length,
+          itemBuilder: (context, index) =>
+              _buildSnapshotTile(context, state, snapshots[index]),
+        );
+    }
+  }
+
+  Widget _buildSnapshotTile(
+    BuildContext context,
+    PrefixSnapshotsState state,
+    PrefixSnapshot snapshot,
+  ) {
+    final bloc = BlocProvider.of<PrefixSnapshotsBloc>(context);
+    final createdAt = _formatDateTime(snapshot.createdAt);
+
+    return ListTile(
+      title: Text(
+        snapshot.label.isNotEmpty ? snapshot.label : createdAt,
+        overflow: TextOverflow.ellipsis,
+      ),
+      subtitle: Text(
+        '$createdAt, ${_formatSize(snapshot.numBytes)} in '
+        '${snapshot.numFiles} files',
+      ),
+      trailing: Row(
+        mainAxisSize: MainAxisSize.min,
+        children: [
+          IconButton(
+            icon: Icon(MdiIcons.restore),
+            tooltip: 'Roll the prefix back to this point',
+            onPressed: state.operationInProgress
+                ? null
+                : () => unawaited(
+                    _confirmAndRestore(
+                      context: context,
+                      bloc: bloc,
+                      snapshot: snapshot,
+                    ),
+                  ),
+          ),
+          IconButton(
+            icon: Icon(MdiIcons.delete),
+            tooltip: 'Delete this restore point',
+            onPressed: state.operationInProgress
+                ? null
+                : () => unawaited(bloc.deleteSnapshot(snapshot)),
+          ),
+        ],
+      ),
+    );
+  }
+
+  Future<void> _confirmAndRestore({
+    required BuildContext context,
+    required PrefixSnapshotsBloc bloc,
+    required PrefixSnapshot snapshot,
+  }) async {
+    final confirmed = await showDialog<bool>(
+      context: context,
+      builder: (context) => AlertDialog(
+        title: const Text('Prefix rollback confirmation'),
+        content: const Text(
+          'Any changes made to the prefix since this restore point '
+          'was created will be lost.',
+        ),
+        actions: <Widget>[
+          TextButton.icon(
+            icon: Icon(MdiIcons.restore),
+            label: const Text('Roll back'),
+            onPressed: () => Navigator.of(context).pop(true),
+          ),
+          TextButton(
+            child: const Text('Cancel'),
+            onPressed: () => Navigator.of(context).pop(false),
+          ),
+        ],
+      ),
+    );
+
+    if (confirmed == true && await bloc.restoreSnapshot(snapshot)) {
+      widget.onPrefixRestored();
+    }
+  }
+
+  static String _formatDateTime(DateTime dateTime) {
+    String twoDigits(int n) => n.toString().padLeft(2, '0');
+
+    return '${dateTime.year}-${twoDigits(dateTime.month)}-'
+        '${twoDigits(dateTime.day)} ${twoDigits(dateTime.hour)}:'
+        '${twoDigits(dateTime.minute)}';
+  }
+
+  static String _formatSize(int bytes) {
+    const mib = 1024 * 1024;
+    const gib = 1024 * mib;
+
+    if (bytes >= gib) {
+      return '${(bytes / gib).toStringAsFixed(1)} GiB';
+    } else {
+      return '${(bytes / mib).toStringAsFixed(1)} MiB';
+    }
+  }
+}
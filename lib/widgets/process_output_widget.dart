@@ -28,14 +28,25 @@ class ProcessOutputWidget extends StatelessWidget {
   @protected
   final ProcessOutput processOutput;
 
-  const ProcessOutputWidget({super.key, required this.processOutput});
+  /// Keeps updating the logs while the process is running.
+  @protected
+  final Stream<ProcessLogChunk>? liveLogs;
+
+  const ProcessOutputWidget({
+    super.key,
+    required this.processOutput,
+    this.liveLogs,
+  });
 
   @override
   Widget build(BuildContext context) {
     final colorScheme = Theme.of(context).colorScheme;
 
     return BlocProvider(
-      create: (context) => ProcessOutputViewBloc(processOutput: processOutput),
+      create: (context) => ProcessOutputViewBloc(
+        processOutput: processOutput,
+        liveLogs: liveLogs,
+      ),
       child: BlocBuilder<ProcessOutputViewBloc, ProcessOutputViewState>(
         builder: (context, state) {
           return Scaffold(
@@ -58,15 +69,12 @@ class ProcessOutputWidget extends StatelessWidget {
                               state.selectedLogIndex ??
                               state.processOutput.logs.length,
                           children: [
-                            ...state.processOutput.logs.map(
-                              (log) => SelectableText(
-                                log.content,
-                                style: TextStyle(fontFamily: 'monospace'),
-                              ),
-                            ),
+                            ...state.processOutput.logs.map(_buildLogView),
                             Center(
                               child: Text(
-                                'No logs were captured from this process',
+                                liveLogs != null
+                                    ? 'No logs have been captured yet'
+                                    : 'No logs were captured from this process',
                                 textAlign: TextAlign.center,
                                 style: TextStyle(fontSize: 16.0),
                               ),
@@ -85,6 +93,26 @@ class ProcessOutputWidget extends StatelessWidget {
     );
   }
 
+  Widget _buildLogView(ProcessLog log) {
+    const style = TextStyle(fontFamily: 'monospace');
+
+    final logFile = log.logFile;
+    if (logFile == null) {
+      return SelectableText(log.content, style: style);
+    }
+
+    // Only the lines scrolled into view get decoded.
+    return SelectionArea(
+      child: ListView.builder(
+        itemCount: logFile.stats.numLines,
+        itemBuilder: (context, index) => Text(
+          logFile.decodedLines(index, 1).firstOrNull ?? '',
+          style: style,
+        ),
+      ),
+    );
+  }
+
   Widget _buildLogSelectionControls(BuildContext context) {
     return BlocBuilder<ProcessOutputViewBloc, ProcessOutputViewState>(
       builder: (context, state) {
@@ -58,7 +58,10 @@ class RunProcessChip extends StatelessWidget {
             start: extraSpaceBetweenIconAndLabel,
             end: extraTrailingSpace,
           ),
-          onPressed: onPrimaryButtonPressed,
+          // While the process is running, its live logs are a click away.
+          onPressed: specialExecutableState.isRunning
+              ? onViewLogsPressed
+              : onPrimaryButtonPressed,
         ),
         ?_maybeBuildAuxButton(context),
       ],
@@ -25,20 +25,23 @@ import 'package:flutter/material.dart';
 import 'package:flutter_bloc/flutter_bloc.dart';
 import 'package:get_it/get_it.dart';
 import 'package:material_design_icons_flutter/material_design_icons_flutter.dart';
-import 'package:path/path.dart' as path;
 import 'package:winebar/blocs/pinned_executable/pinned_executable_bloc.dart';
 import 'package:winebar/blocs/pinned_executable/pinned_executable_state.dart';
 import 'package:winebar/blocs/pinned_executable_set/pinned_executable_set_bloc.dart';
 import 'package:winebar/blocs/special_executable/special_executable_bloc.dart';
 import 'package:winebar/blocs/special_executable/special_executable_state.dart';
+import 'package:winebar/models/pin_suggestion.dart';
 import 'package:winebar/models/pinned_executable.dart';
 import 'package:winebar/models/pinned_executable_list_event.dart';
+import 'package:winebar/models/process_output.dart';
 import 'package:winebar/services/utility_service.dart';
 import 'package:winebar/utils/maybe_tell_user_to_finish_running_apps.dart';
 import 'package:winebar/utils/startup_data.dart';
 import 'package:winebar/widgets/bouncing_widget.dart';
 import 'package:winebar/widgets/pin_executable_button.dart';
+import 'package:winebar/widgets/pin_suggestions_dialog.dart';
 import 'package:winebar/widgets/prefix_settings_dialog.dart';
+import 'package:winebar/widgets/prefix_snapshots_dialog.dart';
 import 'package:winebar/widgets/run_process_chip.dart';
 
 import '../blocs/pinned_executable_set/pinned_executable_set_state.dart';
@@ -76,7 +79,11 @@ class WinePrefixPage extends StatelessWidget {
     return MultiBlocProvider(
       providers: [
         BlocProvider<PrefixDetailsBloc>(
-          create: (context) => PrefixDetailsBloc(prefix: initialPrefix),
+          create: (context) {
+            final bloc = PrefixDetailsBloc(prefix: initialPrefix);
+            unawaited(bloc.refreshDiskUsage());
+            return bloc;
+          },
         ),
         BlocProvider<PinnedExecutableSetBloc>(
           create: (context) => PinnedExecutableSetBloc(
@@ -134,6 +141,21 @@ class WinePrefixPage extends StatelessWidget {
                   winePrefix: state.prefix,
                 ),
               ),
+              BlocProvider<PinExecutableBloc>(
+                // We provide a key in order to force the bloc to be recreated
+                // when the prefix is modified.
+                key: ValueKey(state.prefix),
+
+                create: (context) => PinExecutableBloc(
+                  startupData: startupData,
+                  winePrefix: state.prefix,
+                  processExecutablePinnedInTempDir:
+                      (executablePinnedInTempDir) =>
+                          BlocProvider.of<PinnedExecutableSetBloc>(
+                            context,
+                          ).pinExecutable(executablePinnedInTempDir),
+                ),
+              ),
             ],
             child: Stack(
               children: [
@@ -145,6 +167,19 @@ class WinePrefixPage extends StatelessWidget {
                       maxLines: 1,
                       overflow: TextOverflow.ellipsis,
                     ),
+                    actions: [
+                      _buildSuggestPinsButton(prefix: state.prefix),
+                      if (state.diskUsageBytes != null)
+                        Padding(
+                          padding: EdgeInsets.symmetric(horizontal: 16.0),
+                          child: Tooltip(
+                            message: 'Disk space taken by the prefix',
+                            child: Text(
+                              _formatDiskUsage(state.diskUsageBytes!),
+                            ),
+                          ),
+                        ),
+                    ],
                   ),
                   body: _PinnedExecutablesGridWidget(
                     startupData: startupData,
@@ -174,6 +209,17 @@ class WinePrefixPage extends StatelessWidget {
     );
   }
 
+  static String _formatDiskUsage(int bytes) {
+    const mib = 1024 * 1024;
+    const gib = 1024 * mib;
+
+    if (bytes >= gib) {
+      return '${(bytes / gib).toStringAsFixed(1)} GiB';
+    } else {
+      return '${(bytes / mib).toStringAsFixed(1)} MiB';
+    }
+  }
+
   Widget _buildBottomPanel({
     required BuildContext context,
     required PrefixDetailsState state,
@@ -212,11 +258,30 @@ class WinePrefixPage extends StatelessWidget {
             // We apply a negative padding in order to avoid
             // enlarging the bottom panel.
             padding: EdgeInsets.symmetric(vertical: -8.0),
-            child: IconButton.filledTonal(
-              icon: Icon(MdiIcons.cogs),
-              onPressed: () {
-                _maybeShowPrefixSettingsDialog(context: context, state: state);
-              },
+            child: Row(
+              mainAxisSize: MainAxisSize.min,
+              spacing: 8.0,
+              children: [
+                IconButton.filledTonal(
+                  icon: Icon(MdiIcons.backupRestore),
+                  tooltip: 'Restore points',
+                  onPressed: () {
+                    _maybeShowPrefixSnapshotsDialog(
+                      context: context,
+                      state: state,
+                    );
+                  },
+                ),
+                IconButton.filledTonal(
+                  icon: Icon(MdiIcons.cogs),
+                  onPressed: () {
+                    _maybeShowPrefixSettingsDialog(
+                      context: context,
+                      state: state,
+                    );
+                  },
+                ),
+              ],
             ),
           ),
         ],
@@ -224,6 +289,43 @@ class WinePrefixPage extends StatelessWidget {
     );
   }
 
+  void _maybeShowPrefixSnapshotsDialog({
+    required BuildContext context,
+    required PrefixDetailsState state,
+  }) {
+    final prefixDetailsBloc = BlocProvider.of<PrefixDetailsBloc>(context);
+
+    // Restore points can't be created or restored while Wine is running
+    // in the prefix.
+    if (maybeTellUserToFinishRunningApps(
+      context: context,
+      appsRunningInThisPrefixAreAProblem: state.prefix,
+      appsRunningInAnyPrefixAreAProblem: startupData.wineWillRunUnderMuvm,
+    )) {
+      return;
+    }
+
+    void showPrefixRestoredSnackBar() {
+      const snackBar = SnackBar(content: Text('Wine prefix rolled back'));
+      ScaffoldMessenger.of(context).showSnackBar(snackBar);
+    }
+
+    unawaited(
+      showDialog(
+        context: context,
+        barrierDismissible: false,
+        builder: (context) => PrefixSnapshotsDialog(
+          startupData: startupData,
+          prefix: state.prefix,
+          onPrefixRestored: () {
+            showPrefixRestoredSnackBar();
+            unawaited(prefixDetailsBloc.refreshDiskUsage());
+          },
+        ),
+      ),
+    );
+  }
+
   void _maybeShowPrefixSettingsDialog({
     required BuildContext context,
     required PrefixDetailsState state,
@@ -290,22 +392,45 @@ class WinePrefixPage extends StatelessWidget {
       );
     }
 
-    return BlocProvider(
-      // We provide a key in order to force the bloc to be recreated
-      // when the prefix is modified.
-      key: ValueKey(prefix),
-
-      create: (context) => PinExecutableBloc(
-        startupData: startupData,
-        winePrefix: prefix,
-        processExecutablePinnedInTempDir: (executablePinnedInTempDir) =>
-            BlocProvider.of<PinnedExecutableSetBloc>(
-              context,
-            ).pinExecutable(executablePinnedInTempDir),
-      ),
-      child: BlocBuilder<PinExecutableBloc, SpecialExecutableState>(
-        builder: (context, state) => buildButton(context, state),
-      ),
+    return BlocBuilder<PinExecutableBloc, SpecialExecutableState>(
+      builder: (context, state) => buildButton(context, state),
+    );
+  }
+
+  Widget _buildSuggestPinsButton({required WinePrefix prefix}) {
+    return BlocBuilder<PinExecutableBloc, SpecialExecutableState>(
+      builder: (context, state) {
+        final bloc = BlocProvider.of<PinExecutableBloc>(context);
+
+        void pinSuggestion(PinSuggestion suggestion) {
+          if (maybeTellUserToFinishRunningApps(
+            context: context,
+            appsRunningInThisPrefixAreAProblem: prefix,
+            appsRunningInAnyPrefixAreAProblem: startupData.wineWillRunUnderMuvm,
+          )) {
+            return;
+          }
+
+          bloc.startProcess([suggestion.executablePath]);
+        }
+
+        return IconButton(
+          icon: Icon(MdiIcons.magnify),
+          tooltip: 'Suggest executables to pin',
+          onPressed: state.isRunning
+              ? null
+              : () => unawaited(
+                  showDialog<void>(
+                    context: context,
+                    builder: (_) => PinSuggestionsDialog(
+                      startupData: startupData,
+                      winePrefix: prefix,
+                      onSuggestionPicked: pinSuggestion,
+                    ),
+                  ),
+                ),
+        );
+      },
     );
   }
 
@@ -328,8 +453,11 @@ class WinePrefixPage extends StatelessWidget {
         specialExecutableBloc: specialExecutableBloc,
       ),
       onKillProcessPressed: () => specialExecutableBloc.killProcessIfRunning(),
-      onViewLogsPressed: () =>
-          _viewProcessLogs(context: context, specialExecutableState: state),
+      onViewLogsPressed: () => _viewProcessLogs(
+        context: context,
+        specialExecutableBloc: specialExecutableBloc,
+        specialExecutableState: state,
+      ),
     );
   }
 
@@ -350,8 +478,11 @@ class WinePrefixPage extends StatelessWidget {
         specialExecutableBloc: specialExecutableBloc,
       ),
       onKillProcessPressed: () => specialExecutableBloc.killProcessIfRunning(),
-      onViewLogsPressed: () =>
-          _viewProcessLogs(context: context, specialExecutableState: state),
+      onViewLogsPressed: () => _viewProcessLogs(
+        context: context,
+        specialExecutableBloc: specialExecutableBloc,
+        specialExecutableState: state,
+      ),
     );
   }
 
@@ -369,8 +500,11 @@ class WinePrefixPage extends StatelessWidget {
       onPrimaryButtonPressed: () =>
           specialExecutableBloc.startProcess(['winecfg.exe']),
       onKillProcessPressed: () => specialExecutableBloc.killProcessIfRunning(),
-      onViewLogsPressed: () =>
-          _viewProcessLogs(context: context, specialExecutableState: state),
+      onViewLogsPressed: () => _viewProcessLogs(
+        context: context,
+        specialExecutableBloc: specialExecutableBloc,
+        specialExecutableState: state,
+      ),
     );
   }
 
@@ -391,8 +525,11 @@ class WinePrefixPage extends StatelessWidget {
       onPrimaryButtonPressed: () =>
           specialExecutableBloc.startProcess(['--gui']),
       onKillProcessPressed: () => specialExecutableBloc.killProcessIfRunning(),
-      onViewLogsPressed: () =>
-          _viewProcessLogs(context: context, specialExecutableState: state),
+      onViewLogsPressed: () => _viewProcessLogs(
+        context: context,
+        specialExecutableBloc: specialExecutableBloc,
+        specialExecutableState: state,
+      ),
     );
   }
 
@@ -440,11 +577,25 @@ class WinePrefixPage extends StatelessWidget {
 
   void _viewProcessLogs({
     required BuildContext context,
+    required SpecialExecutableBloc specialExecutableBloc,
     required SpecialExecutableState specialExecutableState,
   }) {
+    final runningProcess = specialExecutableBloc.runningProcess;
     final processOutput = specialExecutableState.processOutput;
 
-    if (processOutput != null) {
+    if (specialExecutableState.isRunning && runningProcess != null) {
+      unawaited(
+        Navigator.push(
+          context,
+          MaterialPageRoute(
+            builder: (_) => ProcessOutputWidget(
+              processOutput: ProcessOutput(logs: []),
+              liveLogs: runningProcess.watchLogs(),
+            ),
+          ),
+        ),
+      );
+    } else if (processOutput != null) {
       unawaited(
         Navigator.push(
           context,
@@ -563,9 +714,9 @@ class _PinnedAppsGridState extends State<_PinnedExecutablesGridWidget> {
     Widget buildWidgetTree(BuildContext context, PinnedExecutableState state) {
       final bloc = BlocProvider.of<PinnedExecutableBloc>(context);
 
-      final String? imageFilePath = pinnedExecutable.hasIcon
-          ? path.join(pinnedExecutable.pinDirectory, 'icon.png')
-          : null;
+      final String? imageFilePath = pinnedExecutable.iconFilePathForSize(
+        _iconDim * MediaQuery.devicePixelRatioOf(context),
+      );
 
       return FadeTransition(
         opacity: animation,
@@ -31,6 +31,7 @@ import 'package:winebar/models/prefix_list_event.dart';
 import 'package:winebar/utils/app_info.dart';
 import 'package:winebar/utils/local_storage_paths.dart';
 import 'package:winebar/utils/maybe_tell_user_to_finish_running_apps.dart';
+import 'package:winebar/utils/warm_up_prefix.dart';
 import 'package:winebar/widgets/gesture_recognizer_holder.dart';
 
 import '../blocs/prefix_list/prefix_list_bloc.dart';
@@ -47,7 +48,11 @@ class WinePrefixesPage extends StatelessWidget {
   @override
   Widget build(BuildContext context) {
     return BlocProvider<PrefixListBloc>(
-      create: (context) => PrefixListBloc(startupData.winePrefixes),
+      create: (context) => PrefixListBloc(
+        startupData.winePrefixes,
+        wineProcessRunnerService: startupData.wineProcessRunnerService,
+        winebarAgentService: startupData.winebarAgentService,
+      ),
       child: Builder(
         builder: (context) {
           return Scaffold(
@@ -449,6 +454,11 @@ class _WinePrefixesListState extends State<_WinePrefixesList> {
     required StartupData startupData,
     required WinePrefix winePrefix,
   }) async {
+    // This overlaps with loading the pinned executables.
+    unawaited(
+      warmUpPrefix(startupData: startupData, winePrefix: winePrefix),
+    );
+
     final bloc = BlocProvider.of<PrefixListBloc>(context);
     final pinnedExecutables = await bloc.startLoadingPinnedExecutablesFor(
       winePrefix,
@@ -0,0 +1,324 @@
+#include "log_tail_plugin.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib-unix.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct CaptureFile {
+  const char *name;
+
+  // log-capturing-runner rewrites stdout.txt, stderr.txt and crash.txt as
+  // a whole every now and then, so their new contents are not necessarily an
+  // extension of the old ones. Its own log is only ever appended to.
+  bool rewritten_in_place;
+};
+
+const CaptureFile kCaptureFiles[] = {
+    {"stdout.txt", true},
+    {"stderr.txt", true},
+    {"crash.txt", true},
+    {"log-capturing-runner.txt", false},
+};
+
+const size_t kNumCaptureFiles = G_N_ELEMENTS(kCaptureFiles);
+
+struct Watch {
+  int64_t id;
+  gchar *dir;
+  int inotify_fd;
+  guint source_id;
+
+  // What was sent for each of kCaptureFiles. Only the size is kept for the
+  // append-only ones.
+  GByteArray *sent_contents[kNumCaptureFiles];
+  off_t sent_sizes[kNumCaptureFiles];
+};
+
+FlMethodChannel *channel = nullptr;
+GHashTable *watches_by_id = nullptr;
+int64_t next_watch_id = 1;
+
+void watch_free(Watch *watch) {
+  if (watch->source_id != 0) {
+    g_source_remove(watch->source_id);
+  }
+  close(watch->inotify_fd);
+  for (size_t i = 0; i < kNumCaptureFiles; ++i) {
+    if (watch->sent_contents[i] != nullptr) {
+      g_byte_array_unref(watch->sent_contents[i]);
+    }
+  }
+  g_free(watch->dir);
+  g_free(watch);
+}
+
+// Reads up to @p length bytes starting at @p offset. Returns null on error.
+GBytes *read_range(int fd, off_t offset, size_t length) {
+  guint8 *buf = static_cast<guint8 *>(g_malloc(length));
+  size_t total = 0;
+
+  while (total < length) {
+    const ssize_t bytes_read =
+        pread(fd, buf + total, length - total, offset + total);
+    if (bytes_read == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes_read == -1) {
+      g_free(buf);
+      return nullptr;
+    } else if (bytes_read == 0) {
+      break;
+    }
+    total += bytes_read;
+  }
+
+  return g_bytes_new_take(buf, total);
+}
+
+void send_chunk(Watch *watch, size_t file_idx, bool replace, GBytes *data) {
+  g_autoptr(FlValue) args = fl_value_new_list();
+  fl_value_append_take(args, fl_value_new_int(watch->id));
+  fl_value_append_take(args, fl_value_new_string(kCaptureFiles[file_idx].name));
+  fl_value_append_take(args, fl_value_new_bool(replace));
+  fl_value_append_take(args, fl_value_new_uint8_list_from_bytes(data));
+  fl_method_channel_invoke_method(channel, "chunk", args, nullptr, nullptr,
+                                  nullptr);
+}
+
+void send_closed(int64_t watch_id) {
+  g_autoptr(FlValue) args = fl_value_new_int(watch_id);
+  fl_method_channel_invoke_method(channel, "closed", args, nullptr, nullptr,
+                                  nullptr);
+}
+
+void update_append_only_file(Watch *watch, size_t file_idx, int fd,
+                             off_t size) {
+  bool replace = false;
+  if (size < watch->sent_sizes[file_idx]) {
+    // Truncated, so start over.
+    watch->sent_sizes[file_idx] = 0;
+    replace = true;
+  }
+
+  const off_t offset = watch->sent_sizes[file_idx];
+  if (size == offset && !replace) {
+    return;
+  }
+
+  g_autoptr(GBytes) data = read_range(fd, offset, size - offset);
+  if (data == nullptr) {
+    return;
+  }
+
+  watch->sent_sizes[file_idx] = offset + g_bytes_get_size(data);
+  send_chunk(watch, file_idx, replace, data);
+}
+
+// The files rewritten in place are capped at about 16 KiB by
+// log-capturing-runner, so they are read whole, and comparing them to what
+// was sent before tells an extension from a rewrite.
+void update_rewritten_file(Watch *watch, size_t file_idx, int fd,
+                           off_t size) {
+  g_autoptr(GBytes) data = read_range(fd, 0, size);
+  if (data == nullptr) {
+    return;
+  }
+
+  gsize data_size = 0;
+  const guint8 *data_ptr =
+      static_cast<const guint8 *>(g_bytes_get_data(data, &data_size));
+
+  GByteArray *sent = watch->sent_contents[file_idx];
+  if (sent == nullptr) {
+    sent = watch->sent_contents[file_idx] = g_byte_array_new();
+  }
+
+  const size_t common_size = MIN(data_size, sent->len);
+  const bool prefix_matches =
+      common_size == 0 || memcmp(data_ptr, sent->data, common_size) == 0;
+
+  if (prefix_matches && data_size <= sent->len) {
+    // Either unchanged or caught in the middle of being rewritten, in which
+    // case the event for the rest of the write is yet to come.
+    return;
+  }
+
+  if (prefix_matches) {
+    g_autoptr(GBytes) appended =
+        g_bytes_new_from_bytes(data, sent->len, data_size - sent->len);
+    send_chunk(watch, file_idx, false, appended);
+  } else {
+    send_chunk(watch, file_idx, true, data);
+  }
+
+  g_byte_array_set_size(sent, 0);
+  g_byte_array_append(sent, data_ptr, data_size);
+}
+
+void update_file(Watch *watch, size_t file_idx) {
+  g_autofree gchar *path =
+      g_build_filename(watch->dir, kCaptureFiles[file_idx].name, nullptr);
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return;  // Not created yet.
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    if (kCaptureFiles[file_idx].rewritten_in_place) {
+      update_rewritten_file(watch, file_idx, fd, st.st_size);
+    } else {
+      update_append_only_file(watch, file_idx, fd, st.st_size);
+    }
+  }
+
+  close(fd);
+}
+
+gboolean inotify_cb(gint fd, GIOCondition condition, gpointer user_data) {
+  Watch *watch = static_cast<Watch *>(user_data);
+
+  // Events are coalesced per file, as each update reads whatever is there.
+  bool dirty[kNumCaptureFiles] = {};
+  bool dir_gone = (condition & (G_IO_ERR | G_IO_HUP)) != 0;
+
+  alignas(struct inotify_event) char buf[4096];
+  for (;;) {
+    const ssize_t len = read(fd, buf, sizeof(buf));
+    if (len <= 0) {
+      break;
+    }
+
+    for (char *p = buf; p < buf + len;) {
+      const struct inotify_event *event =
+          reinterpret_cast<const struct inotify_event *>(p);
+      p += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        dir_gone = true;
+      } else if (event->len > 0) {
+        for (size_t i = 0; i < kNumCaptureFiles; ++i) {
+          if (strcmp(event->name, kCaptureFiles[i].name) == 0) {
+            dirty[i] = true;
+          }
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < kNumCaptureFiles; ++i) {
+    if (dirty[i] && !dir_gone) {
+      update_file(watch, i);
+    }
+  }
+
+  if (dir_gone) {
+    // Removing the watch from the table frees it, and the source is already
+    // on its way out.
+    watch->source_id = 0;
+    const int64_t watch_id = watch->id;
+    g_hash_table_remove(watches_by_id, &watch_id);
+    send_closed(watch_id);
+    return G_SOURCE_REMOVE;
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+
+FlMethodResponse *start_watch(FlValue *args, Watch **started_watch) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad-args", "Expected the directory to watch", nullptr));
+  }
+
+  const gchar *dir = fl_value_get_string(args);
+
+  const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd == -1) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "inotify", g_strerror(errno), nullptr));
+  }
+
+  if (inotify_add_watch(inotify_fd, dir,
+                        IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE |
+                            IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                            IN_ONLYDIR) == -1) {
+    g_autofree gchar *message =
+        g_strdup_printf("Failed to watch %s: %s", dir, g_strerror(errno));
+    close(inotify_fd);
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("inotify", message, nullptr));
+  }
+
+  Watch *watch = g_new0(Watch, 1);
+  watch->id = next_watch_id++;
+  watch->dir = g_strdup(dir);
+  watch->inotify_fd = inotify_fd;
+  watch->source_id = g_unix_fd_add(inotify_fd, G_IO_IN, inotify_cb, watch);
+  g_hash_table_insert(watches_by_id, &watch->id, watch);
+  *started_watch = watch;
+
+  return FL_METHOD_RESPONSE(
+      fl_method_success_response_new(fl_value_new_int(watch->id)));
+}
+
+FlMethodResponse *stop_watch(FlValue *args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_INT) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad-args", "Expected a watch ID", nullptr));
+  }
+
+  // Unknown IDs are fine, as the directory may be gone already.
+  const int64_t watch_id = fl_value_get_int(args);
+  g_hash_table_remove(watches_by_id, &watch_id);
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+void method_call_cb(FlMethodChannel *channel, FlMethodCall *method_call,
+                    gpointer user_data) {
+  g_autoptr(FlMethodResponse) response = nullptr;
+  const gchar *method = fl_method_call_get_name(method_call);
+  Watch *started_watch = nullptr;
+
+  if (g_strcmp0(method, "watch") == 0) {
+    response =
+        start_watch(fl_method_call_get_args(method_call), &started_watch);
+  } else if (g_strcmp0(method, "unwatch") == 0) {
+    response = stop_watch(fl_method_call_get_args(method_call));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond to a log tail call: %s", error->message);
+  }
+
+  if (started_watch != nullptr) {
+    // Whatever was written before the watch was set up. This goes out after
+    // the response with the watch ID, so the Dart side knows what it's for.
+    for (size_t i = 0; i < kNumCaptureFiles; ++i) {
+      update_file(started_watch, i);
+    }
+  }
+}
+
+}  // namespace
+
+void log_tail_plugin_register_with_registrar(FlPluginRegistrar *registrar) {
+  watches_by_id = g_hash_table_new_full(
+      g_int64_hash, g_int64_equal, nullptr,
+      reinterpret_cast<GDestroyNotify>(watch_free));
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  channel = fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                  "winebar/log_tail", FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(channel, method_call_cb, nullptr,
+                                            nullptr);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <flutter_linux/flutter_linux.h>
+
+/**
+ * Lets the Dart side follow the capture files log-capturing-runner writes
+ * into a process output directory while the process is still running.
+ *
+ * The "winebar/log_tail" method channel takes "watch" with the directory as
+ * the argument, which returns a watch ID, and "unwatch" with that ID. For
+ * each change to a capture file, we invoke "chunk" with
+ * [id, file_name, replace, bytes], where replace says whether the bytes
+ * replace what was sent for that file so far rather than extend it. Once the
+ * directory is gone, we invoke "closed" with the ID.
+ */
+void log_tail_plugin_register_with_registrar(FlPluginRegistrar *registrar);
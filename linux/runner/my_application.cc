@@ -1,4 +1,8 @@
 #include "my_application.h"
+#include "log_tail_plugin.h"
+#include "pinned_launch.h"
+#include "process_supervisor_plugin.h"
+#include "startup_trace.h"
 #include "utils.h"
 
 #include <flutter_linux/flutter_linux.h>
@@ -8,21 +12,31 @@
 
 #include "flutter/generated_plugin_registrant.h"
 
+#include <errno.h>
+#include <unistd.h>
+
 struct _MyApplication {
   GtkApplication parent_instance;
   char **dart_entrypoint_arguments;
+
+  // The "winebar/pin_launch" method channel of PinLaunchService.
+  FlMethodChannel *pin_launch_channel;
 };
 
 G_DEFINE_TYPE(MyApplication, my_application, GTK_TYPE_APPLICATION)
 
 // Called when first Flutter frame received.
 static void first_frame_cb(MyApplication *self, FlView *view) {
+  startup_trace_instant("first frame");
   gtk_widget_show(gtk_widget_get_toplevel(GTK_WIDGET(view)));
 }
 
 // Implements GApplication::activate.
 static void my_application_activate(GApplication *application) {
   MyApplication *self = MY_APPLICATION(application);
+  const int64_t activate_start = startup_trace_now();
+
+  int64_t span_start = startup_trace_now();
   GtkWindow *window =
       GTK_WINDOW(gtk_application_window_new(GTK_APPLICATION(application)));
 
@@ -54,12 +68,18 @@ static void my_application_activate(GApplication *application) {
   }
 
   gtk_window_set_default_size(window, 1280, 720);
+  startup_trace_span("window creation", span_start);
 
+  span_start = startup_trace_now();
   g_autoptr(FlDartProject) project = fl_dart_project_new();
   fl_dart_project_set_dart_entrypoint_arguments(
       project, self->dart_entrypoint_arguments);
+  startup_trace_span("fl_dart_project_new", span_start);
 
+  span_start = startup_trace_now();
   FlView *view = fl_view_new(project);
+  startup_trace_span("fl_view_new", span_start);
+
   GdkRGBA background_color;
   // Background defaults to black, override it here if necessary, e.g. #00000000
   // for transparent.
@@ -72,11 +92,110 @@ static void my_application_activate(GApplication *application) {
   // Requires the view to be realized so we can start rendering.
   g_signal_connect_swapped(view, "first-frame", G_CALLBACK(first_frame_cb),
                            self);
+
+  span_start = startup_trace_now();
   gtk_widget_realize(GTK_WIDGET(view));
+  startup_trace_span("gtk_widget_realize", span_start);
 
+  span_start = startup_trace_now();
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
+  g_autoptr(FlPluginRegistrar) log_tail_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(FL_PLUGIN_REGISTRY(view),
+                                                  "LogTailPlugin");
+  log_tail_plugin_register_with_registrar(log_tail_registrar);
+  g_autoptr(FlPluginRegistrar) process_supervisor_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(FL_PLUGIN_REGISTRY(view),
+                                                  "ProcessSupervisorPlugin");
+  process_supervisor_plugin_register_with_registrar(
+      process_supervisor_registrar);
+  FlBinaryMessenger *messenger =
+      fl_engine_get_binary_messenger(fl_view_get_engine(view));
+  startup_trace_listen_to_dart(messenger);
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->pin_launch_channel = fl_method_channel_new(
+      messenger, "winebar/pin_launch", FL_METHOD_CODEC(codec));
+  startup_trace_span("fl_register_plugins", span_start);
 
   gtk_widget_grab_focus(GTK_WIDGET(view));
+  startup_trace_span("activate", activate_start);
+}
+
+static void launch_pin_response_cb(GObject *object, GAsyncResult *result,
+                                   gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlMethodResponse) response = fl_method_channel_invoke_method_finish(
+      FL_METHOD_CHANNEL(object), result, &error);
+  if (response == nullptr ||
+      fl_method_response_get_result(response, &error) == nullptr) {
+    g_warning("Failed to launch a pin: %s", error->message);
+  }
+}
+
+// Implements the "launch-pin" action, through which instances started with
+// --launch hand their request over to an already running instance. The
+// request is passed on to PinLaunchService, so that the process is tracked
+// like the ones launched from the UI.
+static void launch_pin_activated(GSimpleAction *action, GVariant *parameter,
+                                 gpointer user_data) {
+  MyApplication *self = MY_APPLICATION(user_data);
+
+  const gchar *prefix_dir_name = nullptr;
+  const gchar *pin_dir_name = nullptr;
+  g_variant_get(parameter, "(&s&s)", &prefix_dir_name, &pin_dir_name);
+
+  if (self->pin_launch_channel == nullptr) {
+    g_warning("Can't launch pin %s of prefix %s without the UI", pin_dir_name,
+              prefix_dir_name);
+    return;
+  }
+
+  g_autoptr(FlValue) args = fl_value_new_list();
+  fl_value_append_take(args, fl_value_new_string(prefix_dir_name));
+  fl_value_append_take(args, fl_value_new_string(pin_dir_name));
+  fl_method_channel_invoke_method(self->pin_launch_channel, "launchPin", args,
+                                  nullptr, launch_pin_response_cb, nullptr);
+}
+
+// Handles "--launch <prefix> <pin>", which is what launchers outside of the
+// app use to start a pinned executable. The Flutter engine is never started:
+// either the running instance is asked to launch it, or we replace ourselves
+// with the command from the pin's launch.json.
+static int launch_pin_headless(GApplication *application,
+                               const gchar *prefix_dir_name,
+                               const gchar *pin_dir_name) {
+  g_autoptr(GError) error = nullptr;
+  if (!g_application_register(application, nullptr, &error)) {
+    g_warning("Failed to register: %s", error->message);
+    return 1;
+  }
+
+  if (g_application_get_is_remote(application)) {
+    g_action_group_activate_action(
+        G_ACTION_GROUP(application), "launch-pin",
+        g_variant_new("(ss)", prefix_dir_name, pin_dir_name));
+
+    // The action is sent asynchronously, and we are about to exit.
+    GDBusConnection *connection =
+        g_application_get_dbus_connection(application);
+    if (connection != nullptr) {
+      g_dbus_connection_flush_sync(connection, nullptr, nullptr);
+    }
+    return 0;
+  }
+
+  g_auto(GStrv) argv = nullptr;
+  g_auto(GStrv) envp = nullptr;
+  if (!pinned_launch_build_command(prefix_dir_name, pin_dir_name, &argv, &envp,
+                                   &error)) {
+    g_warning("Failed to launch pin %s of prefix %s: %s", pin_dir_name,
+              prefix_dir_name, error->message);
+    return 1;
+  }
+
+  startup_trace_instant("exec");
+  execvpe(argv[0], argv, envp);
+  g_warning("Failed to execute %s: %s", argv[0], g_strerror(errno));
+  return 1;
 }
 
 // Implements GApplication::local_command_line.
@@ -84,11 +203,24 @@ static gboolean my_application_local_command_line(GApplication *application,
                                                   gchar ***arguments,
                                                   int *exit_status) {
   MyApplication *self = MY_APPLICATION(application);
+  startup_trace_instant("local_command_line");
+
+  if (g_strv_length(*arguments) == 4 &&
+      g_strcmp0((*arguments)[1], "--launch") == 0) {
+    *exit_status =
+        launch_pin_headless(application, (*arguments)[2], (*arguments)[3]);
+    return TRUE;
+  }
+
   // Strip out the first argument as it is the binary name.
   self->dart_entrypoint_arguments = g_strdupv(*arguments + 1);
 
   g_autoptr(GError) error = nullptr;
-  if (!g_application_register(application, nullptr, &error)) {
+  const int64_t register_start = startup_trace_now();
+  const gboolean registered =
+      g_application_register(application, nullptr, &error);
+  startup_trace_span("g_application_register", register_start);
+  if (!registered) {
     g_warning("Failed to register: %s", error->message);
     *exit_status = 1;
     return TRUE;
@@ -106,7 +238,10 @@ static void my_application_startup(GApplication *application) {
 
   // Perform any actions required at application startup.
 
+  // This is where GTK gets initialized.
+  const int64_t startup_start = startup_trace_now();
   G_APPLICATION_CLASS(my_application_parent_class)->startup(application);
+  startup_trace_span("gtk startup", startup_start);
 }
 
 // Implements GApplication::shutdown.
@@ -114,6 +249,7 @@ static void my_application_shutdown(GApplication *application) {
   // MyApplication* self = MY_APPLICATION(object);
 
   // Perform any actions required at application shutdown.
+  startup_trace_finish();
 
   G_APPLICATION_CLASS(my_application_parent_class)->shutdown(application);
 }
@@ -122,6 +258,7 @@ static void my_application_shutdown(GApplication *application) {
 static void my_application_dispose(GObject *object) {
   MyApplication *self = MY_APPLICATION(object);
   g_clear_pointer(&self->dart_entrypoint_arguments, g_strfreev);
+  g_clear_object(&self->pin_launch_channel);
   G_OBJECT_CLASS(my_application_parent_class)->dispose(object);
 }
 
@@ -134,7 +271,13 @@ static void my_application_class_init(MyApplicationClass *klass) {
   G_OBJECT_CLASS(klass)->dispose = my_application_dispose;
 }
 
-static void my_application_init(MyApplication *self) {}
+static void my_application_init(MyApplication *self) {
+  static const GActionEntry actions[] = {
+      {"launch-pin", launch_pin_activated, "(ss)", nullptr, nullptr, {}},
+  };
+  g_action_map_add_action_entries(G_ACTION_MAP(self), actions,
+                                  G_N_ELEMENTS(actions), self);
+}
 
 MyApplication *my_application_new() {
   // Set the program name to the application ID, which helps various systems
@@ -0,0 +1,188 @@
+#include "pinned_launch.h"
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <errno.h>
+#include <string.h>
+
+namespace {
+
+// These should be kept in sync with LocalStoragePaths,
+// WinePrefixDirStructure, PinnedExecutable and PinLaunchService on the Dart
+// side.
+const char kToplevelDirName[] = "WineBarData";
+const char kWinePrefixesDirName[] = "wine-prefixes";
+const char kPinsDirName[] = "pins";
+const char kLaunchJsonFileName[] = "launch.json";
+
+gboolean is_valid_dir_name(const char *name) {
+  return name[0] != '\0' && strchr(name, '/') == nullptr &&
+         strcmp(name, ".") != 0 && strcmp(name, "..") != 0;
+}
+
+FlValue *load_json_object(const char *file_path, GError **error) {
+  g_autofree gchar *contents = nullptr;
+  if (!g_file_get_contents(file_path, &contents, nullptr, error)) {
+    return nullptr;
+  }
+
+  // The codec is just a JSON parser that happens to be at hand. It doesn't
+  // need the engine.
+  g_autoptr(FlJsonMessageCodec) codec = fl_json_message_codec_new();
+  g_autoptr(FlValue) value =
+      fl_json_message_codec_decode(codec, contents, error);
+  if (value == nullptr) {
+    return nullptr;
+  }
+
+  if (fl_value_get_type(value) != FL_VALUE_TYPE_MAP) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "%s doesn't contain a JSON object", file_path);
+    return nullptr;
+  }
+
+  return fl_value_ref(value);
+}
+
+FlValue *lookup_typed(FlValue *object, const char *key, FlValueType type,
+                      const char *file_path, GError **error) {
+  FlValue *value = fl_value_lookup_string(object, key);
+  if (value == nullptr || fl_value_get_type(value) != type) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "%s lacks a valid \"%s\" entry", file_path, key);
+    return nullptr;
+  }
+  return value;
+}
+
+// Replaces every occurrence of the placeholder with the process output
+// directory, which is different for each launch.
+gchar *substitute(FlValue *value, const char *placeholder,
+                  const char *process_output_dir) {
+  g_auto(GStrv) parts =
+      g_strsplit(fl_value_get_string(value), placeholder, -1);
+  return g_strjoinv(process_output_dir, parts);
+}
+
+}  // namespace
+
+gboolean pinned_launch_build_command(const char *prefix_dir_name,
+                                     const char *pin_dir_name, gchar ***argv,
+                                     gchar ***envp, GError **error) {
+  if (!is_valid_dir_name(prefix_dir_name) || !is_valid_dir_name(pin_dir_name)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Invalid prefix or pin name");
+    return FALSE;
+  }
+
+  const gchar *home_dir = g_getenv("HOME");
+  if (home_dir == nullptr) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                "Couldn't read the HOME environment variable");
+    return FALSE;
+  }
+
+  // Pins created by older versions get their launch.json once the app is
+  // started.
+  g_autofree gchar *launch_json_path = g_build_filename(
+      home_dir, kToplevelDirName, kWinePrefixesDirName, prefix_dir_name,
+      kPinsDirName, pin_dir_name, kLaunchJsonFileName, nullptr);
+  g_autoptr(FlValue) launch_json = load_json_object(launch_json_path, error);
+  if (launch_json == nullptr) {
+    return FALSE;
+  }
+
+  FlValue *temp_dir = lookup_typed(launch_json, "tempDir",
+                                   FL_VALUE_TYPE_STRING, launch_json_path,
+                                   error);
+  if (temp_dir == nullptr) {
+    return FALSE;
+  }
+  FlValue *placeholder =
+      lookup_typed(launch_json, "processOutputDirPlaceholder",
+                   FL_VALUE_TYPE_STRING, launch_json_path, error);
+  if (placeholder == nullptr) {
+    return FALSE;
+  }
+  if (fl_value_get_string(placeholder)[0] == '\0') {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "%s has an empty placeholder", launch_json_path);
+    return FALSE;
+  }
+  FlValue *executable = lookup_typed(launch_json, "executable",
+                                     FL_VALUE_TYPE_STRING, launch_json_path,
+                                     error);
+  if (executable == nullptr) {
+    return FALSE;
+  }
+  FlValue *args = lookup_typed(launch_json, "args", FL_VALUE_TYPE_LIST,
+                               launch_json_path, error);
+  if (args == nullptr) {
+    return FALSE;
+  }
+  FlValue *env_vars = lookup_typed(launch_json, "envVars", FL_VALUE_TYPE_MAP,
+                                   launch_json_path, error);
+  if (env_vars == nullptr) {
+    return FALSE;
+  }
+  for (size_t i = 0; i < fl_value_get_length(args); ++i) {
+    if (fl_value_get_type(fl_value_get_list_value(args, i)) !=
+        FL_VALUE_TYPE_STRING) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "%s has a non-string argument", launch_json_path);
+      return FALSE;
+    }
+  }
+  for (size_t i = 0; i < fl_value_get_length(env_vars); ++i) {
+    if (fl_value_get_type(fl_value_get_map_key(env_vars, i)) !=
+            FL_VALUE_TYPE_STRING ||
+        fl_value_get_type(fl_value_get_map_value(env_vars, i)) !=
+            FL_VALUE_TYPE_STRING) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "%s has a non-string environment variable",
+                  launch_json_path);
+      return FALSE;
+    }
+  }
+
+  // Nobody collects the output of a headless launch, but log-capturing-runner
+  // still needs a directory to write the exit status to. Whatever is left of
+  // it is removed along with the rest of the temp directory on the next
+  // startup of the UI.
+  const gchar *temp_dir_path = fl_value_get_string(temp_dir);
+  g_mkdir_with_parents(temp_dir_path, 0777);
+  g_autofree gchar *process_output_dir =
+      g_build_filename(temp_dir_path, "process-outdir-XXXXXX", nullptr);
+  if (g_mkdtemp(process_output_dir) == nullptr) {
+    g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno),
+                "Failed to create a directory in %s: %s", temp_dir_path,
+                g_strerror(errno));
+    return FALSE;
+  }
+
+  const gchar *placeholder_string = fl_value_get_string(placeholder);
+
+  GPtrArray *argv_array = g_ptr_array_new_with_free_func(g_free);
+  g_ptr_array_add(argv_array, substitute(executable, placeholder_string,
+                                         process_output_dir));
+  for (size_t i = 0; i < fl_value_get_length(args); ++i) {
+    g_ptr_array_add(argv_array,
+                    substitute(fl_value_get_list_value(args, i),
+                               placeholder_string, process_output_dir));
+  }
+  g_ptr_array_add(argv_array, nullptr);
+
+  gchar **environment = g_get_environ();
+  for (size_t i = 0; i < fl_value_get_length(env_vars); ++i) {
+    g_autofree gchar *value =
+        substitute(fl_value_get_map_value(env_vars, i), placeholder_string,
+                   process_output_dir);
+    environment = g_environ_setenv(
+        environment, fl_value_get_string(fl_value_get_map_key(env_vars, i)),
+        value, TRUE);
+  }
+
+  *argv = reinterpret_cast<gchar **>(g_ptr_array_free(argv_array, FALSE));
+  *envp = environment;
+  return TRUE;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glib.h>
+
+/**
+ * Loads the command for launching a pinned executable without going through
+ * the Dart side. That command is resolved in advance by PinLaunchService,
+ * which writes it into the pin's launch.json file. All that's left to do here
+ * is to create a process output directory for it.
+ *
+ * The @p prefix_dir_name is the name of the prefix's directory under
+ * WineBarData/wine-prefixes and @p pin_dir_name is the name of the pin's
+ * directory under the prefix's "pins" directory.
+ *
+ * On success, @p argv and @p envp are to be freed with g_strfreev().
+ */
+gboolean pinned_launch_build_command(const char *prefix_dir_name,
+                                     const char *pin_dir_name, gchar ***argv,
+                                     gchar ***envp, GError **error);
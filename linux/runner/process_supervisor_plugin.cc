@@ -0,0 +1,230 @@
+#include "process_supervisor_plugin.h"
+
+#include <errno.h>
+#include <glib-unix.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace {
+
+struct SupervisedProcess {
+  int pidfd;
+  int64_t pid;
+  gchar *group;
+};
+
+FlMethodChannel *channel = nullptr;
+int epoll_fd = -1;
+
+// Group name -> GINT_TO_POINTER(number of processes running). Groups with no
+// processes running are removed.
+GHashTable *counts_by_group = nullptr;
+int64_t total_count = 0;
+
+int group_count(const gchar *group) {
+  return GPOINTER_TO_INT(g_hash_table_lookup(counts_by_group, group));
+}
+
+void adjust_group_count(const gchar *group, int delta) {
+  const int count = group_count(group) + delta;
+  if (count > 0) {
+    g_hash_table_insert(counts_by_group, g_strdup(group),
+                        GINT_TO_POINTER(count));
+  } else {
+    g_hash_table_remove(counts_by_group, group);
+  }
+  total_count += delta;
+}
+
+// The pid comes from Process.start() on the Dart side, which may have reaped
+// the process by the time the pid gets here, letting the kernel hand the pid to
+// an unrelated process. Only a child of ours can be the process Dart started.
+// Reading /proc by pid is racy in the same way, but if the pidfd still refers
+// to a live process afterwards, both refer to the same one.
+bool is_own_child(int pidfd, int64_t pid) {
+  g_autofree gchar *stat_path =
+      g_strdup_printf("/proc/%" G_GINT64_FORMAT "/stat", pid);
+  g_autofree gchar *stat = nullptr;
+  if (!g_file_get_contents(stat_path, &stat, nullptr, nullptr)) {
+    return false;
+  }
+
+  // The command name in parentheses may contain anything, including spaces
+  // and parentheses, so the fields are parsed from after the last ')'.
+  const char *const comm_end = strrchr(stat, ')');
+  char state;
+  int ppid;
+  if (comm_end == nullptr ||
+      sscanf(comm_end + 1, " %c %d", &state, &ppid) != 2) {
+    return false;
+  }
+
+  return ppid == getpid() &&
+         syscall(SYS_pidfd_send_signal, pidfd, 0, nullptr, 0) == 0;
+}
+
+FlMethodResponse *supervise(FlValue *args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_LIST ||
+      fl_value_get_length(args) != 2 ||
+      fl_value_get_type(fl_value_get_list_value(args, 0)) !=
+          FL_VALUE_TYPE_INT ||
+      fl_value_get_type(fl_value_get_list_value(args, 1)) !=
+          FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad-args", "Expected [pid, group]", nullptr));
+  }
+
+  const int64_t pid = fl_value_get_int(fl_value_get_list_value(args, 0));
+  const gchar *group = fl_value_get_string(fl_value_get_list_value(args, 1));
+
+  bool supervised = false;
+  const int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+  if (pidfd != -1 && !is_own_child(pidfd, pid)) {
+    // Our process is gone, same as if pidfd_open() had failed with ESRCH.
+    close(pidfd);
+  } else if (pidfd != -1) {
+    SupervisedProcess *process = g_new0(SupervisedProcess, 1);
+    process->pidfd = pidfd;
+    process->pid = pid;
+    process->group = g_strdup(group);
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = process;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pidfd, &event) == -1) {
+      const int error = errno;
+      close(pidfd);
+      g_free(process->group);
+      g_free(process);
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "epoll", g_strerror(error), nullptr));
+    }
+
+    adjust_group_count(group, 1);
+    supervised = true;
+  } else if (errno != ESRCH) {
+    // Most likely a kernel older than 5.3.
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "pidfd", g_strerror(errno), nullptr));
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "supervised",
+                           fl_value_new_bool(supervised));
+  fl_value_set_string_take(result, "count",
+                           fl_value_new_int(group_count(group)));
+  fl_value_set_string_take(result, "total", fl_value_new_int(total_count));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+gboolean epoll_cb(gint fd, GIOCondition condition, gpointer user_data) {
+  g_autoptr(GArray) exited_pids = g_array_new(FALSE, FALSE, sizeof(int64_t));
+  g_autoptr(GHashTable) changed_groups =
+      g_hash_table_new_full(g_str_hash, g_str_equal, g_free, nullptr);
+
+  struct epoll_event events[64];
+  for (;;) {
+    const int num_events = epoll_wait(fd, events, G_N_ELEMENTS(events), 0);
+    if (num_events <= 0) {
+      break;
+    }
+
+    for (int i = 0; i < num_events; ++i) {
+      // A pidfd becomes readable once its process has exited. Reaping it is
+      // left to the Dart side, which started it.
+      SupervisedProcess *process =
+          static_cast<SupervisedProcess *>(events[i].data.ptr);
+      epoll_ctl(fd, EPOLL_CTL_DEL, process->pidfd, nullptr);
+      close(process->pidfd);
+
+      adjust_group_count(process->group, -1);
+      g_array_append_val(exited_pids, process->pid);
+      g_hash_table_add(changed_groups, g_steal_pointer(&process->group));
+      g_free(process);
+    }
+
+    if (num_events < static_cast<int>(G_N_ELEMENTS(events))) {
+      break;
+    }
+  }
+
+  if (exited_pids->len == 0) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  g_autoptr(FlValue) counts = fl_value_new_map();
+  GHashTableIter iter;
+  gpointer group;
+  g_hash_table_iter_init(&iter, changed_groups);
+  while (g_hash_table_iter_next(&iter, &group, nullptr)) {
+    fl_value_set_string_take(
+        counts, static_cast<const gchar *>(group),
+        fl_value_new_int(group_count(static_cast<const gchar *>(group))));
+  }
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(
+      args, "exited",
+      fl_value_new_int64_list(
+          reinterpret_cast<const int64_t *>(exited_pids->data),
+          exited_pids->len));
+  fl_value_set_string(args, "counts", counts);
+  fl_value_set_string_take(args, "total", fl_value_new_int(total_count));
+  fl_method_channel_invoke_method(channel, "update", args, nullptr, nullptr,
+                                  nullptr);
+
+  return G_SOURCE_CONTINUE;
+}
+
+void method_call_cb(FlMethodChannel *channel, FlMethodCall *method_call,
+                    gpointer user_data) {
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (g_strcmp0(fl_method_call_get_name(method_call), "supervise") == 0) {
+    response = supervise(fl_method_call_get_args(method_call));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond to a process supervisor call: %s",
+              error->message);
+  }
+}
+
+}  // namespace
+
+void process_supervisor_plugin_register_with_registrar(
+    FlPluginRegistrar *registrar) {
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd == -1) {
+    // Without the channel handler, the Dart side gets MissingPluginException
+    // and keeps track of processes on its own.
+    g_warning("epoll_create1() failed: %s", g_strerror(errno));
+    return;
+  }
+
+  counts_by_group =
+      g_hash_table_new_full(g_str_hash, g_str_equal, g_free, nullptr);
+  g_unix_fd_add(epoll_fd, G_IO_IN, epoll_cb, nullptr);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  channel = fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                  "winebar/process_supervisor",
+                                  FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(channel, method_call_cb, nullptr,
+                                            nullptr);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <flutter_linux/flutter_linux.h>
+
+/**
+ * Watches the processes the Dart side launches through pidfds, all in one
+ * epoll set that's polled from the main loop, and keeps the number of them
+ * running per group, which the Dart side uses the prefix directory for.
+ *
+ * The "winebar/process_supervisor" method channel takes "supervise" with
+ * [pid, group], which returns {"supervised": bool, "count": int,
+ * "total": int}, "supervised" being false if the process is gone already.
+ * Whenever processes exit, we invoke "update" with {"exited": Int64List,
+ * "counts": {group: count}, "total": int}, with the counts of only the groups
+ * that changed. The processes that exit together are reported together.
+ */
+void process_supervisor_plugin_register_with_registrar(
+    FlPluginRegistrar *registrar);
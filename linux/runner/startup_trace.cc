@@ -0,0 +1,184 @@
+#include "startup_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace {
+
+// Thread IDs in the trace, which only serve to put the native and the Dart
+// spans on separate tracks.
+const int kNativeTid = 1;
+const int kDartTid = 2;
+
+FILE *trace_file = nullptr;
+int64_t trace_start_us = 0;
+FlMethodChannel *dart_channel = nullptr;
+
+void write_json_string(const char *str) {
+  fputc('"', trace_file);
+  for (const char *p = str; *p; ++p) {
+    if (*p == '"' || *p == '\\') {
+      fputc('\\', trace_file);
+      fputc(*p, trace_file);
+    } else if (static_cast<unsigned char>(*p) < 0x20) {
+      fprintf(trace_file, "\\u%04x", *p);
+    } else {
+      fputc(*p, trace_file);
+    }
+  }
+  fputc('"', trace_file);
+}
+
+// Events are flushed one by one, so that whatever was recorded survives a
+// crash. Chrome accepts a trace with the closing bracket missing.
+void write_event(const char *name, char phase, int tid, int64_t ts_us,
+                 int64_t dur_us) {
+  fputs(",\n{\"name\": ", trace_file);
+  write_json_string(name);
+  fprintf(trace_file,
+          ", \"ph\": \"%c\", \"pid\": %d, \"tid\": %d, \"ts\": %lld", phase,
+          static_cast<int>(getpid()), tid,
+          static_cast<long long>(ts_us - trace_start_us));
+  if (phase == 'X') {
+    fprintf(trace_file, ", \"dur\": %lld", static_cast<long long>(dur_us));
+  } else if (phase == 'i') {
+    fputs(", \"s\": \"p\"", trace_file);
+  }
+  fputc('}', trace_file);
+  fflush(trace_file);
+}
+
+void write_thread_name(int tid, const char *name) {
+  fprintf(trace_file,
+          ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, "
+          "\"tid\": %d, \"args\": {\"name\": ",
+          static_cast<int>(getpid()), tid);
+  write_json_string(name);
+  fputs("}}", trace_file);
+}
+
+// Expects {"now": <int>, "spans": [[<name>, <start>, <end>], ...]}, with
+// the times taken from the Dart timeline clock. Rather than assume that
+// clock is the same as ours, "now" lets us map one onto the other.
+FlMethodResponse *add_dart_spans(FlValue *args) {
+  FlValue *now = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                     ? fl_value_lookup_string(args, "now")
+                     : nullptr;
+  FlValue *spans = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                       ? fl_value_lookup_string(args, "spans")
+                       : nullptr;
+  if (now == nullptr || fl_value_get_type(now) != FL_VALUE_TYPE_INT ||
+      spans == nullptr || fl_value_get_type(spans) != FL_VALUE_TYPE_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "bad-args", "Expected {now: int, spans: list}", nullptr));
+  }
+
+  const int64_t offset_us = g_get_monotonic_time() - fl_value_get_int(now);
+
+  for (size_t i = 0; i < fl_value_get_length(spans); ++i) {
+    FlValue *span = fl_value_get_list_value(spans, i);
+    if (fl_value_get_type(span) != FL_VALUE_TYPE_LIST ||
+        fl_value_get_length(span) != 3) {
+      continue;
+    }
+
+    FlValue *name = fl_value_get_list_value(span, 0);
+    FlValue *start = fl_value_get_list_value(span, 1);
+    FlValue *end = fl_value_get_list_value(span, 2);
+    if (fl_value_get_type(name) != FL_VALUE_TYPE_STRING ||
+        fl_value_get_type(start) != FL_VALUE_TYPE_INT ||
+        fl_value_get_type(end) != FL_VALUE_TYPE_INT) {
+      continue;
+    }
+
+    write_event(fl_value_get_string(name), 'X', kDartTid,
+                fl_value_get_int(start) + offset_us,
+                fl_value_get_int(end) - fl_value_get_int(start));
+  }
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+void method_call_cb(FlMethodChannel *channel, FlMethodCall *method_call,
+                    gpointer user_data) {
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (trace_file == nullptr) {
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (g_strcmp0(fl_method_call_get_name(method_call), "addSpans") ==
+             0) {
+    response = add_dart_spans(fl_method_call_get_args(method_call));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond to a startup trace call: %s",
+              error->message);
+  }
+}
+
+}  // namespace
+
+void startup_trace_init() {
+  const char *path = getenv("WINEBAR_STARTUP_TRACE");
+  if (path == nullptr || *path == '\0') {
+    return;
+  }
+
+  trace_file = fopen(path, "w");
+  if (trace_file == nullptr) {
+    g_warning("Failed to open the startup trace file %s", path);
+    return;
+  }
+
+  trace_start_us = g_get_monotonic_time();
+
+  // Every event starts with a comma, so here is one to follow.
+  fputs("[{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": ", trace_file);
+  fprintf(trace_file, "%d, \"args\": {\"name\": \"winebar\"}}",
+          static_cast<int>(getpid()));
+  write_thread_name(kNativeTid, "runner");
+  write_thread_name(kDartTid, "dart");
+  write_event("main", 'i', kNativeTid, trace_start_us, 0);
+}
+
+int64_t startup_trace_now() { return g_get_monotonic_time(); }
+
+void startup_trace_span(const char *name, int64_t start_us) {
+  if (trace_file != nullptr) {
+    write_event(name, 'X', kNativeTid, start_us,
+                g_get_monotonic_time() - start_us);
+  }
+}
+
+void startup_trace_instant(const char *name) {
+  if (trace_file != nullptr) {
+    write_event(name, 'i', kNativeTid, g_get_monotonic_time(), 0);
+  }
+}
+
+void startup_trace_listen_to_dart(FlBinaryMessenger *messenger) {
+  // The Dart side doesn't call us unless tracing is enabled.
+  if (trace_file == nullptr || dart_channel != nullptr) {
+    return;
+  }
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  dart_channel = fl_method_channel_new(messenger, "winebar/startup_trace",
+                                       FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(dart_channel, method_call_cb,
+                                            nullptr, nullptr);
+}
+
+void startup_trace_finish() {
+  g_clear_object(&dart_channel);
+
+  if (trace_file != nullptr) {
+    fputs("\n]\n", trace_file);
+    fclose(trace_file);
+    trace_file = nullptr;
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <stdint.h>
+
+/**
+ * An opt-in startup timeline, enabled by setting the WINEBAR_STARTUP_TRACE
+ * environment variable to the path of the file to write. The file is in the
+ * Chrome trace-event format and can be opened in chrome://tracing or
+ * https://ui.perfetto.dev. Timestamps are relative to the call to
+ * startup_trace_init().
+ *
+ * All the functions do nothing if tracing is not enabled, and must be called
+ * from the main thread.
+ */
+
+/**
+ * Opens the trace file. Meant to be the first thing main() does.
+ */
+void startup_trace_init();
+
+/**
+ * Returns the current monotonic time, to be passed to startup_trace_span().
+ */
+int64_t startup_trace_now();
+
+/**
+ * Records a span that started at @p start_us and ends now.
+ */
+void startup_trace_span(const char *name, int64_t start_us);
+
+/**
+ * Records a point in time.
+ */
+void startup_trace_instant(const char *name);
+
+/**
+ * Lets the Dart side add its own spans through the "winebar/startup_trace"
+ * method channel.
+ */
+void startup_trace_listen_to_dart(FlBinaryMessenger *messenger);
+
+/**
+ * Completes and closes the trace file.
+ */
+void startup_trace_finish();
@@ -0,0 +1,195 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CrashCapture.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * How much of the line a trigger was found in we can keep from the previous chunks.
+ * Longer lines will have their beginning cut off.
+ */
+#define MAX_LINE_PREFIX_SIZE 256
+
+struct CrashCapture
+{
+    PatternMatcher const* matcher;
+
+    PatternMatcherState matcherState;
+
+    HeadBuffer* pinnedBuffer;
+
+    size_t capacity;
+
+    unsigned linesAfterTrigger;
+
+    /**
+     * The number of line endings left to copy into @p pinnedBuffer, including the one
+     * of the current line. Zero indicates we are not copying anything at the moment.
+     */
+    unsigned linesRemaining;
+
+    /**
+     * The tail of the current line, as seen in the previous chunks.
+     */
+    char linePrefix[MAX_LINE_PREFIX_SIZE];
+    size_t linePrefixSize;
+};
+
+CrashCapture*
+crashCaptureNew(PatternMatcher const* matcher, size_t capacity, unsigned linesAfterTrigger)
+{
+    CrashCapture* capture = malloc(sizeof(CrashCapture));
+    if (!capture)
+    {
+        return NULL;
+    }
+
+    if (!(capture->pinnedBuffer = headBufferNew(capacity)))
+    {
+        free(capture);
+        return NULL;
+    }
+
+    capture->matcher = matcher;
+    capture->matcherState = PATTERN_MATCHER_INITIAL_STATE;
+    capture->capacity = capacity;
+    capture->linesAfterTrigger = linesAfterTrigger;
+    capture->linesRemaining = 0;
+    capture->linePrefixSize = 0;
+
+    return capture;
+}
+
+void
+crashCaptureFree(CrashCapture* capture)
+{
+    if (!capture)
+    {
+        return;
+    }
+
+    headBufferFree(capture->pinnedBuffer);
+    free(capture);
+}
+
+HeadBufferData
+crashCaptureGetData(CrashCapture const* capture)
+{
+    return headBufferGetData(capture->pinnedBuffer);
+}
+
+/**
+ * Appends @p data to the tail of the current line kept in @p capture->linePrefix,
+ * discarding the beginning of the line if it doesn't fit.
+ */
+static void
+appendToLinePrefix(CrashCapture* capture, char const* data, size_t size)
+{
+    if (size >= MAX_LINE_PREFIX_SIZE)
+    {
+        memcpy(capture->linePrefix, data + size - MAX_LINE_PREFIX_SIZE, MAX_LINE_PREFIX_SIZE);
+        capture->linePrefixSize = MAX_LINE_PREFIX_SIZE;
+        return;
+    }
+
+    size_t const overflow = capture->linePrefixSize + size > MAX_LINE_PREFIX_SIZE
+        ? capture->linePrefixSize + size - MAX_LINE_PREFIX_SIZE
+        : 0;
+
+    if (overflow > 0)
+    {
+        memmove(
+            capture->linePrefix, capture->linePrefix + overflow,
+            capture->linePrefixSize - overflow);
+        capture->linePrefixSize -= overflow;
+    }
+
+    memcpy(capture->linePrefix + capture->linePrefixSize, data, size);
+    capture->linePrefixSize += size;
+}
+
+void
+crashCaptureAppend(CrashCapture* capture, void const* data, size_t size)
+{
+    if (headBufferGetData(capture->pinnedBuffer).size == capture->capacity)
+    {
+        return; // Nothing more can be kept.
+    }
+
+    char const* bytes = data;
+
+    // Where the part of this chunk to be copied into the pinned buffer begins.
+    // It's only relevant while capture->linesRemaining is non-zero.
+    size_t pinnedRegionBegin = 0;
+
+    // Where the current line begins within this chunk, or SIZE_MAX if it has begun
+    // in one of the previous chunks.
+    size_t lineBegin = SIZE_MAX;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (patternMatcherStep(capture->matcher, &capture->matcherState, (unsigned char)bytes[i]))
+        {
+            if (capture->linesRemaining == 0)
+            {
+                if (lineBegin == SIZE_MAX)
+                {
+                    headBufferAppend(
+                        capture->pinnedBuffer, capture->linePrefix, capture->linePrefixSize);
+                    pinnedRegionBegin = 0;
+                }
+                else
+                {
+                    pinnedRegionBegin = lineBegin;
+                }
+            }
+
+            capture->linesRemaining = capture->linesAfterTrigger + 1;
+        }
+
+        if (bytes[i] == '\n')
+        {
+            lineBegin = i + 1;
+
+            if (capture->linesRemaining > 0 && --capture->linesRemaining == 0)
+            {
+                headBufferAppend(
+                    capture->pinnedBuffer, bytes + pinnedRegionBegin, i + 1 - pinnedRegionBegin);
+            }
+        }
+    }
+
+    if (capture->linesRemaining > 0)
+    {
+        headBufferAppend(
+            capture->pinnedBuffer, bytes + pinnedRegionBegin, size - pinnedRegionBegin);
+    }
+
+    if (lineBegin == SIZE_MAX)
+    {
+        appendToLinePrefix(capture, bytes, size);
+    }
+    else
+    {
+        capture->linePrefixSize = 0;
+        appendToLinePrefix(capture, bytes + lineBegin, size - lineBegin);
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/**
+ * The purpose of a CrashCapture object is to keep the output of a crash from being evicted
+ * from a HeadTailBuffer by whatever the application prints afterwards. It watches a stream
+ * for trigger patterns, like Wine's "Unhandled page fault", and copies the line containing
+ * the trigger, plus a number of lines following it, into a separate bounded buffer.
+ * Once that buffer is full, further matches are ignored, so the first crash is the one
+ * that's kept.
+ */
+
+#include "HeadBuffer.h"
+#include "PatternMatcher.h"
+
+#include <stddef.h>
+
+typedef struct CrashCapture CrashCapture;
+
+/**
+ * @param matcher Recognizes the trigger patterns. It has to outlive the CrashCapture object.
+ * @param capacity The maximum number of bytes to keep.
+ * @param linesAfterTrigger The number of lines following the trigger line to keep.
+ *        Another trigger within those lines extends the captured region.
+ */
+CrashCapture* crashCaptureNew(
+    PatternMatcher const* matcher, size_t capacity, unsigned linesAfterTrigger);
+
+void crashCaptureFree(CrashCapture* capture);
+
+HeadBufferData crashCaptureGetData(CrashCapture const* capture);
+
+/**
+ * Feeds the next chunk of the stream to the capture.
+ */
+void crashCaptureAppend(CrashCapture* capture, void const* data, size_t size);
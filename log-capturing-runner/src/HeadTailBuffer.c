@@ -86,6 +86,12 @@ headTailBufferGetData(HeadTailBuffer const* buffer)
     return data;
 }
 
+TailBufferData
+headTailBufferGetLastAppendedData(HeadTailBuffer const* buffer)
+{
+    return tailBufferGetLastAppendedData(buffer->tailBuffer);
+}
+
 static void
 processDataDiscardedByTailBuffer(char* data, size_t size, void* context)
 {
@@ -56,6 +56,12 @@ void headTailBufferFree(HeadTailBuffer* buffer);
 
 HeadTailBufferData headTailBufferGetData(HeadTailBuffer const* buffer);
 
+/**
+ * Returns the data appended by the last call to headTailBufferAppendFromFd(), which makes
+ * it possible to inspect a stream as it passes through the buffer.
+ */
+TailBufferData headTailBufferGetLastAppendedData(HeadTailBuffer const* buffer);
+
 /**
  * Reads data from the provided file descriptor and updates the buffer accordingly.
  *
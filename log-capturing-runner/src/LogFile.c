@@ -0,0 +1,392 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LogFile.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct LogFile
+{
+    uint8_t const* data;
+
+    size_t size;
+
+    /**
+     * Whether @p data was mmap()ed by us and has to be munmap()ed.
+     */
+    bool ownsMapping;
+
+    /**
+     * numLines + 1 elements. Line i occupies [lineStarts[i], lineStarts[i + 1]),
+     * including its line terminator, if any.
+     */
+    uint64_t* lineStarts;
+
+    uint64_t numLines;
+
+    uint64_t longestLineLength;
+
+    int64_t cutMarkerLine;
+};
+
+static uint64_t
+lineLength(LogFile const* file, uint64_t line)
+{
+    uint64_t const begin = file->lineStarts[line];
+    uint64_t end = file->lineStarts[line + 1];
+
+    if (end > begin && file->data[end - 1] == '\n')
+    {
+        --end;
+
+        if (end > begin && file->data[end - 1] == '\r')
+        {
+            --end;
+        }
+    }
+
+    return end - begin;
+}
+
+/**
+ * Returns the index of the line containing the byte at @p offset.
+ * The offset must be less than the size of the file.
+ */
+static uint64_t
+lineContainingOffset(LogFile const* file, uint64_t offset)
+{
+    // Find the last line starting at or before the offset.
+    uint64_t lo = 0;
+    uint64_t hi = file->numLines;
+
+    while (hi - lo > 1)
+    {
+        uint64_t const mid = lo + (hi - lo) / 2;
+        if (file->lineStarts[mid] <= offset)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static bool
+bytesEqual(uint8_t const* a, uint8_t const* b, size_t size, bool ignoreCase)
+{
+    if (!ignoreCase)
+    {
+        return memcmp(a, b, size) == 0;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (tolower(a[i]) != tolower(b[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Returns the offset of the first occurrence of @p needle within @p haystack
+ * or -1 if there is none.
+ */
+static int64_t
+findBytes(
+    uint8_t const* haystack, size_t haystackSize, uint8_t const* needle, size_t needleSize,
+    bool ignoreCase)
+{
+    if (needleSize == 0)
+    {
+        return 0;
+    }
+
+    if (needleSize > haystackSize)
+    {
+        return -1;
+    }
+
+    size_t const lastCandidate = haystackSize - needleSize;
+
+    for (size_t pos = 0; pos <= lastCandidate; ++pos)
+    {
+        if (!ignoreCase)
+        {
+            // Let memchr() skip quickly to the next candidate.
+            uint8_t const* candidate =
+                memchr(haystack + pos, needle[0], lastCandidate - pos + 1);
+            if (!candidate)
+            {
+                return -1;
+            }
+
+            pos = candidate - haystack;
+        }
+
+        if (bytesEqual(haystack + pos, needle, needleSize, ignoreCase))
+        {
+            return pos;
+        }
+    }
+
+    return -1;
+}
+
+static bool
+buildLineIndex(LogFile* file)
+{
+    uint64_t numNewlines = 0;
+
+    for (uint8_t const* p = file->data; p && p < file->data + file->size; ++p)
+    {
+        p = memchr(p, '\n', file->data + file->size - p);
+        if (!p)
+        {
+            break;
+        }
+
+        ++numNewlines;
+    }
+
+    bool const hasUnterminatedLine = file->size > 0 && file->data[file->size - 1] != '\n';
+    file->numLines = numNewlines + (hasUnterminatedLine ? 1 : 0);
+
+    file->lineStarts = malloc((file->numLines + 1) * sizeof(uint64_t));
+    if (!file->lineStarts)
+    {
+        return false;
+    }
+
+    uint64_t line = 0;
+    file->lineStarts[0] = 0;
+
+    for (size_t offset = 0; offset < file->size; ++offset)
+    {
+        if (file->data[offset] == '\n')
+        {
+            file->lineStarts[++line] = offset + 1;
+        }
+    }
+
+    file->lineStarts[file->numLines] = file->size;
+
+    file->longestLineLength = 0;
+    for (line = 0; line < file->numLines; ++line)
+    {
+        uint64_t const length = lineLength(file, line);
+        if (length > file->longestLineLength)
+        {
+            file->longestLineLength = length;
+        }
+    }
+
+    file->cutMarkerLine = -1;
+
+    int64_t const markerOffset = findBytes(
+        file->data, file->size, (uint8_t const*)LOG_FILE_CUT_MARKER,
+        strlen(LOG_FILE_CUT_MARKER), false);
+    if (markerOffset >= 0)
+    {
+        // Skip the two newlines preceding the dashes.
+        file->cutMarkerLine = lineContainingOffset(file, markerOffset + 2);
+    }
+
+    return true;
+}
+
+static LogFile*
+logFileNew(uint8_t const* data, size_t size, bool ownsMapping)
+{
+    LogFile* file = malloc(sizeof(LogFile));
+    if (!file)
+    {
+        return NULL;
+    }
+
+    file->data = data;
+    file->size = size;
+    file->ownsMapping = ownsMapping;
+
+    if (!buildLineIndex(file))
+    {
+        free(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+LogFile*
+logFileOpen(char const* path)
+{
+    int const fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    LogFile* file = NULL;
+    void* data = NULL;
+    int savedErrno;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        goto done;
+    }
+
+    if ((uint64_t)st.st_size > SIZE_MAX)
+    {
+        errno = EFBIG;
+        goto done;
+    }
+
+    size_t const size = st.st_size;
+
+    if (size > 0)
+    {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            data = NULL;
+            goto done;
+        }
+    }
+
+    file = logFileNew(data, size, data != NULL);
+    if (!file && data)
+    {
+        savedErrno = errno;
+        munmap(data, size);
+        errno = savedErrno;
+    }
+
+done:
+    savedErrno = errno;
+    close(fd);
+    errno = savedErrno;
+
+    return file;
+}
+
+LogFile*
+logFileOpenMemory(void const* data, uint64_t size)
+{
+    if (size > SIZE_MAX || (!data && size > 0))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    return logFileNew(data, size, false);
+}
+
+void
+logFileClose(LogFile* file)
+{
+    if (!file)
+    {
+        return;
+    }
+
+    if (file->ownsMapping)
+    {
+        munmap((void*)file->data, file->size);
+    }
+
+    free(file->lineStarts);
+    free(file);
+}
+
+uint8_t const*
+logFileGetData(LogFile const* file)
+{
+    return file->data;
+}
+
+void
+logFileGetStats(LogFile const* file, LogFileStats* stats)
+{
+    stats->size = file->size;
+    stats->numLines = file->numLines;
+    stats->longestLineLength = file->longestLineLength;
+    stats->cutMarkerLine = file->cutMarkerLine;
+}
+
+uint64_t
+logFileGetLines(LogFile const* file, uint64_t firstLine, uint64_t maxLines, LogFileLine* lines)
+{
+    if (firstLine >= file->numLines)
+    {
+        return 0;
+    }
+
+    uint64_t numLines = file->numLines - firstLine;
+    if (numLines > maxLines)
+    {
+        numLines = maxLines;
+    }
+
+    for (uint64_t i = 0; i < numLines; ++i)
+    {
+        lines[i].offset = file->lineStarts[firstLine + i];
+        lines[i].length = lineLength(file, firstLine + i);
+    }
+
+    return numLines;
+}
+
+int64_t
+logFileFind(
+    LogFile const* file, uint64_t firstLine, void const* needle, uint64_t needleSize,
+    uint32_t flags)
+{
+    bool const ignoreCase = (flags & LOG_FILE_FIND_IGNORE_CASE) != 0;
+
+    for (uint64_t line = firstLine; line < file->numLines; ++line)
+    {
+        uint64_t const length = lineLength(file, line);
+        if (length < needleSize)
+        {
+            continue;
+        }
+
+        if (findBytes(
+                file->data + file->lineStarts[line], length, needle, needleSize, ignoreCase) >= 0)
+        {
+            return line;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,126 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/**
+ * A LogFile object provides read-only access to a log capture, like the stdout.txt / stderr.txt
+ * files written by the runner. The data is never copied: it's either mmap()ed from a file or
+ * borrowed from the caller. On top of that data, a line index is built, making it possible to
+ * fetch arbitrary pages of lines and to search within them.
+ *
+ * This API is exported from a shared library that the Flutter app loads through dart:ffi,
+ * so only fixed-width types are used in the structures below and existing functions and
+ * structure layouts must not be changed in incompatible ways.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(LOG_FILE_BUILDING_SHARED_LIBRARY)
+#define LOG_FILE_API __attribute__((visibility("default")))
+#else
+#define LOG_FILE_API
+#endif
+
+/**
+ * Written between the head and the tail parts of a capture when some data in the middle
+ * had to be discarded.
+ */
+#define LOG_FILE_CUT_MARKER "\n\n------------------- cut ----------------------\n\n"
+
+/**
+ * Makes logFileFind() compare ASCII letters case-insensitively.
+ */
+#define LOG_FILE_FIND_IGNORE_CASE 1u
+
+typedef struct LogFile LogFile;
+
+typedef struct LogFileLine
+{
+    /**
+     * The offset of the first byte of the line, relative to logFileGetData().
+     */
+    uint64_t offset;
+
+    /**
+     * The length of the line in bytes, excluding the line terminator ("\n" or "\r\n").
+     */
+    uint64_t length;
+} LogFileLine;
+
+typedef struct LogFileStats
+{
+    uint64_t size;
+
+    uint64_t numLines;
+
+    uint64_t longestLineLength;
+
+    /**
+     * The index of the line consisting of the dashes of LOG_FILE_CUT_MARKER, or -1 if the
+     * capture doesn't contain the marker.
+     */
+    int64_t cutMarkerLine;
+} LogFileStats;
+
+/**
+ * Maps the file at @p path into memory and indexes its lines.
+ *
+ * Returns NULL on failure, in which case errno will indicate the reason.
+ * The file is expected not to be rewritten while it's open. The runner replaces its captures
+ * by rewriting them in place, so open them once the process has finished.
+ */
+LOG_FILE_API LogFile* logFileOpen(char const* path);
+
+/**
+ * Indexes the lines of a memory region owned by the caller. The region must outlive the
+ * returned object.
+ *
+ * Returns NULL on failure, in which case errno will indicate the reason.
+ */
+LOG_FILE_API LogFile* logFileOpenMemory(void const* data, uint64_t size);
+
+LOG_FILE_API void logFileClose(LogFile* file);
+
+/**
+ * Returns a pointer to the file's data, which stays valid until logFileClose().
+ * May return NULL for an empty file.
+ */
+LOG_FILE_API uint8_t const* logFileGetData(LogFile const* file);
+
+LOG_FILE_API void logFileGetStats(LogFile const* file, LogFileStats* stats);
+
+/**
+ * Writes the locations of up to @p maxLines lines, starting from line @p firstLine,
+ * into @p lines.
+ *
+ * Returns the number of lines written, which will be zero if @p firstLine is past the end.
+ */
+LOG_FILE_API uint64_t logFileGetLines(
+    LogFile const* file, uint64_t firstLine, uint64_t maxLines, LogFileLine* lines);
+
+/**
+ * Finds the first line, starting from @p firstLine, that contains @p needle.
+ *
+ * @param flags A combination of LOG_FILE_FIND_* flags.
+ * @return The index of the matching line or -1 if nothing was found.
+ */
+LOG_FILE_API int64_t logFileFind(
+    LogFile const* file, uint64_t firstLine, void const* needle, uint64_t needleSize,
+    uint32_t flags);
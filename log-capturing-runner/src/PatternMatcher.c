@@ -0,0 +1,220 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PatternMatcher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_BYTE_VALUES 256
+
+/**
+ * Marks a missing trie edge while the automaton is being built.
+ */
+#define NO_TRANSITION UINT32_MAX
+
+struct PatternMatcher
+{
+    /**
+     * numStates * NUM_BYTE_VALUES elements, indexed by state * NUM_BYTE_VALUES + byte.
+     * State 0 is the root of the trie.
+     */
+    PatternMatcherState* transitions;
+
+    /**
+     * Whether reaching a state means a pattern has just ended. This takes into account
+     * the patterns that are suffixes of the path leading to the state.
+     */
+    bool* accepting;
+
+    size_t numStates;
+};
+
+static PatternMatcherState*
+transitionsOf(PatternMatcher const* matcher, PatternMatcherState state)
+{
+    return matcher->transitions + (size_t)state * NUM_BYTE_VALUES;
+}
+
+static void
+addPattern(PatternMatcher* matcher, char const* pattern)
+{
+    PatternMatcherState state = PATTERN_MATCHER_INITIAL_STATE;
+
+    for (unsigned char const* p = (unsigned char const*)pattern; *p; ++p)
+    {
+        PatternMatcherState* next = &transitionsOf(matcher, state)[*p];
+
+        if (*next == NO_TRANSITION)
+        {
+            *next = matcher->numStates++;
+        }
+
+        state = *next;
+    }
+
+    matcher->accepting[state] = true;
+}
+
+/**
+ * Replaces the missing edges of the trie with the transitions the failure links lead to.
+ * Processing the states in breadth-first order guarantees the failure link of a state
+ * points to a state that's already complete.
+ */
+static bool
+computeFailureTransitions(PatternMatcher* matcher)
+{
+    PatternMatcherState* failureLinks = malloc(matcher->numStates * sizeof(PatternMatcherState));
+    PatternMatcherState* queue = malloc(matcher->numStates * sizeof(PatternMatcherState));
+    if (!failureLinks || !queue)
+    {
+        free(queue);
+        free(failureLinks);
+        return false;
+    }
+
+    size_t queueBegin = 0;
+    size_t queueEnd = 0;
+
+    PatternMatcherState* rootTransitions = transitionsOf(matcher, PATTERN_MATCHER_INITIAL_STATE);
+
+    for (int byte = 0; byte < NUM_BYTE_VALUES; ++byte)
+    {
+        PatternMatcherState const child = rootTransitions[byte];
+
+        if (child == NO_TRANSITION)
+        {
+            rootTransitions[byte] = PATTERN_MATCHER_INITIAL_STATE;
+        }
+        else
+        {
+            failureLinks[child] = PATTERN_MATCHER_INITIAL_STATE;
+            queue[queueEnd++] = child;
+        }
+    }
+
+    while (queueBegin < queueEnd)
+    {
+        PatternMatcherState const state = queue[queueBegin++];
+        PatternMatcherState* transitions = transitionsOf(matcher, state);
+        PatternMatcherState const* failureTransitions =
+            transitionsOf(matcher, failureLinks[state]);
+
+        for (int byte = 0; byte < NUM_BYTE_VALUES; ++byte)
+        {
+            PatternMatcherState const child = transitions[byte];
+
+            if (child == NO_TRANSITION)
+            {
+                transitions[byte] = failureTransitions[byte];
+            }
+            else
+            {
+                failureLinks[child] = failureTransitions[byte];
+                matcher->accepting[child] |= matcher->accepting[failureLinks[child]];
+                queue[queueEnd++] = child;
+            }
+        }
+    }
+
+    free(queue);
+    free(failureLinks);
+
+    return true;
+}
+
+PatternMatcher*
+patternMatcherNew(char const* const* patterns, size_t numPatterns)
+{
+    // Each byte of each pattern adds at most one state to the trie.
+    size_t maxStates = 1;
+    for (size_t i = 0; i < numPatterns; ++i)
+    {
+        maxStates += strlen(patterns[i]);
+    }
+
+    PatternMatcher* matcher = malloc(sizeof(PatternMatcher));
+    if (!matcher)
+    {
+        goto skip_free_matcher;
+    }
+
+    matcher->transitions = malloc(maxStates * NUM_BYTE_VALUES * sizeof(PatternMatcherState));
+    if (!matcher->transitions)
+    {
+        goto skip_free_transitions;
+    }
+
+    // All bits set is NO_TRANSITION.
+    memset(matcher->transitions, 0xff, maxStates * NUM_BYTE_VALUES * sizeof(PatternMatcherState));
+
+    matcher->accepting = calloc(maxStates, sizeof(bool));
+    if (!matcher->accepting)
+    {
+        goto skip_free_accepting;
+    }
+
+    matcher->numStates = 1;
+
+    for (size_t i = 0; i < numPatterns; ++i)
+    {
+        if (patterns[i][0] != '\0')
+        {
+            addPattern(matcher, patterns[i]);
+        }
+    }
+
+    if (!computeFailureTransitions(matcher))
+    {
+        goto free_all;
+    }
+
+    return matcher;
+
+free_all:
+    free(matcher->accepting);
+skip_free_accepting:
+
+    free(matcher->transitions);
+skip_free_transitions:
+
+    free(matcher);
+skip_free_matcher:
+
+    return NULL;
+}
+
+void
+patternMatcherFree(PatternMatcher* matcher)
+{
+    if (!matcher)
+    {
+        return;
+    }
+
+    free(matcher->accepting);
+    free(matcher->transitions);
+    free(matcher);
+}
+
+bool
+patternMatcherStep(PatternMatcher const* matcher, PatternMatcherState* state, unsigned char byte)
+{
+    *state = transitionsOf(matcher, *state)[byte];
+    return matcher->accepting[*state];
+}
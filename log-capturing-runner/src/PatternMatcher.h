@@ -0,0 +1,56 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/**
+ * A PatternMatcher object recognizes any of a fixed set of byte strings in a stream,
+ * one byte at a time. It's an Aho-Corasick automaton with the failure links folded into
+ * a full transition table, so advancing it costs a single table lookup per byte,
+ * no matter how many patterns there are.
+ *
+ * The matcher itself is immutable. The position within the stream is represented by
+ * a PatternMatcherState, so one matcher can be shared by several streams.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct PatternMatcher PatternMatcher;
+
+typedef uint32_t PatternMatcherState;
+
+#define PATTERN_MATCHER_INITIAL_STATE ((PatternMatcherState)0)
+
+/**
+ * Builds a matcher for the given NUL-terminated patterns. Empty patterns are ignored.
+ *
+ * Returns NULL if memory allocation fails.
+ */
+PatternMatcher* patternMatcherNew(char const* const* patterns, size_t numPatterns);
+
+void patternMatcherFree(PatternMatcher* matcher);
+
+/**
+ * Advances @p state by one byte of the stream.
+ *
+ * Returns true if one of the patterns ends at this byte.
+ */
+bool patternMatcherStep(
+    PatternMatcher const* matcher, PatternMatcherState* state, unsigned char byte);
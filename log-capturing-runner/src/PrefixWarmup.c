@@ -0,0 +1,194 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PrefixWarmup.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char const* const libDirs[] = {"lib", "lib64"};
+
+static char const* const unixModuleDirs[] = {"x86_64-unix", "i386-unix"};
+
+static char const* const windowsModuleDirs[] = {"x86_64-windows", "i386-windows"};
+
+static char const* const binFiles[] = {"wine", "wine64", "wine-preloader", "wine64-preloader"};
+
+static char const* const unixModules[] = {
+    "ntdll.so", "win32u.so", "winex11.so", "winewayland.so",
+};
+
+// What even the simplest GUI application ends up loading, plus the processes wineboot starts
+// in every session.
+static char const* const windowsModules[] = {
+    "ntdll.dll",     "kernelbase.dll", "kernel32.dll", "ucrtbase.dll",   "msvcrt.dll",
+    "advapi32.dll",  "sechost.dll",    "rpcrt4.dll",   "combase.dll",    "ole32.dll",
+    "win32u.dll",    "user32.dll",     "gdi32.dll",    "imm32.dll",      "shell32.dll",
+    "shlwapi.dll",   "winex11.drv",    "start.exe",    "explorer.exe",   "services.exe",
+    "rpcss.exe",     "winedevice.exe", "plugplay.exe", "conhost.exe",    "wineboot.exe",
+};
+
+bool
+wineserverDirForPrefix(char const* winePrefix, char* buf, size_t bufSize)
+{
+    struct stat prefixStat;
+    if (stat(winePrefix, &prefixStat) == -1)
+    {
+        return false;
+    }
+
+    // This mirrors init_server_dir() in Wine's dlls/ntdll/unix/server.c.
+    int const len = snprintf(
+        buf, bufSize, "/tmp/.wine-%u/server-%llx-%llx", (unsigned)getuid(),
+        (unsigned long long)prefixStat.st_dev, (unsigned long long)prefixStat.st_ino);
+
+    return len > 0 && (size_t)len < bufSize;
+}
+
+bool
+isWineserverRunning(char const* wineserverDir)
+{
+    char lockPath[PATH_MAX];
+    int const len = snprintf(lockPath, sizeof(lockPath), "%s/lock", wineserverDir);
+    if (len < 0 || (size_t)len >= sizeof(lockPath))
+    {
+        return false;
+    }
+
+    int const fd = open(lockPath, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    // wineserver holds a write lock on the whole file for as long as it runs.
+    struct flock lock = {.l_type = F_WRLCK, .l_whence = SEEK_SET, .l_start = 0, .l_len = 0};
+
+    bool const running = fcntl(fd, F_GETLK, &lock) == 0 && lock.l_type != F_UNLCK;
+
+    close(fd);
+
+    return running;
+}
+
+static void
+pretouchFile(char const* dir, char const* fileName, PretouchStats* stats)
+{
+    char path[PATH_MAX];
+    int const len = snprintf(path, sizeof(path), "%s/%s", dir, fileName);
+    if (len < 0 || (size_t)len >= sizeof(path))
+    {
+        return;
+    }
+
+    int const fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) &&
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0)
+    {
+        ++stats->numFiles;
+        stats->numBytes += (uint64_t)fileStat.st_size;
+    }
+
+    // Closing the file doesn't cancel the readahead.
+    close(fd);
+}
+
+static void
+pretouchFiles(
+    char const* dir, char const* const* fileNames, size_t numFileNames, PretouchStats* stats)
+{
+    for (size_t i = 0; i < numFileNames; ++i)
+    {
+        pretouchFile(dir, fileNames[i], stats);
+    }
+}
+
+static void
+pretouchModuleDirs(
+    char const* libDir, char const* const* moduleDirs, size_t numModuleDirs,
+    char const* const* modules, size_t numModules, PretouchStats* stats)
+{
+    for (size_t i = 0; i < numModuleDirs; ++i)
+    {
+        char dir[PATH_MAX];
+        int const len = snprintf(dir, sizeof(dir), "%s/wine/%s", libDir, moduleDirs[i]);
+        if (len > 0 && (size_t)len < sizeof(dir))
+        {
+            pretouchFiles(dir, modules, numModules, stats);
+        }
+    }
+}
+
+PretouchStats
+pretouchCoreWineFiles(char const* wineserverExecutablePath)
+{
+    PretouchStats stats = {0};
+
+    // <root>/bin/wineserver -> <root>
+    char root[PATH_MAX];
+    int const len = snprintf(root, sizeof(root), "%s", wineserverExecutablePath);
+    if (len < 0 || (size_t)len >= sizeof(root))
+    {
+        return stats;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        char* const lastSlash = strrchr(root, '/');
+        if (!lastSlash)
+        {
+            return stats;
+        }
+        *lastSlash = '\0';
+    }
+
+    char dir[PATH_MAX];
+
+    if (snprintf(dir, sizeof(dir), "%s/bin", root) < (int)sizeof(dir))
+    {
+        pretouchFiles(dir, binFiles, sizeof(binFiles) / sizeof(binFiles[0]), &stats);
+    }
+
+    for (size_t i = 0; i < sizeof(libDirs) / sizeof(libDirs[0]); ++i)
+    {
+        if (snprintf(dir, sizeof(dir), "%s/%s", root, libDirs[i]) >= (int)sizeof(dir))
+        {
+            continue;
+        }
+
+        pretouchModuleDirs(
+            dir, unixModuleDirs, sizeof(unixModuleDirs) / sizeof(unixModuleDirs[0]),
+            unixModules, sizeof(unixModules) / sizeof(unixModules[0]), &stats);
+
+        pretouchModuleDirs(
+            dir, windowsModuleDirs, sizeof(windowsModuleDirs) / sizeof(windowsModuleDirs[0]),
+            windowsModules, sizeof(windowsModules) / sizeof(windowsModules[0]), &stats);
+    }
+
+    return stats;
+}
@@ -0,0 +1,53 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Builds the path of the directory wineserver keeps its socket and lock file in for
+ * @p winePrefix. Wine derives it from the prefix's device and inode numbers.
+ *
+ * @return false if the prefix can't be stat'ed or @p bufSize is insufficient.
+ */
+bool wineserverDirForPrefix(char const* winePrefix, char* buf, size_t bufSize);
+
+/**
+ * Returns true if a running wineserver holds the lock file in @p wineserverDir.
+ * Unlike connecting to its socket, this doesn't disturb the wineserver in any way.
+ */
+bool isWineserverRunning(char const* wineserverDir);
+
+typedef struct PretouchStats
+{
+    size_t numFiles;
+    uint64_t numBytes;
+} PretouchStats;
+
+/**
+ * Asks the kernel to start reading the Wine loader and the core modules every Wine process
+ * loads into the page cache, without waiting for that to finish.
+ *
+ * The files are looked up relative to the wineserver executable, which is expected to live
+ * in the "bin" directory of a Wine build (or in "files/bin" of a Proton one). Files that
+ * don't exist are skipped.
+ */
+PretouchStats pretouchCoreWineFiles(char const* wineserverExecutablePath);
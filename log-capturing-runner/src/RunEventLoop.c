@@ -18,7 +18,9 @@
 
 #include "RunEventLoop.h"
 
+#include "CrashCapture.h"
 #include "HeadTailBuffer.h"
+#include "LogFile.h"
 #include "MinMax.h"
 #include "SpawnProcess.h"
 #include "StreamStatus.h"
@@ -41,6 +43,8 @@
 #include <unistd.h>
 
 #define PER_CHANNEL_HALF_BUFFER_SIZE 8192
+#define PER_CHANNEL_CRASH_CAPTURE_SIZE 8192
+#define CRASH_CAPTURE_LINES_AFTER_TRIGGER 100
 #define LOG_WRITE_DELAY_MS 500
 
 typedef struct StdioStream
@@ -52,6 +56,16 @@ typedef struct StdioStream
 
     HeadTailBuffer* headTailBuffer;
 
+    /**
+     * Keeps crash reports from being evicted from @p headTailBuffer. May be NULL.
+     */
+    CrashCapture* crashCapture;
+
+    /**
+     * The size of the @p crashCapture data that made it into "crash.txt".
+     */
+    size_t crashCaptureSizeWritten;
+
     struct timespec lastWriteToDiskTime;
 
     bool updatedSinceLastWrittenToDisk;
@@ -88,6 +102,11 @@ typedef struct EventLoopContext
 
     char* wineserverExecutablePath;
 
+    // Set when the main child waits for the processes it starts on its own, which is the case
+    // for launch-shim.exe. Then we don't run "wineserver -w", which would also wait for
+    // unrelated processes running in the same prefix.
+    bool skipWineserverWait;
+
     // Note: these members won't be initialized if disableLogCapture is set to false.
     StdioStream stdoutStream;
     StdioStream stderrStream;
@@ -96,23 +115,47 @@ typedef struct EventLoopContext
 } EventLoopContext;
 
 static bool
-initStdioStream(StdioStream* stream, char const* fileName)
+initStdioStream(
+    StdioStream* stream, char const* fileName, PatternMatcher const* crashPatternMatcher)
 {
     stream->fileName = fileName;
 
+    stream->crashCapture = NULL;
+    stream->crashCaptureSizeWritten = 0;
+
     memset(&stream->lastWriteToDiskTime, 0, sizeof(stream->lastWriteToDiskTime));
 
     stream->updatedSinceLastWrittenToDisk = false;
 
     stream->headTailBuffer =
         headTailBufferNew(PER_CHANNEL_HALF_BUFFER_SIZE, PER_CHANNEL_HALF_BUFFER_SIZE);
+    if (!stream->headTailBuffer)
+    {
+        return false;
+    }
+
+    if (crashPatternMatcher)
+    {
+        stream->crashCapture = crashCaptureNew(
+            crashPatternMatcher, PER_CHANNEL_CRASH_CAPTURE_SIZE,
+            CRASH_CAPTURE_LINES_AFTER_TRIGGER);
+        if (!stream->crashCapture)
+        {
+            headTailBufferFree(stream->headTailBuffer);
+            stream->headTailBuffer = NULL;
+            return false;
+        }
+    }
 
-    return stream->headTailBuffer != NULL;
+    return true;
 }
 
 static void
 freeStdioStream(StdioStream* stream)
 {
+    crashCaptureFree(stream->crashCapture);
+    stream->crashCapture = NULL;
+
     headTailBufferFree(stream->headTailBuffer);
     stream->headTailBuffer = NULL;
 }
@@ -120,7 +163,8 @@ freeStdioStream(StdioStream* stream)
 static EventLoopContext*
 eventLoopContextNew(
     char const* outDir, char* wineserverExecutablePath, pid_t mainChildPid,
-    int mainChildStdoutReadFd, int mainChildStderrReadFd, int signalFd, bool disableLogCapture)
+    int mainChildStdoutReadFd, int mainChildStderrReadFd, int signalFd, bool disableLogCapture,
+    PatternMatcher const* crashPatternMatcher, bool skipWineserverWait)
 {
     EventLoopContext* ctx = malloc(sizeof(EventLoopContext));
     if (!ctx)
@@ -138,17 +182,18 @@ eventLoopContextNew(
     ctx->wineserverWChildPid = -1;
     ctx->wineserverKChildPid = -1;
     ctx->wineserverExecutablePath = wineserverExecutablePath;
+    ctx->skipWineserverWait = skipWineserverWait;
 
     ctx->disableLogCapture = disableLogCapture;
 
     if (!disableLogCapture)
     {
-        if (!initStdioStream(&ctx->stdoutStream, "stdout.txt"))
+        if (!initStdioStream(&ctx->stdoutStream, "stdout.txt", crashPatternMatcher))
         {
             goto skip_free_stdout_stream;
         }
 
-        if (!initStdioStream(&ctx->stderrStream, "stderr.txt"))
+        if (!initStdioStream(&ctx->stderrStream, "stderr.txt", crashPatternMatcher))
         {
             goto skip_free_stderr_stream;
         }
@@ -192,6 +237,19 @@ processStreamEvents(EventLoopContext* ctx, StdioStream* stdioStream, struct poll
 
         stdioStream->updatedSinceLastWrittenToDisk = true;
 
+        if (stdioStream->crashCapture)
+        {
+            TailBufferData const appended =
+                headTailBufferGetLastAppendedData(stdioStream->headTailBuffer);
+
+            for (int i = 0; i < appended.numChunks; ++i)
+            {
+                crashCaptureAppend(
+                    stdioStream->crashCapture, appended.chunks[i].iov_base,
+                    appended.chunks[i].iov_len);
+            }
+        }
+
         if (streamStatus == STREAM_ERROR)
         {
             if (errno != EINTR && errno != EWOULDBLOCK)
@@ -284,14 +342,20 @@ onSigchldReceived(EventLoopContext* ctx, struct signalfd_siginfo const* siginfo,
         ctx->mainChildPid = -1;
         ctx->mainChildExitCode = siginfo->ssi_status;
 
-        logPrintf(log, "Running \"wineserver -w\" to wait for background processes to finish.\n");
-
         if (ctx->terminationRequested)
         {
             ctx->exiting = true;
         }
+        else if (ctx->skipWineserverWait)
+        {
+            logPrintf(log, "Not waiting for background processes, as requested.\n");
+            ctx->exiting = true;
+        }
         else
         {
+            logPrintf(
+                log, "Running \"wineserver -w\" to wait for background processes to finish.\n");
+
             // Start "wineserver -w" in order to wait for any application processes still
             // running to finish.
             char* wineserverWCommandLine[] = {ctx->wineserverExecutablePath, "-w", NULL};
@@ -417,7 +481,7 @@ writeHeadTailBuffer(HeadTailBuffer* buffer, char const* outDir, char const* file
 
     if (data.bytesDiscarded > 0)
     {
-        if (fprintf(fp, "\n\n------------------- cut ----------------------\n\n") < 0)
+        if (fputs(LOG_FILE_CUT_MARKER, fp) == EOF)
         {
             goto done;
         }
@@ -436,6 +500,42 @@ done:
     fclose(fp);
 }
 
+/**
+ * Writes "crash.txt", consisting of whatever the crash captures of stdout and stderr hold.
+ */
+static void
+writeCrashCaptures(EventLoopContext* ctx)
+{
+    char const fileName[] = "crash.txt";
+    size_t const outDirLen = strlen(ctx->outDir);
+
+    char filePath[outDirLen + 1 + sizeof(fileName)];
+    snprintf(filePath, sizeof(filePath), "%s/%s", ctx->outDir, fileName);
+
+    FILE* fp = fopen(filePath, "wb");
+    if (!fp)
+    {
+        // We don't log this situation, as this function may get called many times.
+        return;
+    }
+
+    StdioStream* const streams[] = {&ctx->stdoutStream, &ctx->stderrStream};
+
+    for (size_t i = 0; i < sizeof(streams) / sizeof(streams[0]); ++i)
+    {
+        HeadBufferData const data = crashCaptureGetData(streams[i]->crashCapture);
+
+        if (fwrite(data.data, 1, data.size, fp) != data.size)
+        {
+            break;
+        }
+
+        streams[i]->crashCaptureSizeWritten = data.size;
+    }
+
+    fclose(fp);
+}
+
 static void
 writeExitStatus(int exitCode, char const* outDir, char const* fileName, Log* log)
 {
@@ -510,6 +610,13 @@ maybeWriteStdioStreamToDisk(
         writeHeadTailBuffer(stdioStream->headTailBuffer, ctx->outDir, stdioStream->fileName);
         stdioStream->updatedSinceLastWrittenToDisk = false;
 
+        if (stdioStream->crashCapture &&
+            crashCaptureGetData(stdioStream->crashCapture).size !=
+                stdioStream->crashCaptureSizeWritten)
+        {
+            writeCrashCaptures(ctx);
+        }
+
         if (now)
         {
             stdioStream->lastWriteToDiskTime = *now;
@@ -521,7 +628,7 @@ int
 runEventLoop(
     char const* outDir, char* wineserverExecutablePath, pid_t mainChildPid,
     int mainChildStdoutReadFd, int mainChildStderrReadFd, int signalFd, Log* log,
-    bool disableLogCapture)
+    bool disableLogCapture, PatternMatcher const* crashPatternMatcher, bool skipWineserverWait)
 {
     enum
     {
@@ -542,7 +649,8 @@ runEventLoop(
 
     EventLoopContext* ctx = eventLoopContextNew(
         outDir, wineserverExecutablePath, mainChildPid, mainChildStdoutReadFd,
-        mainChildStderrReadFd, signalFd, disableLogCapture);
+        mainChildStderrReadFd, signalFd, disableLogCapture, crashPatternMatcher,
+        skipWineserverWait);
     if (!ctx)
     {
         return EXIT_FAILURE;
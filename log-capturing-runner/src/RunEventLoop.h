@@ -19,6 +19,7 @@
 #pragma once
 
 #include "Log.h"
+#include "PatternMatcher.h"
 
 #include <stdbool.h>
 #include <unistd.h>
@@ -44,9 +45,15 @@
  * @param log The log object.
  * @param disableLogCapture If set to true, disables capturing stdout / stderr from the
  *        child process.
+ * @param crashPatternMatcher If not NULL, recognizes the lines that start a crash report.
+ *        The reports are then copied into "crash.txt", so they survive being evicted from
+ *        "stdout.txt" / "stderr.txt" by the output that follows them.
+ * @param skipWineserverWait If set to true, we exit as soon as the main child does, without
+ *        running "wineserver -w". That's for main children that wait for the processes they
+ *        start on their own.
  * @return The exit code of the child process.
  */
 int runEventLoop(
     char const* outDir, char* wineserverExecutablePath, pid_t mainChildPid,
     int mainChildStdoutReadFd, int mainChildStderrReadFd, int signalFd, Log* log,
-    bool disableLogCapture);
+    bool disableLogCapture, PatternMatcher const* crashPatternMatcher, bool skipWineserverWait);
@@ -49,6 +49,12 @@ struct TailBuffer
      * @p dataBeginOffset, the sum may exceed it. That indicates the data wraps around.
      */
     size_t dataSize;
+
+    /**
+     * The number of bytes the last call to tailBufferAppendFromFd() has appended.
+     * Those are the last bytes of the stored data. This value never exceeds @p dataSize.
+     */
+    size_t lastAppendSize;
 };
 
 typedef struct ReservedSpace
@@ -81,6 +87,11 @@ tailBufferCheckInvariants(TailBuffer const* buffer)
         return false;
     }
 
+    if (buffer->lastAppendSize > buffer->dataSize)
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -102,6 +113,7 @@ tailBufferNew(size_t capacity)
         buffer->bufferCapacity = capacity;
         buffer->dataBeginOffset = 0;
         buffer->dataSize = 0;
+        buffer->lastAppendSize = 0;
         assert(tailBufferCheckInvariants(buffer));
     }
 
@@ -161,6 +173,33 @@ tailBufferGetData(TailBuffer const* buffer)
     return data;
 }
 
+TailBufferData
+tailBufferGetLastAppendedData(TailBuffer const* buffer)
+{
+    TailBufferData data = tailBufferGetData(buffer);
+
+    // Drop the bytes preceding the last appended ones.
+    size_t bytesToDrop = buffer->dataSize - buffer->lastAppendSize;
+
+    while (bytesToDrop > 0)
+    {
+        struct iovec* chunk = &data.chunks[0];
+
+        if (chunk->iov_len > bytesToDrop)
+        {
+            chunk->iov_base = (char*)chunk->iov_base + bytesToDrop;
+            chunk->iov_len -= bytesToDrop;
+            break;
+        }
+
+        bytesToDrop -= chunk->iov_len;
+        data.chunks[0] = data.chunks[1];
+        --data.numChunks;
+    }
+
+    return data;
+}
+
 static void
 reservedSpaceAddChunk(ReservedSpace* reservedSpace, char* data, size_t size)
 {
@@ -316,6 +355,8 @@ tailBufferAppendFromFd(
 {
     assert(tailBufferCheckInvariants(buffer));
 
+    buffer->lastAppendSize = 0;
+
     int bytesAvailableForReading = 0;
     if (ioctl(fd, FIONREAD, &bytesAvailableForReading) < 0)
     {
@@ -341,6 +382,7 @@ tailBufferAppendFromFd(
         else
         {
             buffer->dataSize += bytesRead;
+            buffer->lastAppendSize = bytesRead;
 
             assert(tailBufferCheckInvariants(buffer));
 
@@ -377,6 +419,7 @@ tailBufferAppendFromFd(
             copyDataIntoReservedSpace(tempBuffer, bytesRead, &reservedSpace);
 
             buffer->dataSize += bytesRead;
+            buffer->lastAppendSize = bytesRead;
 
             assert(tailBufferCheckInvariants(buffer));
 
@@ -50,6 +50,12 @@ void tailBufferFree(TailBuffer* buffer);
 
 TailBufferData tailBufferGetData(TailBuffer const* buffer);
 
+/**
+ * Returns the part of the stored data that was appended by the last call to
+ * tailBufferAppendFromFd(). That will be empty if the call didn't append anything.
+ */
+TailBufferData tailBufferGetLastAppendedData(TailBuffer const* buffer);
+
 /**
  * Reads data from the provided file descriptor and updates the buffer accordingly.
  *
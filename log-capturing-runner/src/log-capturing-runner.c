@@ -23,15 +23,24 @@
 // finish. When running inside muvm, we can't return as soon as the wine
 // executable exits, as that happens before the process it has started
 // finishes.
+//
+// In the keepalive mode ("--keepalive <seconds>" in place of the command), it starts
+// "wineserver -p<seconds>" instead, which keeps a wineserver running for the prefix until
+// that many seconds pass after the last Wine process in it exits. The launches that follow
+// then connect to that wineserver rather than starting one of their own. Optionally, the core
+// Wine modules are read into the page cache in the background too.
 
 #include "FdSetCloexecFlag.h"
 #include "FdSetNonblockFlag.h"
 #include "Log.h"
+#include "PatternMatcher.h"
+#include "PrefixWarmup.h"
 #include "RunEventLoop.h"
 #include "SpawnProcess.h"
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <poll.h>
 #include <signal.h>
 #include <stdbool.h>
@@ -44,6 +53,136 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+// The beginnings of the messages Wine and winedbg print when an application crashes.
+// These are followed by a register dump and a backtrace, which are what we are after.
+static char const* const defaultCrashPatterns[] = {
+    "Unhandled page fault",
+    "Unhandled exception",
+    "Unhandled stack overflow",
+    "Unhandled illegal instruction",
+    "Unhandled privileged instruction",
+};
+
+/**
+ * Builds the matcher for the lines that start a crash report. The patterns can be overridden
+ * with the LOG_CAPTURING_RUNNER_CRASH_PATTERNS environment variable, which holds them
+ * separated by newlines. Setting it to an empty string disables crash capturing.
+ *
+ * Returns NULL if crash capturing is disabled or on failure.
+ */
+static PatternMatcher*
+newCrashPatternMatcher(Log* log)
+{
+    char const* const patternsEnvVar = getenv("LOG_CAPTURING_RUNNER_CRASH_PATTERNS");
+    if (!patternsEnvVar)
+    {
+        PatternMatcher* matcher = patternMatcherNew(
+            defaultCrashPatterns, sizeof(defaultCrashPatterns) / sizeof(defaultCrashPatterns[0]));
+        if (!matcher)
+        {
+            logPrintf(log, "Failed to build the crash pattern matcher\n");
+        }
+        return matcher;
+    }
+
+    if (!*patternsEnvVar)
+    {
+        return NULL;
+    }
+
+    PatternMatcher* matcher = NULL;
+
+    char* const patternsCopy = strdup(patternsEnvVar);
+    if (!patternsCopy)
+    {
+        goto done;
+    }
+
+    size_t numPatterns = 1;
+    for (char const* p = patternsCopy; *p; ++p)
+    {
+        if (*p == '\n')
+        {
+            ++numPatterns;
+        }
+    }
+
+    char const** const patterns = malloc(numPatterns * sizeof(char const*));
+    if (!patterns)
+    {
+        goto free_patterns_copy;
+    }
+
+    // Split the copy in place.
+    patterns[0] = patternsCopy;
+    size_t patternIdx = 1;
+    for (char* p = patternsCopy; *p; ++p)
+    {
+        if (*p == '\n')
+        {
+            *p = '\0';
+            patterns[patternIdx++] = p + 1;
+        }
+    }
+
+    matcher = patternMatcherNew(patterns, numPatterns);
+
+    free(patterns);
+
+free_patterns_copy:
+    free(patternsCopy);
+
+done:
+    if (!matcher)
+    {
+        logPrintf(log, "Failed to build the crash pattern matcher\n");
+    }
+
+    return matcher;
+}
+
+/**
+ * Logs whether a wineserver is already running for the prefix, meaning the process we are
+ * about to start won't have to wait for one to start.
+ */
+static void
+logWineserverState(char const* winePrefix, Log* log)
+{
+    char wineserverDir[PATH_MAX];
+    if (!wineserverDirForPrefix(winePrefix, wineserverDir, sizeof(wineserverDir)))
+    {
+        logPrintf(log, "Failed to locate the wineserver directory for %s\n", winePrefix);
+    }
+    else if (isWineserverRunning(wineserverDir))
+    {
+        logPrintf(log, "Prefix state: warm (a wineserver is already running)\n");
+    }
+    else
+    {
+        logPrintf(log, "Prefix state: cold (no wineserver is running)\n");
+    }
+}
+
+/**
+ * Reads the core Wine modules into the page cache in the background, if asked to by the
+ * LOG_CAPTURING_RUNNER_PRETOUCH environment variable.
+ */
+static void
+maybePretouchCoreWineFiles(char const* wineserverExecutablePath, Log* log)
+{
+    char const* const pretouchEnvVar = getenv("LOG_CAPTURING_RUNNER_PRETOUCH");
+    if (!pretouchEnvVar || atoi(pretouchEnvVar) == 0)
+    {
+        return;
+    }
+
+    PretouchStats const stats = pretouchCoreWineFiles(wineserverExecutablePath);
+
+    logPrintf(
+        log, "Requested readahead of %zu core Wine files (%llu KiB)\n", stats.numFiles,
+        (unsigned long long)(stats.numBytes / 1024));
+}
+
 static int
 setupSignalsAndReturnSignalFd(sigset_t* oldSigMask, Log* log)
 {
@@ -89,7 +228,11 @@ main(int argc, char* argv[])
 
     if (argc < 3)
     {
-        fprintf(stderr, "Usage: %s <outdir> [-e ENV=VAL ...] <command> [args]\n", argv[0]);
+        fprintf(
+            stderr,
+            "Usage: %s <outdir> [-e ENV=VAL ...] <command> [args]\n"
+            "       %s <outdir> [-e ENV=VAL ...] --keepalive <seconds>\n",
+            argv[0], argv[0]);
         return exitCode;
     }
 
@@ -104,6 +247,9 @@ main(int argc, char* argv[])
 
     char** mainChildCommandLine = argv + 2;
 
+    // Zero unless in the keepalive mode.
+    int keepaliveSeconds = 0;
+
     // Parse command-line options past <outdir>, which is at argv[1].
     for (int i = 2; i < argc; ++i)
     {
@@ -130,6 +276,17 @@ main(int argc, char* argv[])
                 ++i;
             }
         }
+        else if (strcmp(argv[i], "--keepalive") == 0)
+        {
+            if (i + 1 >= argc || (keepaliveSeconds = atoi(argv[i + 1])) <= 0)
+            {
+                fprintf(stderr, "--keepalive requires a positive number of seconds.\n");
+                goto exit;
+            }
+
+            mainChildCommandLine = NULL;
+            break;
+        }
         else if (strcmp(argv[i], "--") == 0)
         {
             mainChildCommandLine = argv + i + 1;
@@ -145,6 +302,12 @@ main(int argc, char* argv[])
     char const* const disableLoggingEnvVar = getenv("LOG_CAPTURING_RUNNER_DISABLE_LOGGING");
     bool const disableLogging = disableLoggingEnvVar && atoi(disableLoggingEnvVar) != 0;
 
+    char const* const skipWineserverWaitEnvVar =
+        getenv("LOG_CAPTURING_RUNNER_SKIP_WINESERVER_WAIT");
+    // In the keepalive mode, "wineserver -w" would wait for the very wineserver we've started.
+    bool const skipWineserverWait =
+        keepaliveSeconds != 0 || (skipWineserverWaitEnvVar && atoi(skipWineserverWaitEnvVar) != 0);
+
     Log* log = logOpenFile(outDir, "log-capturing-runner.txt", disableLogging);
     if (!log)
     {
@@ -160,7 +323,8 @@ main(int argc, char* argv[])
         goto close_log;
     }
 
-    if (!getenv("WINEPREFIX"))
+    char const* const winePrefix = getenv("WINEPREFIX");
+    if (!winePrefix)
     {
         // The wineserver process seems to use the WINEPREFIX environment variable, so we insist
         // for it to be set. I've observed that without the WINEPREFIX environment variable set,
@@ -170,6 +334,25 @@ main(int argc, char* argv[])
         goto close_log;
     }
 
+    logWineserverState(winePrefix, log);
+
+    // Wineserver's "-p" option takes the persistence delay glued to it.
+    char persistenceOption[32];
+    char* keepaliveCommandLine[] = {wineserverExecutablePath, persistenceOption, NULL};
+    if (keepaliveSeconds != 0)
+    {
+        snprintf(persistenceOption, sizeof(persistenceOption), "-p%d", keepaliveSeconds);
+        mainChildCommandLine = keepaliveCommandLine;
+
+        logPrintf(
+            log,
+            "Keepalive: running \"wineserver %s\". If a wineserver is already running, "
+            "the new one exits right away without affecting it.\n",
+            persistenceOption);
+
+        maybePretouchCoreWineFiles(wineserverExecutablePath, log);
+    }
+
     sigset_t oldSigMask;
     int const signalFd = setupSignalsAndReturnSignalFd(&oldSigMask, log);
     if (signalFd == -1)
@@ -183,7 +366,8 @@ main(int argc, char* argv[])
         /*stderrStream=*/SPAWNED_PROCESS_STDIO_PIPE, &oldSigMask, log);
     if (spawnedProcess.pid == -1)
     {
-        logPrintf(log, "Failed to spawn process %s: %s\n", argv[2], strerror(errno));
+        logPrintf(
+            log, "Failed to spawn process %s: %s\n", mainChildCommandLine[0], strerror(errno));
         goto close_signalfd;
     }
 
@@ -200,9 +384,15 @@ main(int argc, char* argv[])
     fdSetCloexecFlag(spawnedProcess.stdoutPipeFd, true);
     fdSetCloexecFlag(spawnedProcess.stderrPipeFd, true);
 
+    // Without log capture, there is nothing to look for crash reports in.
+    PatternMatcher* const crashPatternMatcher = disableLogging ? NULL : newCrashPatternMatcher(log);
+
     exitCode = runEventLoop(
         outDir, wineserverExecutablePath, spawnedProcess.pid, spawnedProcess.stdoutPipeFd,
-        spawnedProcess.stderrPipeFd, signalFd, log, disableLogging);
+        spawnedProcess.stderrPipeFd, signalFd, log, disableLogging, crashPatternMatcher,
+        skipWineserverWait);
+
+    patternMatcherFree(crashPatternMatcher);
 
     return exitCode;
 
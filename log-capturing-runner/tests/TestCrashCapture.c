@@ -0,0 +1,169 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CrashCapture.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+static char const* const patterns[] = {"Unhandled page fault"};
+
+static void
+assert_captured(CrashCapture const* capture, char const* expected)
+{
+    HeadBufferData const data = crashCaptureGetData(capture);
+    assert_uint_equal(data.size, strlen(expected));
+    assert_memory_equal(data.data, expected, data.size);
+}
+
+static void
+crash_capture_ignores_output_without_triggers(void** state)
+{
+    (void)state;
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 1);
+    CrashCapture* capture = crashCaptureNew(matcher, 1000, 2);
+
+    char const text[] = "line 1\nline 2\nUnhandled page\n";
+    crashCaptureAppend(capture, text, strlen(text));
+
+    assert_captured(capture, "");
+
+    crashCaptureFree(capture);
+    patternMatcherFree(matcher);
+}
+
+static void
+crash_capture_keeps_trigger_line_and_following_lines(void** state)
+{
+    (void)state;
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 1);
+    CrashCapture* capture = crashCaptureNew(matcher, 1000, 2);
+
+    char const text[] =
+        "noise\n"
+        "wine: Unhandled page fault on read access\n"
+        "eax 0\n"
+        "ebx 0\n"
+        "more noise\n";
+    crashCaptureAppend(capture, text, strlen(text));
+
+    assert_captured(
+        capture,
+        "wine: Unhandled page fault on read access\n"
+        "eax 0\n"
+        "ebx 0\n");
+
+    crashCaptureFree(capture);
+    patternMatcherFree(matcher);
+}
+
+static void
+crash_capture_handles_triggers_split_across_chunks(void** state)
+{
+    (void)state;
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 1);
+    CrashCapture* capture = crashCaptureNew(matcher, 1000, 1);
+
+    // Feed the text a byte at a time.
+    char const text[] =
+        "noise\n"
+        "0024:wine: Unhandled page fault\n"
+        "backtrace\n"
+        "more noise\n";
+    for (size_t i = 0; i < strlen(text); ++i)
+    {
+        crashCaptureAppend(capture, text + i, 1);
+    }
+
+    assert_captured(
+        capture,
+        "0024:wine: Unhandled page fault\n"
+        "backtrace\n");
+
+    crashCaptureFree(capture);
+    patternMatcherFree(matcher);
+}
+
+static void
+crash_capture_extends_region_on_repeated_trigger(void** state)
+{
+    (void)state;
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 1);
+    CrashCapture* capture = crashCaptureNew(matcher, 1000, 1);
+
+    char const text[] =
+        "Unhandled page fault 1\n"
+        "Unhandled page fault 2\n"
+        "detail\n"
+        "noise\n"
+        "Unhandled page fault 3\n";
+    crashCaptureAppend(capture, text, strlen(text));
+
+    assert_captured(
+        capture,
+        "Unhandled page fault 1\n"
+        "Unhandled page fault 2\n"
+        "detail\n"
+        "Unhandled page fault 3\n");
+
+    crashCaptureFree(capture);
+    patternMatcherFree(matcher);
+}
+
+static void
+crash_capture_stops_when_full(void** state)
+{
+    (void)state;
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 1);
+    CrashCapture* capture = crashCaptureNew(matcher, 30, 10);
+
+    char const text[] =
+        "Unhandled page fault\n"
+        "0123456789\n"
+        "Unhandled page fault\n";
+    crashCaptureAppend(capture, text, strlen(text));
+
+    assert_captured(capture, "Unhandled page fault\n012345678");
+
+    crashCaptureFree(capture);
+    patternMatcherFree(matcher);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(crash_capture_ignores_output_without_triggers),
+        cmocka_unit_test(crash_capture_keeps_trigger_line_and_following_lines),
+        cmocka_unit_test(crash_capture_handles_triggers_split_across_chunks),
+        cmocka_unit_test(crash_capture_extends_region_on_repeated_trigger),
+        cmocka_unit_test(crash_capture_stops_when_full),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,174 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LogFile.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+static void
+empty_log_file_has_no_lines(void** state)
+{
+    (void)state;
+
+    LogFile* file = logFileOpenMemory(NULL, 0);
+    assert_non_null(file);
+
+    LogFileStats stats;
+    logFileGetStats(file, &stats);
+    assert_uint_equal(stats.size, 0);
+    assert_uint_equal(stats.numLines, 0);
+    assert_int_equal(stats.cutMarkerLine, -1);
+
+    LogFileLine line;
+    assert_uint_equal(logFileGetLines(file, 0, 1, &line), 0);
+    assert_int_equal(logFileFind(file, 0, "a", 1, 0), -1);
+
+    logFileClose(file);
+}
+
+static void
+log_file_lines_exclude_terminators(void** state)
+{
+    (void)state;
+
+    char const text[] = "first\r\nsecond line\n\nlast";
+
+    LogFile* file = logFileOpenMemory(text, strlen(text));
+    assert_non_null(file);
+
+    LogFileStats stats;
+    logFileGetStats(file, &stats);
+    assert_uint_equal(stats.numLines, 4);
+    assert_uint_equal(stats.longestLineLength, strlen("second line"));
+
+    LogFileLine lines[10];
+    assert_uint_equal(logFileGetLines(file, 0, 10, lines), 4);
+
+    assert_uint_equal(lines[0].offset, 0);
+    assert_uint_equal(lines[0].length, strlen("first"));
+    assert_uint_equal(lines[1].offset, strlen("first\r\n"));
+    assert_uint_equal(lines[1].length, strlen("second line"));
+    assert_uint_equal(lines[2].length, 0);
+    assert_uint_equal(lines[3].length, strlen("last"));
+    assert_memory_equal(logFileGetData(file) + lines[3].offset, "last", lines[3].length);
+
+    // Paging.
+    assert_uint_equal(logFileGetLines(file, 1, 2, lines), 2);
+    assert_uint_equal(lines[0].offset, strlen("first\r\n"));
+    assert_uint_equal(logFileGetLines(file, 3, 2, lines), 1);
+    assert_uint_equal(logFileGetLines(file, 4, 2, lines), 0);
+
+    logFileClose(file);
+}
+
+static void
+log_file_find_starts_from_given_line(void** state)
+{
+    (void)state;
+
+    char const text[] = "err: one\nok\nERR: two\nerr: three\n";
+
+    LogFile* file = logFileOpenMemory(text, strlen(text));
+    assert_non_null(file);
+
+    assert_int_equal(logFileFind(file, 0, "err", 3, 0), 0);
+    assert_int_equal(logFileFind(file, 1, "err", 3, 0), 3);
+    assert_int_equal(logFileFind(file, 1, "err", 3, LOG_FILE_FIND_IGNORE_CASE), 2);
+    assert_int_equal(logFileFind(file, 0, "three", 5, 0), 3);
+    assert_int_equal(logFileFind(file, 0, "missing", 7, 0), -1);
+
+    // Matches don't span lines.
+    assert_int_equal(logFileFind(file, 0, "one\nok", 6, 0), -1);
+
+    logFileClose(file);
+}
+
+static void
+log_file_reports_cut_marker_line(void** state)
+{
+    (void)state;
+
+    char const text[] = "head 1\nhead 2" LOG_FILE_CUT_MARKER "tail 1\ntail 2\n";
+
+    LogFile* file = logFileOpenMemory(text, strlen(text));
+    assert_non_null(file);
+
+    LogFileStats stats;
+    logFileGetStats(file, &stats);
+
+    // "head 1", "head 2", "", dashes, "", "tail 1", "tail 2"
+    assert_uint_equal(stats.numLines, 7);
+    assert_int_equal(stats.cutMarkerLine, 3);
+
+    LogFileLine line;
+    assert_uint_equal(logFileGetLines(file, stats.cutMarkerLine, 1, &line), 1);
+    assert_memory_equal(logFileGetData(file) + line.offset, "-----", 5);
+
+    logFileClose(file);
+}
+
+static void
+log_file_maps_file_from_disk(void** state)
+{
+    (void)state;
+
+    char path[] = "/tmp/TestLogFileXXXXXX";
+    int const fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+
+    char const text[] = "line 1\nline 2\n";
+    assert_int_equal(write(fd, text, strlen(text)), strlen(text));
+    close(fd);
+
+    LogFile* file = logFileOpen(path);
+    assert_non_null(file);
+
+    LogFileStats stats;
+    logFileGetStats(file, &stats);
+    assert_uint_equal(stats.size, strlen(text));
+    assert_uint_equal(stats.numLines, 2);
+    assert_int_equal(logFileFind(file, 0, "2", 1, 0), 1);
+
+    logFileClose(file);
+    unlink(path);
+
+    assert_null(logFileOpen(path));
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(empty_log_file_has_no_lines),
+        cmocka_unit_test(log_file_lines_exclude_terminators),
+        cmocka_unit_test(log_file_find_starts_from_given_line),
+        cmocka_unit_test(log_file_reports_cut_marker_line),
+        cmocka_unit_test(log_file_maps_file_from_disk),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,136 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PatternMatcher.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+/**
+ * Feeds @p text to the matcher and returns a string of the same length, with '^'
+ * at the positions where a pattern ended and '.' elsewhere.
+ */
+static void
+mark_matches(PatternMatcher const* matcher, char const* text, char* marks)
+{
+    PatternMatcherState state = PATTERN_MATCHER_INITIAL_STATE;
+
+    size_t const length = strlen(text);
+    for (size_t i = 0; i < length; ++i)
+    {
+        marks[i] = patternMatcherStep(matcher, &state, (unsigned char)text[i]) ? '^' : '.';
+    }
+
+    marks[length] = '\0';
+}
+
+static void
+pattern_matcher_without_patterns_matches_nothing(void** state)
+{
+    (void)state;
+
+    PatternMatcher* matcher = patternMatcherNew(NULL, 0);
+    assert_non_null(matcher);
+
+    char marks[32];
+    mark_matches(matcher, "anything", marks);
+    assert_string_equal(marks, "........");
+
+    patternMatcherFree(matcher);
+}
+
+static void
+pattern_matcher_finds_overlapping_patterns(void** state)
+{
+    (void)state;
+
+    // The classic example: "she" contains "he", and "hers" shares a prefix with "he".
+    char const* const patterns[] = {"he", "she", "his", "hers"};
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 4);
+    assert_non_null(matcher);
+
+    char marks[32];
+    mark_matches(matcher, "ushers", marks);
+    assert_string_equal(marks, "...^.^");
+
+    mark_matches(matcher, "ahishe", marks);
+    assert_string_equal(marks, "...^.^");
+
+    patternMatcherFree(matcher);
+}
+
+static void
+pattern_matcher_recovers_after_partial_match(void** state)
+{
+    (void)state;
+
+    char const* const patterns[] = {"", "Unhandled page fault"};
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 2);
+    assert_non_null(matcher);
+
+    char marks[64];
+    mark_matches(matcher, "UnhandUnhandled page fault", marks);
+    assert_string_equal(marks, ".........................^");
+
+    patternMatcherFree(matcher);
+}
+
+static void
+pattern_matcher_state_carries_across_chunks(void** state)
+{
+    (void)state;
+
+    char const* const patterns[] = {"fault"};
+
+    PatternMatcher* matcher = patternMatcherNew(patterns, 1);
+    assert_non_null(matcher);
+
+    PatternMatcherState matcherState = PATTERN_MATCHER_INITIAL_STATE;
+
+    for (char const* p = "page fa"; *p; ++p)
+    {
+        assert_false(patternMatcherStep(matcher, &matcherState, (unsigned char)*p));
+    }
+
+    assert_false(patternMatcherStep(matcher, &matcherState, 'u'));
+    assert_false(patternMatcherStep(matcher, &matcherState, 'l'));
+    assert_true(patternMatcherStep(matcher, &matcherState, 't'));
+
+    patternMatcherFree(matcher);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(pattern_matcher_without_patterns_matches_nothing),
+        cmocka_unit_test(pattern_matcher_finds_overlapping_patterns),
+        cmocka_unit_test(pattern_matcher_recovers_after_partial_match),
+        cmocka_unit_test(pattern_matcher_state_carries_across_chunks),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
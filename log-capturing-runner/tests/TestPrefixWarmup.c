@@ -0,0 +1,188 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// For F_OFD_SETLK
+#define _GNU_SOURCE
+
+#include "PrefixWarmup.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+/**
+ * Writes "<dir>/<fileName>" into @p path, which has to be PATH_MAX bytes long.
+ */
+static void
+buildPath(char* path, char const* dir, char const* fileName)
+{
+    int const len = snprintf(path, PATH_MAX, "%s/%s", dir, fileName);
+    assert_true(len >= 0 && len < PATH_MAX);
+}
+
+static void
+writeFile(char const* dir, char const* fileName, char const* content)
+{
+    char path[PATH_MAX];
+    buildPath(path, dir, fileName);
+
+    FILE* fp = fopen(path, "w");
+    assert_non_null(fp);
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static void
+removeFile(char const* dir, char const* fileName)
+{
+    char path[PATH_MAX];
+    buildPath(path, dir, fileName);
+    assert_int_equal(remove(path), 0);
+}
+
+static void
+wineserver_dir_is_derived_from_prefix_identity(void** state)
+{
+    (void)state;
+
+    char prefix[] = "/tmp/TestPrefixWarmupXXXXXX";
+    assert_non_null(mkdtemp(prefix));
+
+    struct stat prefixStat;
+    assert_int_equal(stat(prefix, &prefixStat), 0);
+
+    char expected[PATH_MAX];
+    snprintf(
+        expected, sizeof(expected), "/tmp/.wine-%u/server-%llx-%llx", (unsigned)getuid(),
+        (unsigned long long)prefixStat.st_dev, (unsigned long long)prefixStat.st_ino);
+
+    char dir[PATH_MAX];
+    assert_true(wineserverDirForPrefix(prefix, dir, sizeof(dir)));
+    assert_string_equal(dir, expected);
+
+    // Doesn't fit.
+    assert_false(wineserverDirForPrefix(prefix, dir, strlen(expected)));
+
+    assert_int_equal(rmdir(prefix), 0);
+    assert_false(wineserverDirForPrefix(prefix, dir, sizeof(dir)));
+}
+
+static void
+wineserver_is_running_while_lock_is_held(void** state)
+{
+    (void)state;
+
+    char dir[] = "/tmp/TestPrefixWarmupXXXXXX";
+    assert_non_null(mkdtemp(dir));
+
+    assert_false(isWineserverRunning(dir));
+
+    writeFile(dir, "lock", "");
+
+    // A lock file left behind by a wineserver that's gone.
+    assert_false(isWineserverRunning(dir));
+
+    char lockPath[PATH_MAX];
+    buildPath(lockPath, dir, "lock");
+    int const fd = open(lockPath, O_RDWR);
+    assert_int_not_equal(fd, -1);
+
+    // Locks held by our own process don't show up in F_GETLK, unless they are
+    // open file description locks.
+    struct flock lock = {.l_type = F_WRLCK, .l_whence = SEEK_SET, .l_start = 0, .l_len = 0};
+    assert_int_equal(fcntl(fd, F_OFD_SETLK, &lock), 0);
+
+    assert_true(isWineserverRunning(dir));
+
+    close(fd);
+
+    assert_false(isWineserverRunning(dir));
+
+    removeFile(dir, "lock");
+    assert_int_equal(rmdir(dir), 0);
+}
+
+static void
+pretouch_finds_files_relative_to_wineserver(void** state)
+{
+    (void)state;
+
+    char root[] = "/tmp/TestPrefixWarmupXXXXXX";
+    assert_non_null(mkdtemp(root));
+
+    char bin[PATH_MAX];
+    char lib[PATH_MAX];
+    char libWine[PATH_MAX];
+    char modules[PATH_MAX];
+    buildPath(bin, root, "bin");
+    buildPath(lib, root, "lib");
+    buildPath(libWine, lib, "wine");
+    buildPath(modules, libWine, "x86_64-windows");
+    assert_int_equal(mkdir(bin, 0700), 0);
+    assert_int_equal(mkdir(lib, 0700), 0);
+    assert_int_equal(mkdir(libWine, 0700), 0);
+    assert_int_equal(mkdir(modules, 0700), 0);
+
+    writeFile(bin, "wineserver", "server");
+    writeFile(bin, "wine", "12345");
+    writeFile(modules, "ntdll.dll", "123");
+    writeFile(modules, "notepad.exe", "1234567");
+
+    char wineserver[PATH_MAX];
+    buildPath(wineserver, bin, "wineserver");
+
+    PretouchStats const stats = pretouchCoreWineFiles(wineserver);
+    assert_uint_equal(stats.numFiles, 2);
+    assert_uint_equal(stats.numBytes, 5 + 3);
+
+    // Not under a "bin" directory of anything.
+    PretouchStats const noStats = pretouchCoreWineFiles("wineserver");
+    assert_uint_equal(noStats.numFiles, 0);
+
+    removeFile(modules, "notepad.exe");
+    removeFile(modules, "ntdll.dll");
+    removeFile(bin, "wine");
+    removeFile(bin, "wineserver");
+    assert_int_equal(rmdir(modules), 0);
+    assert_int_equal(rmdir(libWine), 0);
+    assert_int_equal(rmdir(lib), 0);
+    assert_int_equal(rmdir(bin), 0);
+    assert_int_equal(rmdir(root), 0);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(wineserver_dir_is_derived_from_prefix_identity),
+        cmocka_unit_test(wineserver_is_running_while_lock_is_held),
+        cmocka_unit_test(pretouch_finds_files_relative_to_wineserver),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -295,6 +295,57 @@ tail_buffer_adding_data_that_eats_into_both_existing_chunks(void** state)
     tailBufferFree(buf);
 }
 
+static void
+tail_buffer_last_appended_data_across_the_wrap_around(void** state)
+{
+    (void)state;
+
+    int const capacity = 100;
+    int const firstChunkSize = 70;
+    int const secondChunkSize = 50;
+
+    TailBuffer* buf = tailBufferNew(capacity);
+
+    uint8_t referenceData[256];
+    for (size_t i = 0; i < sizeof(referenceData); ++i)
+    {
+        referenceData[i] = i;
+    }
+
+    assert(sizeof(referenceData) >= firstChunkSize + secondChunkSize);
+
+    int pipeFds[2];
+    pipe(pipeFds);
+
+    write(pipeFds[1], referenceData, firstChunkSize);
+    tailBufferAppendFromFd(buf, pipeFds[0], NULL, NULL);
+
+    TailBufferData data = tailBufferGetLastAppendedData(buf);
+    assert_int_equal(data.numChunks, 1);
+    assert_int_equal(data.chunks[0].iov_len, firstChunkSize);
+    assert_memory_equal(data.chunks[0].iov_base, referenceData, firstChunkSize);
+
+    write(pipeFds[1], referenceData + firstChunkSize, secondChunkSize);
+
+    // The stored data becomes [20, 100) + [0, 20), of which the last 50 bytes were
+    // appended by this call: [70, 100) + [0, 20).
+    tailBufferAppendFromFd(buf, pipeFds[0], NULL, NULL);
+
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+
+    data = tailBufferGetLastAppendedData(buf);
+    assert_int_equal(data.numChunks, 2);
+
+    assert_int_equal(data.chunks[0].iov_len, 30);
+    assert_memory_equal(data.chunks[0].iov_base, referenceData + 70, 30);
+
+    assert_int_equal(data.chunks[1].iov_len, 20);
+    assert_memory_equal(data.chunks[1].iov_base, referenceData + 100, 20);
+
+    tailBufferFree(buf);
+}
+
 int
 main(void)
 {
@@ -305,6 +356,7 @@ main(void)
         cmocka_unit_test(tail_buffer_adding_data_that_doesnt_cause_discarding_any_existing_data),
         cmocka_unit_test(tail_buffer_adding_data_that_eats_into_the_1st_existing_chunk),
         cmocka_unit_test(tail_buffer_adding_data_that_eats_into_both_existing_chunks),
+        cmocka_unit_test(tail_buffer_last_appended_data_across_the_wrap_around),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
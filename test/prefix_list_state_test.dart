@@ -13,6 +13,7 @@ WinePrefix _makePrefix({required String name, required String outerDir}) {
       relPathToWineInstall: '..',
       hiDpiScale: null,
       wow64ModePreferred: null,
+      warmUpOnOpen: false,
     ),
   );
 }
@@ -12,8 +12,10 @@ import 'package:winebar/models/wine_prefix.dart';
 import 'package:winebar/models/wine_prefix_dir_structure.dart';
 import 'package:winebar/repositories/running_executables_repo.dart';
 import 'package:winebar/services/app_settings_service.dart';
+import 'package:winebar/services/running_wine_processes_tracker.dart';
 import 'package:winebar/services/utility_service.dart';
 import 'package:winebar/services/wine_process_runner_service.dart';
+import 'package:winebar/services/winebar_agent_service.dart';
 import 'package:winebar/utils/local_storage_paths.dart';
 import 'package:winebar/utils/prefix_descriptor.dart';
 import 'package:winebar/utils/startup_data.dart';
@@ -33,6 +35,7 @@ import 'package:winebar/widgets/prefix_settings_dialog.dart';
   MockSpec<WineInstallationDescriptor>(),
   MockSpec<WineProcessRunnerService>(),
   MockSpec<WineProcess>(),
+  MockSpec<WinebarAgentService>(),
 ])
 import 'prefix_settings_dialog_test.mocks.dart';
 
@@ -57,6 +60,7 @@ void main() {
     final wineInstallationDescriptor = MockWineInstallationDescriptor();
     final wineProcessRunnerService = MockWineProcessRunnerService();
     final wineProcess = MockWineProcess();
+    final winebarAgentService = MockWinebarAgentService();
 
     final runningSpecialExecutablesRepo =
         MockRunningExecutablesRepo<SpecialExecutableSlot>();
@@ -77,6 +81,8 @@ void main() {
       startupData.wineProcessRunnerService,
     ).thenReturn(wineProcessRunnerService);
 
+    when(startupData.winebarAgentService).thenReturn(winebarAgentService);
+
     when(
       localStoragePaths.createProcessOutputDir(),
     ).thenAnswer((_) async => processOutputDir);
@@ -102,6 +108,9 @@ void main() {
     ).thenAnswer((_) async => prefixJsonFile);
 
     GetIt.I.registerSingleton<Logger>(Logger());
+    GetIt.I.registerSingleton<RunningWineProcessesTracker>(
+      RunningWineProcessesTracker(),
+    );
     GetIt.I.registerSingleton<AppSettingsService>(appSettingsService);
     GetIt.I.registerSingleton<UtilityService>(utilityService);
     GetIt.I.registerSingleton<RunningExecutablesRepo<SpecialExecutableSlot>>(
@@ -115,6 +124,7 @@ void main() {
         relPathToWineInstall: relPathToWineInstall,
         hiDpiScale: 1.5, // The value to be picked up.
         wow64ModePreferred: null,
+        warmUpOnOpen: false,
       ),
     );
 
@@ -22,6 +22,7 @@ import 'package:winebar/repositories/running_executables_repo.dart' as _i21;
 import 'package:winebar/services/app_settings_service.dart' as _i8;
 import 'package:winebar/services/utility_service.dart' as _i12;
 import 'package:winebar/services/wine_process_runner_service.dart' as _i5;
+import 'package:winebar/services/winebar_agent_service.dart' as _i23;
 import 'package:winebar/utils/local_storage_paths.dart' as _i4;
 import 'package:winebar/utils/startup_data.dart' as _i14;
 import 'package:winebar/utils/wine_installation_descriptor.dart' as _i3;
@@ -126,6 +127,17 @@ class _FakeWineProcessResult_14 extends _i1.SmartFake
     : super(parent, parentInvocation);
 }
 
+class _FakeWineCommand_15 extends _i1.SmartFake implements _i5.WineCommand {
+  _FakeWineCommand_15(Object parent, Invocation parentInvocation)
+    : super(parent, parentInvocation);
+}
+
+class _FakeWinebarAgentService_16 extends _i1.SmartFake
+    implements _i23.WinebarAgentService {
+  _FakeWinebarAgentService_16(Object parent, Invocation parentInvocation)
+    : super(parent, parentInvocation);
+}
+
 /// A class which mocks [AppSettingsService].
 ///
 /// See the documentation for Mockito's code generation for more information.
@@ -250,6 +262,21 @@ class MockStartupData extends _i1.Mock implements _i14.StartupData {
           )
           as _i5.WineProcessRunnerService);
 
+  @override
+  _i23.WinebarAgentService get winebarAgentService =>
+      (super.noSuchMethod(
+            Invocation.getter(#winebarAgentService),
+            returnValue: _FakeWinebarAgentService_16(
+              this,
+              Invocation.getter(#winebarAgentService),
+            ),
+            returnValueForMissingStub: _FakeWinebarAgentService_16(
+              this,
+              Invocation.getter(#winebarAgentService),
+            ),
+          )
+          as _i23.WinebarAgentService);
+
   @override
   bool get isIntelHost =>
       (super.noSuchMethod(
@@ -1579,12 +1606,14 @@ class MockWineProcessRunnerService extends _i1.Mock
     required _i6.Directory? processOutputDir,
     required List<String>? commandLine,
     required Map<String, String>? envVars,
+    bool? viaLaunchShim = false,
   }) =>
       (super.noSuchMethod(
             Invocation.method(#start, [], {
               #processOutputDir: processOutputDir,
               #commandLine: commandLine,
               #envVars: envVars,
+              #viaLaunchShim: viaLaunchShim,
             }),
             returnValue: _i13.Future<_i5.WineProcess>.value(
               _FakeWineProcess_13(
@@ -1593,6 +1622,7 @@ class MockWineProcessRunnerService extends _i1.Mock
                   #processOutputDir: processOutputDir,
                   #commandLine: commandLine,
                   #envVars: envVars,
+                  #viaLaunchShim: viaLaunchShim,
                 }),
               ),
             ),
@@ -1603,11 +1633,91 @@ class MockWineProcessRunnerService extends _i1.Mock
                   #processOutputDir: processOutputDir,
                   #commandLine: commandLine,
                   #envVars: envVars,
+                  #viaLaunchShim: viaLaunchShim,
+                }),
+              ),
+            ),
+          )
+          as _i13.Future<_i5.WineProcess>);
+
+  @override
+  _i5.WineCommand buildCommand({
+    required String? processOutputDir,
+    required List<String>? commandLine,
+    required Map<String, String>? envVars,
+    bool? viaLaunchShim = false,
+  }) =>
+      (super.noSuchMethod(
+            Invocation.method(#buildCommand, [], {
+              #processOutputDir: processOutputDir,
+              #commandLine: commandLine,
+              #envVars: envVars,
+              #viaLaunchShim: viaLaunchShim,
+            }),
+            returnValue: _FakeWineCommand_15(
+              this,
+              Invocation.method(#buildCommand, [], {
+                #processOutputDir: processOutputDir,
+                #commandLine: commandLine,
+                #envVars: envVars,
+                #viaLaunchShim: viaLaunchShim,
+              }),
+            ),
+            returnValueForMissingStub: _FakeWineCommand_15(
+              this,
+              Invocation.method(#buildCommand, [], {
+                #processOutputDir: processOutputDir,
+                #commandLine: commandLine,
+                #envVars: envVars,
+                #viaLaunchShim: viaLaunchShim,
+              }),
+            ),
+          )
+          as _i5.WineCommand);
+
+  @override
+  _i13.Future<_i5.WineProcess> startKeepalive({
+    required _i6.Directory? processOutputDir,
+    required Map<String, String>? envVars,
+    required Duration? keepalive,
+  }) =>
+      (super.noSuchMethod(
+            Invocation.method(#startKeepalive, [], {
+              #processOutputDir: processOutputDir,
+              #envVars: envVars,
+              #keepalive: keepalive,
+            }),
+            returnValue: _i13.Future<_i5.WineProcess>.value(
+              _FakeWineProcess_13(
+                this,
+                Invocation.method(#startKeepalive, [], {
+                  #processOutputDir: processOutputDir,
+                  #envVars: envVars,
+                  #keepalive: keepalive,
+                }),
+              ),
+            ),
+            returnValueForMissingStub: _i13.Future<_i5.WineProcess>.value(
+              _FakeWineProcess_13(
+                this,
+                Invocation.method(#startKeepalive, [], {
+                  #processOutputDir: processOutputDir,
+                  #envVars: envVars,
+                  #keepalive: keepalive,
                 }),
               ),
             ),
           )
           as _i13.Future<_i5.WineProcess>);
+
+  @override
+  _i13.Future<void> stopKeepalive({required String? prefixDir}) =>
+      (super.noSuchMethod(
+            Invocation.method(#stopKeepalive, [], {#prefixDir: prefixDir}),
+            returnValue: _i13.Future<void>.value(),
+            returnValueForMissingStub: _i13.Future<void>.value(),
+          )
+          as _i13.Future<void>);
 }
 
 /// A class which mocks [WineProcess].
@@ -1636,3 +1746,35 @@ class MockWineProcess extends _i1.Mock implements _i5.WineProcess {
           )
           as bool);
 }
+
+/// A class which mocks [WinebarAgentService].
+///
+/// See the documentation for Mockito's code generation for more information.
+class MockWinebarAgentService extends _i1.Mock
+    implements _i23.WinebarAgentService {
+  @override
+  _i13.Future<List<String>?> request({
+    required _i11.WinePrefix? winePrefix,
+    required _i3.WineInstallationDescriptor? wineInstDescriptor,
+    required List<String>? request,
+  }) =>
+      (super.noSuchMethod(
+            Invocation.method(#request, [], {
+              #winePrefix: winePrefix,
+              #wineInstDescriptor: wineInstDescriptor,
+              #request: request,
+            }),
+            returnValue: _i13.Future<List<String>?>.value(),
+            returnValueForMissingStub: _i13.Future<List<String>?>.value(),
+          )
+          as _i13.Future<List<String>?>);
+
+  @override
+  _i13.Future<void> shutDown({required _i11.WinePrefix? winePrefix}) =>
+      (super.noSuchMethod(
+            Invocation.method(#shutDown, [], {#winePrefix: winePrefix}),
+            returnValue: _i13.Future<void>.value(),
+            returnValueForMissingStub: _i13.Future<void>.value(),
+          )
+          as _i13.Future<void>);
+}
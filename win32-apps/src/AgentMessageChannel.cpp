@@ -0,0 +1,159 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AgentMessageChannel.h"
+
+#include "ErrorString.h"
+#include "Utf8.h"
+#include "WStringRuntimeError.h"
+
+#include <format>
+#include <string_view>
+
+AgentMessageChannel::AgentMessageChannel(HANDLE input, HANDLE output)
+    : mInput(input)
+    , mOutput(output)
+{
+}
+
+std::optional<std::vector<std::wstring>>
+AgentMessageChannel::readMessage()
+{
+    unsigned char sizeBytes[4];
+    if (!readExactly(sizeBytes, sizeof(sizeBytes)))
+    {
+        return std::nullopt;
+    }
+
+    uint32_t const size = (uint32_t)sizeBytes[0] | ((uint32_t)sizeBytes[1] << 8) |
+                          ((uint32_t)sizeBytes[2] << 16) | ((uint32_t)sizeBytes[3] << 24);
+
+    if (size > maxMessageSize)
+    {
+        throw WStringRuntimeError(std::format(L"Message too large: {} bytes", size));
+    }
+
+    std::string payload(size, '\0');
+    if (size != 0 && !readExactly(payload.data(), size))
+    {
+        throw WStringRuntimeError(L"Input closed in the middle of a message");
+    }
+
+    if (!payload.empty() && payload.back() != '\0')
+    {
+        throw WStringRuntimeError(L"Malformed message: the last field is not terminated");
+    }
+
+    std::vector<std::wstring> fields;
+
+    std::string_view remaining(payload);
+    while (!remaining.empty())
+    {
+        size_t const fieldEnd = remaining.find('\0');
+        fields.push_back(fromUtf8(remaining.substr(0, fieldEnd)));
+        remaining.remove_prefix(fieldEnd + 1);
+    }
+
+    return fields;
+}
+
+void
+AgentMessageChannel::writeMessage(std::vector<std::wstring> const& fields)
+{
+    std::string payload;
+    for (std::wstring const& field : fields)
+    {
+        payload += toUtf8(field);
+        payload += '\0';
+    }
+
+    if (payload.size() > maxMessageSize)
+    {
+        throw WStringRuntimeError(std::format(L"Message too large: {} bytes", payload.size()));
+    }
+
+    uint32_t const size = (uint32_t)payload.size();
+    unsigned char const sizeBytes[4] = {
+        (unsigned char)size, (unsigned char)(size >> 8), (unsigned char)(size >> 16),
+        (unsigned char)(size >> 24)};
+
+    writeExactly(sizeBytes, sizeof(sizeBytes));
+    writeExactly(payload.data(), size);
+}
+
+bool
+AgentMessageChannel::readExactly(void* buffer, DWORD size)
+{
+    DWORD totalRead = 0;
+
+    while (totalRead < size)
+    {
+        DWORD bytesRead = 0;
+        if (!ReadFile(
+                mInput, static_cast<char*>(buffer) + totalRead, size - totalRead, &bytesRead,
+                nullptr))
+        {
+            DWORD const errorCode = GetLastError();
+            if (errorCode != ERROR_BROKEN_PIPE && errorCode != ERROR_HANDLE_EOF)
+            {
+                throw WStringRuntimeError(
+                    std::format(
+                        L"Failed to read a message: {}",
+                        errorStringFromErrorCode(errorCode).get()));
+            }
+
+            bytesRead = 0;
+        }
+
+        if (bytesRead == 0)
+        {
+            if (totalRead == 0)
+            {
+                return false;
+            }
+
+            throw WStringRuntimeError(L"Input closed in the middle of a message");
+        }
+
+        totalRead += bytesRead;
+    }
+
+    return true;
+}
+
+void
+AgentMessageChannel::writeExactly(void const* buffer, DWORD size)
+{
+    DWORD totalWritten = 0;
+
+    while (totalWritten < size)
+    {
+        DWORD bytesWritten = 0;
+        if (!WriteFile(
+                mOutput, static_cast<char const*>(buffer) + totalWritten, size - totalWritten,
+                &bytesWritten, nullptr))
+        {
+            throw WStringRuntimeError(
+                std::format(
+                    L"Failed to write a message: {}",
+                    errorStringFromErrorCode(GetLastError()).get()));
+        }
+
+        totalWritten += bytesWritten;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <windows.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Reads and writes the length-prefixed messages winebar-agent exchanges with Wine Bar.
+ *
+ * A message is a 32-bit little-endian payload size followed by the payload. The payload is
+ * a sequence of UTF-8 fields, each terminated by a '\0'. For requests, the first field is
+ * the operation name and the rest are its arguments. For responses, the first field is
+ * either "ok", followed by the results, or "error", followed by the error message.
+ */
+class AgentMessageChannel
+{
+public:
+    /**
+     * Messages larger than this are rejected, as they can only result from a protocol
+     * mismatch.
+     */
+    static constexpr uint32_t maxMessageSize = 16 * 1024 * 1024;
+
+    AgentMessageChannel(AgentMessageChannel const&) = delete;
+    AgentMessageChannel& operator=(AgentMessageChannel const&) = delete;
+
+    /**
+     * The channel doesn't take ownership of the handles.
+     */
+    AgentMessageChannel(HANDLE input, HANDLE output);
+
+    /**
+     * Blocks until a whole message is read.
+     *
+     * @return The message's fields or std::nullopt if the input was closed between messages.
+     * @throw WStringRuntimeError If reading fails, including the input getting closed in the
+     *        middle of a message, or if the message is malformed.
+     */
+    std::optional<std::vector<std::wstring>> readMessage();
+
+    /**
+     * @throw WStringRuntimeError If writing fails.
+     */
+    void writeMessage(std::vector<std::wstring> const& fields);
+
+private:
+    /**
+     * @return false if the input was closed before anything was read.
+     * @throw WStringRuntimeError If reading fails or the input gets closed after reading
+     *        some but not all of @p size bytes.
+     */
+    bool readExactly(void* buffer, DWORD size);
+
+    void writeExactly(void const* buffer, DWORD size);
+
+    HANDLE mInput;
+    HANDLE mOutput;
+};
@@ -0,0 +1,475 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DesktopChangeWatcher.h"
+
+#include "CaseInsensitiveCompare.h"
+#include "ErrorString.h"
+#include "ScopeCleanup.h"
+#include "WStringRuntimeError.h"
+
+#include <shlobj.h>
+#include <shlwapi.h>
+#include <windows.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <system_error>
+
+namespace
+{
+
+/**
+ * After being told to stop, we keep collecting notifications until there are none for
+ * this long, as they are delivered asynchronously.
+ */
+DWORD const kDrainTimeoutMs = 200;
+
+/**
+ * The size of the buffer ReadDirectoryChangesW() writes notifications to, in DWORDs.
+ * If the buffer overflows, we fall back to rescanning the folders.
+ */
+size_t const kNotificationBufferDwords = 16 * 1024;
+
+std::wstring
+knownFolderPath(REFKNOWNFOLDERID knownFolderId, wchar_t const* folderName)
+{
+    PWSTR folderPath = nullptr;
+
+    HRESULT hr = SHGetKnownFolderPath(knownFolderId, KF_FLAG_DEFAULT, nullptr, &folderPath);
+
+    // The docs say to call CoTaskMemFree() even if SHGetKnownFolderPath fails.
+    ScopeCleanup folderPathCleanup([folderPath] { CoTaskMemFree(folderPath); });
+
+    if (FAILED(hr))
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"SHGetKnownFolderPath({}) failed: {}", folderName,
+                errorStringFromErrorCode(hr).get()));
+    }
+
+    return folderPath;
+}
+
+bool
+isLnkFile(std::wstring const& path)
+{
+    return caseInsensitiveCompare(PathFindExtensionW(path.c_str()), L".lnk") == 0;
+}
+
+bool
+isPathUnder(std::wstring const& path, std::wstring const& dir)
+{
+    if (path.size() <= dir.size() || path[dir.size()] != L'\\')
+    {
+        return false;
+    }
+
+    int const dirSize = (int)dir.size();
+    return CompareStringOrdinal(path.c_str(), dirSize, dir.c_str(), dirSize, TRUE) == CSTR_EQUAL;
+}
+
+bool
+pathsEqual(std::wstring const& lhs, std::wstring const& rhs)
+{
+    return caseInsensitiveCompare(lhs.c_str(), rhs.c_str()) == 0;
+}
+
+} // namespace
+
+struct DesktopChangeWatcher::WatchedFolder
+{
+    std::wstring path;
+    bool recursive = false;
+    bool onlyLnkFiles = false;
+    OwnedHandle directory = makeOwnedHandle();
+    OwnedHandle event = makeOwnedHandle();
+    OVERLAPPED overlapped;
+    bool readPending = false;
+
+    // ReadDirectoryChangesW() requires a DWORD-aligned buffer.
+    std::vector<DWORD> buffer = std::vector<DWORD>(kNotificationBufferDwords);
+};
+
+DesktopChangeWatcher::DesktopChangeWatcher()
+{
+    // Pending reads have to be cancelled before the buffers are freed, which wouldn't
+    // happen automatically if we throw from here.
+    ScopeCleanup pendingReadsCleanup([this] { cancelPendingReads(); });
+
+    GetSystemTimeAsFileTime(&mStartTime);
+
+    struct FolderSpec
+    {
+        KNOWNFOLDERID const* id;
+        wchar_t const* name;
+        bool isStartMenu;
+    };
+
+    FolderSpec const folderSpecs[] = {
+        {&FOLDERID_Desktop, L"FOLDERID_Desktop", false},
+        {&FOLDERID_PublicDesktop, L"FOLDERID_PublicDesktop", false},
+        {&FOLDERID_Programs, L"FOLDERID_Programs", true},
+        {&FOLDERID_CommonPrograms, L"FOLDERID_CommonPrograms", true},
+    };
+
+    for (auto const& spec : folderSpecs)
+    {
+        auto folder = std::make_unique<WatchedFolder>();
+        folder->path = knownFolderPath(*spec.id, spec.name);
+        folder->recursive = spec.isStartMenu;
+        folder->onlyLnkFiles = spec.isStartMenu;
+
+        // The folder may not exist yet in a fresh prefix.
+        std::error_code ec;
+        std::filesystem::create_directories(folder->path, ec);
+
+        folder->directory.reset(CreateFileW(
+            folder->path.c_str(), FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr));
+
+        if (folder->directory.get() == INVALID_HANDLE_VALUE)
+        {
+            folder->directory.release();
+            throw WStringRuntimeError(
+                std::format(
+                    L"Failed to open directory {} for watching: {}", folder->path,
+                    errorStringFromErrorCode(GetLastError()).get()));
+        }
+
+        folder->event.reset(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+        if (!folder->event)
+        {
+            throw WStringRuntimeError(
+                std::format(
+                    L"CreateEvent() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+        }
+
+        if (!issueRead(*folder))
+        {
+            throw WStringRuntimeError(
+                std::format(
+                    L"ReadDirectoryChangesW() failed on {}: {}", folder->path,
+                    errorStringFromErrorCode(GetLastError()).get()));
+        }
+
+        mFolders.push_back(std::move(folder));
+    }
+
+    mStopEvent.reset(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+    if (!mStopEvent)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateEvent() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    mThread.reset(CreateThread(nullptr, 0, &DesktopChangeWatcher::threadProc, this, 0, nullptr));
+    if (!mThread)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateThread() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    pendingReadsCleanup.cancelCleanup();
+}
+
+DesktopChangeWatcher::~DesktopChangeWatcher()
+{
+    stopThread();
+    cancelPendingReads();
+}
+
+std::vector<std::wstring>
+DesktopChangeWatcher::stop()
+{
+    stopThread();
+
+    std::vector<std::wstring> files;
+
+    if (mNotificationsLost)
+    {
+        files = filesModifiedSinceStart();
+    }
+    else
+    {
+        for (auto const& path : mAddedFiles)
+        {
+            std::error_code ec;
+            if (std::filesystem::is_directory(path, ec))
+            {
+                // Files moved into the Start Menu along with their directory don't produce
+                // notifications of their own.
+                for (auto const& entry :
+                     std::filesystem::recursive_directory_iterator(path, ec))
+                {
+                    if (entry.is_regular_file(ec) && isLnkFile(entry.path().wstring()))
+                    {
+                        files.push_back(entry.path().wstring());
+                    }
+                }
+            }
+            else if (std::filesystem::exists(path, ec))
+            {
+                files.push_back(path);
+            }
+        }
+    }
+
+    return files;
+}
+
+DWORD WINAPI
+DesktopChangeWatcher::threadProc(LPVOID param)
+{
+    static_cast<DesktopChangeWatcher*>(param)->run();
+    return 0;
+}
+
+void
+DesktopChangeWatcher::run()
+{
+    std::vector<HANDLE> handles;
+    handles.push_back(mStopEvent.get());
+    for (auto const& folder : mFolders)
+    {
+        handles.push_back(folder->event.get());
+    }
+
+    for (;;)
+    {
+        DWORD const r =
+            WaitForMultipleObjects((DWORD)handles.size(), handles.data(), FALSE, INFINITE);
+
+        if (r == WAIT_OBJECT_0)
+        {
+            break;
+        }
+        else if (r > WAIT_OBJECT_0 && r < WAIT_OBJECT_0 + handles.size())
+        {
+            handleCompletedRead(*mFolders[r - WAIT_OBJECT_0 - 1]);
+        }
+        else
+        {
+            mNotificationsLost = true;
+            return;
+        }
+    }
+
+    drainPendingNotifications(std::vector<HANDLE>(handles.begin() + 1, handles.end()));
+}
+
+void
+DesktopChangeWatcher::drainPendingNotifications(std::vector<HANDLE> const& folderEvents)
+{
+    for (;;)
+    {
+        DWORD const r = WaitForMultipleObjects(
+            (DWORD)folderEvents.size(), folderEvents.data(), FALSE, kDrainTimeoutMs);
+
+        if (r >= WAIT_OBJECT_0 && r < WAIT_OBJECT_0 + folderEvents.size())
+        {
+            handleCompletedRead(*mFolders[r - WAIT_OBJECT_0]);
+        }
+        else
+        {
+            // Either a timeout or an error.
+            break;
+        }
+    }
+}
+
+bool
+DesktopChangeWatcher::issueRead(WatchedFolder& folder)
+{
+    ZeroMemory(&folder.overlapped, sizeof(folder.overlapped));
+    folder.overlapped.hEvent = folder.event.get();
+
+    DWORD const bufferSize = (DWORD)(folder.buffer.size() * sizeof(DWORD));
+
+    folder.readPending = ReadDirectoryChangesW(
+        folder.directory.get(), folder.buffer.data(), bufferSize, folder.recursive,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME, nullptr, &folder.overlapped,
+        nullptr);
+
+    return folder.readPending;
+}
+
+void
+DesktopChangeWatcher::handleCompletedRead(WatchedFolder& folder)
+{
+    DWORD numBytes = 0;
+    bool const ok =
+        GetOverlappedResult(folder.directory.get(), &folder.overlapped, &numBytes, FALSE);
+    folder.readPending = false;
+
+    if (!ok || numBytes == 0)
+    {
+        // Zero bytes means the buffer overflowed and the notifications were dropped.
+        mNotificationsLost = true;
+    }
+    else
+    {
+        auto const* bytes = reinterpret_cast<BYTE const*>(folder.buffer.data());
+
+        for (;;)
+        {
+            auto const* info = reinterpret_cast<FILE_NOTIFY_INFORMATION const*>(bytes);
+
+            std::wstring const path = std::format(
+                L"{}\\{}", folder.path,
+                std::wstring_view(info->FileName, info->FileNameLength / sizeof(wchar_t)));
+
+            switch (info->Action)
+            {
+            case FILE_ACTION_ADDED:
+            case FILE_ACTION_RENAMED_NEW_NAME:
+                // Directories are let through here and expanded in stop().
+                if (!folder.onlyLnkFiles || isLnkFile(path) || PathIsDirectoryW(path.c_str()))
+                {
+                    addFile(path);
+                }
+                break;
+            case FILE_ACTION_REMOVED:
+            case FILE_ACTION_RENAMED_OLD_NAME:
+                removeFile(path);
+                break;
+            default:
+                break;
+            }
+
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+
+            bytes += info->NextEntryOffset;
+        }
+    }
+
+    ResetEvent(folder.event.get());
+
+    if (!issueRead(folder))
+    {
+        mNotificationsLost = true;
+    }
+}
+
+void
+DesktopChangeWatcher::addFile(std::wstring const& path)
+{
+    auto const it = std::find_if(
+        mAddedFiles.begin(), mAddedFiles.end(),
+        [&path](std::wstring const& addedFile) { return pathsEqual(addedFile, path); });
+
+    if (it == mAddedFiles.end())
+    {
+        mAddedFiles.push_back(path);
+    }
+}
+
+void
+DesktopChangeWatcher::removeFile(std::wstring const& path)
+{
+    std::erase_if(mAddedFiles, [&path](std::wstring const& addedFile) {
+        return pathsEqual(addedFile, path) || isPathUnder(addedFile, path);
+    });
+}
+
+void
+DesktopChangeWatcher::cancelPendingReads()
+{
+    // The buffers must outlive any pending reads.
+    for (auto& folder : mFolders)
+    {
+        if (folder->readPending)
+        {
+            DWORD numBytes = 0;
+            CancelIo(folder->directory.get());
+            GetOverlappedResult(folder->directory.get(), &folder->overlapped, &numBytes, TRUE);
+            folder->readPending = false;
+        }
+    }
+}
+
+void
+DesktopChangeWatcher::stopThread()
+{
+    if (!mThread)
+    {
+        return;
+    }
+
+    SetEvent(mStopEvent.get());
+    WaitForSingleObject(mThread.get(), INFINITE);
+    mThread.reset();
+}
+
+std::vector<std::wstring>
+DesktopChangeWatcher::filesModifiedSinceStart() const
+{
+    std::vector<std::wstring> files;
+
+    auto const maybeAddFile = [this, &files](WatchedFolder const& folder, auto const& entry) {
+        std::error_code ec;
+        if (!entry.is_regular_file(ec))
+        {
+            return;
+        }
+
+        std::wstring const path = entry.path().wstring();
+        if (folder.onlyLnkFiles && !isLnkFile(path))
+        {
+            return;
+        }
+
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes) &&
+            (CompareFileTime(&attributes.ftLastWriteTime, &mStartTime) >= 0 ||
+             CompareFileTime(&attributes.ftCreationTime, &mStartTime) >= 0))
+        {
+            files.push_back(path);
+        }
+    };
+
+    for (auto const& folder : mFolders)
+    {
+        std::error_code ec;
+        if (folder->recursive)
+        {
+            for (auto const& entry :
+                 std::filesystem::recursive_directory_iterator(folder->path, ec))
+            {
+                maybeAddFile(*folder, entry);
+            }
+        }
+        else
+        {
+            for (auto const& entry : std::filesystem::directory_iterator(folder->path, ec))
+            {
+                maybeAddFile(*folder, entry);
+            }
+        }
+    }
+
+    return files;
+}
@@ -0,0 +1,95 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OwnedTypes.h"
+
+#include <windows.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Watches the Desktop, Public Desktop, Programs and Common Programs folders for files
+ * being added or removed, using ReadDirectoryChangesW() on a background thread.
+ *
+ * The Programs folders (the Start Menu) are watched recursively, as installers put their
+ * shortcuts into subfolders there. Only .lnk files are tracked in the Start Menu.
+ */
+class DesktopChangeWatcher
+{
+public:
+    DesktopChangeWatcher(DesktopChangeWatcher const&) = delete;
+    DesktopChangeWatcher& operator=(DesktopChangeWatcher const&) = delete;
+
+    /**
+     * Starts watching.
+     *
+     * @throw WStringRuntimeError If any of the folders can't be watched.
+     */
+    DesktopChangeWatcher();
+
+    /**
+     * Stops watching, unless stop() was already called.
+     */
+    ~DesktopChangeWatcher();
+
+    /**
+     * Stops watching and returns the files that were added and not removed afterwards,
+     * in the order they appeared. Directories that were added are replaced by the files
+     * inside them.
+     *
+     * If some notifications were lost, the watched folders are rescanned for files
+     * modified since the watcher was started.
+     */
+    std::vector<std::wstring> stop();
+
+private:
+    struct WatchedFolder;
+
+    static DWORD WINAPI threadProc(LPVOID param);
+
+    void run();
+
+    void drainPendingNotifications(std::vector<HANDLE> const& folderEvents);
+
+    bool issueRead(WatchedFolder& folder);
+
+    void handleCompletedRead(WatchedFolder& folder);
+
+    void addFile(std::wstring const& path);
+
+    void removeFile(std::wstring const& path);
+
+    void cancelPendingReads();
+
+    void stopThread();
+
+    std::vector<std::wstring> filesModifiedSinceStart() const;
+
+    std::vector<std::unique_ptr<WatchedFolder>> mFolders;
+    OwnedHandle mStopEvent = makeOwnedHandle();
+    OwnedHandle mThread = makeOwnedHandle();
+    FILETIME mStartTime;
+
+    // These are only accessed by the background thread until it's stopped.
+    std::vector<std::wstring> mAddedFiles;
+    bool mNotificationsLost = false;
+};
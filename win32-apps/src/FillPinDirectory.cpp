@@ -32,16 +32,42 @@
 #include <iostream>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace
 {
 
-bool
-tryExtractIconFromExecutable(
-    wchar_t const* windowsExecutableFilePath, wchar_t const* windowsPngOutputPath)
+/**
+ * The icon sizes we extract. We produce a separate PNG for each of them, so that the UI
+ * could pick the one closest to the size it's going to display it at, rather than decoding
+ * and downsampling the largest one.
+ *
+ * The list has to be sorted in ascending order. Keep in sync with pinned_executable.dart.
+ */
+int const kIconSizes[] = {16, 24, 32, 48, 64, 256};
+
+/**
+ * The largest icon goes into icon.png, which is what older versions of the UI expect.
+ * The rest go into icon-<size>.png.
+ */
+int const kPrimaryIconSize = 256;
+
+std::wstring
+iconFileNameForSize(int iconSize)
 {
-    int const iconResolution = 256;
+    if (iconSize == kPrimaryIconSize)
+    {
+        return L"icon.png";
+    }
+    else
+    {
+        return std::format(L"icon-{}.png", iconSize);
+    }
+}
 
+OwnedIcon
+tryLoadIcon(wchar_t const* windowsExecutableFilePath, int iconResolution)
+{
     OwnedIcon icon = makeOwnedIcon();
 
     try
@@ -59,11 +85,11 @@ tryExtractIconFromExecutable(
 
     if (!icon)
     {
-        std::wcout
-            << std::format(
-                   L"Failed to get an icon for {}. Will try to get a default icon instead.",
-                   windowsExecutableFilePath)
-            << std::endl;
+        std::wcout << std::format(
+                          L"Failed to get a {}px icon for {}. Will try to get a default icon "
+                          L"instead.",
+                          iconResolution, windowsExecutableFilePath)
+                   << std::endl;
 
         try
         {
@@ -80,6 +106,16 @@ tryExtractIconFromExecutable(
         }
     }
 
+    return icon;
+}
+
+bool
+tryExtractIconFromExecutable(
+    wchar_t const* windowsExecutableFilePath, int iconResolution,
+    wchar_t const* windowsPngOutputPath)
+{
+    OwnedIcon const icon = tryLoadIcon(windowsExecutableFilePath, iconResolution);
+
     if (!icon)
     {
         return false;
@@ -107,18 +143,32 @@ tryExtractIconFromExecutable(
 void
 fillPinDirectory(wchar_t const* windowsPinDir, wchar_t const* unixOrWindowsPinTargetPath)
 {
-    static wchar_t const kExtractedIconFileName[] = L"icon.png";
-
     auto const windowsPinTargetPath = toWindowsFilePath(unixOrWindowsPinTargetPath);
 
-    auto const windowsPngOutputPath = std::format(L"{}\\{}", windowsPinDir, kExtractedIconFileName);
+    std::vector<int> extractedIconSizes;
+    bool primaryIconExtracted = false;
 
-    bool const iconExtracted =
-        tryExtractIconFromExecutable(windowsPinTargetPath.c_str(), windowsPngOutputPath.c_str());
+    for (int const iconSize : kIconSizes)
+    {
+        auto const windowsPngOutputPath =
+            std::format(L"{}\\{}", windowsPinDir, iconFileNameForSize(iconSize));
+
+        if (tryExtractIconFromExecutable(
+                windowsPinTargetPath.c_str(), iconSize, windowsPngOutputPath.c_str()))
+        {
+            extractedIconSizes.push_back(iconSize);
+
+            if (iconSize == kPrimaryIconSize)
+            {
+                primaryIconExtracted = true;
+            }
+        }
+    }
 
     wchar_t const* windowsPinTargetFileName = PathFindFileNameW(windowsPinTargetPath.c_str());
     wchar_t const* windowsPinTargetExtension = PathFindExtensionW(windowsPinTargetFileName);
     std::wstring_view const label(windowsPinTargetFileName, windowsPinTargetExtension);
 
-    writePinJson(windowsPinDir, label, windowsPinTargetPath, iconExtracted);
+    writePinJson(
+        windowsPinDir, label, windowsPinTargetPath, primaryIconExtracted, extractedIconSizes);
 }
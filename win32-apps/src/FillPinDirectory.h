@@ -19,7 +19,10 @@
 #pragma once
 
 /**
- * Writes pin.json and icon.png to @p windowsPinDir.
+ * Writes pin.json and icon PNGs to @p windowsPinDir.
+ *
+ * The 256px icon goes to icon.png, while smaller ones go to icon-<size>.png files.
+ * The sizes that were actually written are listed in pin.json.
  *
  * @param windowsPinDir The Windows-style directory to write the files to.
  * @param unixOrWindowsPinTargetPath The file to pin. Usually that's going to be an executable or
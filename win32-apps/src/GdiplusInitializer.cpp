@@ -0,0 +1,42 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GdiplusInitializer.h"
+
+#include "WStringRuntimeError.h"
+
+#include <gdiplus.h>
+#include <windows.h>
+
+#include <format>
+
+GdiplusInitializer::GdiplusInitializer()
+{
+    Gdiplus::GdiplusStartupInput gdiplusStartupInput{};
+    Gdiplus::Status const status =
+        Gdiplus::GdiplusStartup(&mToken, &gdiplusStartupInput, nullptr);
+    if (status != Gdiplus::Status::Ok)
+    {
+        throw WStringRuntimeError(std::format(L"GdiplusStartup() failed ({})", (int)status));
+    }
+}
+
+GdiplusInitializer::~GdiplusInitializer()
+{
+    Gdiplus::GdiplusShutdown(mToken);
+}
@@ -0,0 +1,50 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <windows.h>
+
+/**
+ * Calls GdiplusStartup() in constructor and GdiplusShutdown() in destructor.
+ *
+ * GDI+ keeps a reference count of its users, so holding an instance of this class for
+ * a long time makes the startup / shutdown pairs elsewhere (see writeIconToPng())
+ * cheap, as GDI+ itself is only initialized once.
+ */
+class GdiplusInitializer
+{
+public:
+    GdiplusInitializer(GdiplusInitializer const&) = delete;
+    GdiplusInitializer& operator=(GdiplusInitializer const&) = delete;
+
+    /**
+     * Calls GdiplusStartup().
+     *
+     * @throw WStringRuntimeError If GdiplusStartup() fails.
+     */
+    GdiplusInitializer();
+
+    /**
+     * Calls GdiplusShutdown().
+     */
+    ~GdiplusInitializer();
+
+private:
+    ULONG_PTR mToken = 0;
+};
@@ -19,9 +19,9 @@
 #include "IconForLnkFile.h"
 
 #include "DefaultIconSelector.h"
-#include "ErrorString.h"
 #include "IconFromPortableExecutable.h"
 #include "IconFromPortableExecutableOrIcoFile.h"
+#include "ShellLink.h"
 #include "SignedIndexIconSelector.h"
 #include "WStringRuntimeError.h"
 
@@ -30,73 +30,34 @@
 #include <wrl/client.h>
 
 #include <format>
+#include <iterator> // for std::size()
 
 using Microsoft::WRL::ComPtr;
 
 OwnedIcon
 iconForLnkFile(wchar_t const* filePath, int iconResolution)
 {
-    ComPtr<IShellLinkW> shellLink;
-    HRESULT hr = CoCreateInstance(
-        CLSID_ShellLink, NULL, CLSCTX_INPROC_SERVER, IID_IShellLinkW,
-        (void**)shellLink.GetAddressOf());
-    if (FAILED(hr))
-    {
-        throw WStringRuntimeError(
-            std::format(L"Could not create IShellLinkW: {}", errorStringFromErrorCode(hr).get()));
-    }
-
-    ComPtr<IPersistFile> persistFile;
-    hr = shellLink.As(&persistFile);
-    if (FAILED(hr))
-    {
-        throw WStringRuntimeError(
-            std::format(L"Could not query IPersistFile: {}", errorStringFromErrorCode(hr).get()));
-    }
-
-    hr = persistFile->Load(filePath, STGM_READ);
-    if (FAILED(hr))
-    {
-        throw WStringRuntimeError(
-            std::format(L"Could not read .lnk: {}", errorStringFromErrorCode(hr).get()));
-    }
+    ComPtr<IShellLinkW> const shellLink = loadShellLink(filePath);
 
     // Note that MAX_PATH is too small on Windows (defined to be 260).
-    wchar_t tmpPathBuffer[4096];
-    wchar_t targetPathBuffer[4096];
+    wchar_t iconPathBuffer[4096];
 
     int iconId = 0;
-    hr = shellLink->GetIconLocation(tmpPathBuffer, sizeof(tmpPathBuffer), &iconId);
-    if (SUCCEEDED(hr) && tmpPathBuffer[0])
+    HRESULT hr = shellLink->GetIconLocation(iconPathBuffer, std::size(iconPathBuffer), &iconId);
+    if (SUCCEEDED(hr) && iconPathBuffer[0])
     {
-        if (auto r = ExpandEnvironmentStringsW(
-                tmpPathBuffer, targetPathBuffer, sizeof(targetPathBuffer));
-            r > 0 && r <= sizeof(targetPathBuffer))
+        if (auto iconPath = expandEnvironmentStrings(iconPathBuffer))
         {
             SignedIndexIconSelector iconSelector(iconId);
             return iconFromPortableExecutableOrIcoFile(
-                targetPathBuffer, iconSelector, iconResolution);
-        }
-    }
-
-    hr = shellLink->GetPath(tmpPathBuffer, sizeof(tmpPathBuffer), nullptr, SLGP_RAWPATH);
-    if (SUCCEEDED(hr) && tmpPathBuffer[0])
-    {
-        if (auto r = ExpandEnvironmentStringsW(
-                tmpPathBuffer, targetPathBuffer, sizeof(targetPathBuffer));
-            r > 0 && r <= sizeof(targetPathBuffer))
-        {
-            DefaultIconSelector iconSelector;
-            return iconFromPortableExecutable(targetPathBuffer, iconSelector, iconResolution);
+                iconPath->c_str(), iconSelector, iconResolution);
         }
     }
 
-    LPITEMIDLIST idList = nullptr;
-    hr = shellLink->GetIDList(&idList);
-    if (SUCCEEDED(hr) && idList && SHGetPathFromIDListW(idList, targetPathBuffer))
+    if (auto targetPath = shellLinkTargetPath(shellLink.Get()))
     {
         DefaultIconSelector iconSelector;
-        return iconFromPortableExecutable(targetPathBuffer, iconSelector, iconResolution);
+        return iconFromPortableExecutable(targetPath->c_str(), iconSelector, iconResolution);
     }
 
     throw WStringRuntimeError(
@@ -0,0 +1,103 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "IdleTimeoutWatchdog.h"
+
+#include "ErrorString.h"
+#include "WStringRuntimeError.h"
+
+#include <windows.h>
+
+#include <format>
+#include <utility>
+
+IdleTimeoutWatchdog::IdleTimeoutWatchdog(DWORD timeoutMs, std::function<void()> onTimeout)
+    : mTimeoutMs(timeoutMs)
+    , mOnTimeout(std::move(onTimeout))
+{
+    // An auto-reset event, so that every state change wakes the thread exactly once.
+    mActivityEvent.reset(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+    if (!mActivityEvent)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateEvent() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    mStopEvent.reset(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+    if (!mStopEvent)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateEvent() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    mThread.reset(CreateThread(nullptr, 0, &IdleTimeoutWatchdog::threadProc, this, 0, nullptr));
+    if (!mThread)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateThread() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+}
+
+IdleTimeoutWatchdog::~IdleTimeoutWatchdog()
+{
+    SetEvent(mStopEvent.get());
+    WaitForSingleObject(mThread.get(), INFINITE);
+}
+
+void
+IdleTimeoutWatchdog::setBusy(bool busy)
+{
+    mBusy = busy;
+    SetEvent(mActivityEvent.get());
+}
+
+DWORD WINAPI
+IdleTimeoutWatchdog::threadProc(LPVOID param)
+{
+    static_cast<IdleTimeoutWatchdog*>(param)->run();
+    return 0;
+}
+
+void
+IdleTimeoutWatchdog::run()
+{
+    HANDLE const handles[] = {mStopEvent.get(), mActivityEvent.get()};
+
+    for (;;)
+    {
+        DWORD const r = WaitForMultipleObjects(2, handles, FALSE, mBusy ? INFINITE : mTimeoutMs);
+
+        if (r == WAIT_OBJECT_0 + 1 || (r == WAIT_TIMEOUT && mBusy))
+        {
+            // Got busy or became idle again. Either way, the timeout starts over.
+            // The same goes for the timeout racing with getting busy.
+            continue;
+        }
+
+        if (r == WAIT_TIMEOUT)
+        {
+            mOnTimeout();
+        }
+
+        // Either the timeout has fired, we were told to stop or waiting failed.
+        return;
+    }
+}
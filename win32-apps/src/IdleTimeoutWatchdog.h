@@ -0,0 +1,66 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OwnedTypes.h"
+
+#include <windows.h>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * Calls a callback on a background thread once nothing has happened for a given time.
+ *
+ * Activity is reported by marking the owner busy or idle. The timeout only runs while the
+ * owner is idle and is restarted every time it becomes idle again.
+ */
+class IdleTimeoutWatchdog
+{
+public:
+    IdleTimeoutWatchdog(IdleTimeoutWatchdog const&) = delete;
+    IdleTimeoutWatchdog& operator=(IdleTimeoutWatchdog const&) = delete;
+
+    /**
+     * Starts the timeout. The owner is initially idle.
+     *
+     * @param onTimeout Called on the background thread, at most once.
+     * @throw WStringRuntimeError If the background thread can't be started.
+     */
+    IdleTimeoutWatchdog(DWORD timeoutMs, std::function<void()> onTimeout);
+
+    /**
+     * Stops the watchdog. The callback is guaranteed not to be running once this returns.
+     */
+    ~IdleTimeoutWatchdog();
+
+    void setBusy(bool busy);
+
+private:
+    static DWORD WINAPI threadProc(LPVOID param);
+
+    void run();
+
+    DWORD mTimeoutMs;
+    std::function<void()> mOnTimeout;
+    std::atomic<bool> mBusy = false;
+    OwnedHandle mActivityEvent = makeOwnedHandle();
+    OwnedHandle mStopEvent = makeOwnedHandle();
+    OwnedHandle mThread = makeOwnedHandle();
+};
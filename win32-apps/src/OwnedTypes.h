@@ -61,3 +61,29 @@ makeOwnedIcon(HICON hIcon = nullptr)
 {
     return OwnedIcon(hIcon, ownedIconDeleter);
 }
+
+using OwnedHandle = std::unique_ptr<std::remove_pointer_t<HANDLE>, void (*)(HANDLE)>;
+
+static inline auto const ownedHandleDeleter = [](HANDLE handle)
+{
+    CloseHandle(handle);
+};
+
+inline OwnedHandle
+makeOwnedHandle(HANDLE handle = nullptr)
+{
+    return OwnedHandle(handle, ownedHandleDeleter);
+}
+
+using OwnedChangeNotification = std::unique_ptr<std::remove_pointer_t<HANDLE>, void (*)(HANDLE)>;
+
+static inline auto const ownedChangeNotificationDeleter = [](HANDLE handle)
+{
+    FindCloseChangeNotification(handle);
+};
+
+inline OwnedChangeNotification
+makeOwnedChangeNotification(HANDLE handle = nullptr)
+{
+    return OwnedChangeNotification(handle, ownedChangeNotificationDeleter);
+}
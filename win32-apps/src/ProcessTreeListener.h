@@ -0,0 +1,61 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <windows.h>
+
+/**
+ * Receives notifications about the processes in the job object runProcess() puts
+ * the launched process into. Child processes inherit the job, so this covers the whole
+ * process tree, including processes that outlive their parents.
+ *
+ * All methods are called on the thread that called runProcess().
+ */
+class ProcessTreeListener
+{
+public:
+    virtual ~ProcessTreeListener() = default;
+
+    /**
+     * Called once the initial process has been put into the job, right before it's resumed.
+     * The job handle remains valid until runProcess() returns and can be used to terminate
+     * the whole process tree with TerminateJobObject(), including from another thread.
+     * Not called if the process couldn't be put into a job.
+     */
+    virtual void onProcessTreeStarted(HANDLE job) = 0;
+
+    /**
+     * Called when a process is added to the job, including the initial one.
+     */
+    virtual void onProcessStarted(DWORD processId) = 0;
+
+    /**
+     * Called when a process in the job exits.
+     *
+     * @param abnormally True if the process was terminated by an unhandled exception.
+     */
+    virtual void onProcessExited(DWORD processId, bool abnormally) = 0;
+
+    /**
+     * Called once the last process in the job has exited or, if tracking the process tree
+     * failed, once the initial process has exited. The job handle remains valid until
+     * runProcess() returns and can be used to query accounting information.
+     */
+    virtual void onProcessTreeExited(HANDLE job) = 0;
+};
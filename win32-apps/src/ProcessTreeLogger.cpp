@@ -0,0 +1,91 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ProcessTreeLogger.h"
+
+#include <format>
+#include <iostream>
+#include <utility>
+
+void
+ProcessTreeLogger::onProcessTreeStarted(HANDLE /*job*/)
+{
+    // Nothing to log here, as onProcessStarted() will report the initial process.
+}
+
+void
+ProcessTreeLogger::onProcessStarted(DWORD processId)
+{
+    TrackedProcess process;
+
+    // We keep the handle open, so that we could retrieve the exit code once the process exits.
+    process.handle.reset(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId));
+
+    if (process.handle)
+    {
+        wchar_t imagePath[MAX_PATH];
+        DWORD imagePathSize = MAX_PATH;
+        if (QueryFullProcessImageNameW(process.handle.get(), 0, imagePath, &imagePathSize))
+        {
+            process.imagePath.assign(imagePath, imagePathSize);
+        }
+    }
+
+    std::wcout << std::format(L"Process {} started: {}", processId, process.imagePath)
+               << std::endl;
+
+    mRunningProcesses.insert_or_assign(processId, std::move(process));
+}
+
+void
+ProcessTreeLogger::onProcessExited(DWORD processId, bool abnormally)
+{
+    auto const it = mRunningProcesses.find(processId);
+    if (it == mRunningProcesses.end())
+    {
+        std::wcout << std::format(L"Process {} exited", processId) << std::endl;
+        return;
+    }
+
+    TrackedProcess const& process = it->second;
+
+    DWORD exitCode = 0;
+    if (process.handle && GetExitCodeProcess(process.handle.get(), &exitCode))
+    {
+        std::wcout << std::format(
+                          L"Process {} {} with code {:#x}: {}", processId,
+                          (abnormally ? L"crashed" : L"exited"), exitCode, process.imagePath)
+                   << std::endl;
+    }
+    else
+    {
+        std::wcout << std::format(
+                          L"Process {} {}: {}", processId, (abnormally ? L"crashed" : L"exited"),
+                          process.imagePath)
+                   << std::endl;
+    }
+
+    mRunningProcesses.erase(it);
+}
+
+void
+ProcessTreeLogger::onProcessTreeExited(HANDLE /*job*/)
+{
+    std::wcout << L"All processes in the process tree have exited" << std::endl;
+    mRunningProcesses.clear();
+}
@@ -0,0 +1,55 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OwnedTypes.h"
+#include "ProcessTreeListener.h"
+
+#include <windows.h>
+
+#include <map>
+#include <string>
+
+/**
+ * A ProcessTreeListener that prints a line to stdout for every process starting
+ * or exiting in the process tree.
+ */
+class ProcessTreeLogger : public ProcessTreeListener
+{
+public:
+    void onProcessTreeStarted(HANDLE job) override;
+
+    void onProcessStarted(DWORD processId) override;
+
+    void onProcessExited(DWORD processId, bool abnormally) override;
+
+    void onProcessTreeExited(HANDLE job) override;
+
+private:
+    struct TrackedProcess
+    {
+        /** May be null if we weren't allowed to open the process. */
+        OwnedHandle handle = makeOwnedHandle();
+
+        std::wstring imagePath;
+    };
+
+    /** Processes that have started but haven't exited yet, indexed by process id. */
+    std::map<DWORD, TrackedProcess> mRunningProcesses;
+};
@@ -0,0 +1,120 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "QueryRegistryValue.h"
+
+#include "CaseInsensitiveCompare.h"
+#include "ErrorString.h"
+#include "WStringRuntimeError.h"
+
+#include <windows.h>
+
+#include <cstring>
+#include <format>
+#include <vector>
+
+namespace
+{
+
+struct RootKey
+{
+    wchar_t const* name;
+    HKEY hKey;
+};
+
+RootKey const rootKeys[] = {
+    {L"HKEY_CLASSES_ROOT", HKEY_CLASSES_ROOT},
+    {L"HKCR", HKEY_CLASSES_ROOT},
+    {L"HKEY_CURRENT_USER", HKEY_CURRENT_USER},
+    {L"HKCU", HKEY_CURRENT_USER},
+    {L"HKEY_LOCAL_MACHINE", HKEY_LOCAL_MACHINE},
+    {L"HKLM", HKEY_LOCAL_MACHINE},
+    {L"HKEY_USERS", HKEY_USERS},
+    {L"HKU", HKEY_USERS},
+};
+
+void
+throwRegistryError(std::wstring_view keyPath, std::wstring_view valueName, LSTATUS status)
+{
+    throw WStringRuntimeError(
+        std::format(
+            L"Failed to read registry value \"{}\" of {}: {}", valueName, keyPath,
+            errorStringFromErrorCode(status).get()));
+}
+
+} // namespace
+
+std::wstring
+queryRegistryValue(std::wstring_view keyPath, std::wstring_view valueName)
+{
+    std::wstring const rootName(keyPath.substr(0, keyPath.find(L'\\')));
+    std::wstring const subKey(
+        rootName.size() < keyPath.size() ? keyPath.substr(rootName.size() + 1) : std::wstring_view());
+
+    HKEY rootKey = nullptr;
+    for (RootKey const& candidate : rootKeys)
+    {
+        if (caseInsensitiveCompare(rootName.c_str(), candidate.name) == 0)
+        {
+            rootKey = candidate.hKey;
+            break;
+        }
+    }
+
+    if (!rootKey)
+    {
+        throw WStringRuntimeError(std::format(L"Unsupported registry root key: {}", rootName));
+    }
+
+    std::wstring const value(valueName);
+    wchar_t const* const valuePtr = value.empty() ? nullptr : value.c_str();
+    DWORD const flags = RRF_RT_REG_SZ | RRF_RT_REG_EXPAND_SZ | RRF_RT_REG_DWORD | RRF_NOEXPAND;
+
+    DWORD type = 0;
+    DWORD size = 0;
+    LSTATUS status =
+        RegGetValueW(rootKey, subKey.c_str(), valuePtr, flags, &type, nullptr, &size);
+    if (status != ERROR_SUCCESS)
+    {
+        throwRegistryError(keyPath, valueName, status);
+    }
+
+    // The value may grow between the two calls, in which case we try again.
+    std::vector<BYTE> data;
+    do
+    {
+        data.resize(size);
+        status =
+            RegGetValueW(rootKey, subKey.c_str(), valuePtr, flags, &type, data.data(), &size);
+    } while (status == ERROR_MORE_DATA);
+
+    if (status != ERROR_SUCCESS)
+    {
+        throwRegistryError(keyPath, valueName, status);
+    }
+
+    if (type == REG_DWORD)
+    {
+        DWORD dword = 0;
+        memcpy(&dword, data.data(), sizeof(dword));
+        return std::to_wstring(dword);
+    }
+
+    // RegGetValueW() guarantees the string is null-terminated.
+    return std::wstring(reinterpret_cast<wchar_t const*>(data.data()));
+}
@@ -0,0 +1,36 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/**
+ * Reads a registry value and returns it as a string.
+ *
+ * @param keyPath The full path to the key, starting with one of HKEY_CLASSES_ROOT,
+ *        HKEY_CURRENT_USER, HKEY_LOCAL_MACHINE or HKEY_USERS, or their HKCR, HKCU, HKLM and
+ *        HKU abbreviations, like "HKCU\Software\Wine\Drives".
+ * @param valueName The name of the value. An empty string stands for the default value.
+ * @return The value for REG_SZ and REG_EXPAND_SZ (without expanding environment variables)
+ *         or the decimal representation of a REG_DWORD.
+ * @throw WStringRuntimeError If the value doesn't exist, is of a different type or can't
+ *        be read for another reason.
+ */
+std::wstring queryRegistryValue(std::wstring_view keyPath, std::wstring_view valueName);
@@ -21,6 +21,8 @@
 #include "CaseInsensitiveCompare.h"
 #include "CommandLineBuilder.h"
 #include "ErrorString.h"
+#include "ProcessTreeListener.h"
+#include "ScopeCleanup.h"
 
 #include <windows.h>
 
@@ -28,11 +30,71 @@
 #include <cstring>
 #include <string>
 
+namespace
+{
+
 /**
- * Runs the executable at argv[0], waits for it to exit and returns its exit code.
+ * Waits for the job to run out of active processes, forwarding the job's notifications
+ * to @p listener.
+ *
+ * @return false if waiting on the completion port failed.
  */
+bool
+waitForProcessTreeToExit(HANDLE completionPort, HANDLE hJob, ProcessTreeListener* listener)
+{
+    for (;;)
+    {
+        DWORD message = 0;
+        ULONG_PTR completionKey = 0;
+        LPOVERLAPPED overlapped = nullptr;
+
+        if (!GetQueuedCompletionStatus(
+                completionPort, &message, &completionKey, &overlapped, INFINITE))
+        {
+            auto const errorCode = GetLastError();
+            wprintf(
+                L"GetQueuedCompletionStatus failed: %ls\n",
+                errorStringFromErrorCode(errorCode).get());
+            return false;
+        }
+
+        if (completionKey != reinterpret_cast<ULONG_PTR>(hJob))
+        {
+            continue;
+        }
+
+        // For per-process messages, the process id is passed in place of the OVERLAPPED pointer.
+        auto const processId = static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(overlapped));
+
+        switch (message)
+        {
+        case JOB_OBJECT_MSG_NEW_PROCESS:
+            if (listener)
+            {
+                listener->onProcessStarted(processId);
+            }
+            break;
+        case JOB_OBJECT_MSG_EXIT_PROCESS:
+        case JOB_OBJECT_MSG_ABNORMAL_EXIT_PROCESS:
+            if (listener)
+            {
+                listener->onProcessExited(
+                    processId, message == JOB_OBJECT_MSG_ABNORMAL_EXIT_PROCESS);
+            }
+            break;
+        case JOB_OBJECT_MSG_ACTIVE_PROCESS_ZERO:
+            return true;
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace
+
 int
-runProcess(wchar_t const* windowsExecutable, wchar_t* args[], int numArgs)
+runProcess(
+    wchar_t const* windowsExecutable, wchar_t* args[], int numArgs, ProcessTreeListener* listener)
 {
     CommandLineBuilder cmdLineBuilder;
     cmdLineBuilder.addArg(windowsExecutable);
@@ -52,7 +114,9 @@ runProcess(wchar_t const* windowsExecutable, wchar_t* args[], int numArgs)
     si.hStdError = GetStdHandle(STD_ERROR_HANDLE);   // Connect to our stderr.
     ZeroMemory(&pi, sizeof(pi));
 
-    DWORD flags = 0;
+    // The process is started suspended, so that it can't spawn any children before
+    // it's put into the job.
+    DWORD flags = CREATE_SUSPENDED;
 
     if (caseInsensitiveCompare(windowsExecutable, L"start") == 0 ||
         caseInsensitiveCompare(windowsExecutable, L"start.exe") == 0)
@@ -64,6 +128,51 @@ runProcess(wchar_t const* windowsExecutable, wchar_t* args[], int numArgs)
         flags |= CREATE_NO_WINDOW;
     }
 
+    // We create a job object in order to automatically kill our child processes in case
+    // the parent (us) terminates, and to track the whole process tree.
+    HANDLE hJob = CreateJobObjectW(nullptr, nullptr);
+
+    // Configure the job object to kill all the processes associated with it when the
+    // job closes. The job is closed when the last handle to that job is closed. We never
+    // call CloseHandle(hJob), but the handle will be closed automatically when our process
+    // terminates, causing the child processes to be terminated as well.
+    //
+    // Note that we don't allow silent breakaway, as we want the children of our child
+    // to stay in the job. Processes that explicitly ask to break away are still allowed to.
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limitInfo;
+    memset(&limitInfo, 0, sizeof(limitInfo));
+    limitInfo.BasicLimitInformation.LimitFlags =
+        JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE | JOB_OBJECT_LIMIT_BREAKAWAY_OK;
+    SetInformationJobObject(hJob, JobObjectExtendedLimitInformation, &limitInfo, sizeof(limitInfo));
+
+    // The job posts notifications about its processes to this port.
+    HANDLE completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    ScopeCleanup const completionPortCleanup([completionPort] {
+        if (completionPort)
+        {
+            CloseHandle(completionPort);
+        }
+    });
+
+    bool trackingProcessTree = false;
+
+    if (hJob && completionPort)
+    {
+        JOBOBJECT_ASSOCIATE_COMPLETION_PORT portInfo;
+        portInfo.CompletionKey = hJob;
+        portInfo.CompletionPort = completionPort;
+        trackingProcessTree = SetInformationJobObject(
+            hJob, JobObjectAssociateCompletionPortInformation, &portInfo, sizeof(portInfo));
+    }
+
+    if (!trackingProcessTree)
+    {
+        auto const errorCode = GetLastError();
+        wprintf(
+            L"Failed to set up process tree tracking: %ls\n",
+            errorStringFromErrorCode(errorCode).get());
+    }
+
     // Create the process.
     if (!CreateProcessW(
             nullptr, commandLine.data(), nullptr, nullptr, TRUE, flags, nullptr, nullptr, &si, &pi))
@@ -73,25 +182,32 @@ runProcess(wchar_t const* windowsExecutable, wchar_t* args[], int numArgs)
         return 1;
     }
 
-    // We create a job object in order to automatically kill our child process in case
-    // the parent (us) terminates.
-    HANDLE hJob = CreateJobObjectW(nullptr, nullptr);
+    // Assign our child process to the job before letting it run.
+    if (!AssignProcessToJobObject(hJob, pi.hProcess))
+    {
+        auto const errorCode = GetLastError();
+        wprintf(
+            L"AssignProcessToJobObject failed: %ls\n", errorStringFromErrorCode(errorCode).get());
+        trackingProcessTree = false;
+    }
+    else if (listener)
+    {
+        listener->onProcessTreeStarted(hJob);
+    }
 
-    // Configure the job object to kill all the processes associated with it when the
-    // job closes. The job is closed when the last handle to that job is closed. We never
-    // call CloseHandle(hJob), but the handle will be closed automatically when our process
-    // terminates, causing the child process to be terminated as well.
-    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limitInfo;
-    memset(&limitInfo, 0, sizeof(limitInfo));
-    limitInfo.BasicLimitInformation.LimitFlags =
-        JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE | JOB_OBJECT_LIMIT_SILENT_BREAKAWAY_OK;
-    SetInformationJobObject(hJob, JobObjectExtendedLimitInformation, &limitInfo, sizeof(limitInfo));
+    ResumeThread(pi.hThread);
 
-    // Finally, we assign our child process to the job.
-    AssignProcessToJobObject(hJob, pi.hProcess);
+    // Wait until the whole process tree exits, falling back to waiting for
+    // the child process alone.
+    if (!trackingProcessTree || !waitForProcessTreeToExit(completionPort, hJob, listener))
+    {
+        WaitForSingleObject(pi.hProcess, INFINITE);
+    }
 
-    // Wait until child process exits.
-    WaitForSingleObject(pi.hProcess, INFINITE);
+    if (listener && hJob)
+    {
+        listener->onProcessTreeExited(hJob);
+    }
 
     DWORD exitCode;
     if (!GetExitCodeProcess(pi.hProcess, &exitCode))
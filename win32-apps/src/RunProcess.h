@@ -18,9 +18,20 @@
 
 #pragma once
 
+class ProcessTreeListener;
+
 /**
- * Runs the given executable, passing it the given args and waits for it to exit.
+ * Runs the given executable, passing it the given args and waits for it and all of its
+ * descendants to exit.
+ *
+ * Installers often spawn msiexec or an unpacked copy of themselves and exit right away,
+ * so waiting for the initial process alone is not enough to tell when the installation
+ * is complete.
+ *
+ * @param listener If not null, receives notifications about processes in the process tree.
  *
  * Returns the exit code of the executable.
  */
-int runProcess(wchar_t const* windowsExecutable, wchar_t* args[], int numArgs);
+int runProcess(
+    wchar_t const* windowsExecutable, wchar_t* args[], int numArgs,
+    ProcessTreeListener* listener = nullptr);
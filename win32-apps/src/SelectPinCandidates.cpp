@@ -0,0 +1,95 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SelectPinCandidates.h"
+
+#include "CaseInsensitiveCompare.h"
+#include "ShellLink.h"
+#include "WStringException.h"
+
+#include <shlwapi.h>
+#include <windows.h>
+
+#include <exception>
+#include <format>
+#include <iostream>
+#include <set>
+
+namespace
+{
+
+std::wstring
+toLower(std::wstring str)
+{
+    CharLowerBuffW(str.data(), (DWORD)str.size());
+    return str;
+}
+
+/**
+ * Returns what identifies the item a file added to the Desktop or the Start Menu opens.
+ * For shortcuts, that's their target and arguments, so that two shortcuts to the same thing
+ * get the same key.
+ */
+std::wstring
+dedupeKeyFor(std::wstring const& file)
+{
+    if (caseInsensitiveCompare(PathFindExtensionW(file.c_str()), L".lnk") == 0)
+    {
+        try
+        {
+            auto const shellLink = loadShellLink(file.c_str());
+            if (auto const targetPath = shellLinkTargetPath(shellLink.Get()))
+            {
+                return toLower(*targetPath) + L'\n' + shellLinkArguments(shellLink.Get());
+            }
+        }
+        catch (WStringException const& e)
+        {
+            std::wcout << e.what() << std::endl;
+        }
+        catch (std::exception const& e)
+        {
+            std::cout << e.what() << std::endl;
+        }
+    }
+
+    // Shortcuts we couldn't resolve are only deduped by their own path.
+    return toLower(file);
+}
+
+} // namespace
+
+std::vector<std::wstring>
+selectPinCandidates(std::vector<std::wstring> const& addedFiles)
+{
+    std::vector<std::wstring> candidates;
+    std::set<std::wstring> seenKeys;
+
+    for (auto const& file : addedFiles)
+    {
+        if (!seenKeys.insert(dedupeKeyFor(file)).second)
+        {
+            std::wcout << std::format(L"Skipping {} as a duplicate", file) << std::endl;
+            continue;
+        }
+
+        candidates.push_back(file);
+    }
+
+    return candidates;
+}
@@ -0,0 +1,33 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Removes duplicates from the files an installer has added to the Desktop and the Start Menu.
+ *
+ * A shortcut pointing to the same target with the same arguments as an earlier one is dropped,
+ * which is typically the case for a Desktop shortcut and its Start Menu counterpart. Everything
+ * else is kept.
+ *
+ * Shortcuts are resolved through COM, so COM has to be initialized on the calling thread.
+ */
+std::vector<std::wstring> selectPinCandidates(std::vector<std::wstring> const& addedFiles);
@@ -0,0 +1,117 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ShellLink.h"
+
+#include "ErrorString.h"
+#include "WStringRuntimeError.h"
+
+#include <format>
+#include <iterator> // for std::size()
+
+using Microsoft::WRL::ComPtr;
+
+ComPtr<IShellLinkW>
+loadShellLink(wchar_t const* filePath)
+{
+    ComPtr<IShellLinkW> shellLink;
+    HRESULT hr = CoCreateInstance(
+        CLSID_ShellLink, NULL, CLSCTX_INPROC_SERVER, IID_IShellLinkW,
+        (void**)shellLink.GetAddressOf());
+    if (FAILED(hr))
+    {
+        throw WStringRuntimeError(
+            std::format(L"Could not create IShellLinkW: {}", errorStringFromErrorCode(hr).get()));
+    }
+
+    ComPtr<IPersistFile> persistFile;
+    hr = shellLink.As(&persistFile);
+    if (FAILED(hr))
+    {
+        throw WStringRuntimeError(
+            std::format(L"Could not query IPersistFile: {}", errorStringFromErrorCode(hr).get()));
+    }
+
+    hr = persistFile->Load(filePath, STGM_READ);
+    if (FAILED(hr))
+    {
+        throw WStringRuntimeError(
+            std::format(L"Could not read .lnk: {}", errorStringFromErrorCode(hr).get()));
+    }
+
+    return shellLink;
+}
+
+std::optional<std::wstring>
+expandEnvironmentStrings(wchar_t const* str)
+{
+    // Note that MAX_PATH is too small on Windows (defined to be 260).
+    wchar_t expanded[4096];
+
+    DWORD const r = ExpandEnvironmentStringsW(str, expanded, std::size(expanded));
+    if (r == 0 || r > std::size(expanded))
+    {
+        return std::nullopt;
+    }
+
+    return std::wstring(expanded);
+}
+
+std::optional<std::wstring>
+shellLinkTargetPath(IShellLinkW* shellLink)
+{
+    // Note that MAX_PATH is too small on Windows (defined to be 260).
+    wchar_t pathBuffer[4096];
+
+    HRESULT hr = shellLink->GetPath(pathBuffer, std::size(pathBuffer), nullptr, SLGP_RAWPATH);
+    if (SUCCEEDED(hr) && pathBuffer[0])
+    {
+        if (auto expanded = expandEnvironmentStrings(pathBuffer))
+        {
+            return expanded;
+        }
+    }
+
+    LPITEMIDLIST idList = nullptr;
+    hr = shellLink->GetIDList(&idList);
+    if (SUCCEEDED(hr) && idList)
+    {
+        bool const gotPath = SHGetPathFromIDListW(idList, pathBuffer);
+        ILFree(idList);
+
+        if (gotPath)
+        {
+            return std::wstring(pathBuffer);
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::wstring
+shellLinkArguments(IShellLinkW* shellLink)
+{
+    wchar_t argsBuffer[4096];
+
+    if (FAILED(shellLink->GetArguments(argsBuffer, std::size(argsBuffer))))
+    {
+        return std::wstring();
+    }
+
+    return std::wstring(argsBuffer);
+}
@@ -0,0 +1,54 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <shlobj.h>
+#include <windows.h>
+#include <wrl/client.h>
+
+#include <optional>
+#include <string>
+
+/**
+ * Loads a .lnk file into a shell link object.
+ *
+ * @param filePath A Windows (not Unix) file path to the .lnk file.
+ *
+ * @throw WStringRuntimeError If anything goes wrong.
+ */
+Microsoft::WRL::ComPtr<IShellLinkW> loadShellLink(wchar_t const* filePath);
+
+/**
+ * Returns the file the shell link points to, with environment variables expanded.
+ *
+ * Returns std::nullopt if the link doesn't point to a filesystem object.
+ */
+std::optional<std::wstring> shellLinkTargetPath(IShellLinkW* shellLink);
+
+/**
+ * Returns the command line arguments stored in the shell link, which may be empty.
+ */
+std::wstring shellLinkArguments(IShellLinkW* shellLink);
+
+/**
+ * Expands environment variables in @p str.
+ *
+ * Returns std::nullopt if the expansion fails.
+ */
+std::optional<std::wstring> expandEnvironmentStrings(wchar_t const* str);
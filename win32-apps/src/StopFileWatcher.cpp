@@ -0,0 +1,110 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "StopFileWatcher.h"
+
+#include "ErrorString.h"
+#include "WStringRuntimeError.h"
+
+#include <windows.h>
+
+#include <format>
+#include <utility>
+
+StopFileWatcher::StopFileWatcher(
+    std::wstring_view windowsDir, std::wstring_view fileName,
+    std::function<void()> onStopRequested)
+    : mStopFilePath(std::format(L"{}\\{}", windowsDir, fileName))
+    , mOnStopRequested(std::move(onStopRequested))
+{
+    std::wstring const dir(windowsDir);
+
+    // Unlike ReadDirectoryChangesW(), this doesn't tell which file has changed, but we only
+    // care about one file, so we just check for its existence on every notification.
+    HANDLE const changeNotification =
+        FindFirstChangeNotificationW(dir.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (changeNotification == INVALID_HANDLE_VALUE)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"Failed to watch directory {}: {}", dir,
+                errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    mChangeNotification.reset(changeNotification);
+
+    mStopEvent.reset(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+    if (!mStopEvent)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateEvent() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    mThread.reset(CreateThread(nullptr, 0, &StopFileWatcher::threadProc, this, 0, nullptr));
+    if (!mThread)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"CreateThread() failed: {}", errorStringFromErrorCode(GetLastError()).get()));
+    }
+}
+
+StopFileWatcher::~StopFileWatcher()
+{
+    SetEvent(mStopEvent.get());
+    WaitForSingleObject(mThread.get(), INFINITE);
+}
+
+DWORD WINAPI
+StopFileWatcher::threadProc(LPVOID param)
+{
+    static_cast<StopFileWatcher*>(param)->run();
+    return 0;
+}
+
+void
+StopFileWatcher::run()
+{
+    HANDLE const handles[] = {mStopEvent.get(), mChangeNotification.get()};
+
+    // The file may have been created before we started watching.
+    while (!stopFileExists())
+    {
+        DWORD const r = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+
+        if (r != WAIT_OBJECT_0 + 1)
+        {
+            // Either we were told to stop or waiting failed.
+            return;
+        }
+
+        if (!FindNextChangeNotification(mChangeNotification.get()))
+        {
+            return;
+        }
+    }
+
+    mOnStopRequested();
+}
+
+bool
+StopFileWatcher::stopFileExists() const
+{
+    return GetFileAttributesW(mStopFilePath.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
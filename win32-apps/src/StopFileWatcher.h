@@ -0,0 +1,68 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OwnedTypes.h"
+
+#include <windows.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * Watches a directory for a file with a particular name to appear, using
+ * FindFirstChangeNotificationW() on a background thread. This lets a Linux process ask
+ * a Windows one to do something by merely creating a file, without starting another
+ * Wine process.
+ */
+class StopFileWatcher
+{
+public:
+    StopFileWatcher(StopFileWatcher const&) = delete;
+    StopFileWatcher& operator=(StopFileWatcher const&) = delete;
+
+    /**
+     * Starts watching. If the file already exists, @p onStopRequested is called right away.
+     *
+     * @param onStopRequested Called on the background thread, at most once.
+     * @throw WStringRuntimeError If the directory can't be watched.
+     */
+    StopFileWatcher(
+        std::wstring_view windowsDir, std::wstring_view fileName,
+        std::function<void()> onStopRequested);
+
+    /**
+     * Stops watching. The callback is guaranteed not to be running once this returns.
+     */
+    ~StopFileWatcher();
+
+private:
+    static DWORD WINAPI threadProc(LPVOID param);
+
+    void run();
+
+    bool stopFileExists() const;
+
+    std::wstring mStopFilePath;
+    std::function<void()> mOnStopRequested;
+    OwnedChangeNotification mChangeNotification = makeOwnedChangeNotification();
+    OwnedHandle mStopEvent = makeOwnedHandle();
+    OwnedHandle mThread = makeOwnedHandle();
+};
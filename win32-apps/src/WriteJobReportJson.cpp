@@ -0,0 +1,114 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WriteJobReportJson.h"
+
+#include "ErrorString.h"
+#include "WStringRuntimeError.h"
+
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+/**
+ * Converts a LARGE_INTEGER holding a duration in 100-nanosecond units to milliseconds.
+ */
+int64_t
+toMilliseconds(LARGE_INTEGER duration)
+{
+    return duration.QuadPart / 10'000;
+}
+
+} // namespace
+
+void
+writeJobReportJson(std::wstring_view directory, HANDLE job)
+{
+    // This is to be kept in sync with special_executable_bloc.dart
+    static std::wstring_view const kJsonFileName = L"job-report.json";
+
+    JOBOBJECT_BASIC_AND_IO_ACCOUNTING_INFORMATION accountingInfo;
+    ZeroMemory(&accountingInfo, sizeof(accountingInfo));
+
+    if (!QueryInformationJobObject(
+            job, JobObjectBasicAndIoAccountingInformation, &accountingInfo,
+            sizeof(accountingInfo), nullptr))
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"QueryInformationJobObject() failed to query accounting information: {}",
+                errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limitInfo;
+    ZeroMemory(&limitInfo, sizeof(limitInfo));
+
+    if (!QueryInformationJobObject(
+            job, JobObjectExtendedLimitInformation, &limitInfo, sizeof(limitInfo), nullptr))
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"QueryInformationJobObject() failed to query memory usage: {}",
+                errorStringFromErrorCode(GetLastError()).get()));
+    }
+
+    auto const& basicInfo = accountingInfo.BasicInfo;
+    auto const& ioInfo = accountingInfo.IoInfo;
+
+    std::wstring const filePath = std::format(L"{}\\{}", directory, kJsonFileName);
+
+    std::ofstream strm(filePath.c_str(), std::ios::binary);
+
+    if (!strm)
+    {
+        throw WStringRuntimeError(std::format(L"Failed to open file {} for writing", filePath));
+    }
+
+    strm << std::format(
+        "{{\n"
+        "  \"totalUserTimeMs\": {},\n"
+        "  \"totalKernelTimeMs\": {},\n"
+        "  \"totalProcesses\": {},\n"
+        "  \"totalTerminatedProcesses\": {},\n"
+        "  \"totalPageFaults\": {},\n"
+        "  \"readOperations\": {},\n"
+        "  \"writeOperations\": {},\n"
+        "  \"otherOperations\": {},\n"
+        "  \"readBytes\": {},\n"
+        "  \"writeBytes\": {},\n"
+        "  \"otherBytes\": {},\n"
+        "  \"peakProcessMemoryBytes\": {},\n"
+        "  \"peakJobMemoryBytes\": {}\n"
+        "}}",
+        toMilliseconds(basicInfo.TotalUserTime), toMilliseconds(basicInfo.TotalKernelTime),
+        basicInfo.TotalProcesses, basicInfo.TotalTerminatedProcesses,
+        basicInfo.TotalPageFaultCount, ioInfo.ReadOperationCount, ioInfo.WriteOperationCount,
+        ioInfo.OtherOperationCount, ioInfo.ReadTransferCount, ioInfo.WriteTransferCount,
+        ioInfo.OtherTransferCount, limitInfo.PeakProcessMemoryUsed, limitInfo.PeakJobMemoryUsed);
+
+    strm.flush();
+
+    if (!strm)
+    {
+        throw WStringRuntimeError(std::format(L"I/O error writing to {}", filePath));
+    }
+}
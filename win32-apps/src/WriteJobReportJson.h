@@ -0,0 +1,34 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <windows.h>
+
+#include <string_view>
+
+/**
+ * Queries the accounting information of a job object and writes it as job-report.json
+ * to the specified directory.
+ *
+ * The report covers the CPU time, I/O and peak memory usage of all the processes that
+ * were ever part of the job, as well as the number of those processes.
+ *
+ * @throw WStringRuntimeError If anything goes wrong.
+ */
+void writeJobReportJson(std::wstring_view directory, HANDLE job);
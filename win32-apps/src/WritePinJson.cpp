@@ -23,16 +23,18 @@
 
 #include <format>
 #include <fstream>
+#include <string>
 
 void
 writePinJson(
     std::wstring_view pinDirectory, std::wstring_view label,
-    std::wstring_view windowsPathToExecutable, bool hasIcon)
+    std::wstring_view windowsPathToExecutable, bool hasIcon, std::span<int const> iconSizes)
 {
     // These constants are to be kept in sync with those in pinned_executable.dart
     static std::string_view const kLabelKey = "label";
     static std::string_view const kWindowsPathToExecutableKey = "windowsPathToExecutable";
     static std::string_view const kHasIconKey = "hasIcon";
+    static std::string_view const kIconSizesKey = "iconSizes";
     static std::wstring_view const kJsonFileName = L"pin.json";
 
     std::wstring const filePath = std::format(L"{}\\{}", pinDirectory, kJsonFileName);
@@ -44,14 +46,26 @@ writePinJson(
         throw WStringRuntimeError(std::format(L"Failed to open file {} for writing", filePath));
     }
 
+    std::string iconSizesJson;
+    for (int const iconSize : iconSizes)
+    {
+        if (!iconSizesJson.empty())
+        {
+            iconSizesJson += ", ";
+        }
+        iconSizesJson += std::to_string(iconSize);
+    }
+
     strm << std::format(
         "{{\n"
         "  \"{}\": {},\n"
         "  \"{}\": {},\n"
-        "  \"{}\": {}\n"
+        "  \"{}\": {},\n"
+        "  \"{}\": [{}]\n"
         "}}",
         kWindowsPathToExecutableKey, escapeAndQuoteJsonString(windowsPathToExecutable), kLabelKey,
-        escapeAndQuoteJsonString(label), kHasIconKey, (hasIcon ? "true" : "false"));
+        escapeAndQuoteJsonString(label), kHasIconKey, (hasIcon ? "true" : "false"), kIconSizesKey,
+        iconSizesJson);
 
     strm.flush();
 
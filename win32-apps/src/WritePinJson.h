@@ -18,13 +18,16 @@
 
 #pragma once
 
+#include <span>
 #include <string_view>
 
 /**
  * Writes a pin.json file to the specified directory holding the provided information.
  *
+ * @param iconSizes The sizes (in pixels) of the icon PNGs written to the pin directory.
+ *
  * @throw WStringException If anything goes wrong.
  */
 void writePinJson(
     std::wstring_view pinDirectory, std::wstring_view label,
-    std::wstring_view windowsPathToExecutable, bool hasIcon);
+    std::wstring_view windowsPathToExecutable, bool hasIcon, std::span<int const> iconSizes);
@@ -17,12 +17,16 @@
  */
 
 #include "CoInitializer.h"
+#include "DesktopChangeWatcher.h"
 #include "EnumerateFilesOnDesktop.h"
 #include "FillPinDirectory.h"
+#include "ProcessTreeLogger.h"
 #include "RunProcess.h"
+#include "SelectPinCandidates.h"
 #include "ScopeCleanup.h"
 #include "ToWindowsFilePath.h"
 #include "WStringException.h"
+#include "WriteJobReportJson.h"
 
 #include <windows.h>
 
@@ -36,9 +40,50 @@
 #include <format>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace
+{
+
+/**
+ * Logs the process tree events and writes a job report once the tree has exited.
+ */
+class InstallerProcessTreeListener : public ProcessTreeLogger
+{
+public:
+    explicit InstallerProcessTreeListener(std::wstring_view windowsPinsDir)
+        : mWindowsPinsDir(windowsPinsDir)
+    {
+    }
+
+    void onProcessTreeExited(HANDLE job) override
+    {
+        ProcessTreeLogger::onProcessTreeExited(job);
+
+        // The report is nice to have, so failing to produce it is not an error.
+        try
+        {
+            writeJobReportJson(mWindowsPinsDir, job);
+        }
+        catch (WStringException const& e)
+        {
+            std::wcout << e.what() << std::endl;
+        }
+        catch (std::exception const& e)
+        {
+            std::cout << e.what() << std::endl;
+        }
+    }
+
+private:
+    std::wstring mWindowsPinsDir;
+};
+
+} // namespace
+
 extern "C"
 {
 
@@ -46,10 +91,11 @@ int WINAPI
 wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PWSTR /*pCmdLine*/, int /*nCmdShow*/)
 {
     // When the "Run Installer" function is invoked, Wine runs this launcher first, which
-    // in turn runs the target executable. The launcher enumerates the items in the Desktop
-    // folder before and after running the the target executable (the installer) in order to
-    // detect which items were added by the installer. For each of those items, it extracts
-    // their icon and other metadata and writes them to a pin directory.
+    // in turn runs the target executable. The launcher watches the Desktop and Start Menu
+    // folders while the target executable (the installer) runs in order to detect which
+    // items were added by the installer. For each of those items, it extracts
+    // their icon and other metadata and writes them to a pin directory. It also writes
+    // a job-report.json file with the resource usage of the installer's process tree.
 
     CoInitializer const coInitializer;
 
@@ -73,21 +119,52 @@ wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PWSTR /*pCmdLine*
         auto const windowsPinsDir = toWindowsFilePath(unixPinsDir);
         auto const windowsExecutable = toWindowsFilePath(unixOrWindowsExecutable);
 
-        std::vector<std::wstring> desktopFilesBefore = enumerateFilesOnDesktop();
-        std::sort(desktopFilesBefore.begin(), desktopFilesBefore.end());
+        // We watch the Desktop and the Start Menu while the installer runs. If that's not
+        // possible, we fall back to comparing the contents of the Desktop before and after.
+        std::unique_ptr<DesktopChangeWatcher> desktopChangeWatcher;
+        std::vector<std::wstring> desktopFilesBefore;
+
+        try
+        {
+            desktopChangeWatcher = std::make_unique<DesktopChangeWatcher>();
+        }
+        catch (WStringException const& e)
+        {
+            std::wcout << e.what() << std::endl;
+        }
+
+        if (!desktopChangeWatcher)
+        {
+            desktopFilesBefore = enumerateFilesOnDesktop();
+            std::sort(desktopFilesBefore.begin(), desktopFilesBefore.end());
+        }
+
+        // Installers tend to spawn child processes and exit before those do, so we wait
+        // for the whole process tree before looking for new desktop files.
+        InstallerProcessTreeListener processTreeListener(windowsPinsDir);
+        int const exitCode =
+            runProcess(windowsExecutable.c_str(), argv + 3, argc - 3, &processTreeListener);
+
+        std::vector<std::wstring> addedFiles;
 
-        int const exitCode = runProcess(windowsExecutable.c_str(), argv + 3, argc - 3);
+        if (desktopChangeWatcher)
+        {
+            addedFiles = desktopChangeWatcher->stop();
+        }
+        else
+        {
+            std::vector<std::wstring> desktopFilesAfter = enumerateFilesOnDesktop();
+            std::sort(desktopFilesAfter.begin(), desktopFilesAfter.end());
 
-        std::vector<std::wstring> desktopFilesAfter = enumerateFilesOnDesktop();
-        std::sort(desktopFilesAfter.begin(), desktopFilesAfter.end());
+            std::set_difference(
+                desktopFilesAfter.begin(), desktopFilesAfter.end(), desktopFilesBefore.begin(),
+                desktopFilesBefore.end(), std::back_inserter(addedFiles));
+        }
 
-        std::vector<std::wstring> addedDesktopFiles;
-        std::set_difference(
-            desktopFilesAfter.begin(), desktopFilesAfter.end(), desktopFilesBefore.begin(),
-            desktopFilesBefore.end(), std::back_inserter(addedDesktopFiles));
+        std::vector<std::wstring> const pinTargetFiles = selectPinCandidates(addedFiles);
 
         int pinSubdirNumber = 0;
-        for (auto const& pinTargetFile : addedDesktopFiles)
+        for (auto const& pinTargetFile : pinTargetFiles)
         {
             ++pinSubdirNumber;
 
@@ -0,0 +1,142 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ProcessTreeLogger.h"
+#include "RunProcess.h"
+#include "ScopeCleanup.h"
+#include "StopFileWatcher.h"
+#include "ToWindowsFilePath.h"
+#include "WStringException.h"
+
+#include <windows.h>
+
+// This one has to go after <windows.h>
+#include <shellapi.h>
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+/**
+ * Creating a file with this name in the control directory terminates the process tree.
+ */
+wchar_t const kStopFileName[] = L"stop";
+
+/**
+ * Terminates the process tree once a stop file appears in the control directory.
+ */
+class LaunchShimProcessTreeListener : public ProcessTreeLogger
+{
+public:
+    explicit LaunchShimProcessTreeListener(std::wstring_view windowsControlDir)
+        : mWindowsControlDir(windowsControlDir)
+    {
+    }
+
+    void onProcessTreeStarted(HANDLE job) override
+    {
+        ProcessTreeLogger::onProcessTreeStarted(job);
+
+        // Without the watcher, the process tree can still be stopped by killing us,
+        // as the job is set up to kill its processes once its last handle is closed.
+        try
+        {
+            mStopFileWatcher = std::make_unique<StopFileWatcher>(
+                mWindowsControlDir, kStopFileName, [job] {
+                    std::wcout << L"Stop requested. Terminating the process tree." << std::endl;
+                    TerminateJobObject(job, 1);
+                });
+        }
+        catch (WStringException const& e)
+        {
+            std::wcout << e.what() << std::endl;
+        }
+    }
+
+    void onProcessTreeExited(HANDLE job) override
+    {
+        mStopFileWatcher.reset();
+
+        ProcessTreeLogger::onProcessTreeExited(job);
+    }
+
+private:
+    std::wstring mWindowsControlDir;
+    std::unique_ptr<StopFileWatcher> mStopFileWatcher;
+};
+
+} // namespace
+
+extern "C"
+{
+
+int WINAPI
+wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PWSTR /*pCmdLine*/, int /*nCmdShow*/)
+{
+    // Pinned executables are launched through this shim. "wine" returns as soon as it has
+    // started the Windows executable, so on its own it can't tell when the executable (and
+    // whatever it spawns) exits, short of running "wineserver -w", which waits for every
+    // process in the prefix. This shim puts the executable into a job object of its own,
+    // which lets it:
+    // 1. Exit when the last process in that job exits, and not before.
+    // 2. Terminate just that job when asked to stop, rather than the whole prefix.
+    //    A stop is requested by creating a file named "stop" in the control directory.
+
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+
+    ScopeCleanup const argvCleanup([argv] { LocalFree(argv); });
+
+    if (argc < 3)
+    {
+        wprintf(
+            L"Usage: %ls <unix_control_dir> <unix_or_windows_executable> [args...]\n", argv[0]);
+        return 1;
+    }
+
+    wchar_t const* unixControlDir = argv[1];
+    wchar_t const* unixOrWindowsExecutable = argv[2];
+
+    try
+    {
+        // These will throw if the paths don't exist.
+        auto const windowsControlDir = toWindowsFilePath(unixControlDir);
+        auto const windowsExecutable = toWindowsFilePath(unixOrWindowsExecutable);
+
+        LaunchShimProcessTreeListener processTreeListener(windowsControlDir);
+        return runProcess(windowsExecutable.c_str(), argv + 3, argc - 3, &processTreeListener);
+    }
+    catch (WStringException const& e)
+    {
+        std::wcout << e.what() << std::endl;
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << e.what() << std::endl;
+    }
+
+    return 1;
+}
+
+} // extern "C"
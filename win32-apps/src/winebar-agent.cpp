@@ -0,0 +1,231 @@
+/*
+ * Wine Bar - A Wine prefix manager.
+ * Copyright (C) 2025 Josif Arcimovic
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AgentMessageChannel.h"
+#include "CoInitializer.h"
+#include "EnumerateFilesOnDesktop.h"
+#include "FillPinDirectory.h"
+#include "GdiplusInitializer.h"
+#include "IdleTimeoutWatchdog.h"
+#include "QueryRegistryValue.h"
+#include "ScopeCleanup.h"
+#include "ToWindowsFilePath.h"
+#include "Utf8.h"
+#include "WStringException.h"
+#include "WStringRuntimeError.h"
+
+#include <windows.h>
+
+// These have to go after <windows.h>
+#include <io.h>
+#include <shellapi.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * How long to wait for the next request before exiting, unless specified on the command line.
+ */
+DWORD const kDefaultIdleTimeoutSeconds = 5 * 60;
+
+void
+requireArgs(std::vector<std::wstring> const& request, size_t numArgs)
+{
+    if (request.size() != numArgs + 1)
+    {
+        throw WStringRuntimeError(
+            std::format(
+                L"Request {} takes {} arguments, got {}", request[0], numArgs,
+                request.size() - 1));
+    }
+}
+
+/**
+ * Performs the requested operation and returns its results.
+ *
+ * @throw WStringException, std::exception If the operation fails.
+ */
+std::vector<std::wstring>
+handleRequest(std::vector<std::wstring> const& request)
+{
+    if (request.empty())
+    {
+        throw WStringRuntimeError(L"Empty request");
+    }
+
+    std::wstring const& op = request[0];
+
+    if (op == L"ping")
+    {
+        requireArgs(request, 0);
+        return {};
+    }
+    else if (op == L"fill-pin-dir")
+    {
+        // The same as what pin-executable-info-extractor.exe does.
+        requireArgs(request, 2);
+        auto const windowsPinDir = toWindowsFilePath(request[1]);
+        fillPinDirectory(windowsPinDir.c_str(), request[2].c_str());
+        return {};
+    }
+    else if (op == L"to-windows-path")
+    {
+        requireArgs(request, 1);
+        return {toWindowsFilePath(request[1])};
+    }
+    else if (op == L"enumerate-desktop")
+    {
+        requireArgs(request, 0);
+        return enumerateFilesOnDesktop();
+    }
+    else if (op == L"reg-query")
+    {
+        requireArgs(request, 2);
+        return {queryRegistryValue(request[1], request[2])};
+    }
+
+    throw WStringRuntimeError(std::format(L"Unknown request: {}", op));
+}
+
+std::vector<std::wstring>
+buildResponse(std::vector<std::wstring> const& request)
+{
+    try
+    {
+        std::vector<std::wstring> response = handleRequest(request);
+        response.insert(response.begin(), L"ok");
+        return response;
+    }
+    catch (WStringException const& e)
+    {
+        return {L"error", e.what()};
+    }
+    catch (std::exception const& e)
+    {
+        return {L"error", fromUtf8(e.what())};
+    }
+}
+
+/**
+ * Takes the process's stdout for the protocol and redirects whatever else would go to stdout
+ * (the helpers in the common library print their diagnostics there) to stderr.
+ *
+ * @return The handle to write the responses to.
+ * @throw WStringRuntimeError On failure.
+ */
+HANDLE
+takeOverStdout()
+{
+    HANDLE protocolOutput = nullptr;
+    if (!DuplicateHandle(
+            GetCurrentProcess(), GetStdHandle(STD_OUTPUT_HANDLE), GetCurrentProcess(),
+            &protocolOutput, 0, FALSE, DUPLICATE_SAME_ACCESS))
+    {
+        throw WStringRuntimeError(L"Failed to duplicate the stdout handle");
+    }
+
+    fflush(stdout);
+    if (_dup2(_fileno(stderr), _fileno(stdout)) != 0)
+    {
+        CloseHandle(protocolOutput);
+        throw WStringRuntimeError(L"Failed to redirect stdout to stderr");
+    }
+
+    SetStdHandle(STD_OUTPUT_HANDLE, GetStdHandle(STD_ERROR_HANDLE));
+
+    return protocolOutput;
+}
+
+} // namespace
+
+extern "C"
+{
+
+int WINAPI
+wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PWSTR /*pCmdLine*/, int /*nCmdShow*/)
+{
+    // Each helper operation (pinning an executable, converting a path, etc.) would otherwise
+    // pay for starting a Wine process, which takes seconds. This agent is started once per
+    // prefix session and serves such operations one after another over stdin / stdout,
+    // keeping COM, GDI+ and the modules they load warm in between. See AgentMessageChannel
+    // for the protocol. The agent exits when stdin is closed or after being idle for a while.
+
+    CoInitializer const coInitializer;
+
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+
+    ScopeCleanup const argvCleanup([argv] { LocalFree(argv); });
+
+    if (argc > 2)
+    {
+        std::wcerr << std::format(L"Usage: {} [idle_timeout_seconds]", argv[0]) << std::endl;
+        return 1;
+    }
+
+    DWORD const idleTimeoutSeconds =
+        argc == 2 ? (DWORD)wcstoul(argv[1], nullptr, 10) : kDefaultIdleTimeoutSeconds;
+
+    try
+    {
+        GdiplusInitializer const gdiplusInitializer;
+
+        HANDLE const protocolOutput = takeOverStdout();
+        ScopeCleanup const protocolOutputCleanup([protocolOutput] {
+            CloseHandle(protocolOutput);
+        });
+
+        AgentMessageChannel channel(GetStdHandle(STD_INPUT_HANDLE), protocolOutput);
+
+        // The main thread is blocked reading stdin while idle, so the only way to exit from
+        // there is to exit the whole process.
+        IdleTimeoutWatchdog idleTimeoutWatchdog(idleTimeoutSeconds * 1000, [] {
+            std::wcerr << L"Exiting due to inactivity" << std::endl;
+            ExitProcess(0);
+        });
+
+        while (auto const request = channel.readMessage())
+        {
+            idleTimeoutWatchdog.setBusy(true);
+            channel.writeMessage(buildResponse(*request));
+            idleTimeoutWatchdog.setBusy(false);
+        }
+
+        return 0;
+    }
+    catch (WStringException const& e)
+    {
+        std::wcerr << e.what() << std::endl;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
+    return 1;
+}
+
+} // extern "C"